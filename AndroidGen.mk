@@ -11,6 +11,7 @@ LOCAL_SRC_FILES := \
 	execserver/xsTestDriver.cpp \
 	execserver/xsTestProcess.cpp \
 	executor/xeBatchExecutor.cpp \
+	executor/xeBatchLogReader.cpp \
 	executor/xeBatchResult.cpp \
 	executor/xeCallQueue.cpp \
 	executor/xeCommLink.cpp \
@@ -40,12 +41,14 @@ LOCAL_SRC_FILES := \
 	external/vulkancts/framework/vulkan/vkMemUtil.cpp \
 	external/vulkancts/framework/vulkan/vkNullDriver.cpp \
 	external/vulkancts/framework/vulkan/vkObjUtil.cpp \
+	external/vulkancts/framework/vulkan/vkPipelineCacheUtil.cpp \
 	external/vulkancts/framework/vulkan/vkPlatform.cpp \
 	external/vulkancts/framework/vulkan/vkPrograms.cpp \
 	external/vulkancts/framework/vulkan/vkQueryUtil.cpp \
 	external/vulkancts/framework/vulkan/vkRef.cpp \
 	external/vulkancts/framework/vulkan/vkRefUtil.cpp \
 	external/vulkancts/framework/vulkan/vkRenderDocUtil.cpp \
+	external/vulkancts/framework/vulkan/vkShaderCache.cpp \
 	external/vulkancts/framework/vulkan/vkShaderProgram.cpp \
 	external/vulkancts/framework/vulkan/vkShaderToSpirV.cpp \
 	external/vulkancts/framework/vulkan/vkSpirVAsm.cpp \
@@ -394,6 +397,7 @@ LOCAL_SRC_FILES := \
 	framework/common/tcuInterval.cpp \
 	framework/common/tcuMatrix.cpp \
 	framework/common/tcuMaybe.cpp \
+	framework/common/tcuParallelFor.cpp \
 	framework/common/tcuPlatform.cpp \
 	framework/common/tcuRGBA.cpp \
 	framework/common/tcuRandomValueIterator.cpp \
@@ -411,6 +415,7 @@ LOCAL_SRC_FILES := \
 	framework/common/tcuTestHierarchyUtil.cpp \
 	framework/common/tcuTestLog.cpp \
 	framework/common/tcuTestPackage.cpp \
+	framework/common/tcuTestProfiler.cpp \
 	framework/common/tcuTestSessionExecutor.cpp \
 	framework/common/tcuTexCompareVerifier.cpp \
 	framework/common/tcuTexLookupVerifier.cpp \
@@ -490,6 +495,7 @@ LOCAL_SRC_FILES := \
 	framework/delibs/deutil/deCommandLine.c \
 	framework/delibs/deutil/deDynamicLibrary.c \
 	framework/delibs/deutil/deFile.c \
+	framework/delibs/deutil/deMappedFile.c \
 	framework/delibs/deutil/deProcess.c \
 	framework/delibs/deutil/deSocket.c \
 	framework/delibs/deutil/deTimer.c \
@@ -564,6 +570,7 @@ LOCAL_SRC_FILES := \
 	framework/platform/android/tcuAndroidUtil.cpp \
 	framework/platform/android/tcuAndroidWindow.cpp \
 	framework/platform/android/tcuTestLogParserJNI.cpp \
+	framework/qphelper/qpAsyncWriter.c \
 	framework/qphelper/qpCrashHandler.c \
 	framework/qphelper/qpDebugOut.c \
 	framework/qphelper/qpInfo.c \
@@ -36,16 +36,18 @@
 namespace opt
 {
 
-DE_DECLARE_COMMAND_LINE_OPT(Port,		int);
-DE_DECLARE_COMMAND_LINE_OPT(SingleExec,	bool);
+DE_DECLARE_COMMAND_LINE_OPT(Port,			int);
+DE_DECLARE_COMMAND_LINE_OPT(SingleExec,		bool);
+DE_DECLARE_COMMAND_LINE_OPT(LogFileName,	std::string);
 
 void registerOptions (de::cmdline::Parser& parser)
 {
 	using de::cmdline::Option;
 	using de::cmdline::NamedValue;
 
-	parser << Option<Port>		("p", "port",	"Port", "50016")
-		   << Option<SingleExec>("s", "single",	"Kill execserver after first session");
+	parser << Option<Port>			("p", "port",			"Port", "50016")
+		   << Option<SingleExec>	("s", "single",			"Kill execserver after first session")
+		   << Option<LogFileName>	("l", "log-filename",	"Test log file name, relative to test working directory", "TestResults.qpa");
 }
 
 }
@@ -54,11 +56,7 @@ int main (int argc, const char* const* argv)
 {
 	de::cmdline::CommandLine	cmdLine;
 
-#if (DE_OS == DE_OS_WIN32)
-	xs::Win32TestProcess		testProcess;
-#else
-	xs::PosixTestProcess		testProcess;
-
+#if (DE_OS != DE_OS_WIN32)
 	// Set line buffered mode to stdout so executor gets any log messages in a timely manner.
 	setvbuf(stdout, DE_NULL, _IOLBF, 4*1024);
 #endif
@@ -77,6 +75,11 @@ int main (int argc, const char* const* argv)
 
 	try
 	{
+#if (DE_OS == DE_OS_WIN32)
+		xs::Win32TestProcess				testProcess	(cmdLine.getOption<opt::LogFileName>().c_str());
+#else
+		xs::PosixTestProcess				testProcess	(cmdLine.getOption<opt::LogFileName>().c_str());
+#endif
 		const xs::ExecutionServer::RunMode	runMode		= cmdLine.getOption<opt::SingleExec>()
 														? xs::ExecutionServer::RUNMODE_SINGLE_EXEC
 														: xs::ExecutionServer::RUNMODE_FOREVER;
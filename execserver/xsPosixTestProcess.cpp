@@ -168,9 +168,10 @@ void PipeReader::stop (void)
 
 } // unix
 
-PosixTestProcess::PosixTestProcess (void)
+PosixTestProcess::PosixTestProcess (const char* logFileName)
 	: m_process				(DE_NULL)
 	, m_processStartTime	(0)
+	, m_logFileBaseName		(logFileName)
 	, m_infoBuffer			(INFO_BUFFER_BLOCK_SIZE, INFO_BUFFER_NUM_BLOCKS)
 	, m_stdOutReader		(&m_infoBuffer)
 	, m_stdErrReader		(&m_infoBuffer)
@@ -189,7 +190,7 @@ void PosixTestProcess::start (const char* name, const char* params, const char*
 
 	XS_CHECK(!m_process);
 
-	de::FilePath logFilePath = de::FilePath::join(workingDir, "TestResults.qpa");
+	de::FilePath logFilePath = de::FilePath::join(workingDir, m_logFileBaseName);
 	m_logFileName = logFilePath.getPath();
 
 	// Remove old file if such exists.
@@ -201,7 +202,7 @@ void PosixTestProcess::start (const char* name, const char* params, const char*
 
 	// Construct command line.
 	string cmdLine = de::FilePath(name).isAbsolutePath() ? name : de::FilePath::join(workingDir, name).getPath();
-	cmdLine += string(" --deqp-log-filename=") + logFilePath.getBaseName();
+	cmdLine += string(" --deqp-log-filename=") + m_logFileBaseName;
 
 	if (hasCaseList)
 		cmdLine += " --deqp-stdin-caselist";
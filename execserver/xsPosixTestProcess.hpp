@@ -75,7 +75,7 @@ private:
 class PosixTestProcess : public TestProcess
 {
 public:
-							PosixTestProcess		(void);
+							PosixTestProcess		(const char* logFileName = "TestResults.qpa");
 	virtual					~PosixTestProcess		(void);
 
 	virtual void			start					(const char* name, const char* params, const char* workingDir, const char* caseList);
@@ -95,6 +95,7 @@ private:
 
 	de::Process*			m_process;
 	deUint64				m_processStartTime;		//!< Used for determining log file timeout.
+	const std::string		m_logFileBaseName;		//!< Log file name relative to working directory.
 	std::string				m_logFileName;
 	ThreadedByteBuffer		m_infoBuffer;
 
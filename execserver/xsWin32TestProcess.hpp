@@ -179,7 +179,7 @@ private:
 class Win32TestProcess : public TestProcess
 {
 public:
-							Win32TestProcess		(void);
+							Win32TestProcess		(const char* logFileName = "TestResults.qpa");
 	virtual					~Win32TestProcess		(void);
 
 	virtual void			start					(const char* name, const char* params, const char* workingDir, const char* caseList);
@@ -198,6 +198,7 @@ private:
 
 	win32::Process*			m_process;
 	deUint64				m_processStartTime;
+	const std::string		m_logFileBaseName;		//!< Log file name relative to working directory.
 	std::string				m_logFileName;
 
 	ThreadedByteBuffer		m_infoBuffer;
@@ -30,8 +30,8 @@
 
 #include "deCommandLine.hpp"
 #include "deDirectoryIterator.hpp"
+#include "deSharedPtr.hpp"
 #include "deStringUtil.hpp"
-#include "deUniquePtr.hpp"
 
 #include "deString.h"
 
@@ -62,6 +62,7 @@ namespace opt
 DE_DECLARE_COMMAND_LINE_OPT(StartServer,	string);
 DE_DECLARE_COMMAND_LINE_OPT(Host,			string);
 DE_DECLARE_COMMAND_LINE_OPT(Port,			int);
+DE_DECLARE_COMMAND_LINE_OPT(Shards,			int);
 DE_DECLARE_COMMAND_LINE_OPT(CaseListDir,	string);
 DE_DECLARE_COMMAND_LINE_OPT(TestSet,		vector<string>);
 DE_DECLARE_COMMAND_LINE_OPT(ExcludeSet,		vector<string>);
@@ -98,6 +99,7 @@ void registerOptions (de::cmdline::Parser& parser)
 	parser << Option<StartServer>	("s",		"start-server",	"Start local execserver. Path to the execserver binary.")
 		   << Option<Host>			("c",		"connect",		"Connect to host. Address of the execserver.")
 		   << Option<Port>			("p",		"port",			"TCP port of the execserver.",											"50016")
+		   << Option<Shards>		("j",		"shards",		"Number of test processes to run in parallel. Shard N uses port + N.",	"1")
 		   << Option<CaseListDir>	("cd",		"caselistdir",	"Path to the directory containing test case XML files.",				".")
 		   << Option<TestSet>		("t",		"testset",		"Comma-separated list of include filters.",								parseCommaSeparatedList)
 		   << Option<ExcludeSet>	("e",		"exclude",		"Comma-separated list of exclude filters.",								parseCommaSeparatedList, "")
@@ -122,6 +124,7 @@ struct CommandLine
 {
 	CommandLine (void)
 		: port		(0)
+		, numShards	(1)
 		, summary	(false)
 	{
 	}
@@ -130,6 +133,7 @@ struct CommandLine
 	RunMode					runMode;
 	string					serverBinOrAddress;
 	int						port;
+	int						numShards;
 	string					caseListDir;
 	vector<string>			testset;
 	vector<string>			exclude;
@@ -172,6 +176,12 @@ bool parseCommandLine (CommandLine& cmdLine, int argc, const char* const* argv)
 		return false;
 	}
 
+	if (opts.getOption<opt::Shards>() < 1)
+	{
+		std::cout << "Invalid command line arguments. --shards must be at least 1." << std::endl;
+		return false;
+	}
+
 	if (opts.hasOption<opt::StartServer>())
 	{
 		cmdLine.runMode				= RUNMODE_START_SERVER;
@@ -195,6 +205,7 @@ bool parseCommandLine (CommandLine& cmdLine, int argc, const char* const* argv)
 	}
 
 	cmdLine.port					= opts.getOption<opt::Port>();
+	cmdLine.numShards				= opts.getOption<opt::Shards>();
 	cmdLine.caseListDir				= opts.getOption<opt::CaseListDir>();
 	cmdLine.testset					= opts.getOption<opt::TestSet>();
 	cmdLine.exclude					= opts.getOption<opt::ExcludeSet>();
@@ -456,14 +467,18 @@ void writeInfoLog (const xe::InfoLog& log, const char* filename)
 	out.close();
 }
 
-xe::CommLink* createCommLink (const CommandLine& cmdLine)
+xe::CommLink* createCommLink (const CommandLine& cmdLine, int shardNdx)
 {
+	const int port = cmdLine.port + shardNdx;
+
 	if (cmdLine.runMode == RUNMODE_START_SERVER)
 	{
-		xe::LocalTcpIpLink* link = new xe::LocalTcpIpLink();
+		// All shards run in the same working directory so they must not share a log file.
+		const string		logFileName	= "TestResults-" + de::toString(shardNdx) + ".qpa";
+		xe::LocalTcpIpLink*	link		= new xe::LocalTcpIpLink();
 		try
 		{
-			link->start(cmdLine.serverBinOrAddress.c_str(), DE_NULL, cmdLine.port);
+			link->start(cmdLine.serverBinOrAddress.c_str(), DE_NULL, port, cmdLine.numShards > 1 ? logFileName.c_str() : DE_NULL);
 			return link;
 		}
 		catch (...)
@@ -479,7 +494,7 @@ xe::CommLink* createCommLink (const CommandLine& cmdLine)
 		address.setFamily(DE_SOCKETFAMILY_INET4);
 		address.setProtocol(DE_SOCKETPROTOCOL_TCP);
 		address.setHost(cmdLine.serverBinOrAddress.c_str());
-		address.setPort(cmdLine.port);
+		address.setPort(port);
 
 		xe::TcpIpLink* link = new xe::TcpIpLink();
 		try
@@ -492,7 +507,7 @@ xe::CommLink* createCommLink (const CommandLine& cmdLine)
 		catch (const std::exception& error)
 		{
 			delete link;
-			throw xe::Error("Failed to connect to ExecServer at: " + cmdLine.serverBinOrAddress + ":" + de::toString(cmdLine.port) + ", " + error.what());
+			throw xe::Error("Failed to connect to ExecServer at: " + cmdLine.serverBinOrAddress + ":" + de::toString(port) + ", " + error.what());
 		}
 		catch (...)
 		{
@@ -604,10 +619,19 @@ void runExecutor (const CommandLine& cmdLine)
 	if (!cmdLine.inFile.empty())
 		readLogFile(&batchResult, cmdLine.inFile.c_str());
 
-	// Initialize commLink.
-	de::UniquePtr<xe::CommLink> commLink(createCommLink(cmdLine));
+	// Initialize commLinks, one per shard.
+	vector<de::SharedPtr<xe::CommLink> >	commLinks;
+	vector<xe::CommLink*>					commLinkPtrs;
+
+	for (int shardNdx = 0; shardNdx < cmdLine.numShards; shardNdx++)
+	{
+		const de::SharedPtr<xe::CommLink> commLink (createCommLink(cmdLine, shardNdx));
+
+		commLinks.push_back(commLink);
+		commLinkPtrs.push_back(commLink.get());
+	}
 
-	xe::BatchExecutor executor(cmdLine.targetCfg, commLink.get(), &root, testSet, &batchResult, &infoLog);
+	xe::BatchExecutor executor(cmdLine.targetCfg, commLinkPtrs, &root, testSet, &batchResult, &infoLog);
 
 	try
 	{
@@ -652,10 +676,11 @@ void runExecutor (const CommandLine& cmdLine)
 	if (cmdLine.summary)
 		printBatchResultSummary(&root, testSet, batchResult);
 
+	for (size_t linkNdx = 0; linkNdx < commLinks.size(); linkNdx++)
 	{
 		string err;
 
-		if (commLink->getState(err) == xe::COMMLINKSTATE_ERROR)
+		if (commLinks[linkNdx]->getState(err) == xe::COMMLINKSTATE_ERROR)
 			throw xe::Error(err);
 	}
 }
@@ -21,7 +21,7 @@
  * \brief Extract shader programs from log.
  *//*--------------------------------------------------------------------*/
 
-#include "xeTestLogParser.hpp"
+#include "xeBatchLogReader.hpp"
 #include "xeTestResultParser.hpp"
 #include "deFilePath.hpp"
 #include "deStringUtil.hpp"
@@ -43,11 +43,14 @@ using std::map;
 struct CommandLine
 {
 	CommandLine (void)
+		: useIndex(false)
 	{
 	}
 
-	string		filename;
-	string		dstPath;
+	string			filename;
+	string			dstPath;
+	vector<string>	casePaths;
+	bool			useIndex;
 };
 
 static const char* getShaderTypeSuffix (const xe::ri::Shader::ShaderType shaderType)
@@ -128,77 +131,55 @@ static void extractShaderPrograms (const CommandLine& cmdLine, const std::string
 		std::cout << "WARNING: no shader programs found in '" << casePath << "'\n";
 }
 
-class ShaderProgramExtractHandler : public xe::TestLogHandler
+static void extractShaderProgramsFromResult (const CommandLine& cmdLine, const xe::BatchLogReader& reader, xe::TestResultParser& testResultParser, int resultNdx)
 {
-public:
-	ShaderProgramExtractHandler (const CommandLine& cmdLine)
-		: m_cmdLine(cmdLine)
+	if (reader.getTestCaseDataSize(resultNdx) > 0)
 	{
-	}
-
-	void setSessionInfo (const xe::SessionInfo&)
-	{
-		// Ignored.
-	}
-
-	xe::TestCaseResultPtr startTestCaseResult (const char* casePath)
-	{
-		return xe::TestCaseResultPtr(new xe::TestCaseResultData(casePath));
-	}
-
-	void testCaseResultUpdated (const xe::TestCaseResultPtr&)
-	{
-		// Ignored.
-	}
-
-	void testCaseResultComplete (const xe::TestCaseResultPtr& caseData)
-	{
-		if (caseData->getDataSize() > 0)
-		{
-			xe::TestCaseResult					fullResult;
-			xe::TestResultParser::ParseResult	parseResult;
+		xe::TestCaseResult					fullResult;
+		xe::TestResultParser::ParseResult	parseResult;
 
-			m_testResultParser.init(&fullResult);
-			parseResult = m_testResultParser.parse(caseData->getData(), caseData->getDataSize());
-			DE_UNREF(parseResult);
+		testResultParser.init(&fullResult);
+		parseResult = testResultParser.parse(reader.getTestCaseData(resultNdx), reader.getTestCaseDataSize(resultNdx));
+		DE_UNREF(parseResult);
 
-			extractShaderPrograms(m_cmdLine, caseData->getTestCasePath(), fullResult);
-		}
+		extractShaderPrograms(cmdLine, reader.getTestCasePath(resultNdx), fullResult);
 	}
-
-private:
-	const CommandLine&		m_cmdLine;
-	xe::TestResultParser	m_testResultParser;
-};
+}
 
 static void extractShaderProgramsFromLogFile (const CommandLine& cmdLine)
 {
-	std::ifstream					in				(cmdLine.filename.c_str(), std::ifstream::binary|std::ifstream::in);
-	ShaderProgramExtractHandler		resultHandler	(cmdLine);
-	xe::TestLogParser				parser			(&resultHandler);
-	deUint8							buf				[1024];
-	int								numRead			= 0;
+	xe::BatchLogReader		reader				(cmdLine.filename.c_str());
+	xe::TestResultParser	testResultParser;
 
-	if (!in.good())
-		throw std::runtime_error(string("Failed to open '") + cmdLine.filename + "'");
+	if (cmdLine.useIndex)
+		reader.readOrCreateIndex(xe::BatchLogReader::getDefaultIndexFilename(cmdLine.filename.c_str()).c_str());
+	else
+		reader.createIndex();
 
-	for (;;)
+	if (cmdLine.casePaths.empty())
 	{
-		in.read((char*)&buf[0], DE_LENGTH_OF_ARRAY(buf));
-		numRead = (int)in.gcount();
+		for (int resultNdx = 0; resultNdx < reader.getNumTestCaseResults(); resultNdx++)
+			extractShaderProgramsFromResult(cmdLine, reader, testResultParser, resultNdx);
+	}
+	else
+	{
+		for (vector<string>::const_iterator casePath = cmdLine.casePaths.begin(); casePath != cmdLine.casePaths.end(); ++casePath)
+		{
+			const int resultNdx = reader.findTestCaseResult(casePath->c_str());
 
-		if (numRead <= 0)
-			break;
+			if (resultNdx < 0)
+				throw xe::Error("No result for '" + *casePath + "' in log");
 
-		parser.parse(&buf[0], numRead);
+			extractShaderProgramsFromResult(cmdLine, reader, testResultParser, resultNdx);
+		}
 	}
-
-	in.close();
 }
 
 static void printHelp (const char* binName)
 {
 	printf("%s: [filename] [dst path (optional)]\n", binName);
+	printf(" --case=[case path]  Extract only given case. Can be repeated.\n");
+	printf(" --index             Read or write log index from [filename].idx.\n");
 }
 
 static bool parseCommandLine (CommandLine& cmdLine, int argc, const char* const* argv)
@@ -207,7 +188,11 @@ static bool parseCommandLine (CommandLine& cmdLine, int argc, const char* const*
 	{
 		const char* arg = argv[argNdx];
 
-		if (!deStringBeginsWith(arg, "--"))
+		if (deStringBeginsWith(arg, "--case="))
+			cmdLine.casePaths.push_back(arg + 7);
+		else if (deStringEqual(arg, "--index"))
+			cmdLine.useIndex = true;
+		else if (!deStringBeginsWith(arg, "--"))
 		{
 			if (cmdLine.filename.empty())
 				cmdLine.filename = arg;
@@ -21,7 +21,7 @@
  * \brief Extract values by name from logs.
  *//*--------------------------------------------------------------------*/
 
-#include "xeTestLogParser.hpp"
+#include "xeBatchLogReader.hpp"
 #include "xeTestResultParser.hpp"
 #include "deFilePath.hpp"
 #include "deString.h"
@@ -42,13 +42,16 @@ using std::map;
 struct CommandLine
 {
 	CommandLine (void)
-		: statusCode(false)
+		: statusCode	(false)
+		, useIndex		(false)
 	{
 	}
 
 	string			filename;
 	vector<string>	tagNames;
+	vector<string>	casePaths;
 	bool			statusCode;
+	bool			useIndex;
 };
 
 typedef xe::ri::NumericValue Value;
@@ -123,106 +126,82 @@ static Value findValueByTag (const xe::ri::List& items, const string& tagName)
 	return Value();
 }
 
-class TagParser : public xe::TestLogHandler
+static void readCaseValues (BatchResultValues& batchResult, const xe::BatchLogReader& reader, xe::TestResultParser& testResultParser, int resultNdx)
 {
-public:
-	TagParser (BatchResultValues& result)
-		: m_result(result)
-	{
-	}
-
-	void setSessionInfo (const xe::SessionInfo&)
-	{
-		// Ignored.
-	}
+	const vector<string>&	tagNames	= batchResult.getTagNames();
+	CaseValues				tagResult;
 
-	xe::TestCaseResultPtr startTestCaseResult (const char* casePath)
-	{
-		return xe::TestCaseResultPtr(new xe::TestCaseResultData(casePath));
-	}
-
-	void testCaseResultUpdated (const xe::TestCaseResultPtr&)
-	{
-		// Ignored.
-	}
+	tagResult.casePath		= reader.getTestCasePath(resultNdx);
+	tagResult.caseType		= xe::TESTCASETYPE_SELF_VALIDATE;
+	tagResult.statusCode	= reader.getStatusCode(resultNdx);
+	tagResult.statusDetails	= reader.getStatusDetails(resultNdx);
+	tagResult.values.resize(tagNames.size());
 
-	void testCaseResultComplete (const xe::TestCaseResultPtr& caseData)
+	if (reader.getTestCaseDataSize(resultNdx) > 0 && reader.getStatusCode(resultNdx) == xe::TESTSTATUSCODE_LAST)
 	{
-		const vector<string>&	tagNames	= m_result.getTagNames();
-		CaseValues				tagResult;
+		xe::TestCaseResult					fullResult;
+		xe::TestResultParser::ParseResult	parseResult;
 
-		tagResult.casePath		= caseData->getTestCasePath();
-		tagResult.caseType		= xe::TESTCASETYPE_SELF_VALIDATE;
-		tagResult.statusCode	= caseData->getStatusCode();
-		tagResult.statusDetails	= caseData->getStatusDetails();
-		tagResult.values.resize(tagNames.size());
+		testResultParser.init(&fullResult);
+		parseResult = testResultParser.parse(reader.getTestCaseData(resultNdx), reader.getTestCaseDataSize(resultNdx));
 
-		if (caseData->getDataSize() > 0 && caseData->getStatusCode() == xe::TESTSTATUSCODE_LAST)
+		if ((parseResult != xe::TestResultParser::PARSERESULT_ERROR && fullResult.statusCode != xe::TESTSTATUSCODE_LAST) ||
+			(tagResult.statusCode == xe::TESTSTATUSCODE_LAST && fullResult.statusCode != xe::TESTSTATUSCODE_LAST))
 		{
-			xe::TestCaseResult					fullResult;
-			xe::TestResultParser::ParseResult	parseResult;
-
-			m_testResultParser.init(&fullResult);
-			parseResult = m_testResultParser.parse(caseData->getData(), caseData->getDataSize());
-
-			if ((parseResult != xe::TestResultParser::PARSERESULT_ERROR && fullResult.statusCode != xe::TESTSTATUSCODE_LAST) ||
-				(tagResult.statusCode == xe::TESTSTATUSCODE_LAST && fullResult.statusCode != xe::TESTSTATUSCODE_LAST))
-			{
-				tagResult.statusCode	= fullResult.statusCode;
-				tagResult.statusDetails	= fullResult.statusDetails;
-			}
-			else if (tagResult.statusCode == xe::TESTSTATUSCODE_LAST)
-			{
-				DE_ASSERT(parseResult == xe::TestResultParser::PARSERESULT_ERROR);
-				tagResult.statusCode	= xe::TESTSTATUSCODE_INTERNAL_ERROR;
-				tagResult.statusDetails	= "Test case result parsing failed";
-			}
-
-			if (parseResult != xe::TestResultParser::PARSERESULT_ERROR)
-			{
-				for (int valNdx = 0; valNdx < (int)tagNames.size(); valNdx++)
-					tagResult.values[valNdx] = findValueByTag(fullResult.resultItems, tagNames[valNdx]);
-			}
+			tagResult.statusCode	= fullResult.statusCode;
+			tagResult.statusDetails	= fullResult.statusDetails;
+		}
+		else if (tagResult.statusCode == xe::TESTSTATUSCODE_LAST)
+		{
+			DE_ASSERT(parseResult == xe::TestResultParser::PARSERESULT_ERROR);
+			tagResult.statusCode	= xe::TESTSTATUSCODE_INTERNAL_ERROR;
+			tagResult.statusDetails	= "Test case result parsing failed";
 		}
 
-		m_result.add(tagResult);
+		if (parseResult != xe::TestResultParser::PARSERESULT_ERROR)
+		{
+			for (int valNdx = 0; valNdx < (int)tagNames.size(); valNdx++)
+				tagResult.values[valNdx] = findValueByTag(fullResult.resultItems, tagNames[valNdx]);
+		}
 	}
 
-private:
-	BatchResultValues&		m_result;
-	xe::TestResultParser	m_testResultParser;
-};
+	batchResult.add(tagResult);
+}
 
-static void readLogFile (BatchResultValues& batchResult, const char* filename)
+static void readLogFile (BatchResultValues& batchResult, const CommandLine& cmdLine)
 {
-	std::ifstream		in				(filename, std::ifstream::binary|std::ifstream::in);
-	TagParser			resultHandler	(batchResult);
-	xe::TestLogParser	parser			(&resultHandler);
-	deUint8				buf				[1024];
-	int					numRead			= 0;
+	xe::BatchLogReader		reader				(cmdLine.filename.c_str());
+	xe::TestResultParser	testResultParser;
 
-	if (!in.good())
-		throw std::runtime_error(string("Failed to open '") + filename + "'");
+	if (cmdLine.useIndex)
+		reader.readOrCreateIndex(xe::BatchLogReader::getDefaultIndexFilename(cmdLine.filename.c_str()).c_str());
+	else
+		reader.createIndex();
 
-	for (;;)
+	if (cmdLine.casePaths.empty())
 	{
-		in.read((char*)&buf[0], DE_LENGTH_OF_ARRAY(buf));
-		numRead = (int)in.gcount();
+		for (int resultNdx = 0; resultNdx < reader.getNumTestCaseResults(); resultNdx++)
+			readCaseValues(batchResult, reader, testResultParser, resultNdx);
+	}
+	else
+	{
+		for (vector<string>::const_iterator casePath = cmdLine.casePaths.begin(); casePath != cmdLine.casePaths.end(); ++casePath)
+		{
+			const int resultNdx = reader.findTestCaseResult(casePath->c_str());
 
-		if (numRead <= 0)
-			break;
+			if (resultNdx < 0)
+				throw xe::Error("No result for '" + *casePath + "' in log");
 
-		parser.parse(&buf[0], numRead);
+			readCaseValues(batchResult, reader, testResultParser, resultNdx);
+		}
 	}
-
-	in.close();
 }
 
 static void printTaggedValues (const CommandLine& cmdLine, std::ostream& dst)
 {
 	BatchResultValues values(cmdLine.tagNames);
 
-	readLogFile(values, cmdLine.filename.c_str());
+	readLogFile(values, cmdLine);
 
 	// Header
 	{
@@ -254,7 +233,9 @@ static void printTaggedValues (const CommandLine& cmdLine, std::ostream& dst)
 static void printHelp (const char* binName)
 {
 	printf("%s: [filename] [name 1] [[name 2]...]\n", binName);
-	printf(" --statuscode     Include status code as first entry.\n");
+	printf(" --statuscode         Include status code as first entry.\n");
+	printf(" --case=[case path]   Extract values only from given case. Can be repeated.\n");
+	printf(" --index              Read or write log index from [filename].idx.\n");
 }
 
 static bool parseCommandLine (CommandLine& cmdLine, int argc, const char* const* argv)
@@ -265,6 +246,10 @@ static bool parseCommandLine (CommandLine& cmdLine, int argc, const char* const*
 
 		if (deStringEqual(arg, "--statuscode"))
 			cmdLine.statusCode = true;
+		else if (deStringBeginsWith(arg, "--case="))
+			cmdLine.casePaths.push_back(arg + 7);
+		else if (deStringEqual(arg, "--index"))
+			cmdLine.useIndex = true;
 		else if (!deStringBeginsWith(arg, "--"))
 		{
 			if (cmdLine.filename.empty())
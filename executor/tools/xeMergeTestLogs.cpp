@@ -23,10 +23,11 @@
  * \todo [2013-11-08 pyry] Write variant that can operate with less memory.
  *//*--------------------------------------------------------------------*/
 
-#include "xeTestLogParser.hpp"
-#include "xeTestResultParser.hpp"
+#include "xeBatchLogReader.hpp"
 #include "xeTestLogWriter.hpp"
 #include "deString.h"
+#include "deThread.hpp"
+#include "deSharedPtr.hpp"
 
 #include <vector>
 #include <string>
@@ -35,6 +36,7 @@
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <map>
 
 using std::vector;
 using std::string;
@@ -58,104 +60,143 @@ struct CommandLine
 	deUint32		flags;
 };
 
-class LogHandler : public xe::TestLogHandler
+static void mergeSessionInfo (xe::SessionInfo& combinedInfo, const xe::SessionInfo& info, deUint32 flags)
 {
-public:
-	LogHandler (xe::BatchResult* batchResult, deUint32 flags)
-		: m_batchResult	(batchResult)
-		, m_flags		(flags)
+	if (flags & FLAG_USE_LAST_INFO)
 	{
+		if (!info.targetName.empty())		combinedInfo.targetName			= info.targetName;
+		if (!info.releaseId.empty())		combinedInfo.releaseId			= info.releaseId;
+		if (!info.releaseName.empty())		combinedInfo.releaseName		= info.releaseName;
+		if (!info.candyTargetName.empty())	combinedInfo.candyTargetName	= info.candyTargetName;
+		if (!info.configName.empty())		combinedInfo.configName			= info.configName;
+		if (!info.resultName.empty())		combinedInfo.resultName			= info.resultName;
+		if (!info.timestamp.empty())		combinedInfo.timestamp			= info.timestamp;
 	}
-
-	void setSessionInfo (const xe::SessionInfo& info)
+	else
 	{
-		xe::SessionInfo& combinedInfo = m_batchResult->getSessionInfo();
-
-		if (m_flags & FLAG_USE_LAST_INFO)
-		{
-			if (!info.targetName.empty())		combinedInfo.targetName			= info.targetName;
-			if (!info.releaseId.empty())		combinedInfo.releaseId			= info.releaseId;
-			if (!info.releaseName.empty())		combinedInfo.releaseName		= info.releaseName;
-			if (!info.candyTargetName.empty())	combinedInfo.candyTargetName	= info.candyTargetName;
-			if (!info.configName.empty())		combinedInfo.configName			= info.configName;
-			if (!info.resultName.empty())		combinedInfo.resultName			= info.resultName;
-			if (!info.timestamp.empty())		combinedInfo.timestamp			= info.timestamp;
-		}
-		else
-		{
-			if (combinedInfo.targetName.empty())		combinedInfo.targetName			= info.targetName;
-			if (combinedInfo.releaseId.empty())			combinedInfo.releaseId			= info.releaseId;
-			if (combinedInfo.releaseName.empty())		combinedInfo.releaseName		= info.releaseName;
-			if (combinedInfo.candyTargetName.empty())	combinedInfo.candyTargetName	= info.candyTargetName;
-			if (combinedInfo.configName.empty())		combinedInfo.configName			= info.configName;
-			if (combinedInfo.resultName.empty())		combinedInfo.resultName			= info.resultName;
-			if (combinedInfo.timestamp.empty())			combinedInfo.timestamp			= info.timestamp;
-		}
+		if (combinedInfo.targetName.empty())		combinedInfo.targetName			= info.targetName;
+		if (combinedInfo.releaseId.empty())			combinedInfo.releaseId			= info.releaseId;
+		if (combinedInfo.releaseName.empty())		combinedInfo.releaseName		= info.releaseName;
+		if (combinedInfo.candyTargetName.empty())	combinedInfo.candyTargetName	= info.candyTargetName;
+		if (combinedInfo.configName.empty())		combinedInfo.configName			= info.configName;
+		if (combinedInfo.resultName.empty())		combinedInfo.resultName			= info.resultName;
+		if (combinedInfo.timestamp.empty())			combinedInfo.timestamp			= info.timestamp;
 	}
+}
 
-	xe::TestCaseResultPtr startTestCaseResult (const char* casePath)
+class LogIndexer : public de::Thread
+{
+public:
+	LogIndexer (xe::BatchLogReader& reader)
+		: m_reader(reader)
 	{
-		if (m_batchResult->hasTestCaseResult(casePath))
-		{
-			xe::TestCaseResultPtr existingResult = m_batchResult->getTestCaseResult(casePath);
-			existingResult->clear();
-			return existingResult;
-		}
-		else
-			return m_batchResult->createTestCaseResult(casePath);
 	}
 
-	void testCaseResultUpdated (const xe::TestCaseResultPtr&)
+	void run (void)
 	{
-		// Ignored.
+		try
+		{
+			m_reader.createIndex();
+		}
+		catch (const std::exception& e)
+		{
+			m_error = e.what();
+		}
 	}
 
-	void testCaseResultComplete (const xe::TestCaseResultPtr&)
-	{
-		// Ignored.
-	}
+	const string& getError (void) const { return m_error; }
 
 private:
-	xe::BatchResult* const	m_batchResult;
-	const deUint32			m_flags;
+	xe::BatchLogReader&	m_reader;
+	string				m_error;
 };
 
-static void readLogFile (xe::BatchResult* dstResult, const char* filename, deUint32 flags)
+struct CaseSource
 {
-	std::ifstream		in				(filename, std::ifstream::binary|std::ifstream::in);
-	LogHandler			resultHandler	(dstResult, flags);
-	xe::TestLogParser	parser			(&resultHandler);
-	deUint8				buf				[2048];
-	int					numRead			= 0;
+	int		logNdx;
+	int		resultNdx;
 
-	if (!in.good())
-		throw std::runtime_error(string("Failed to open '") + filename + "'");
+	CaseSource (int logNdx_, int resultNdx_) : logNdx(logNdx_), resultNdx(resultNdx_) {}
+};
 
-	for (;;)
+static void writeMergedLog (const CommandLine& cmdLine, const vector<de::SharedPtr<xe::BatchLogReader> >& logs, std::ostream& dst)
+{
+	xe::SessionInfo		sessionInfo;
+	vector<CaseSource>	cases;
+	map<string, int>	caseMap;
+
+	// Cases are written in order of first appearance using data from the last log that has them.
+	for (int logNdx = 0; logNdx < (int)logs.size(); logNdx++)
 	{
-		in.read((char*)&buf[0], DE_LENGTH_OF_ARRAY(buf));
-		numRead = (int)in.gcount();
+		const xe::BatchLogReader& log = *logs[logNdx];
+
+		mergeSessionInfo(sessionInfo, log.getSessionInfo(), cmdLine.flags);
 
-		if (numRead <= 0)
-			break;
+		for (int resultNdx = 0; resultNdx < log.getNumTestCaseResults(); resultNdx++)
+		{
+			const map<string, int>::const_iterator pos = caseMap.find(log.getTestCasePath(resultNdx));
 
-		parser.parse(&buf[0], numRead);
+			if (pos != caseMap.end())
+				cases[pos->second] = CaseSource(logNdx, resultNdx);
+			else
+			{
+				caseMap[log.getTestCasePath(resultNdx)] = (int)cases.size();
+				cases.push_back(CaseSource(logNdx, resultNdx));
+			}
+		}
 	}
 
-	in.close();
+	xe::writeSessionStart(sessionInfo, dst);
+
+	for (vector<CaseSource>::const_iterator source = cases.begin(); source != cases.end(); ++source)
+	{
+		const xe::BatchLogReader& log = *logs[source->logNdx];
+
+		xe::writeTestCaseData(log.getTestCasePath(source->resultNdx),
+							  log.getStatusCode(source->resultNdx),
+							  log.getTestCaseData(source->resultNdx),
+							  (size_t)log.getTestCaseDataSize(source->resultNdx),
+							  dst);
+	}
+
+	xe::writeSessionEnd(dst);
 }
 
 static void mergeTestLogs (const CommandLine& cmdLine)
 {
-	xe::BatchResult batchResult;
+	vector<de::SharedPtr<xe::BatchLogReader> >	logs;
+	vector<de::SharedPtr<LogIndexer> >			indexers;
 
+	// Logs are mapped, not loaded, so memory use is bounded by the indices.
 	for (vector<string>::const_iterator filename = cmdLine.srcFilenames.begin(); filename != cmdLine.srcFilenames.end(); ++filename)
-		readLogFile(&batchResult, filename->c_str(), cmdLine.flags);
+		logs.push_back(de::SharedPtr<xe::BatchLogReader>(new xe::BatchLogReader(filename->c_str())));
+
+	for (int ndx = 0; ndx < (int)logs.size(); ndx++)
+	{
+		indexers.push_back(de::SharedPtr<LogIndexer>(new LogIndexer(*logs[ndx])));
+		indexers.back()->start();
+	}
+
+	for (int ndx = 0; ndx < (int)indexers.size(); ndx++)
+		indexers[ndx]->join();
+
+	for (int ndx = 0; ndx < (int)indexers.size(); ndx++)
+	{
+		if (!indexers[ndx]->getError().empty())
+			throw xe::Error("Failed to read '" + cmdLine.srcFilenames[ndx] + "': " + indexers[ndx]->getError());
+	}
 
 	if (!cmdLine.dstFilename.empty())
-		xe::writeBatchResultToFile(batchResult, cmdLine.dstFilename.c_str());
+	{
+		std::ofstream out(cmdLine.dstFilename.c_str(), std::ofstream::binary|std::ofstream::trunc);
+
+		if (!out.good())
+			throw xe::Error("Failed to open '" + cmdLine.dstFilename + "'");
+
+		writeMergedLog(cmdLine, logs, out);
+	}
 	else
-		xe::writeTestLog(batchResult, std::cout);
+		writeMergedLog(cmdLine, logs, std::cout);
 }
 
 static void printHelp (const char* binName)
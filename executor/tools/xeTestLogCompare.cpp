@@ -21,7 +21,7 @@
  * \brief Test log compare utility.
  *//*--------------------------------------------------------------------*/
 
-#include "xeTestLogParser.hpp"
+#include "xeBatchLogReader.hpp"
 #include "xeTestResultParser.hpp"
 #include "deFilePath.hpp"
 #include "deString.h"
@@ -122,78 +122,37 @@ struct ShortBatchResult
 	map<string, int>					resultMap;
 };
 
-class ShortResultHandler : public xe::TestLogHandler
+static void readLogFile (ShortBatchResult& batchResult, const char* filename)
 {
-public:
-	ShortResultHandler (ShortBatchResult& result)
-		: m_result(result)
-	{
-	}
+	xe::BatchLogReader		reader				(filename);
+	xe::TestResultParser	testResultParser;
 
-	void setSessionInfo (const xe::SessionInfo&)
-	{
-		// Ignored.
-	}
-
-	xe::TestCaseResultPtr startTestCaseResult (const char* casePath)
-	{
-		return xe::TestCaseResultPtr(new xe::TestCaseResultData(casePath));
-	}
+	reader.createIndex();
 
-	void testCaseResultUpdated (const xe::TestCaseResultPtr&)
-	{
-		// Ignored.
-	}
-
-	void testCaseResultComplete (const xe::TestCaseResultPtr& caseData)
+	// Cases are parsed one at a time in place, so only the headers are kept in memory.
+	for (int resultNdx = 0; resultNdx < reader.getNumTestCaseResults(); resultNdx++)
 	{
 		xe::TestCaseResultHeader	header;
-		int							caseNdx	= (int)m_result.resultHeaders.size();
+		int							caseNdx	= (int)batchResult.resultHeaders.size();
 
-		header.casePath			= caseData->getTestCasePath();
+		header.casePath			= reader.getTestCasePath(resultNdx);
 		header.caseType			= xe::TESTCASETYPE_SELF_VALIDATE;
-		header.statusCode		= caseData->getStatusCode();
-		header.statusDetails	= caseData->getStatusDetails();
+		header.statusCode		= reader.getStatusCode(resultNdx);
+		header.statusDetails	= reader.getStatusDetails(resultNdx);
 
 		if (header.statusCode == xe::TESTSTATUSCODE_LAST)
 		{
 			xe::TestCaseResult fullResult;
 
-			xe::parseTestCaseResultFromData(&m_testResultParser, &fullResult, *caseData.get());
+			reader.parseTestCaseResult(resultNdx, &testResultParser, &fullResult);
 
 			header = xe::TestCaseResultHeader(fullResult);
 		}
 
 		// Insert into result list & map.
-		m_result.resultHeaders.push_back(header);
-		m_result.resultMap[header.casePath] = caseNdx;
+		batchResult.resultHeaders.push_back(header);
+		batchResult.resultMap[header.casePath] = caseNdx;
 	}
-
-private:
-	ShortBatchResult&		m_result;
-	xe::TestResultParser	m_testResultParser;
-};
-
-static void readLogFile (ShortBatchResult& batchResult, const char* filename)
-{
-	std::ifstream		in				(filename, std::ifstream::binary|std::ifstream::in);
-	ShortResultHandler	resultHandler	(batchResult);
-	xe::TestLogParser	parser			(&resultHandler);
-	deUint8				buf				[1024];
-	int					numRead			= 0;
-
-	for (;;)
-	{
-		in.read((char*)&buf[0], DE_LENGTH_OF_ARRAY(buf));
-		numRead = (int)in.gcount();
-
-		if (numRead <= 0)
-			break;
-
-		parser.parse(&buf[0], numRead);
-	}
-
-	in.close();
 }
 
 class LogFileReader : public de::Thread
@@ -207,12 +166,22 @@ public:
 
 	void run (void)
 	{
-		readLogFile(m_batchResult, m_filename.c_str());
+		try
+		{
+			readLogFile(m_batchResult, m_filename.c_str());
+		}
+		catch (const std::exception& e)
+		{
+			m_error = e.what();
+		}
 	}
 
+	const std::string& getError (void) const { return m_error; }
+
 private:
 	ShortBatchResult&	m_batchResult;
 	std::string			m_filename;
+	std::string			m_error;
 };
 
 static void computeCaseList (vector<string>& cases, const vector<ShortBatchResult>& batchResults)
@@ -283,9 +252,13 @@ static bool runCompare (const CommandLine& cmdLine, std::ostream& dst)
 			}
 
 			for (int ndx = 0; ndx < (int)cmdLine.filenames.size(); ndx++)
-			{
 				readers[ndx]->join();
 
+			for (int ndx = 0; ndx < (int)cmdLine.filenames.size(); ndx++)
+			{
+				if (!readers[ndx]->getError().empty())
+					throw xe::Error(readers[ndx]->getError());
+
 				// Use file name as batch name.
 				batchNames.push_back(de::FilePath(cmdLine.filenames[ndx].c_str()).getBaseName());
 			}
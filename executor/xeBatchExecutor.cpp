@@ -57,10 +57,11 @@ static inline bool isExecutedInBatch (const BatchResult* batchResult, const Test
 
 // \todo [2012-06-19 pyry] These can be optimized using TestSetIterator (once implemented)
 
-static void computeExecuteSet (TestSet& executeSet, const TestNode* root, const TestSet& testSet, const BatchResult* batchResult)
+static int computeExecuteSet (TestSet& executeSet, const TestNode* root, const TestSet& testSet, const BatchResult* batchResult)
 {
-	ConstTestNodeIterator	iter	= ConstTestNodeIterator::begin(root);
-	ConstTestNodeIterator	end		= ConstTestNodeIterator::end(root);
+	ConstTestNodeIterator	iter		= ConstTestNodeIterator::begin(root);
+	ConstTestNodeIterator	end			= ConstTestNodeIterator::end(root);
+	int						numCases	= 0;
 
 	for (; iter != end; ++iter)
 	{
@@ -71,9 +72,14 @@ static void computeExecuteSet (TestSet& executeSet, const TestNode* root, const
 			const TestCase* testCase = static_cast<const TestCase*>(node);
 
 			if (!isExecutedInBatch(batchResult, testCase))
+			{
 				executeSet.addCase(testCase);
+				numCases += 1;
+			}
 		}
 	}
+
+	return numCases;
 }
 
 static void computeBatchRequest (TestSet& requestSet, const TestSet& executeSet, const TestNode* root, int maxCasesInSet)
@@ -95,6 +101,30 @@ static void computeBatchRequest (TestSet& requestSet, const TestSet& executeSet,
 	}
 }
 
+static int moveCases (TestSet& dst, TestSet& src, const TestNode* root, int maxCases)
+{
+	TestSet					oldSet		(src);
+	ConstTestNodeIterator	iter		= ConstTestNodeIterator::begin(root);
+	ConstTestNodeIterator	end			= ConstTestNodeIterator::end(root);
+	int						numMoved	= 0;
+
+	for (; (iter != end) && (numMoved < maxCases); ++iter)
+	{
+		const TestNode* node = *iter;
+
+		if (node->getNodeType() == TESTNODETYPE_TEST_CASE && oldSet.hasNode(node))
+		{
+			const TestCase* testCase = static_cast<const TestCase*>(node);
+
+			dst.addCase(testCase);
+			src.removeCase(testCase);
+			numMoved += 1;
+		}
+	}
+
+	return numMoved;
+}
+
 static int removeExecuted (TestSet& set, const TestNode* root, const BatchResult* batchResult)
 {
 	TestSet					oldSet		(set);
@@ -154,33 +184,89 @@ void BatchExecutorLogHandler::testCaseResultComplete (const TestCaseResultPtr& r
 	printf("%s\n", result->getTestCasePath());
 }
 
+struct BatchExecutor::Shard
+{
+	Shard (BatchExecutor* executor_, CommLink* commLink_, TestLogHandler* logHandler)
+		: executor		(executor_)
+		, commLink		(commLink_)
+		, testLogParser	(logHandler)
+		, numCases		(0)
+		, isRunning		(false)
+		, isRetired		(false)
+	{
+	}
+
+	BatchExecutor*	executor;
+	CommLink*		commLink;
+	TestLogParser	testLogParser;
+
+	TestSet			cases;			//!< Cases handed to this shard that have not been executed yet.
+	int				numCases;
+	bool			isRunning;
+	bool			isRetired;		//!< Shard could not make progress and takes no more cases.
+};
+
 BatchExecutor::BatchExecutor (const TargetConfiguration& config, CommLink* commLink, const TestNode* root, const TestSet& testSet, BatchResult* batchResult, InfoLog* infoLog)
-	: m_config			(config)
-	, m_commLink		(commLink)
-	, m_root			(root)
-	, m_testSet			(testSet)
-	, m_logHandler		(batchResult)
-	, m_batchResult		(batchResult)
-	, m_infoLog			(infoLog)
-	, m_state			(STATE_NOT_STARTED)
-	, m_testLogParser	(&m_logHandler)
+	: m_config				(config)
+	, m_root				(root)
+	, m_testSet				(testSet)
+	, m_logHandler			(batchResult)
+	, m_batchResult			(batchResult)
+	, m_infoLog				(infoLog)
+	, m_state				(STATE_NOT_STARTED)
+	, m_numCasesToExecute	(0)
 {
+	init(vector<CommLink*>(1, commLink));
+}
+
+BatchExecutor::BatchExecutor (const TargetConfiguration& config, const vector<CommLink*>& commLinks, const TestNode* root, const TestSet& testSet, BatchResult* batchResult, InfoLog* infoLog)
+	: m_config				(config)
+	, m_root				(root)
+	, m_testSet				(testSet)
+	, m_logHandler			(batchResult)
+	, m_batchResult			(batchResult)
+	, m_infoLog				(infoLog)
+	, m_state				(STATE_NOT_STARTED)
+	, m_numCasesToExecute	(0)
+{
+	init(commLinks);
 }
 
 BatchExecutor::~BatchExecutor (void)
 {
+	for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+		delete m_shards[ndx];
+}
+
+void BatchExecutor::init (const vector<CommLink*>& commLinks)
+{
+	XE_CHECK(!commLinks.empty());
+	XE_CHECK(m_config.maxCasesPerSession > 0);
+
+	try
+	{
+		for (size_t ndx = 0; ndx < commLinks.size(); ndx++)
+			m_shards.push_back(new Shard(this, commLinks[ndx], &m_logHandler));
+	}
+	catch (...)
+	{
+		for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+			delete m_shards[ndx];
+		throw;
+	}
 }
 
 void BatchExecutor::run (void)
 {
 	XE_CHECK(m_state == STATE_NOT_STARTED);
 
-	// Check commlink state.
+	// Check commlink states.
+	for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
 	{
 		CommLinkState	commState	= COMMLINKSTATE_LAST;
 		std::string		stateStr	= "";
 
-		commState = m_commLink->getState(stateStr);
+		commState = m_shards[ndx]->commLink->getState(stateStr);
 
 		if (commState == COMMLINKSTATE_ERROR)
 		{
@@ -192,23 +278,18 @@ void BatchExecutor::run (void)
 	}
 
 	// Compute initial execute set.
-	computeExecuteSet(m_casesToExecute, m_root, m_testSet, m_batchResult);
+	m_numCasesToExecute = computeExecuteSet(m_casesToExecute, m_root, m_testSet, m_batchResult);
 
 	// Register callbacks.
-	m_commLink->setCallbacks(enqueueStateChanged, enqueueTestLogData, enqueueInfoLogData, this);
+	for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+		m_shards[ndx]->commLink->setCallbacks(enqueueStateChanged, enqueueTestLogData, enqueueInfoLogData, m_shards[ndx]);
 
 	try
 	{
-		if (!m_casesToExecute.empty())
-		{
-			TestSet batchRequest;
-			computeBatchRequest(batchRequest, m_casesToExecute, m_root, m_config.maxCasesPerSession);
-			launchTestSet(batchRequest);
+		m_state = STATE_STARTED;
 
-			m_state = STATE_STARTED;
-		}
-		else
-			m_state = STATE_FINISHED;
+		launchIdleShards();
+		updateState();
 
 		// Run handler loop until we are finished.
 		while (m_state != STATE_FINISHED)
@@ -216,12 +297,14 @@ void BatchExecutor::run (void)
 	}
 	catch (...)
 	{
-		m_commLink->setCallbacks(DE_NULL, DE_NULL, DE_NULL, DE_NULL);
+		for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+			m_shards[ndx]->commLink->setCallbacks(DE_NULL, DE_NULL, DE_NULL, DE_NULL);
 		throw;
 	}
 
 	// De-register callbacks.
-	m_commLink->setCallbacks(DE_NULL, DE_NULL, DE_NULL, DE_NULL);
+	for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+		m_shards[ndx]->commLink->setCallbacks(DE_NULL, DE_NULL, DE_NULL, DE_NULL);
 }
 
 void BatchExecutor::cancel (void)
@@ -230,7 +313,86 @@ void BatchExecutor::cancel (void)
 	m_dispatcher.cancel();
 }
 
-void BatchExecutor::onStateChanged (CommLinkState state, const char* message)
+bool BatchExecutor::launchShard (Shard* shard)
+{
+	DE_ASSERT(!shard->isRunning && !shard->isRetired);
+
+	if (m_state == STATE_FINISHED)
+		return false;
+
+	// Take next chunk from the shared queue. Chunk size is proportional to the
+	// remaining work so that shards run out of cases at roughly the same time.
+	if (shard->cases.empty())
+	{
+		const int	numShards	= (int)m_shards.size();
+		const int	chunkSize	= de::clamp((m_numCasesToExecute + numShards - 1) / numShards, 1, m_config.maxCasesPerSession);
+		const int	numTaken	= moveCases(shard->cases, m_casesToExecute, m_root, chunkSize);
+
+		m_numCasesToExecute	-= numTaken;
+		shard->numCases		+= numTaken;
+	}
+
+	if (shard->cases.empty())
+		return false;
+
+	// Reset state from previous batch.
+	shard->testLogParser.reset();
+
+	if (shard->commLink->getState() != COMMLINKSTATE_READY)
+	{
+		shard->commLink->reset();
+		XE_CHECK(shard->commLink->getState() == COMMLINKSTATE_READY);
+	}
+
+	{
+		TestSet batchRequest;
+		computeBatchRequest(batchRequest, shard->cases, m_root, m_config.maxCasesPerSession);
+		launchTestSet(shard, batchRequest);
+	}
+
+	shard->isRunning = true;
+	return true;
+}
+
+void BatchExecutor::retireShard (Shard* shard)
+{
+	DE_ASSERT(!shard->isRunning);
+
+	shard->isRetired = true;
+
+	// Hand unfinished cases over to remaining shards.
+	if (!shard->cases.empty())
+	{
+		m_numCasesToExecute	+= moveCases(m_casesToExecute, shard->cases, m_root, shard->numCases);
+		shard->numCases		= 0;
+
+		launchIdleShards();
+	}
+}
+
+void BatchExecutor::launchIdleShards (void)
+{
+	for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+	{
+		Shard* const shard = m_shards[ndx];
+
+		if (!shard->isRunning && !shard->isRetired)
+			launchShard(shard);
+	}
+}
+
+void BatchExecutor::updateState (void)
+{
+	for (size_t ndx = 0; ndx < m_shards.size(); ndx++)
+	{
+		if (m_shards[ndx]->isRunning)
+			return;
+	}
+
+	m_state = STATE_FINISHED;
+}
+
+void BatchExecutor::onStateChanged (Shard* shard, CommLinkState state, const char* message)
 {
 	switch (state)
 	{
@@ -244,51 +406,49 @@ void BatchExecutor::onStateChanged (CommLinkState state, const char* message)
 			// Feed end of string to parser. This terminates open test case if such exists.
 			{
 				deUint8 eos = 0;
-				onTestLogData(&eos, 1);
+				onTestLogData(shard, &eos, 1);
 			}
 
-			int numExecuted = removeExecuted(m_casesToExecute, m_root, m_batchResult);
-
-			// \note No new batch is launched if no cases were executed in last one. Otherwise excutor
-			//       could end up in infinite loop.
-			if (!m_casesToExecute.empty() && numExecuted > 0)
-			{
-				// Reset state and start batch.
-				m_testLogParser.reset();
+			const int numExecuted = removeExecuted(shard->cases, m_root, m_batchResult);
 
-				m_commLink->reset();
-				XE_CHECK(m_commLink->getState() == COMMLINKSTATE_READY);
+			shard->numCases		-= numExecuted;
+			shard->isRunning	= false;
 
-				TestSet batchRequest;
-				computeBatchRequest(batchRequest, m_casesToExecute, m_root, m_config.maxCasesPerSession);
-				launchTestSet(batchRequest);
-			}
+			// \note Shard is retired if no cases were executed in last batch. Otherwise executor
+			//       could end up in infinite loop. A crashed batch is relaunched starting from
+			//       the first unfinished case.
+			if (!shard->cases.empty() && numExecuted == 0)
+				retireShard(shard);
 			else
-				m_state = STATE_FINISHED;
+				launchShard(shard);
 
 			break;
 		}
 
 		case COMMLINKSTATE_TEST_PROCESS_LAUNCH_FAILED:
 			printf("Failed to start test process: '%s'\n", message);
-			m_state = STATE_FINISHED;
+			shard->isRunning = false;
+			retireShard(shard);
 			break;
 
 		case COMMLINKSTATE_ERROR:
 			printf("CommLink error: '%s'\n", message);
-			m_state = STATE_FINISHED;
+			shard->isRunning = false;
+			retireShard(shard);
 			break;
 
 		default:
 			XE_FAIL("Unknown state");
 	}
+
+	updateState();
 }
 
-void BatchExecutor::onTestLogData (const deUint8* bytes, size_t numBytes)
+void BatchExecutor::onTestLogData (Shard* shard, const deUint8* bytes, size_t numBytes)
 {
 	try
 	{
-		m_testLogParser.parse(bytes, numBytes);
+		shard->testLogParser.parse(bytes, numBytes);
 	}
 	catch (const ParseError& e)
 	{
@@ -337,22 +497,22 @@ static void writeCaseListNode (std::ostream& str, const TestNode* node, const Te
 	}
 }
 
-void BatchExecutor::launchTestSet (const TestSet& testSet)
+void BatchExecutor::launchTestSet (Shard* shard, const TestSet& testSet)
 {
 	std::ostringstream caseList;
 	XE_CHECK(testSet.hasNode(m_root));
 	XE_CHECK(m_root->getNodeType() == TESTNODETYPE_ROOT);
 	writeCaseListNode(caseList, m_root, testSet);
 
-	m_commLink->startTestProcess(m_config.binaryName.c_str(), m_config.cmdLineArgs.c_str(), m_config.workingDir.c_str(), caseList.str().c_str());
+	shard->commLink->startTestProcess(m_config.binaryName.c_str(), m_config.cmdLineArgs.c_str(), m_config.workingDir.c_str(), caseList.str().c_str());
 }
 
 void BatchExecutor::enqueueStateChanged (void* userPtr, CommLinkState state, const char* message)
 {
-	BatchExecutor*	executor	= static_cast<BatchExecutor*>(userPtr);
-	CallWriter		writer		(&executor->m_dispatcher, BatchExecutor::dispatchStateChanged);
+	Shard*			shard		= static_cast<Shard*>(userPtr);
+	CallWriter		writer		(&shard->executor->m_dispatcher, BatchExecutor::dispatchStateChanged);
 
-	writer << executor
+	writer << shard
 		   << state
 		   << message;
 
@@ -361,10 +521,10 @@ void BatchExecutor::enqueueStateChanged (void* userPtr, CommLinkState state, con
 
 void BatchExecutor::enqueueTestLogData (void* userPtr, const deUint8* bytes, size_t numBytes)
 {
-	BatchExecutor*	executor	= static_cast<BatchExecutor*>(userPtr);
-	CallWriter		writer		(&executor->m_dispatcher, BatchExecutor::dispatchTestLogData);
+	Shard*			shard		= static_cast<Shard*>(userPtr);
+	CallWriter		writer		(&shard->executor->m_dispatcher, BatchExecutor::dispatchTestLogData);
 
-	writer << executor
+	writer << shard
 		   << numBytes;
 
 	writer.write(bytes, numBytes);
@@ -373,10 +533,10 @@ void BatchExecutor::enqueueTestLogData (void* userPtr, const deUint8* bytes, siz
 
 void BatchExecutor::enqueueInfoLogData (void* userPtr, const deUint8* bytes, size_t numBytes)
 {
-	BatchExecutor*	executor	= static_cast<BatchExecutor*>(userPtr);
-	CallWriter		writer		(&executor->m_dispatcher, BatchExecutor::dispatchInfoLogData);
+	Shard*			shard		= static_cast<Shard*>(userPtr);
+	CallWriter		writer		(&shard->executor->m_dispatcher, BatchExecutor::dispatchInfoLogData);
 
-	writer << executor
+	writer << shard
 		   << numBytes;
 
 	writer.write(bytes, numBytes);
@@ -385,37 +545,37 @@ void BatchExecutor::enqueueInfoLogData (void* userPtr, const deUint8* bytes, siz
 
 void BatchExecutor::dispatchStateChanged (CallReader& data)
 {
-	BatchExecutor*	executor	= DE_NULL;
+	Shard*			shard		= DE_NULL;
 	CommLinkState	state		= COMMLINKSTATE_LAST;
 	std::string		message;
 
-	data >> executor
+	data >> shard
 		 >> state
 		 >> message;
 
-	executor->onStateChanged(state, message.c_str());
+	shard->executor->onStateChanged(shard, state, message.c_str());
 }
 
 void BatchExecutor::dispatchTestLogData (CallReader& data)
 {
-	BatchExecutor*	executor	= DE_NULL;
+	Shard*			shard		= DE_NULL;
 	size_t			numBytes;
 
-	data >> executor
+	data >> shard
 		 >> numBytes;
 
-	executor->onTestLogData(data.getDataBlock(numBytes), numBytes);
+	shard->executor->onTestLogData(shard, data.getDataBlock(numBytes), numBytes);
 }
 
 void BatchExecutor::dispatchInfoLogData (CallReader& data)
 {
-	BatchExecutor*	executor	= DE_NULL;
+	Shard*			shard		= DE_NULL;
 	size_t			numBytes;
 
-	data >> executor
+	data >> shard
 		 >> numBytes;
 
-	executor->onInfoLogData(data.getDataBlock(numBytes), numBytes);
+	shard->executor->onInfoLogData(data.getDataBlock(numBytes), numBytes);
 }
 
 } // xe
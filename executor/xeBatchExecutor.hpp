@@ -64,26 +64,45 @@ private:
 	BatchResult*			m_batchResult;
 };
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Test batch executor.
+ *
+ * Executes a TestSet over one or more CommLinks. With several links, cases
+ * are handed out to links in chunks from a shared queue. Chunks shrink as
+ * the queue drains so that all links finish at roughly the same time. If
+ * a test process dies, it is relaunched on the same link starting from the
+ * first unfinished case of its chunk. Results from all links are collected
+ * into the same BatchResult.
+ *
+ * All CommLink callbacks are dispatched on the thread calling run().
+ *//*--------------------------------------------------------------------*/
 class BatchExecutor
 {
 public:
 							BatchExecutor		(const TargetConfiguration& config, CommLink* commLink, const TestNode* root, const TestSet& testSet, BatchResult* batchResult, InfoLog* infoLog);
+							BatchExecutor		(const TargetConfiguration& config, const std::vector<CommLink*>& commLinks, const TestNode* root, const TestSet& testSet, BatchResult* batchResult, InfoLog* infoLog);
 							~BatchExecutor		(void);
 
 	void					run					(void);
 	void					cancel				(void); //!< Cancel current run(), can be called from any thread.
 
 private:
+	struct Shard;
+
 							BatchExecutor		(const BatchExecutor& other);
 	BatchExecutor&			operator=			(const BatchExecutor& other);
 
-	bool					iterate				(void);
+	void					init				(const std::vector<CommLink*>& commLinks);
 
-	void					onStateChanged		(CommLinkState state, const char* message);
-	void					onTestLogData		(const deUint8* bytes, size_t numBytes);
+	void					onStateChanged		(Shard* shard, CommLinkState state, const char* message);
+	void					onTestLogData		(Shard* shard, const deUint8* bytes, size_t numBytes);
 	void					onInfoLogData		(const deUint8* bytes, size_t numBytes);
 
-	void					launchTestSet		(const TestSet& testSet);
+	bool					launchShard			(Shard* shard);
+	void					retireShard			(Shard* shard);
+	void					launchIdleShards	(void);
+	void					updateState			(void);
+	void					launchTestSet		(Shard* shard, const TestSet& testSet);
 
 	// Callbacks for CommLink.
 	static void				enqueueStateChanged	(void* userPtr, CommLinkState state, const char* message);
@@ -105,7 +124,7 @@ private:
 	};
 
 	TargetConfiguration		m_config;
-	CommLink*				m_commLink;
+	std::vector<Shard*>		m_shards;
 
 	const TestNode*			m_root;
 	const TestSet&			m_testSet;
@@ -115,9 +134,8 @@ private:
 	InfoLog*				m_infoLog;
 
 	State					m_state;
-	TestSet					m_casesToExecute;
-
-	TestLogParser			m_testLogParser;
+	TestSet					m_casesToExecute;		//!< Cases not yet handed out to any shard.
+	int						m_numCasesToExecute;
 
 	CallQueue				m_dispatcher;
 };
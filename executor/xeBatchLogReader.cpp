@@ -0,0 +1,478 @@
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Test Executor
+ * ------------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Random-access reader for batch result logs.
+ *//*--------------------------------------------------------------------*/
+
+#include "xeBatchLogReader.hpp"
+#include "xeContainerFormatParser.hpp"
+#include "deMemory.h"
+#include "deString.h"
+#include "deFile.h"
+
+#include <cstring>
+#include <sstream>
+
+using std::string;
+using std::vector;
+using std::map;
+
+namespace xe
+{
+
+namespace
+{
+
+enum
+{
+	INDEX_MAGIC		= 0x58514149,	//!< "IAQX"
+	INDEX_VERSION	= 2
+};
+
+static const char s_beginTestCaseResult[] = "#beginTestCaseResult";
+
+class IndexReader
+{
+public:
+	IndexReader (const deUint8* data, deUint64 size)
+		: m_data	(data)
+		, m_size	(size)
+		, m_pos		(0)
+		, m_ok		(true)
+	{
+	}
+
+	bool isOk (void) const { return m_ok; }
+
+	deUint64 readU64 (void)
+	{
+		const deUint8*	bytes	= read(8);
+		deUint64		value	= 0;
+
+		for (int ndx = 0; bytes && ndx < 8; ndx++)
+			value |= (deUint64)bytes[ndx] << (8*ndx);
+
+		return value;
+	}
+
+	deUint32 readU32 (void)
+	{
+		const deUint8*	bytes	= read(4);
+		deUint32		value	= 0;
+
+		for (int ndx = 0; bytes && ndx < 4; ndx++)
+			value |= (deUint32)bytes[ndx] << (8*ndx);
+
+		return value;
+	}
+
+	void readString (string& dst)
+	{
+		const deUint32	length	= readU32();
+		const deUint8*	bytes	= read(length);
+
+		if (bytes)
+			dst.assign((const char*)bytes, length);
+	}
+
+private:
+	const deUint8* read (deUint64 numBytes)
+	{
+		if (!m_ok || m_size - m_pos < numBytes)
+		{
+			m_ok = false;
+			return DE_NULL;
+		}
+
+		const deUint8* bytes = m_data + m_pos;
+		m_pos += numBytes;
+		return bytes;
+	}
+
+	const deUint8*	m_data;
+	deUint64		m_size;
+	deUint64		m_pos;
+	bool			m_ok;
+};
+
+void writeU64 (std::ostream& str, deUint64 value)
+{
+	deUint8 bytes[8];
+
+	for (int ndx = 0; ndx < 8; ndx++)
+		bytes[ndx] = (deUint8)(value >> (8*ndx));
+
+	str.write((const char*)&bytes[0], sizeof(bytes));
+}
+
+void writeU32 (std::ostream& str, deUint32 value)
+{
+	deUint8 bytes[4];
+
+	for (int ndx = 0; ndx < 4; ndx++)
+		bytes[ndx] = (deUint8)(value >> (8*ndx));
+
+	str.write((const char*)&bytes[0], sizeof(bytes));
+}
+
+void writeString (std::ostream& str, const string& value)
+{
+	writeU32(str, (deUint32)value.size());
+	str.write(value.c_str(), (std::streamsize)value.size());
+}
+
+void setSessionInfoAttribute (SessionInfo& sessionInfo, const char* attribute, const char* value)
+{
+	if (deStringEqual(attribute, "releaseName"))
+		sessionInfo.releaseName = value;
+	else if (deStringEqual(attribute, "releaseId"))
+		sessionInfo.releaseId = value;
+	else if (deStringEqual(attribute, "targetName"))
+		sessionInfo.targetName = value;
+	else if (deStringEqual(attribute, "candyTargetName"))
+		sessionInfo.candyTargetName = value;
+	else if (deStringEqual(attribute, "configName"))
+		sessionInfo.configName = value;
+	else if (deStringEqual(attribute, "resultName"))
+		sessionInfo.resultName = value;
+	else if (deStringEqual(attribute, "timestamp"))
+		sessionInfo.timestamp = value;
+}
+
+} // anonymous
+
+BatchLogReader::BatchLogReader (const char* filename)
+	: m_file				(deMappedFile_create(filename))
+	, m_data				(DE_NULL)
+	, m_size				(0)
+	, m_modificationTime	(deGetFileModificationTime(filename))
+{
+	if (!m_file)
+		throw Error(string("Failed to open '") + filename + "'");
+
+	m_data	= (const deUint8*)deMappedFile_getPtr(m_file);
+	m_size	= (deUint64)deMappedFile_getSize(m_file);
+}
+
+BatchLogReader::~BatchLogReader (void)
+{
+	deMappedFile_destroy(m_file);
+}
+
+string BatchLogReader::getDefaultIndexFilename (const char* filename)
+{
+	return string(filename) + ".idx";
+}
+
+void BatchLogReader::clearIndex (void)
+{
+	m_sessionInfo = SessionInfo();
+	m_entries.clear();
+	m_entryMap.clear();
+}
+
+bool BatchLogReader::isEntryValid (const Entry& entry) const
+{
+	const size_t	prefixLen	= sizeof(s_beginTestCaseResult)-1;
+	const size_t	pathEnd		= prefixLen + 1 + entry.casePath.size();
+	const deUint8*	line		= m_data + entry.lineOffset;
+
+	if (entry.lineOffset >= entry.dataOffset				||
+		entry.dataOffset > m_size							||
+		entry.dataSize > m_size - entry.dataOffset			||
+		!de::inRange<int>(entry.statusCode, 0, TESTSTATUSCODE_LAST))
+		return false;
+
+	// Line must be "#beginTestCaseResult <casePath>"
+	if (entry.dataOffset - entry.lineOffset < pathEnd)
+		return false;
+
+	if (entry.lineOffset > 0 && line[-1] != '\n' && line[-1] != '\r')
+		return false;
+
+	if (deMemCmp(line, s_beginTestCaseResult, prefixLen) != 0 ||
+		line[prefixLen] != ' ' ||
+		deMemCmp(line + prefixLen + 1, entry.casePath.c_str(), entry.casePath.size()) != 0)
+		return false;
+
+	// Path must end where parser would end it, otherwise an entry for a prefix of the path would match
+	return entry.lineOffset + pathEnd == m_size || line[pathEnd] == ' ' || line[pathEnd] == '\n' || line[pathEnd] == '\r';
+}
+
+deUint32 BatchLogReader::getHeaderHash (void) const
+{
+	// Session info lines preceding the first test case result
+	const deUint64 headerSize = m_entries.empty() ? m_size : m_entries.front().lineOffset;
+
+	return deMemoryHash(m_data, (size_t)headerSize);
+}
+
+void BatchLogReader::createIndex (void)
+{
+	clearIndex();
+	scan(m_size, true);
+}
+
+void BatchLogReader::scan (deUint64 end, bool indexCases)
+{
+	ContainerFormatParser	parser;
+	int						curEntryNdx	= -1;
+	deUint64				pos			= 0;
+
+	while (pos < end)
+	{
+		// Container lines start with '#'. Everything else is passed over with memchr().
+		if (m_data[pos] != '#' || (pos > 0 && m_data[pos-1] != '\n' && m_data[pos-1] != '\r'))
+		{
+			const void* next = memchr(m_data+pos+1, '#', (size_t)(end-pos-1));
+			pos = next ? (deUint64)((const deUint8*)next - m_data) : end;
+			continue;
+		}
+
+		const void*		lineEndPtr	= memchr(m_data+pos, '\n', (size_t)(m_size-pos));
+		const deUint64	lineEnd		= lineEndPtr ? (deUint64)((const deUint8*)lineEndPtr - m_data) + 1 : m_size;
+
+		parser.clear();
+		parser.feed(m_data+pos, (size_t)(lineEnd-pos));
+
+		if (!lineEndPtr)
+		{
+			const deUint8 endOfString = 0;
+			parser.feed(&endOfString, 1);
+		}
+
+		switch (parser.getElement())
+		{
+			case CONTAINERELEMENT_SESSION_INFO:
+				setSessionInfoAttribute(m_sessionInfo, parser.getSessionInfoAttribute(), parser.getSessionInfoValue());
+				break;
+
+			case CONTAINERELEMENT_BEGIN_TEST_CASE_RESULT:
+			{
+				if (!indexCases)
+					return;
+
+				// Previous result was never completed; it is left in running state like in TestLogParser.
+				if (curEntryNdx >= 0)
+					m_entries[curEntryNdx].dataSize = pos - m_entries[curEntryNdx].dataOffset;
+
+				Entry entry;
+				entry.casePath		= parser.getTestCasePath();
+				entry.lineOffset	= pos;
+				entry.dataOffset	= lineEnd;
+				entry.statusCode	= TESTSTATUSCODE_RUNNING;
+				entry.statusDetails	= "Running";
+
+				curEntryNdx						= (int)m_entries.size();
+				m_entries.push_back(entry);
+				m_entryMap[entry.casePath]		= curEntryNdx;
+				break;
+			}
+
+			case CONTAINERELEMENT_END_TEST_CASE_RESULT:
+				if (curEntryNdx >= 0)
+				{
+					Entry& entry = m_entries[curEntryNdx];
+
+					entry.dataSize		= pos - entry.dataOffset;
+					entry.statusCode	= TESTSTATUSCODE_LAST;
+					entry.statusDetails.clear();
+				}
+				curEntryNdx = -1;
+				break;
+
+			case CONTAINERELEMENT_TERMINATE_TEST_CASE_RESULT:
+				if (curEntryNdx >= 0)
+				{
+					Entry&			entry		= m_entries[curEntryNdx];
+					TestStatusCode	statusCode	= TESTSTATUSCODE_CRASH;
+					const char*		reason		= parser.getTerminateReason();
+
+					try
+					{
+						statusCode = getTestStatusCode(reason);
+					}
+					catch (const xe::ParseError&)
+					{
+						// Could not map status code.
+					}
+
+					entry.dataSize		= pos - entry.dataOffset;
+					entry.statusCode	= statusCode;
+					entry.statusDetails	= reason;
+				}
+				curEntryNdx = -1;
+				break;
+
+			default:
+				// Session markers and '#' lines inside test case data.
+				break;
+		}
+
+		pos = lineEnd;
+	}
+
+	if (curEntryNdx >= 0)
+	{
+		Entry& entry = m_entries[curEntryNdx];
+
+		entry.dataSize		= end - entry.dataOffset;
+		entry.statusCode	= TESTSTATUSCODE_TERMINATED;
+		entry.statusDetails	= "Unexpected end of string";
+	}
+}
+
+bool BatchLogReader::readIndex (const char* indexFilename)
+{
+	deMappedFile* const indexFile = deMappedFile_create(indexFilename);
+
+	if (!indexFile)
+		return false;
+
+	clearIndex();
+
+	{
+		IndexReader		reader		((const deUint8*)deMappedFile_getPtr(indexFile), (deUint64)deMappedFile_getSize(indexFile));
+		const deUint32	magic		= reader.readU32();
+		const deUint32	version		= reader.readU32();
+		const deUint64	logSize		= reader.readU64();
+		const deInt64	logTime		= (deInt64)reader.readU64();
+		const deUint32	headerHash	= reader.readU32();
+		const deUint32	numEntries	= reader.readU32();
+		bool			isValid		= reader.isOk() && magic == INDEX_MAGIC && version == INDEX_VERSION && logSize == m_size && logTime == m_modificationTime;
+
+		for (deUint32 entryNdx = 0; isValid && entryNdx < numEntries; entryNdx++)
+		{
+			Entry entry;
+
+			reader.readString(entry.casePath);
+			entry.lineOffset	= reader.readU64();
+			entry.dataOffset	= reader.readU64();
+			entry.dataSize		= reader.readU64();
+			entry.statusCode	= (TestStatusCode)reader.readU32();
+			reader.readString(entry.statusDetails);
+
+			isValid = reader.isOk() && isEntryValid(entry);
+
+			if (isValid)
+			{
+				m_entryMap[entry.casePath] = (int)m_entries.size();
+				m_entries.push_back(entry);
+			}
+		}
+
+		deMappedFile_destroy(indexFile);
+
+		if (isValid)
+			isValid = getHeaderHash() == headerHash;
+
+		if (!isValid)
+		{
+			clearIndex();
+			return false;
+		}
+	}
+
+	// Session info precedes the first test case result.
+	scan(m_entries.empty() ? m_size : m_entries.front().lineOffset, false);
+
+	return true;
+}
+
+void BatchLogReader::writeIndex (const char* indexFilename) const
+{
+	std::ostringstream out;
+
+	writeU32(out, INDEX_MAGIC);
+	writeU32(out, INDEX_VERSION);
+	writeU64(out, m_size);
+	writeU64(out, (deUint64)m_modificationTime);
+	writeU32(out, getHeaderHash());
+	writeU32(out, (deUint32)m_entries.size());
+
+	for (vector<Entry>::const_iterator entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+	{
+		writeString(out, entry->casePath);
+		writeU64(out, entry->lineOffset);
+		writeU64(out, entry->dataOffset);
+		writeU64(out, entry->dataSize);
+		writeU32(out, (deUint32)entry->statusCode);
+		writeString(out, entry->statusDetails);
+	}
+
+	{
+		const string data = out.str();
+
+		// Other readers of the log may be loading the index at the same time
+		if (!deWriteFileAtomic(indexFilename, data.c_str(), (deInt64)data.size()))
+			throw Error(string("Failed to write '") + indexFilename + "'");
+	}
+}
+
+void BatchLogReader::readOrCreateIndex (const char* indexFilename)
+{
+	if (!readIndex(indexFilename))
+	{
+		createIndex();
+
+		try
+		{
+			writeIndex(indexFilename);
+		}
+		catch (const Error&)
+		{
+			// Index is only an optimization, e.g. log directory may be read-only
+		}
+	}
+}
+
+int BatchLogReader::findTestCaseResult (const char* casePath) const
+{
+	const map<string, int>::const_iterator pos = m_entryMap.find(casePath);
+	return pos != m_entryMap.end() ? pos->second : -1;
+}
+
+const deUint8* BatchLogReader::getTestCaseData (int ndx) const
+{
+	return m_entries[ndx].dataSize > 0 ? m_data + m_entries[ndx].dataOffset : DE_NULL;
+}
+
+TestCaseResultPtr BatchLogReader::getTestCaseResultData (int ndx) const
+{
+	const Entry&		entry		= m_entries[ndx];
+	TestCaseResultPtr	resultData	(new TestCaseResultData(entry.casePath.c_str()));
+
+	resultData->setTestResult(entry.statusCode, entry.statusDetails.c_str());
+	resultData->setDataSize(getTestCaseDataSize(ndx));
+
+	if (entry.dataSize > 0)
+		deMemcpy(resultData->getData(), getTestCaseData(ndx), (size_t)entry.dataSize);
+
+	return resultData;
+}
+
+void BatchLogReader::parseTestCaseResult (int ndx, TestResultParser* parser, TestCaseResult* result) const
+{
+	const Entry& entry = m_entries[ndx];
+
+	parseTestCaseResultFromData(parser, result, entry.casePath.c_str(), entry.statusCode, entry.statusDetails.c_str(), getTestCaseData(ndx), getTestCaseDataSize(ndx));
+}
+
+} // xe
@@ -0,0 +1,118 @@
+#ifndef _XEBATCHLOGREADER_HPP
+#define _XEBATCHLOGREADER_HPP
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Test Executor
+ * ------------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Random-access reader for batch result logs.
+ *//*--------------------------------------------------------------------*/
+
+#include "xeDefs.hpp"
+#include "xeBatchResult.hpp"
+#include "xeTestResultParser.hpp"
+#include "deMappedFile.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace xe
+{
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Random-access reader for .qpa batch result logs.
+ *
+ * The log is mapped into memory and an index of test case results is built
+ * by looking only at container lines (lines starting with '#'). Test case
+ * data is accessed in place and parsed only when requested.
+ *
+ * The index can be persisted next to the log so that later runs can skip
+ * the scan. A stored index is discarded if the size or modification time
+ * of the log or the hash of the session header lines do not match, or if
+ * any entry doesn't point to the #beginTestCaseResult line of its case.
+ *//*--------------------------------------------------------------------*/
+class BatchLogReader
+{
+public:
+								BatchLogReader				(const char* filename);
+								~BatchLogReader				(void);
+
+	//! Build index by scanning the whole log.
+	void						createIndex					(void);
+
+	//! Load index written by writeIndex(). Returns false if the index is missing or does not match the log.
+	bool						readIndex					(const char* indexFilename);
+	void						writeIndex					(const char* indexFilename) const;
+
+	//! Load index if it is up to date, otherwise build it and try to write it to indexFilename.
+	void						readOrCreateIndex			(const char* indexFilename);
+
+	static std::string			getDefaultIndexFilename		(const char* filename);
+
+	const SessionInfo&			getSessionInfo				(void) const	{ return m_sessionInfo;				}
+
+	int							getNumTestCaseResults		(void) const	{ return (int)m_entries.size();		}
+	const char*					getTestCasePath				(int ndx) const	{ return m_entries[ndx].casePath.c_str();	}
+	TestStatusCode				getStatusCode				(int ndx) const	{ return m_entries[ndx].statusCode;	}
+	const char*					getStatusDetails			(int ndx) const	{ return m_entries[ndx].statusDetails.c_str();	}
+
+	//! Returns index of the last result for casePath, or -1 if the log has none.
+	int							findTestCaseResult			(const char* casePath) const;
+
+	//! Test case data is valid as long as the reader exists.
+	const deUint8*				getTestCaseData				(int ndx) const;
+	int							getTestCaseDataSize			(int ndx) const	{ return (int)m_entries[ndx].dataSize;	}
+
+	TestCaseResultPtr			getTestCaseResultData		(int ndx) const;
+	void						parseTestCaseResult			(int ndx, TestResultParser* parser, TestCaseResult* result) const;
+
+private:
+								BatchLogReader				(const BatchLogReader& other);
+	BatchLogReader&				operator=					(const BatchLogReader& other);
+
+	struct Entry
+	{
+		std::string				casePath;
+		deUint64				lineOffset;		//!< Offset of #beginTestCaseResult line.
+		deUint64				dataOffset;
+		deUint64				dataSize;
+		TestStatusCode			statusCode;		//!< TESTSTATUSCODE_LAST if result was completed with #endTestCaseResult.
+		std::string				statusDetails;
+
+		Entry (void) : lineOffset(0), dataOffset(0), dataSize(0), statusCode(TESTSTATUSCODE_LAST) {}
+	};
+
+	void						scan						(deUint64 end, bool indexCases);
+	void						clearIndex					(void);
+	bool						isEntryValid				(const Entry& entry) const;
+	deUint32					getHeaderHash				(void) const;
+
+	deMappedFile*				m_file;
+	const deUint8*				m_data;
+	deUint64					m_size;
+	deInt64						m_modificationTime;
+
+	SessionInfo					m_sessionInfo;
+	std::vector<Entry>			m_entries;
+	std::map<std::string, int>	m_entryMap;
+};
+
+} // xe
+
+#endif // _XEBATCHLOGREADER_HPP
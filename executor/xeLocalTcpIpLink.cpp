@@ -46,13 +46,17 @@ LocalTcpIpLink::~LocalTcpIpLink (void)
 	stop();
 }
 
-void LocalTcpIpLink::start (const char* execServerPath, const char* workDir, int port)
+void LocalTcpIpLink::start (const char* execServerPath, const char* workDir, int port, const char* logFileName)
 {
 	XE_CHECK(!m_process);
 
 	std::ostringstream cmdLine;
 	cmdLine << execServerPath << " --single --port=" << port;
 
+	// Test processes of execservers sharing a working directory need distinct log files.
+	if (logFileName)
+		cmdLine << " --log-filename=" << logFileName;
+
 	m_process = deProcess_create();
 	XE_CHECK(m_process);
 
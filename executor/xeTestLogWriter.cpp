@@ -86,41 +86,50 @@ static void writeSessionInfo (const SessionInfo& info, std::ostream& stream)
 		stream << "#sessionInfo timestamp " << info.timestamp << "\n";
 }
 
-static void writeTestCase (const TestCaseResultData& caseData, std::ostream& stream)
+void writeSessionStart (const SessionInfo& sessionInfo, std::ostream& stream)
 {
-	stream << "\n#beginTestCaseResult " << caseData.getTestCasePath() << "\n";
+	writeSessionInfo(sessionInfo, stream);
 
-	if (caseData.getDataSize() > 0)
+	stream << "#beginSession\n";
+}
+
+void writeTestCaseData (const char* casePath, TestStatusCode statusCode, const deUint8* data, size_t dataSize, std::ostream& stream)
+{
+	stream << "\n#beginTestCaseResult " << casePath << "\n";
+
+	if (dataSize > 0)
 	{
-		stream.write((const char*)caseData.getData(), caseData.getDataSize());
+		stream.write((const char*)data, (std::streamsize)dataSize);
 
-		deUint8 lastCh = caseData.getData()[caseData.getDataSize()-1];
+		deUint8 lastCh = data[dataSize-1];
 		if (lastCh != '\n' && lastCh != '\r')
 			stream << "\n";
 	}
 
-	TestStatusCode dataCode = caseData.getStatusCode();
-	if (dataCode == TESTSTATUSCODE_CRASH	||
-		dataCode == TESTSTATUSCODE_TIMEOUT	||
-		dataCode == TESTSTATUSCODE_TERMINATED)
-		stream << "#terminateTestCaseResult " << getTestStatusCodeName(dataCode) << "\n";
+	if (statusCode == TESTSTATUSCODE_CRASH		||
+		statusCode == TESTSTATUSCODE_TIMEOUT	||
+		statusCode == TESTSTATUSCODE_TERMINATED)
+		stream << "#terminateTestCaseResult " << getTestStatusCodeName(statusCode) << "\n";
 	else
 		stream << "#endTestCaseResult\n";
 }
 
-void writeTestLog (const BatchResult& result, std::ostream& stream)
+void writeSessionEnd (std::ostream& stream)
 {
-	writeSessionInfo(result.getSessionInfo(), stream);
+	stream << "\n#endSession\n";
+}
 
-	stream << "#beginSession\n";
+void writeTestLog (const BatchResult& result, std::ostream& stream)
+{
+	writeSessionStart(result.getSessionInfo(), stream);
 
 	for (int ndx = 0; ndx < result.getNumTestCaseResults(); ndx++)
 	{
 		ConstTestCaseResultPtr caseData = result.getTestCaseResult(ndx);
-		writeTestCase(*caseData, stream);
+		writeTestCaseData(caseData->getTestCasePath(), caseData->getStatusCode(), caseData->getData(), (size_t)caseData->getDataSize(), stream);
 	}
 
-	stream << "\n#endSession\n";
+	writeSessionEnd(stream);
 }
 
 void writeBatchResultToFile (const BatchResult& result, const char* filename)
@@ -40,6 +40,11 @@ class Writer;
 void	writeTestLog			(const BatchResult& batchResult, std::ostream& stream);
 void	writeBatchResultToFile	(const BatchResult& batchResult, const char* filename);
 
+// Incremental batch result writing; results are written between writeSessionStart() and writeSessionEnd().
+void	writeSessionStart		(const SessionInfo& sessionInfo, std::ostream& stream);
+void	writeTestCaseData		(const char* casePath, TestStatusCode statusCode, const deUint8* data, size_t dataSize, std::ostream& stream);
+void	writeSessionEnd			(std::ostream& stream);
+
 void	writeTestResult			(const TestCaseResult& result, xe::xml::Writer& writer);
 void	writeTestResult			(const TestCaseResult& result, std::ostream& stream);
 void	writeTestResultToFile	(const TestCaseResult& result, const char* filename);
@@ -808,11 +808,12 @@ void TestResultParser::handleData (void)
 			ri::Image* image = static_cast<ri::Image*>(curItem);
 
 			// Base64 decode.
-			int numBytesIn = m_xmlParser.getDataSize();
+			const deUint8*	dataIn		= m_xmlParser.getDataPtr();
+			const int		numBytesIn	= m_xmlParser.getDataSize();
 
 			for (int inNdx = 0; inNdx < numBytesIn; inNdx++)
 			{
-				deUint8		byte		= m_xmlParser.getDataByte(inNdx);
+				deUint8		byte		= dataIn[inNdx];
 				deUint8		decodedBits	= 0;
 
 				if (de::inRange<deInt8>(byte, 'A', 'Z'))
@@ -869,20 +870,25 @@ void TestResultParser::handleData (void)
 
 //! Helper for parsing TestCaseResult from TestCaseResultData.
 void parseTestCaseResultFromData (TestResultParser* parser, TestCaseResult* result, const TestCaseResultData& data)
+{
+	parseTestCaseResultFromData(parser, result, data.getTestCasePath(), data.getStatusCode(), data.getStatusDetails(), data.getData(), data.getDataSize());
+}
+
+void parseTestCaseResultFromData (TestResultParser* parser, TestCaseResult* result, const char* casePath, TestStatusCode statusCode, const char* statusDetails, const deUint8* data, int dataSize)
 {
 	DE_ASSERT(result->resultItems.getNumItems() == 0);
 
 	// Initialize status codes etc. from data.
-	result->casePath		= data.getTestCasePath();
+	result->casePath		= casePath;
 	result->caseType		= TESTCASETYPE_SELF_VALIDATE;
-	result->statusCode		= data.getStatusCode();
-	result->statusDetails	= data.getStatusDetails();
+	result->statusCode		= statusCode;
+	result->statusDetails	= statusDetails;
 
-	if (data.getDataSize() > 0)
+	if (dataSize > 0)
 	{
 		parser->init(result);
 
-		const TestResultParser::ParseResult parseResult = parser->parse(data.getData(), data.getDataSize());
+		const TestResultParser::ParseResult parseResult = parser->parse(data, dataSize);
 
 		if (result->statusCode == TESTSTATUSCODE_LAST)
 		{
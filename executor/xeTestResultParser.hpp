@@ -119,6 +119,7 @@ TestStatusCode	getTestStatusCode			(const char* statusCode);
 class TestCaseResultData;
 
 void			parseTestCaseResultFromData	(TestResultParser* parser, TestCaseResult* result, const TestCaseResultData& data);
+void			parseTestCaseResultFromData	(TestResultParser* parser, TestCaseResult* result, const char* casePath, TestStatusCode statusCode, const char* statusDetails, const deUint8* data, int dataSize);
 
 } // xe
 
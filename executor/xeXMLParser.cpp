@@ -23,6 +23,15 @@
 
 #include "xeXMLParser.hpp"
 #include "deInt32.h"
+#include "deMemory.h"
+
+#if (DE_CPU == DE_CPU_X86_64)
+#	include <emmintrin.h>
+#	define XE_XML_PARSER_USE_SSE2
+#elif (DE_CPU == DE_CPU_ARM_64)
+#	include <arm_neon.h>
+#	define XE_XML_PARSER_USE_NEON
+#endif
 
 namespace xe
 {
@@ -54,11 +63,62 @@ static int getNextBufferSize (int curSize, int minNewSize)
 	return de::max(curSize*2, 1<<deLog2Ceil32(minNewSize));
 }
 
+//! Returns index of first byte in data that equals any of c0, c1 or c2, or numBytes if there is none.
+static int findFirstOf (const deUint8* data, int numBytes, deUint8 c0, deUint8 c1, deUint8 c2)
+{
+	int ndx = 0;
+
+#if defined(XE_XML_PARSER_USE_SSE2)
+	{
+		const __m128i	v0	= _mm_set1_epi8((char)c0);
+		const __m128i	v1	= _mm_set1_epi8((char)c1);
+		const __m128i	v2	= _mm_set1_epi8((char)c2);
+
+		for (; ndx + 16 <= numBytes; ndx += 16)
+		{
+			const __m128i	chars	= _mm_loadu_si128((const __m128i*)(data + ndx));
+			const __m128i	match	= _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, v0), _mm_cmpeq_epi8(chars, v1)), _mm_cmpeq_epi8(chars, v2));
+			const int		mask	= _mm_movemask_epi8(match);
+
+			if (mask != 0)
+				return ndx + deCtz32((deUint32)mask);
+		}
+	}
+#elif defined(XE_XML_PARSER_USE_NEON)
+	{
+		const uint8x16_t	v0	= vdupq_n_u8(c0);
+		const uint8x16_t	v1	= vdupq_n_u8(c1);
+		const uint8x16_t	v2	= vdupq_n_u8(c2);
+
+		for (; ndx + 16 <= numBytes; ndx += 16)
+		{
+			const uint8x16_t	chars	= vld1q_u8(data + ndx);
+			const uint8x16_t	match	= vorrq_u8(vorrq_u8(vceqq_u8(chars, v0), vceqq_u8(chars, v1)), vceqq_u8(chars, v2));
+
+			// Locate the exact byte with the scalar loop below.
+			if (vmaxvq_u8(match) != 0)
+				break;
+		}
+	}
+#endif
+
+	for (; ndx < numBytes; ndx++)
+	{
+		const deUint8 ch = data[ndx];
+		if (ch == c0 || ch == c1 || ch == c2)
+			return ndx;
+	}
+
+	return numBytes;
+}
+
 Tokenizer::Tokenizer (void)
 	: m_curToken	(TOKEN_INCOMPLETE)
 	, m_curTokenLen	(0)
 	, m_state		(STATE_DATA)
 	, m_buf			(TOKENIZER_INITIAL_BUFFER_SIZE)
+	, m_bufBegin	(0)
+	, m_bufEnd		(0)
 {
 }
 
@@ -71,7 +131,8 @@ void Tokenizer::clear (void)
 	m_curToken		= TOKEN_INCOMPLETE;
 	m_curTokenLen	= 0;
 	m_state			= STATE_DATA;
-	m_buf.clear();
+	m_bufBegin		= 0;
+	m_bufEnd		= 0;
 }
 
 void Tokenizer::error (const std::string& what)
@@ -81,14 +142,34 @@ void Tokenizer::error (const std::string& what)
 
 void Tokenizer::feed (const deUint8* bytes, int numBytes)
 {
-	// Grow buffer if necessary.
-	if (m_buf.getNumFree() < numBytes)
+	if ((int)m_buf.size() - m_bufEnd < numBytes)
 	{
-		m_buf.resize(getNextBufferSize(m_buf.getSize(), m_buf.getNumElements()+numBytes));
+		const int numBuffered = getNumBufferedBytes();
+
+		if ((int)m_buf.size() < numBuffered + numBytes)
+		{
+			// Grow buffer.
+			std::vector<deUint8> newBuf (getNextBufferSize((int)m_buf.size(), numBuffered + numBytes));
+
+			if (numBuffered > 0)
+				deMemcpy(&newBuf[0], &m_buf[m_bufBegin], numBuffered);
+
+			m_buf.swap(newBuf);
+		}
+		else if (numBuffered > 0)
+		{
+			// Move unconsumed data to beginning of buffer.
+			deMemmove(&m_buf[0], &m_buf[m_bufBegin], numBuffered);
+		}
+
+		m_bufBegin	= 0;
+		m_bufEnd	= numBuffered;
 	}
 
-	// Append to front.
-	m_buf.pushFront(bytes, numBytes);
+	// Append to end.
+	if (numBytes > 0)
+		deMemcpy(&m_buf[m_bufEnd], bytes, numBytes);
+	m_bufEnd += numBytes;
 
 	// If we haven't parsed complete token, re-try after data feed.
 	if (m_curToken == TOKEN_INCOMPLETE)
@@ -97,14 +178,27 @@ void Tokenizer::feed (const deUint8* bytes, int numBytes)
 
 int Tokenizer::getChar (int offset) const
 {
-	DE_ASSERT(de::inRange(offset, 0, m_buf.getNumElements()));
+	DE_ASSERT(de::inRange(offset, 0, getNumBufferedBytes()));
 
-	if (offset < m_buf.getNumElements())
-		return m_buf.peekBack(offset);
+	if (offset < getNumBufferedBytes())
+		return m_buf[m_bufBegin+offset];
 	else
 		return END_OF_BUFFER;
 }
 
+//! Returns offset of first buffered byte at or after offset that is c0, c1 or c2, or number of buffered bytes if none is found.
+int Tokenizer::scanUntil (int offset, deUint8 c0, deUint8 c1, deUint8 c2) const
+{
+	DE_ASSERT(de::inRange(offset, 0, getNumBufferedBytes()));
+
+	const int numBytes = getNumBufferedBytes() - offset;
+
+	if (numBytes == 0)
+		return offset;
+
+	return offset + findFirstOf(&m_buf[m_bufBegin+offset], numBytes, c0, c1, c2);
+}
+
 void Tokenizer::advance (void)
 {
 	if (m_curToken != TOKEN_INCOMPLETE)
@@ -121,7 +215,7 @@ void Tokenizer::advance (void)
 			m_state = STATE_DATA;
 
 		// Advance buffer by length of last token.
-		m_buf.popBack(m_curTokenLen);
+		m_bufBegin += m_curTokenLen;
 
 		// Reset state.
 		m_curToken		= TOKEN_INCOMPLETE;
@@ -142,6 +236,10 @@ void Tokenizer::advance (void)
 	{
 		if (m_state == STATE_DATA)
 		{
+			// Skip over plain character data in bulk.
+			m_curTokenLen	= scanUntil(m_curTokenLen, '<', '&', END_OF_STRING);
+			curChar			= getChar(m_curTokenLen);
+
 			// Advance until we hit end of buffer or tag start and treat that as data token.
 			if (curChar == END_OF_STRING || curChar == (int)END_OF_BUFFER || curChar == '<' || curChar == '&')
 			{
@@ -175,10 +273,16 @@ void Tokenizer::advance (void)
 			{
 				while (isWhitespaceChar(curChar))
 				{
-					m_buf.popBack();
+					m_bufBegin += 1;
 					curChar = getChar(0);
 				}
 			}
+			else if (m_state == STATE_VALUE)
+			{
+				// Skip over string contents in bulk.
+				m_curTokenLen	= scanUntil(m_curTokenLen, '\'', '"', END_OF_STRING);
+				curChar			= getChar(m_curTokenLen);
+			}
 
 			// Handle end of string / buffer.
 			if (curChar == END_OF_STRING)
@@ -338,9 +442,7 @@ void Tokenizer::advance (void)
 void Tokenizer::getString (std::string& dst) const
 {
 	DE_ASSERT(m_curToken == TOKEN_STRING);
-	dst.resize(m_curTokenLen-2);
-	for (int ndx = 0; ndx < m_curTokenLen-2; ndx++)
-		dst[ndx] = m_buf.peekBack(ndx+1);
+	dst.assign((const char*)getTokenData() + 1, (size_t)(m_curTokenLen-2));
 }
 
 Parser::Parser (void)
@@ -30,9 +30,9 @@
  *//*--------------------------------------------------------------------*/
 
 #include "xeDefs.hpp"
-#include "deRingBuffer.hpp"
 
 #include <string>
+#include <vector>
 #include <map>
 
 namespace xe
@@ -93,7 +93,8 @@ public:
 
 	Token				getToken			(void) const		{ return m_curToken;	}
 	int					getTokenLen			(void) const		{ return m_curTokenLen;	}
-	deUint8				getTokenByte		(int offset) const	{ DE_ASSERT(m_curToken != TOKEN_INCOMPLETE && m_curToken != TOKEN_END_OF_STRING); return m_buf.peekBack(offset); }
+	deUint8				getTokenByte		(int offset) const	{ DE_ASSERT(m_curToken != TOKEN_INCOMPLETE && m_curToken != TOKEN_END_OF_STRING); return m_buf[m_bufBegin+offset]; }
+	const deUint8*		getTokenData		(void) const;
 	void				getTokenStr			(std::string& dst) const;
 	void				appendTokenStr		(std::string& dst) const;
 
@@ -104,6 +105,8 @@ private:
 	Tokenizer&			operator=			(const Tokenizer& other);
 
 	int					getChar				(int offset) const;
+	int					getNumBufferedBytes	(void) const		{ return m_bufEnd - m_bufBegin; }
+	int					scanUntil			(int offset, deUint8 c0, deUint8 c1, deUint8 c2) const;
 
 	void				error				(const std::string& what);
 
@@ -130,7 +133,10 @@ private:
 
 	State						m_state;			//!< Tokenization state.
 
-	de::RingBuffer<deUint8>		m_buf;
+	//! Unconsumed input is kept contiguous in m_buf[m_bufBegin, m_bufEnd) so that tokens can be accessed in place.
+	std::vector<deUint8>		m_buf;
+	int							m_bufBegin;
+	int							m_bufEnd;
 };
 
 class Parser
@@ -160,6 +166,7 @@ public:
 	// For ELEMENT_DATA.
 	int					getDataSize			(void) const;
 	deUint8				getDataByte			(int offset) const;
+	const deUint8*		getDataPtr			(void) const;		//!< Valid until next advance() or feed().
 	void				getDataStr			(std::string& dst) const;
 	void				appendDataStr		(std::string& dst) const;
 
@@ -200,23 +207,22 @@ private:
 
 // Inline implementations
 
+inline const deUint8* Tokenizer::getTokenData (void) const
+{
+	DE_ASSERT(m_curToken != TOKEN_INCOMPLETE && m_curToken != TOKEN_END_OF_STRING);
+	return &m_buf[m_bufBegin];
+}
+
 inline void Tokenizer::getTokenStr (std::string& dst) const
 {
 	DE_ASSERT(m_curToken != TOKEN_INCOMPLETE && m_curToken != TOKEN_END_OF_STRING);
-	dst.resize(m_curTokenLen);
-	for (int ndx = 0; ndx < m_curTokenLen; ndx++)
-		dst[ndx] = m_buf.peekBack(ndx);
+	dst.assign((const char*)getTokenData(), (size_t)m_curTokenLen);
 }
 
 inline void Tokenizer::appendTokenStr (std::string& dst) const
 {
 	DE_ASSERT(m_curToken != TOKEN_INCOMPLETE && m_curToken != TOKEN_END_OF_STRING);
-
-	size_t oldLen = dst.size();
-	dst.resize(oldLen+m_curTokenLen);
-
-	for (int ndx = 0; ndx < m_curTokenLen; ndx++)
-		dst[oldLen+ndx] = m_buf.peekBack(ndx);
+	dst.append((const char*)getTokenData(), (size_t)m_curTokenLen);
 }
 
 inline int Parser::getDataSize (void) const
@@ -235,6 +241,14 @@ inline deUint8 Parser::getDataByte (int offset) const
 		return (deUint8)m_entityValue[offset];
 }
 
+inline const deUint8* Parser::getDataPtr (void) const
+{
+	if (m_state != STATE_ENTITY)
+		return m_tokenizer.getTokenData();
+	else
+		return (const deUint8*)m_entityValue.data();
+}
+
 inline void Parser::getDataStr (std::string& dst) const
 {
 	if (m_state != STATE_ENTITY)
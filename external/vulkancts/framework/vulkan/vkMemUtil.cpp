@@ -29,6 +29,7 @@
 #include "deInt32.h"
 
 #include <sstream>
+#include <map>
 
 namespace vk
 {
@@ -233,6 +234,318 @@ MovePtr<Allocation> SimpleAllocator::allocate (const VkMemoryRequirements& memRe
 	return MovePtr<Allocation>(new SimpleAllocation(mem, hostPtr));
 }
 
+// SuballocatingAllocator
+
+class SuballocatingAllocator::MemoryBlock
+{
+public:
+									MemoryBlock		(const DeviceInterface& vkd, VkDevice device, const VkMemoryAllocateInfo& allocInfo, bool hostVisible, bool dedicated);
+
+	bool							allocate		(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset);
+	void							free			(VkDeviceSize offset, VkDeviceSize size);
+
+	VkDeviceMemory					getMemory		(void) const { return *m_memory;								}
+	void*							getHostPtr		(void) const { return m_hostPtr ? m_hostPtr->get() : DE_NULL;	}
+	VkDeviceSize					getSize			(void) const { return m_size;									}
+	bool							isDedicated		(void) const { return m_dedicated;								}
+	bool							isEmpty			(void) const { return m_numAllocations == 0u;					}
+
+private:
+	typedef std::map<VkDeviceSize, VkDeviceSize> RangeMap;
+
+	const Unique<VkDeviceMemory>	m_memory;
+	const UniquePtr<HostPtr>		m_hostPtr;
+	const VkDeviceSize				m_size;
+	const bool						m_dedicated;
+
+	RangeMap						m_freeRanges;		//!< Free ranges as offset -> size
+	deUint32						m_numAllocations;
+};
+
+SuballocatingAllocator::MemoryBlock::MemoryBlock (const DeviceInterface& vkd, VkDevice device, const VkMemoryAllocateInfo& allocInfo, bool hostVisible, bool dedicated)
+	: m_memory			(allocateMemory(vkd, device, &allocInfo))
+	, m_hostPtr			(hostVisible ? new HostPtr(vkd, device, *m_memory, 0u, allocInfo.allocationSize, 0u) : DE_NULL)
+	, m_size			(allocInfo.allocationSize)
+	, m_dedicated		(dedicated)
+	, m_numAllocations	(0u)
+{
+	m_freeRanges[0u] = m_size;
+}
+
+bool SuballocatingAllocator::MemoryBlock::allocate (VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset)
+{
+	// First fit
+	for (RangeMap::iterator range = m_freeRanges.begin(); range != m_freeRanges.end(); ++range)
+	{
+		const VkDeviceSize	rangeBegin	= range->first;
+		const VkDeviceSize	rangeEnd	= range->first + range->second;
+		const VkDeviceSize	allocBegin	= (VkDeviceSize)deAlign64((deInt64)rangeBegin, (deInt64)alignment);
+
+		if (allocBegin <= rangeEnd && rangeEnd - allocBegin >= size)
+		{
+			m_freeRanges.erase(range);
+
+			if (allocBegin > rangeBegin)
+				m_freeRanges[rangeBegin] = allocBegin - rangeBegin;
+
+			if (allocBegin + size < rangeEnd)
+				m_freeRanges[allocBegin + size] = rangeEnd - (allocBegin + size);
+
+			*offset				 = allocBegin;
+			m_numAllocations	+= 1u;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SuballocatingAllocator::MemoryBlock::free (VkDeviceSize offset, VkDeviceSize size)
+{
+	VkDeviceSize		rangeBegin	= offset;
+	VkDeviceSize		rangeEnd	= offset + size;
+	RangeMap::iterator	next		= m_freeRanges.lower_bound(offset);
+
+	DE_ASSERT(m_numAllocations > 0u);
+	DE_ASSERT(next == m_freeRanges.end() || next->first >= rangeEnd);
+
+	// Merge with adjacent free ranges
+	if (next != m_freeRanges.end() && next->first == rangeEnd)
+	{
+		rangeEnd += next->second;
+		m_freeRanges.erase(next++);
+	}
+
+	if (next != m_freeRanges.begin())
+	{
+		RangeMap::iterator prev = next;
+		--prev;
+
+		DE_ASSERT(prev->first + prev->second <= rangeBegin);
+
+		if (prev->first + prev->second == rangeBegin)
+		{
+			rangeBegin = prev->first;
+			m_freeRanges.erase(prev);
+		}
+	}
+
+	m_freeRanges[rangeBegin]	 = rangeEnd - rangeBegin;
+	m_numAllocations			-= 1u;
+}
+
+class SuballocatingAllocator::BlockAllocation : public Allocation
+{
+public:
+								BlockAllocation		(SuballocatingAllocator& allocator, MemoryBlock* block, VkDeviceSize offset, VkDeviceSize size);
+	virtual						~BlockAllocation	(void);
+
+private:
+	SuballocatingAllocator&		m_allocator;
+	MemoryBlock* const			m_block;
+	const VkDeviceSize			m_size;
+};
+
+SuballocatingAllocator::BlockAllocation::BlockAllocation (SuballocatingAllocator& allocator, MemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+	: Allocation	(block->getMemory(), offset, block->getHostPtr() ? (deUint8*)block->getHostPtr() + offset : DE_NULL)
+	, m_allocator	(allocator)
+	, m_block		(block)
+	, m_size		(size)
+{
+}
+
+SuballocatingAllocator::BlockAllocation::~BlockAllocation (void)
+{
+	m_allocator.free(m_block, getOffset(), m_size);
+}
+
+SuballocatingAllocator::SuballocatingAllocator (const DeviceInterface&					vk,
+												VkDevice								device,
+												const VkPhysicalDeviceMemoryProperties&	deviceMemProps,
+												const VkPhysicalDeviceLimits&			deviceLimits,
+												VkDeviceSize							blockSize)
+	: m_vk						(vk)
+	, m_device					(device)
+	, m_memProps				(deviceMemProps)
+	, m_bufferImageGranularity	(de::max<VkDeviceSize>(deviceLimits.bufferImageGranularity, 1u))
+	, m_nonCoherentAtomSize		(de::max<VkDeviceSize>(deviceLimits.nonCoherentAtomSize, 1u))
+	, m_blockSize				(blockSize)
+	, m_bytesInUse				(0u)
+	, m_deviceMemorySize		(0u)
+{
+}
+
+SuballocatingAllocator::~SuballocatingAllocator (void)
+{
+	for (deUint32 memoryTypeNdx = 0; memoryTypeNdx < VK_MAX_MEMORY_TYPES; memoryTypeNdx++)
+	{
+		for (size_t blockNdx = 0; blockNdx < m_blocks[memoryTypeNdx].size(); blockNdx++)
+		{
+			DE_ASSERT(m_blocks[memoryTypeNdx][blockNdx]->isEmpty());
+			delete m_blocks[memoryTypeNdx][blockNdx];
+		}
+	}
+}
+
+VkDeviceSize SuballocatingAllocator::getGranularity (deUint32 memoryTypeNdx) const
+{
+	const VkMemoryPropertyFlags	flags	= m_memProps.memoryTypes[memoryTypeNdx].propertyFlags;
+
+	if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		return de::max(m_bufferImageGranularity, m_nonCoherentAtomSize);
+	else
+		return m_bufferImageGranularity;
+}
+
+MovePtr<Allocation> SuballocatingAllocator::allocate (const VkMemoryAllocateInfo& allocInfo, VkDeviceSize alignment)
+{
+	return allocateFromBlocks(allocInfo, alignment);
+}
+
+MovePtr<Allocation> SuballocatingAllocator::allocate (const VkMemoryRequirements& memReqs, MemoryRequirement requirement)
+{
+	const deUint32				memoryTypeNdx	= selectMatchingMemoryType(m_memProps, memReqs.memoryTypeBits, requirement);
+	const VkMemoryAllocateInfo	allocInfo		=
+	{
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,	//	VkStructureType			sType;
+		DE_NULL,								//	const void*				pNext;
+		memReqs.size,							//	VkDeviceSize			allocationSize;
+		memoryTypeNdx,							//	deUint32				memoryTypeIndex;
+	};
+
+	DE_ASSERT(!(requirement & MemoryRequirement::HostVisible) || isHostVisibleMemory(m_memProps, memoryTypeNdx));
+
+	return allocateFromBlocks(allocInfo, memReqs.alignment);
+}
+
+MovePtr<Allocation> SuballocatingAllocator::allocateFromBlocks (const VkMemoryAllocateInfo& allocInfo, VkDeviceSize alignment)
+{
+	const deUint32				memoryTypeNdx	= allocInfo.memoryTypeIndex;
+	const VkMemoryPropertyFlags	flags			= m_memProps.memoryTypes[memoryTypeNdx].propertyFlags;
+	const VkDeviceSize			heapSize		= m_memProps.memoryHeaps[m_memProps.memoryTypes[memoryTypeNdx].heapIndex].size;
+	const VkDeviceSize			blockSize		= de::min(m_blockSize, heapSize / 8u);
+	const bool					hostVisible		= isHostVisibleMemory(m_memProps, memoryTypeNdx);
+	const VkDeviceSize			granularity		= getGranularity(memoryTypeNdx);
+	const VkDeviceSize			size			= (VkDeviceSize)deAlign64((deInt64)allocInfo.allocationSize, (deInt64)granularity);
+	bool						dedicated		= allocInfo.pNext != DE_NULL																	||
+												  (flags & (VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT|VK_MEMORY_PROPERTY_PROTECTED_BIT)) != 0u	||
+												  size > blockSize / 4u;
+	const de::ScopedLock		lock			(m_lock);
+	MemoryBlock*				block			= DE_NULL;
+	VkDeviceSize				offset			= 0u;
+
+	DE_ASSERT(memoryTypeNdx < m_memProps.memoryTypeCount);
+
+	if (!dedicated)
+	{
+		const VkDeviceSize			allocAlignment	= de::max(alignment, granularity);
+		std::vector<MemoryBlock*>&	blocks			= m_blocks[memoryTypeNdx];
+
+		for (size_t blockNdx = 0; blockNdx < blocks.size() && !block; blockNdx++)
+		{
+			if (blocks[blockNdx]->allocate(size, allocAlignment, &offset))
+				block = blocks[blockNdx];
+		}
+
+		if (!block)
+		{
+			VkMemoryAllocateInfo	blockInfo	= allocInfo;
+			MovePtr<MemoryBlock>	newBlock;
+
+			blockInfo.allocationSize = blockSize;
+
+			try
+			{
+				newBlock = MovePtr<MemoryBlock>(new MemoryBlock(m_vk, m_device, blockInfo, hostVisible, false));
+			}
+			catch (const OutOfMemoryError&)
+			{
+				// Fall back to allocating only what was requested.
+				dedicated = true;
+			}
+
+			if (newBlock)
+			{
+				blocks.reserve(blocks.size() + 1);
+
+				DE_VERIFY(newBlock->allocate(size, allocAlignment, &offset));
+
+				block = newBlock.release();
+				blocks.push_back(block);
+
+				m_statistics.numDeviceMemoryAllocations	+= 1u;
+				m_deviceMemorySize						+= blockSize;
+			}
+		}
+	}
+
+	if (dedicated)
+	{
+		block = new MemoryBlock(m_vk, m_device, allocInfo, hostVisible, true);
+
+		DE_VERIFY(block->allocate(allocInfo.allocationSize, 1u, &offset));
+
+		m_statistics.numDeviceMemoryAllocations	+= 1u;
+		m_deviceMemorySize						+= allocInfo.allocationSize;
+	}
+
+	m_statistics.numAllocations			+= 1u;
+	m_bytesInUse						+= block->isDedicated() ? allocInfo.allocationSize : size;
+	m_statistics.peakBytesInUse			 = de::max(m_statistics.peakBytesInUse, m_bytesInUse);
+	m_statistics.peakDeviceMemorySize	 = de::max(m_statistics.peakDeviceMemorySize, m_deviceMemorySize);
+
+	return MovePtr<Allocation>(new BlockAllocation(*this, block, offset, block->isDedicated() ? allocInfo.allocationSize : size));
+}
+
+void SuballocatingAllocator::free (MemoryBlock* block, VkDeviceSize offset, VkDeviceSize size)
+{
+	const de::ScopedLock lock (m_lock);
+
+	block->free(offset, size);
+	m_bytesInUse -= size;
+
+	if (block->isDedicated())
+	{
+		m_deviceMemorySize -= block->getSize();
+		delete block;
+	}
+}
+
+void SuballocatingAllocator::reset (void)
+{
+	const de::ScopedLock lock (m_lock);
+
+	for (deUint32 memoryTypeNdx = 0; memoryTypeNdx < VK_MAX_MEMORY_TYPES; memoryTypeNdx++)
+	{
+		std::vector<MemoryBlock*>&	blocks		= m_blocks[memoryTypeNdx];
+		size_t						numKept		= 0;
+
+		for (size_t blockNdx = 0; blockNdx < blocks.size(); blockNdx++)
+		{
+			if (blocks[blockNdx]->isEmpty())
+			{
+				m_deviceMemorySize -= blocks[blockNdx]->getSize();
+				delete blocks[blockNdx];
+			}
+			else
+				blocks[numKept++] = blocks[blockNdx];
+		}
+
+		blocks.resize(numKept);
+	}
+
+	m_statistics						= AllocatorStatistics();
+	m_statistics.peakBytesInUse			= m_bytesInUse;
+	m_statistics.peakDeviceMemorySize	= m_deviceMemorySize;
+}
+
+AllocatorStatistics SuballocatingAllocator::getStatistics (void) const
+{
+	const de::ScopedLock lock (m_lock);
+	return m_statistics;
+}
+
 static MovePtr<Allocation> allocateDedicated (const InstanceInterface&		vki,
 											  const DeviceInterface&		vkd,
 											  const VkPhysicalDevice&		physDevice,
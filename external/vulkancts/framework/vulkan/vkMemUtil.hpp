@@ -25,6 +25,9 @@
 
 #include "vkDefs.hpp"
 #include "deUniquePtr.hpp"
+#include "deMutex.hpp"
+
+#include <vector>
 
 namespace vk
 {
@@ -144,6 +147,88 @@ private:
 	const VkPhysicalDeviceMemoryProperties	m_memProps;
 };
 
+//! Allocation statistics of SuballocatingAllocator
+struct AllocatorStatistics
+{
+	deUint64		numAllocations;					//!< Number of Allocation objects created
+	deUint64		numDeviceMemoryAllocations;		//!< Number of VkDeviceMemory objects allocated
+	VkDeviceSize	peakBytesInUse;					//!< Peak total size of live allocations
+	VkDeviceSize	peakDeviceMemorySize;			//!< Peak total size of live VkDeviceMemory objects
+
+	AllocatorStatistics (void)
+		: numAllocations				(0u)
+		, numDeviceMemoryAllocations	(0u)
+		, peakBytesInUse				(0u)
+		, peakDeviceMemorySize			(0u)
+	{
+	}
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Allocator that sub-allocates from larger VkDeviceMemory blocks
+ *
+ * Small allocations are placed into per-memory-type blocks of blockSize
+ * bytes. Large allocations, allocations with extension structures and
+ * allocations from protected or lazily allocated memory types get their
+ * own VkDeviceMemory.
+ *
+ * Offsets and sizes of sub-allocations are rounded to bufferImageGranularity
+ * (and nonCoherentAtomSize for non-coherent host-visible memory), so linear
+ * and optimal resources never share a granularity page and flushAlloc()
+ * ranges stay valid.
+ *
+ * Host-visible blocks are mapped once for their whole lifetime.
+ *
+ * Blocks are kept until reset() is called. reset() frees blocks that have
+ * no live allocations and restarts statistics; it is meant to be called
+ * between test cases.
+ *//*--------------------------------------------------------------------*/
+class SuballocatingAllocator : public Allocator
+{
+public:
+	enum
+	{
+		DEFAULT_BLOCK_SIZE = 32*1024*1024
+	};
+
+											SuballocatingAllocator	(const DeviceInterface&						vk,
+																	 VkDevice									device,
+																	 const VkPhysicalDeviceMemoryProperties&	deviceMemProps,
+																	 const VkPhysicalDeviceLimits&				deviceLimits,
+																	 VkDeviceSize								blockSize	= (VkDeviceSize)DEFAULT_BLOCK_SIZE);
+											~SuballocatingAllocator	(void);
+
+	de::MovePtr<Allocation>					allocate				(const VkMemoryAllocateInfo& allocInfo, VkDeviceSize alignment);
+	de::MovePtr<Allocation>					allocate				(const VkMemoryRequirements& memRequirements, MemoryRequirement requirement);
+
+	void									reset					(void);
+	AllocatorStatistics						getStatistics			(void) const;
+
+private:
+	class MemoryBlock;
+	class BlockAllocation;
+
+											SuballocatingAllocator	(const SuballocatingAllocator&);
+	SuballocatingAllocator&					operator=				(const SuballocatingAllocator&);
+
+	VkDeviceSize							getGranularity			(deUint32 memoryTypeNdx) const;
+	de::MovePtr<Allocation>					allocateFromBlocks		(const VkMemoryAllocateInfo& allocInfo, VkDeviceSize alignment);
+	void									free					(MemoryBlock* block, VkDeviceSize offset, VkDeviceSize size);
+
+	const DeviceInterface&					m_vk;
+	const VkDevice							m_device;
+	const VkPhysicalDeviceMemoryProperties	m_memProps;
+	const VkDeviceSize						m_bufferImageGranularity;
+	const VkDeviceSize						m_nonCoherentAtomSize;
+	const VkDeviceSize						m_blockSize;
+
+	mutable de::Mutex						m_lock;
+	std::vector<MemoryBlock*>				m_blocks[VK_MAX_MEMORY_TYPES];	//!< Shared blocks per memory type
+	AllocatorStatistics						m_statistics;
+	VkDeviceSize							m_bytesInUse;
+	VkDeviceSize							m_deviceMemorySize;
+};
+
 de::MovePtr<Allocation>	allocateDedicated			(const InstanceInterface& vki, const DeviceInterface& vkd, const VkPhysicalDevice& physDevice, const VkDevice device, const VkBuffer buffer, MemoryRequirement requirement);
 de::MovePtr<Allocation>	allocateDedicated			(const InstanceInterface& vki, const DeviceInterface& vkd, const VkPhysicalDevice& physDevice, const VkDevice device, const VkImage image, MemoryRequirement requirement);
 
@@ -27,6 +27,8 @@
 #include "vkQueryUtil.hpp"
 #include "tcuFunctionLibrary.hpp"
 #include "deMemory.h"
+#include "deString.h"
+#include "deMutex.hpp"
 
 #if (DE_OS == DE_OS_ANDROID) && defined(__ANDROID_API_O__) && (DE_ANDROID_API >= __ANDROID_API_O__ /* __ANDROID_API_O__ */)
 #	define USE_ANDROID_O_HARDWARE_BUFFER
@@ -37,6 +39,7 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <set>
 
 namespace vk
 {
@@ -174,8 +177,6 @@ VK_NULL_DEFINE_DEVICE_OBJ(Event);
 VK_NULL_DEFINE_DEVICE_OBJ(QueryPool);
 VK_NULL_DEFINE_DEVICE_OBJ(BufferView);
 VK_NULL_DEFINE_DEVICE_OBJ(ImageView);
-VK_NULL_DEFINE_DEVICE_OBJ(ShaderModule);
-VK_NULL_DEFINE_DEVICE_OBJ(PipelineCache);
 VK_NULL_DEFINE_DEVICE_OBJ(PipelineLayout);
 VK_NULL_DEFINE_DEVICE_OBJ(DescriptorSetLayout);
 VK_NULL_DEFINE_DEVICE_OBJ(Sampler);
@@ -242,6 +243,152 @@ public:
 	Pipeline (VkDevice, const VkComputePipelineCreateInfo*) {}
 };
 
+class ShaderModule
+{
+public:
+						ShaderModule	(VkDevice, const VkShaderModuleCreateInfo* pCreateInfo)
+		: m_hash (deMemoryHash(pCreateInfo->pCode, (size_t)pCreateInfo->codeSize))
+	{
+	}
+
+	deUint32			getHash			(void) const { return m_hash;	}
+
+private:
+	const deUint32		m_hash;
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Pipeline cache holding hashes of the cached pipelines' shader stages
+ *
+ * Cache data is the standard header followed by the hashes. Initial data
+ * with a different header is ignored like a real driver would do.
+ *//*--------------------------------------------------------------------*/
+class PipelineCache
+{
+public:
+							PipelineCache	(VkDevice, const VkPipelineCacheCreateInfo* pCreateInfo);
+
+	//! Add pipeline to cache. Returns false if it was already cached.
+	bool					insert			(deUint32 key);
+	void					merge			(const PipelineCache& src);
+	VkResult				getData			(deUintptr* pDataSize, void* pData) const;
+
+private:
+	enum
+	{
+		HEADER_SIZE	= 4*sizeof(deUint32) + VK_UUID_SIZE
+	};
+
+	static void				writeHeader		(deUint8* dst);
+	static void				writeUint32		(deUint8* dst, deUint32 value);
+	static deUint32			readUint32		(const deUint8* src);
+
+	mutable de::Mutex		m_lock;
+	std::set<deUint32>		m_keys;
+};
+
+PipelineCache::PipelineCache (VkDevice, const VkPipelineCacheCreateInfo* pCreateInfo)
+{
+	const deUint8* const	data	= (const deUint8*)pCreateInfo->pInitialData;
+	const size_t			size	= pCreateInfo->initialDataSize;
+	deUint8					header[HEADER_SIZE];
+
+	writeHeader(header);
+
+	if (size < (size_t)HEADER_SIZE || deMemCmp(data, header, HEADER_SIZE) != 0)
+		return;
+
+	for (size_t offset = HEADER_SIZE; offset + sizeof(deUint32) <= size; offset += sizeof(deUint32))
+		m_keys.insert(readUint32(data + offset));
+}
+
+bool PipelineCache::insert (deUint32 key)
+{
+	const de::ScopedLock	lock	(m_lock);
+
+	return m_keys.insert(key).second;
+}
+
+void PipelineCache::merge (const PipelineCache& src)
+{
+	const de::ScopedLock	srcLock	(src.m_lock);
+	const de::ScopedLock	dstLock	(m_lock);
+
+	m_keys.insert(src.m_keys.begin(), src.m_keys.end());
+}
+
+VkResult PipelineCache::getData (deUintptr* pDataSize, void* pData) const
+{
+	const de::ScopedLock	lock		(m_lock);
+	const deUintptr			dataSize	= HEADER_SIZE + m_keys.size()*sizeof(deUint32);
+
+	if (!pData)
+	{
+		*pDataSize = dataSize;
+		return VK_SUCCESS;
+	}
+
+	if (*pDataSize < (deUintptr)HEADER_SIZE)
+	{
+		*pDataSize = 0;
+		return VK_INCOMPLETE;
+	}
+
+	{
+		deUint8* const	dst		= (deUint8*)pData;
+		deUintptr		offset	= HEADER_SIZE;
+
+		writeHeader(dst);
+
+		for (std::set<deUint32>::const_iterator keyIter = m_keys.begin(); keyIter != m_keys.end() && offset + sizeof(deUint32) <= *pDataSize; ++keyIter)
+		{
+			writeUint32(dst + offset, *keyIter);
+			offset += sizeof(deUint32);
+		}
+
+		*pDataSize = offset;
+
+		return offset == dataSize ? VK_SUCCESS : VK_INCOMPLETE;
+	}
+}
+
+void PipelineCache::writeHeader (deUint8* dst)
+{
+	// Vendor, device and UUID match the null driver's physical device properties
+	writeUint32(dst + 0,	HEADER_SIZE);
+	writeUint32(dst + 4,	VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+	writeUint32(dst + 8,	0u);
+	writeUint32(dst + 12,	0u);
+	deMemset(dst + 16, 0, VK_UUID_SIZE);
+}
+
+void PipelineCache::writeUint32 (deUint8* dst, deUint32 value)
+{
+	dst[0] = (deUint8)(value & 0xffu);
+	dst[1] = (deUint8)((value >> 8) & 0xffu);
+	dst[2] = (deUint8)((value >> 16) & 0xffu);
+	dst[3] = (deUint8)((value >> 24) & 0xffu);
+}
+
+deUint32 PipelineCache::readUint32 (const deUint8* src)
+{
+	return (deUint32)src[0] | ((deUint32)src[1] << 8) | ((deUint32)src[2] << 16) | ((deUint32)src[3] << 24);
+}
+
+deUint32 getPipelineCacheKey (deUint32 stageCount, const VkPipelineShaderStageCreateInfo* pStages)
+{
+	std::vector<deUint32> stageHashes;
+
+	for (deUint32 stageNdx = 0; stageNdx < stageCount; stageNdx++)
+	{
+		stageHashes.push_back((deUint32)pStages[stageNdx].stage);
+		stageHashes.push_back(reinterpret_cast<const ShaderModule*>((deUintptr)pStages[stageNdx].module.getInternal())->getHash());
+		stageHashes.push_back(deStringHash(pStages[stageNdx].pName));
+	}
+
+	return stageHashes.empty() ? 0u : deMemoryHash(&stageHashes[0], stageHashes.size()*sizeof(deUint32));
+}
+
 class RenderPass
 {
 public:
@@ -652,7 +799,29 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL getDeviceProcAddr (VkDevice device, con
 	return reinterpret_cast<Device*>(device)->getProcAddr(pName);
 }
 
-VKAPI_ATTR VkResult VKAPI_CALL createGraphicsPipelines (VkDevice device, VkPipelineCache, deUint32 count, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+VKAPI_ATTR VkResult VKAPI_CALL getPipelineCacheData (VkDevice, VkPipelineCache pipelineCache, deUintptr* pDataSize, void* pData)
+{
+	return reinterpret_cast<const PipelineCache*>((deUintptr)pipelineCache.getInternal())->getData(pDataSize, pData);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL mergePipelineCaches (VkDevice, VkPipelineCache dstCache, deUint32 srcCacheCount, const VkPipelineCache* pSrcCaches)
+{
+	PipelineCache* const	dst		= reinterpret_cast<PipelineCache*>((deUintptr)dstCache.getInternal());
+
+	try
+	{
+		for (deUint32 srcNdx = 0; srcNdx < srcCacheCount; srcNdx++)
+			dst->merge(*reinterpret_cast<const PipelineCache*>((deUintptr)pSrcCaches[srcNdx].getInternal()));
+
+		return VK_SUCCESS;
+	}
+	catch (const std::bad_alloc&)
+	{
+		return VK_ERROR_OUT_OF_HOST_MEMORY;
+	}
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL createGraphicsPipelines (VkDevice device, VkPipelineCache pipelineCache, deUint32 count, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
 {
 	deUint32 allocNdx;
 	try
@@ -660,6 +829,14 @@ VKAPI_ATTR VkResult VKAPI_CALL createGraphicsPipelines (VkDevice device, VkPipel
 		for (allocNdx = 0; allocNdx < count; allocNdx++)
 			pPipelines[allocNdx] = allocateNonDispHandle<Pipeline, VkPipeline>(device, pCreateInfos+allocNdx, pAllocator);
 
+		if (!!pipelineCache)
+		{
+			PipelineCache* const	cache	= reinterpret_cast<PipelineCache*>((deUintptr)pipelineCache.getInternal());
+
+			for (deUint32 cacheNdx = 0; cacheNdx < count; cacheNdx++)
+				cache->insert(getPipelineCacheKey(pCreateInfos[cacheNdx].stageCount, pCreateInfos[cacheNdx].pStages));
+		}
+
 		return VK_SUCCESS;
 	}
 	catch (const std::bad_alloc&)
@@ -678,7 +855,7 @@ VKAPI_ATTR VkResult VKAPI_CALL createGraphicsPipelines (VkDevice device, VkPipel
 	}
 }
 
-VKAPI_ATTR VkResult VKAPI_CALL createComputePipelines (VkDevice device, VkPipelineCache, deUint32 count, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
+VKAPI_ATTR VkResult VKAPI_CALL createComputePipelines (VkDevice device, VkPipelineCache pipelineCache, deUint32 count, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines)
 {
 	deUint32 allocNdx;
 	try
@@ -686,6 +863,14 @@ VKAPI_ATTR VkResult VKAPI_CALL createComputePipelines (VkDevice device, VkPipeli
 		for (allocNdx = 0; allocNdx < count; allocNdx++)
 			pPipelines[allocNdx] = allocateNonDispHandle<Pipeline, VkPipeline>(device, pCreateInfos+allocNdx, pAllocator);
 
+		if (!!pipelineCache)
+		{
+			PipelineCache* const	cache	= reinterpret_cast<PipelineCache*>((deUintptr)pipelineCache.getInternal());
+
+			for (deUint32 cacheNdx = 0; cacheNdx < count; cacheNdx++)
+				cache->insert(getPipelineCacheKey(1u, &pCreateInfos[cacheNdx].stage));
+		}
+
 		return VK_SUCCESS;
 	}
 	catch (const std::bad_alloc&)
@@ -1352,6 +1537,10 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL getInstanceProcAddr (VkInstance instanc
 {
 	if (instance)
 	{
+		// DeviceDriver queries vkGetDeviceProcAddr through the instance
+		if (std::string(pName) == "vkGetDeviceProcAddr")
+			return (PFN_vkVoidFunction)getDeviceProcAddr;
+
 		return reinterpret_cast<Instance*>(instance)->getProcAddr(pName);
 	}
 	else
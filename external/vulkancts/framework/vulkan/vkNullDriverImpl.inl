@@ -568,24 +568,6 @@ VKAPI_ATTR void VKAPI_CALL getImageSubresourceLayout (VkDevice device, VkImage i
 	DE_UNREF(pLayout);
 }
 
-VKAPI_ATTR VkResult VKAPI_CALL getPipelineCacheData (VkDevice device, VkPipelineCache pipelineCache, deUintptr* pDataSize, void* pData)
-{
-	DE_UNREF(device);
-	DE_UNREF(pipelineCache);
-	DE_UNREF(pDataSize);
-	DE_UNREF(pData);
-	return VK_SUCCESS;
-}
-
-VKAPI_ATTR VkResult VKAPI_CALL mergePipelineCaches (VkDevice device, VkPipelineCache dstCache, deUint32 srcCacheCount, const VkPipelineCache* pSrcCaches)
-{
-	DE_UNREF(device);
-	DE_UNREF(dstCache);
-	DE_UNREF(srcCacheCount);
-	DE_UNREF(pSrcCaches);
-	return VK_SUCCESS;
-}
-
 VKAPI_ATTR void VKAPI_CALL updateDescriptorSets (VkDevice device, deUint32 descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites, deUint32 descriptorCopyCount, const VkCopyDescriptorSet* pDescriptorCopies)
 {
 	DE_UNREF(device);
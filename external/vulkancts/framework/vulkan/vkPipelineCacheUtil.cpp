@@ -0,0 +1,295 @@
+/*-------------------------------------------------------------------------
+ * Vulkan CTS Framework
+ * --------------------
+ *
+ * Copyright (c) 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Shared persistent pipeline cache utilities.
+ *//*--------------------------------------------------------------------*/
+
+#include "vkPipelineCacheUtil.hpp"
+#include "vkRefUtil.hpp"
+
+#include "deFilePath.hpp"
+#include "deFile.h"
+#include "deMemory.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+namespace vk
+{
+
+namespace
+{
+
+enum
+{
+	CACHE_HEADER_SIZE	= 4*sizeof(deUint32) + VK_UUID_SIZE
+};
+
+deUint32 readUint32 (const deUint8* src)
+{
+	return (deUint32)src[0] | ((deUint32)src[1] << 8) | ((deUint32)src[2] << 16) | ((deUint32)src[3] << 24);
+}
+
+//! Check that cache data was created by the device. Drivers should reject foreign data too, but not all do.
+bool isCompatibleCacheData (const std::vector<deUint8>& data, const VkPhysicalDeviceProperties& deviceProperties)
+{
+	if (data.size() < (size_t)CACHE_HEADER_SIZE)
+		return false;
+
+	return readUint32(&data[0]) >= (deUint32)CACHE_HEADER_SIZE &&
+		   readUint32(&data[0]) <= (deUint32)data.size() &&
+		   readUint32(&data[4]) == (deUint32)VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		   readUint32(&data[8]) == deviceProperties.vendorID &&
+		   readUint32(&data[12]) == deviceProperties.deviceID &&
+		   deMemCmp(&data[16], deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+std::vector<deUint8> readCacheFile (const std::string& path, const VkPhysicalDeviceProperties& deviceProperties)
+{
+	std::ifstream			in		(path.c_str(), std::ios::binary | std::ios::ate);
+	std::vector<deUint8>	data;
+
+	if (!in.is_open() || !in.good())
+		return data;
+
+	{
+		const std::streamoff size = in.tellg();
+
+		if (size <= 0)
+			return data;
+
+		data.resize((size_t)size);
+		in.seekg(0, std::ios::beg);
+		in.read((char*)&data[0], (std::streamsize)size);
+	}
+
+	if (!in.good() || !isCompatibleCacheData(data, deviceProperties))
+		data.clear();
+
+	return data;
+}
+
+Move<VkPipelineCache> createSeededPipelineCache (const DeviceInterface& vkd, VkDevice device, const std::vector<deUint8>& initialData)
+{
+	const VkPipelineCacheCreateInfo	createInfo	=
+	{
+		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,	// VkStructureType				sType;
+		DE_NULL,										// const void*					pNext;
+		0u,												// VkPipelineCacheCreateFlags	flags;
+		initialData.size(),								// deUintptr					initialDataSize;
+		initialData.empty() ? DE_NULL : &initialData[0]	// const void*					pInitialData;
+	};
+
+	return createPipelineCache(vkd, device, &createInfo);
+}
+
+} // anonymous
+
+std::string getPipelineCacheFileName (const VkPhysicalDeviceProperties& deviceProperties)
+{
+	std::ostringstream str;
+
+	str << "pipelinecache-" << std::hex << std::setfill('0')
+		<< std::setw(8) << deviceProperties.vendorID << "-"
+		<< std::setw(8) << deviceProperties.deviceID << "-"
+		<< std::setw(8) << deviceProperties.driverVersion << "-";
+
+	for (size_t ndx = 0; ndx < VK_UUID_SIZE; ndx++)
+		str << std::setw(2) << (deUint32)deviceProperties.pipelineCacheUUID[ndx];
+
+	str << ".bin";
+
+	return str.str();
+}
+
+// PersistentPipelineCache
+
+PersistentPipelineCache::PersistentPipelineCache (const DeviceInterface&			vkd,
+												  VkDevice							device,
+												  const VkPhysicalDeviceProperties&	deviceProperties,
+												  const std::string&				dirName)
+	: m_vkd					(vkd)
+	, m_device				(device)
+	, m_deviceProperties	(deviceProperties)
+	, m_path				(de::FilePath::join(dirName, getPipelineCacheFileName(deviceProperties)).getPath())
+	, m_initialDataSize		(0)
+{
+	const std::vector<deUint8>	initialData	= readCacheFile(m_path, deviceProperties);
+
+	m_cache				= createSeededPipelineCache(m_vkd, m_device, initialData);
+	m_initialDataSize	= initialData.size();
+}
+
+PersistentPipelineCache::~PersistentPipelineCache (void)
+{
+	save();
+}
+
+void PersistentPipelineCache::save (void) const
+{
+	const de::FilePath		dirPath	= de::FilePath(m_path).getDirName();
+	std::vector<deUint8>	data;
+
+	try
+	{
+		deUintptr dataSize = 0;
+
+		// Merge entries other runs sharing the file have saved since it was read
+		{
+			const std::vector<deUint8>	savedData	= readCacheFile(m_path, m_deviceProperties);
+
+			if (!savedData.empty())
+			{
+				const Unique<VkPipelineCache>	savedCache		(createSeededPipelineCache(m_vkd, m_device, savedData));
+				const VkPipelineCache			srcCaches[]		= { *savedCache };
+
+				VK_CHECK(m_vkd.mergePipelineCaches(m_device, *m_cache, DE_LENGTH_OF_ARRAY(srcCaches), srcCaches));
+			}
+		}
+
+		VK_CHECK(m_vkd.getPipelineCacheData(m_device, *m_cache, &dataSize, DE_NULL));
+
+		if (dataSize == 0)
+			return;
+
+		data.resize((size_t)dataSize);
+		VK_CHECK(m_vkd.getPipelineCacheData(m_device, *m_cache, &dataSize, &data[0]));
+		data.resize((size_t)dataSize);
+
+		if (!dirPath.exists())
+			de::createDirectoryAndParents(dirPath.getPath());
+
+		deWriteFileAtomic(m_path.c_str(), &data[0], (deInt64)data.size());
+	}
+	catch (const std::exception&)
+	{
+		// Caching is an optimization only
+	}
+}
+
+// PipelineCacheDeviceDriver
+
+PipelineCacheDeviceDriver::PipelineCacheDeviceDriver (const PlatformInterface& platformInterface, VkInstance instance, VkDevice device)
+	: DeviceDriver		(platformInterface, instance, device)
+	, m_device			(device)
+	, m_pipelineCache		(DE_NULL)
+	, m_sampleDataSize		(false)
+	, m_numCreatedPipelines	(0)
+	, m_hasStartDataSize	(false)
+	, m_startDataSize		(0)
+{
+}
+
+PipelineCacheDeviceDriver::~PipelineCacheDeviceDriver (void)
+{
+}
+
+void PipelineCacheDeviceDriver::setPipelineCache (VkPipelineCache pipelineCache, bool sampleDataSize)
+{
+	m_pipelineCache		= pipelineCache;
+	m_sampleDataSize	= sampleDataSize;
+
+	resetStatistics();
+}
+
+PipelineCacheStatistics PipelineCacheDeviceDriver::getStatistics (void) const
+{
+	PipelineCacheStatistics	stats;
+	deUintptr				dataSize	= 0;
+
+	{
+		const de::ScopedLock	lock	(m_statsLock);
+
+		stats.numCreatedPipelines = m_numCreatedPipelines;
+	}
+
+	if (m_hasStartDataSize && getCacheDataSize(&dataSize))
+	{
+		stats.hasDataSizeGrowth	= true;
+		stats.dataSizeGrowth	= dataSize > m_startDataSize ? (deUint64)(dataSize - m_startDataSize) : 0u;
+	}
+
+	return stats;
+}
+
+void PipelineCacheDeviceDriver::resetStatistics (void) const
+{
+	{
+		const de::ScopedLock	lock	(m_statsLock);
+
+		m_numCreatedPipelines = 0;
+	}
+
+	m_hasStartDataSize = m_sampleDataSize && getCacheDataSize(&m_startDataSize);
+}
+
+bool PipelineCacheDeviceDriver::useSharedCache (VkDevice device, VkPipelineCache pipelineCache) const
+{
+	// Pipelines created explicitly with the shared cache are counted too
+	return !!m_pipelineCache && device == m_device && (!pipelineCache || pipelineCache == m_pipelineCache);
+}
+
+bool PipelineCacheDeviceDriver::getCacheDataSize (deUintptr* dataSize) const
+{
+	*dataSize = 0;
+
+	return !!m_pipelineCache && DeviceDriver::getPipelineCacheData(m_device, m_pipelineCache, dataSize, DE_NULL) == VK_SUCCESS;
+}
+
+void PipelineCacheDeviceDriver::recordPipelines (deUint32 numPipelines) const
+{
+	const de::ScopedLock	lock	(m_statsLock);
+
+	m_numCreatedPipelines += numPipelines;
+}
+
+VkResult PipelineCacheDeviceDriver::createGraphicsPipelines (VkDevice device, VkPipelineCache pipelineCache, deUint32 createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) const
+{
+	if (!useSharedCache(device, pipelineCache))
+		return DeviceDriver::createGraphicsPipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+
+	{
+		const VkResult result = DeviceDriver::createGraphicsPipelines(device, m_pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+
+		if (result == VK_SUCCESS)
+			recordPipelines(createInfoCount);
+
+		return result;
+	}
+}
+
+VkResult PipelineCacheDeviceDriver::createComputePipelines (VkDevice device, VkPipelineCache pipelineCache, deUint32 createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) const
+{
+	if (!useSharedCache(device, pipelineCache))
+		return DeviceDriver::createComputePipelines(device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+
+	{
+		const VkResult result = DeviceDriver::createComputePipelines(device, m_pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+
+		if (result == VK_SUCCESS)
+			recordPipelines(createInfoCount);
+
+		return result;
+	}
+}
+
+} // vk
@@ -0,0 +1,139 @@
+#ifndef _VKPIPELINECACHEUTIL_HPP
+#define _VKPIPELINECACHEUTIL_HPP
+/*-------------------------------------------------------------------------
+ * Vulkan CTS Framework
+ * --------------------
+ *
+ * Copyright (c) 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Shared persistent pipeline cache utilities.
+ *//*--------------------------------------------------------------------*/
+
+#include "vkDefs.hpp"
+#include "vkRef.hpp"
+#include "vkPlatform.hpp"
+#include "deMutex.hpp"
+
+#include <string>
+
+namespace vk
+{
+
+struct PipelineCacheStatistics
+{
+	deUint64		numCreatedPipelines;	//!< Number of pipelines created through the shared cache
+	bool			hasDataSizeGrowth;		//!< True if cache data size was sampled
+	deUint64		dataSizeGrowth;			//!< Increase of vkGetPipelineCacheData() size in bytes
+
+	PipelineCacheStatistics (void)
+		: numCreatedPipelines	(0u)
+		, hasDataSizeGrowth		(false)
+		, dataSizeGrowth		(0u)
+	{
+	}
+};
+
+//! Cache file name for device. Driver version is part of the name since it is not in the cache header.
+std::string		getPipelineCacheFileName	(const VkPhysicalDeviceProperties& deviceProperties);
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Pipeline cache loaded from and saved to a file
+ *
+ * The cache is seeded from <dirName>/getPipelineCacheFileName() if the
+ * file exists and its header matches the device. Cache data is written
+ * back when the object is destroyed, through a temporary file that is
+ * renamed in place. Data other runs have saved to the file in the
+ * meantime is merged in first. Missing, stale or damaged files only cost
+ * a cold cache.
+ *//*--------------------------------------------------------------------*/
+class PersistentPipelineCache
+{
+public:
+									PersistentPipelineCache		(const DeviceInterface&				vkd,
+																 VkDevice							device,
+																 const VkPhysicalDeviceProperties&	deviceProperties,
+																 const std::string&					dirName);
+									~PersistentPipelineCache	(void);
+
+	VkPipelineCache					get							(void) const { return *m_cache;				}
+	const std::string&				getPath						(void) const { return m_path;				}
+
+	//! Size of data the cache was seeded with, 0 if no valid file was found.
+	size_t							getInitialDataSize			(void) const { return m_initialDataSize;	}
+
+	//! Failures are ignored; the cache is built again on next run.
+	void							save						(void) const;
+
+private:
+									PersistentPipelineCache		(const PersistentPipelineCache&);
+	PersistentPipelineCache&		operator=					(const PersistentPipelineCache&);
+
+	const DeviceInterface&			m_vkd;
+	const VkDevice					m_device;
+	const VkPhysicalDeviceProperties	m_deviceProperties;
+	const std::string				m_path;
+	size_t							m_initialDataSize;
+	Move<VkPipelineCache>			m_cache;
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Device driver that creates pipelines through a shared cache
+ *
+ * Once a cache has been set, graphics and compute pipelines created for
+ * the device without a pipeline cache use the shared cache instead.
+ *
+ * Pipelines created through the shared cache are counted. If enabled,
+ * cache data size is also sampled when statistics are reset and read.
+ * Sampling makes the driver size the serialized cache twice per case,
+ * and data size growth says nothing reliable about cache hits: drivers
+ * may store entries of any size, or none at all.
+ *//*--------------------------------------------------------------------*/
+class PipelineCacheDeviceDriver : public DeviceDriver
+{
+public:
+									PipelineCacheDeviceDriver	(const PlatformInterface& platformInterface, VkInstance instance, VkDevice device);
+									~PipelineCacheDeviceDriver	(void);
+
+	void							setPipelineCache			(VkPipelineCache pipelineCache, bool sampleDataSize);
+	VkPipelineCache					getPipelineCache			(void) const { return m_pipelineCache;	}
+
+	//! Statistics since last reset. Queries cache data size if sampling is enabled.
+	PipelineCacheStatistics			getStatistics				(void) const;
+	//! Reset statistics. Queries cache data size if sampling is enabled.
+	void							resetStatistics				(void) const;
+
+	virtual VkResult				createGraphicsPipelines		(VkDevice device, VkPipelineCache pipelineCache, deUint32 createInfoCount, const VkGraphicsPipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) const;
+	virtual VkResult				createComputePipelines		(VkDevice device, VkPipelineCache pipelineCache, deUint32 createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) const;
+
+private:
+	bool							useSharedCache				(VkDevice device, VkPipelineCache pipelineCache) const;
+	bool							getCacheDataSize			(deUintptr* dataSize) const;
+	void							recordPipelines				(deUint32 numPipelines) const;
+
+	const VkDevice					m_device;
+	VkPipelineCache					m_pipelineCache;
+	bool							m_sampleDataSize;
+
+	mutable de::Mutex				m_statsLock;
+	mutable deUint64				m_numCreatedPipelines;
+	mutable bool					m_hasStartDataSize;
+	mutable deUintptr				m_startDataSize;
+};
+
+} // vk
+
+#endif // _VKPIPELINECACHEUTIL_HPP
@@ -31,23 +31,22 @@
 #include "vkShaderToSpirV.hpp"
 #include "vkSpirVAsm.hpp"
 #include "vkRefUtil.hpp"
+#include "vkShaderCache.hpp"
 
 #include "deMutex.hpp"
 #include "deFilePath.hpp"
 #include "deArrayUtil.hpp"
 #include "deMemory.h"
 #include "deInt32.h"
+#include "deAtomic.h"
 
 #include "tcuCommandLine.hpp"
 
-#include <map>
-
 namespace vk
 {
 
 using std::string;
 using std::vector;
-using std::map;
 
 #if defined(DE_DEBUG) && defined(DEQP_HAVE_SPIRV_TOOLS)
 #	define VALIDATE_BINARIES	true
@@ -102,6 +101,28 @@ bool isSaneSpirVBinary (const ProgramBinary& binary)
 
 #if defined(DEQP_HAVE_SPIRV_TOOLS)
 
+de::Mutex					s_shaderCacheLock;
+ShaderCache* volatile		s_shaderCache	= DE_NULL;
+
+ShaderCache& getShaderCache (const char* filename, bool truncate)
+{
+	if (!s_shaderCache)
+	{
+		const de::ScopedLock lock (s_shaderCacheLock);
+
+		if (!s_shaderCache)
+		{
+			ShaderCache* const cache = new ShaderCache(filename, truncate);
+
+			deMemoryReadWriteFence();
+
+			s_shaderCache = cache;
+		}
+	}
+
+	return *s_shaderCache;
+}
+
 void optimizeCompiledBinary (vector<deUint32>& binary, int optimizationRecipe, const SpirvVersion spirvVersion)
 {
 	spv_target_env targetEnv = SPV_ENV_VULKAN_1_0;
@@ -350,48 +371,9 @@ void validateCompiledBinary(const vector<deUint32>& binary, glu::ShaderProgramIn
 	}
 }
 
-de::Mutex							cacheFileMutex;
-map<deUint32, vector<deUint32> >	cacheFileIndex;
-bool								cacheFileFirstRun = true;
-
 void shaderCacheFirstRunCheck (const char* shaderCacheFile, bool truncate)
 {
-	cacheFileMutex.lock();
-	if (cacheFileFirstRun)
-	{
-		cacheFileFirstRun = false;
-		if (truncate)
-		{
-			// Open file with "w" access to truncate it
-			FILE* f = fopen(shaderCacheFile, "wb");
-			if (f)
-				fclose(f);
-		}
-		else
-		{
-			// Parse chunked shader cache file for hashes and offsets
-			FILE* file = fopen(shaderCacheFile, "rb");
-			int count = 0;
-			if (file)
-			{
-				deUint32 chunksize	= 0;
-				deUint32 hash		= 0;
-				deUint32 offset		= 0;
-				bool ok				= true;
-				while (ok)
-				{
-					offset = (deUint32)ftell(file);
-					if (ok) ok = fread(&chunksize, 1, 4, file)				== 4;
-					if (ok) ok = fread(&hash, 1, 4, file)					== 4;
-					if (ok) cacheFileIndex[hash].push_back(offset);
-					if (ok) ok = fseek(file, offset + chunksize, SEEK_SET)	== 0;
-					count++;
-				}
-				fclose(file);
-			}
-		}
-	}
-	cacheFileMutex.unlock();
+	getShaderCache(shaderCacheFile, truncate);
 }
 
 std::string intToString (deUint32 integer)
@@ -405,104 +387,21 @@ std::string intToString (deUint32 integer)
 
 vk::ProgramBinary* shadercacheLoad (const std::string& shaderstring, const char* shaderCacheFilename)
 {
-	deUint32		hash		= deStringHash(shaderstring.c_str());
-	deInt32			format;
-	deInt32			length;
-	deInt32			sourcelength;
-	deUint32		i;
-	deUint32		temp;
-	deUint8*		bin			= 0;
-	char*			source		= 0;
-	bool			ok			= true;
-	cacheFileMutex.lock();
-
-	if (cacheFileIndex.count(hash) == 0)
-	{
-		cacheFileMutex.unlock();
-		return 0;
-	}
-	FILE*			file		= fopen(shaderCacheFilename, "rb");
-	ok				= file											!= 0;
+	DE_UNREF(shaderCacheFilename);
+	DE_ASSERT(s_shaderCache);
 
-	for (i = 0; i < cacheFileIndex[hash].size(); i++)
-	{
-		if (ok) ok = fseek(file, cacheFileIndex[hash][i], SEEK_SET)	== 0;
-		if (ok) ok = fread(&temp, 1, 4, file)						== 4; // Chunk size (skip)
-		if (ok) ok = fread(&temp, 1, 4, file)						== 4; // Stored hash
-		if (ok) ok = temp											== hash; // Double check
-		if (ok) ok = fread(&format, 1, 4, file)						== 4;
-		if (ok) ok = fread(&length, 1, 4, file)						== 4;
-		if (ok) ok = length											> 0; // sanity check
-		if (ok) bin = new deUint8[length];
-		if (ok) ok = fread(bin, 1, length, file)					== (size_t)length;
-		if (ok) ok = fread(&sourcelength, 1, 4, file)				== 4;
-		if (ok && sourcelength > 0)
-		{
-			source = new char[sourcelength + 1];
-			ok = fread(source, 1, sourcelength, file)				== (size_t)sourcelength;
-			source[sourcelength] = 0;
-		}
-		if (!ok || shaderstring != std::string(source))
-		{
-			// Mismatch, but may still exist in cache if there were hash collisions
-			delete[] source;
-			delete[] bin;
-		}
-		else
-		{
-			delete[] source;
-			if (file) fclose(file);
-			cacheFileMutex.unlock();
-			vk::ProgramBinary* res = new vk::ProgramBinary((vk::ProgramFormat)format, length, bin);
-			delete[] bin;
-			return res;
-		}
-	}
-	if (file) fclose(file);
-	cacheFileMutex.unlock();
-	return 0;
+	return s_shaderCache->load(shaderstring);
 }
 
 void shadercacheSave (const vk::ProgramBinary* binary, const std::string& shaderstring, const char* shaderCacheFilename)
 {
+	DE_UNREF(shaderCacheFilename);
+	DE_ASSERT(s_shaderCache);
+
 	if (binary == 0)
 		return;
-	deUint32			hash		= deStringHash(shaderstring.c_str());
-	deInt32				format		= binary->getFormat();
-	deUint32			length		= (deUint32)binary->getSize();
-	deUint32			chunksize;
-	deUint32			offset;
-	const deUint8*		bin			= binary->getBinary();
-	const de::FilePath	filePath	(shaderCacheFilename);
-
-	cacheFileMutex.lock();
-
-	if (!de::FilePath(filePath.getDirName()).exists())
-		de::createDirectoryAndParents(filePath.getDirName().c_str());
 
-	FILE*				file		= fopen(shaderCacheFilename, "ab");
-	if (!file)
-	{
-		cacheFileMutex.unlock();
-		return;
-	}
-	// Append mode starts writing from the end of the file,
-	// but unless we do a seek, ftell returns 0.
-	fseek(file, 0, SEEK_END);
-	offset		= (deUint32)ftell(file);
-	chunksize	= 4 + 4 + 4 + 4 + length + 4 + (deUint32)shaderstring.length();
-	fwrite(&chunksize, 1, 4, file);
-	fwrite(&hash, 1, 4, file);
-	fwrite(&format, 1, 4, file);
-	fwrite(&length, 1, 4, file);
-	fwrite(bin, 1, length, file);
-	length = (deUint32)shaderstring.length();
-	fwrite(&length, 1, 4, file);
-	fwrite(shaderstring.c_str(), 1, length, file);
-	fclose(file);
-	cacheFileIndex[hash].push_back(offset);
-
-	cacheFileMutex.unlock();
+	s_shaderCache->store(*binary, shaderstring);
 }
 
 // Insert any information that may affect compilation into the shader string.
@@ -764,6 +663,19 @@ ProgramBinary* assembleProgram (const SpirVAsmSource& program, SpirVProgramInfo*
 	return res;
 }
 
+void closeShaderCache (void)
+{
+	const de::ScopedLock lock (s_shaderCacheLock);
+
+	if (s_shaderCache)
+	{
+		s_shaderCache->commit();
+
+		delete s_shaderCache;
+		s_shaderCache = DE_NULL;
+	}
+}
+
 #else // !DEQP_HAVE_SPIRV_TOOLS
 
 ProgramBinary* buildProgram (const GlslSource&, glu::ShaderProgramInfo*, const tcu::CommandLine&)
@@ -780,6 +692,10 @@ ProgramBinary* assembleProgram (const SpirVAsmSource&, SpirVProgramInfo*, const
 {
 	TCU_THROW(NotSupportedError, "SPIR-V assembly not supported (DEQP_HAVE_SPIRV_TOOLS not defined)");
 }
+
+void closeShaderCache (void)
+{
+}
 #endif
 
 void disassembleProgram (const ProgramBinary& program, std::ostream* dst)
@@ -213,6 +213,9 @@ ProgramBinary*			assembleProgram		(const vk::SpirVAsmSource& program, SpirVProgr
 void					disassembleProgram	(const ProgramBinary& program, std::ostream* dst);
 bool					validateProgram		(const ProgramBinary& program, std::ostream* dst, const SpirvValidatorOptions&);
 
+//! Commit pending runtime shader cache (--deqp-shadercache) updates and close it. Called at end of session.
+void					closeShaderCache	(void);
+
 Move<VkShaderModule>	createShaderModule	(const DeviceInterface& deviceInterface, VkDevice device, const ProgramBinary& binary, VkShaderModuleCreateFlags flags);
 
 glu::ShaderType			getGluShaderType	(VkShaderStageFlagBits shaderStage);
@@ -0,0 +1,618 @@
+/*-------------------------------------------------------------------------
+ * Vulkan CTS Framework
+ * --------------------
+ *
+ * Copyright (c) 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Persistent shader binary cache.
+ *//*--------------------------------------------------------------------*/
+
+#include "vkShaderCache.hpp"
+
+#include "deFilePath.hpp"
+#include "deMemory.h"
+#include "deInt32.h"
+#include "deString.h"
+#include "deAtomic.h"
+#include "deFile.h"
+
+#include <set>
+
+namespace vk
+{
+
+using std::vector;
+
+namespace
+{
+
+//! Holds exclusive lock on file for the scope, if lock could be acquired
+class ScopedFileLock
+{
+public:
+					ScopedFileLock	(deFile* file)
+						: m_file(file && deFile_lock(file) ? file : DE_NULL)
+					{
+					}
+
+					~ScopedFileLock	(void)
+					{
+						if (m_file)
+							deFile_unlock(m_file);
+					}
+
+	bool			isLocked		(void) const { return m_file != DE_NULL; }
+
+private:
+					ScopedFileLock	(const ScopedFileLock&); // Not allowed!
+	ScopedFileLock&	operator=		(const ScopedFileLock&); // Not allowed!
+
+	deFile* const	m_file;
+};
+
+bool readAt (deFile* file, deUint64 offset, void* dst, size_t size)
+{
+	deUint8*	ptr		= (deUint8*)dst;
+	size_t		numLeft	= size;
+
+	if (!deFile_seek(file, DE_FILEPOSITION_BEGIN, (deInt64)offset))
+		return false;
+
+	while (numLeft > 0)
+	{
+		deInt64 numRead = 0;
+
+		if (deFile_read(file, ptr, (deInt64)numLeft, &numRead) != DE_FILERESULT_SUCCESS)
+			return false;
+
+		ptr		+= numRead;
+		numLeft	-= (size_t)numRead;
+	}
+
+	return true;
+}
+
+bool writeAll (deFile* file, const void* src, size_t size)
+{
+	const deUint8*	ptr		= (const deUint8*)src;
+	size_t			numLeft	= size;
+
+	while (numLeft > 0)
+	{
+		deInt64 numWritten = 0;
+
+		if (deFile_write(file, ptr, (deInt64)numLeft, &numWritten) != DE_FILERESULT_SUCCESS)
+			return false;
+
+		ptr		+= numWritten;
+		numLeft	-= (size_t)numWritten;
+	}
+
+	return true;
+}
+
+} // anonymous
+
+ShaderCache::ShaderCache (const std::string& filename, bool truncate)
+	: m_dataFilename			(filename)
+	, m_indexFilename			(filename + ".idx")
+	, m_lockFilename			(filename + ".lock")
+	, m_data					(DE_NULL)
+	, m_index					(DE_NULL)
+	, m_dataPtr					(DE_NULL)
+	, m_dataMappedSize			(0)
+	, m_indexSlots				(DE_NULL)
+	, m_numIndexSlots			(0)
+	, m_numIndexEntries			(0)
+	, m_lockFile				(DE_NULL)
+	, m_dataSize				(0)
+	, m_numCommittedEntries		(0)
+	, m_numUncommittedEntries	(0)
+{
+	for (int bucketNdx = 0; bucketNdx < NUM_BUCKETS; bucketNdx++)
+		m_buckets[bucketNdx] = DE_NULL;
+
+	if (truncate || !openData())
+	{
+		clear(truncate);
+		return;
+	}
+
+	openIndex();
+	scanData(m_indexSlots ? m_dataSize : (deUint64)sizeof(DataHeader));
+}
+
+ShaderCache::~ShaderCache (void)
+{
+	if (m_lockFile)
+		deFile_destroy(m_lockFile);
+
+	if (m_index)
+		deMappedFile_destroy(m_index);
+
+	if (m_data)
+		deMappedFile_destroy(m_data);
+
+	for (size_t entryNdx = 0; entryNdx < m_entries.size(); entryNdx++)
+		delete m_entries[entryNdx];
+}
+
+size_t ShaderCache::getRecordSize (const RecordHeader& header)
+{
+	return (size_t)deAlign64((deInt64)(sizeof(RecordHeader) + header.keySize + header.binarySize), (deInt64)sizeof(deUint64));
+}
+
+bool ShaderCache::isIndexValid (const IndexHeader& header, deUint64 indexFileSize, deUint64 dataFileSize)
+{
+	return header.magic == INDEX_MAGIC && header.version == VERSION	&&
+		   deIsPowerOfTwo32(header.numSlots)							&&
+		   header.numEntries < header.numSlots							&&
+		   header.dataSize >= sizeof(DataHeader)						&&
+		   header.dataSize <= dataFileSize								&&
+		   indexFileSize == sizeof(IndexHeader) + (deUint64)header.numSlots * sizeof(IndexSlot);
+}
+
+bool ShaderCache::openData (void)
+{
+	DataHeader header;
+
+	m_data = deMappedFile_create(m_dataFilename.c_str());
+
+	if (!m_data || deMappedFile_getSize(m_data) < (deInt64)sizeof(DataHeader))
+		return false;
+
+	m_dataPtr			= (const deUint8*)deMappedFile_getPtr(m_data);
+	m_dataMappedSize	= (deUint64)deMappedFile_getSize(m_data);
+	m_dataSize			= m_dataMappedSize;
+
+	deMemcpy(&header, m_dataPtr, sizeof(header));
+
+	// Cache written by another version
+	return header.magic == DATA_MAGIC && header.version == VERSION;
+}
+
+void ShaderCache::openIndex (void)
+{
+	IndexHeader	header;
+
+	m_index = deMappedFile_create(m_indexFilename.c_str());
+
+	if (!m_index || deMappedFile_getSize(m_index) < (deInt64)sizeof(IndexHeader))
+		return;
+
+	deMemcpy(&header, deMappedFile_getPtr(m_index), sizeof(header));
+
+	if (!isIndexValid(header, (deUint64)deMappedFile_getSize(m_index), m_dataMappedSize))
+	{
+		// Stale or damaged index, data file is scanned instead
+		return;
+	}
+
+	m_indexSlots			= (const IndexSlot*)((const deUint8*)deMappedFile_getPtr(m_index) + sizeof(IndexHeader));
+	m_numIndexSlots			= header.numSlots;
+	m_numIndexEntries		= header.numEntries;
+	m_numCommittedEntries	= header.numEntries;
+	m_dataSize				= header.dataSize;
+}
+
+void ShaderCache::scanData (deUint64 offset)
+{
+	while (offset + sizeof(RecordHeader) <= m_dataMappedSize)
+	{
+		const deUint8*	recordPtr	= m_dataPtr + offset;
+		RecordHeader	header;
+
+		deMemcpy(&header, recordPtr, sizeof(header));
+
+		if (offset + getRecordSize(header) > m_dataMappedSize)
+			break;
+
+		{
+			const char*		keyPtr	= (const char*)recordPtr + sizeof(RecordHeader);
+			const deUint8*	binPtr	= recordPtr + sizeof(RecordHeader) + header.keySize;
+			Entry*			entry	= new Entry();
+
+			entry->hash		= header.hash;
+			entry->offset	= offset;
+			entry->format	= (ProgramFormat)header.format;
+			entry->key		= std::string(keyPtr, keyPtr + header.keySize);
+			entry->binary	= vector<deUint8>(binPtr, binPtr + header.binarySize);
+			entry->next		= DE_NULL;
+
+			// Partially written record from interrupted run
+			if (deStringHash(entry->key.c_str()) != header.hash)
+			{
+				delete entry;
+				break;
+			}
+
+			addEntry(entry);
+			m_numUncommittedEntries += 1;
+		}
+
+		offset += getRecordSize(header);
+	}
+
+	// Anything after last valid record is garbage and will not be referenced by index
+	m_dataSize = m_dataMappedSize;
+}
+
+const deUint8* ShaderCache::findRecord (deUint64 offset, deUint32 hash, const std::string& key) const
+{
+	RecordHeader header;
+
+	if (offset + sizeof(RecordHeader) > m_dataMappedSize)
+		return DE_NULL;
+
+	deMemcpy(&header, m_dataPtr + offset, sizeof(header));
+
+	if (header.hash != hash || header.keySize != (deUint32)key.size() || offset + getRecordSize(header) > m_dataMappedSize)
+		return DE_NULL;
+
+	if (deMemCmp(m_dataPtr + offset + sizeof(RecordHeader), key.c_str(), key.size()) != 0)
+		return DE_NULL;
+
+	return m_dataPtr + offset;
+}
+
+ProgramBinary* ShaderCache::load (const std::string& key) const
+{
+	const deUint32 hash = deStringHash(key.c_str());
+
+	if (m_indexSlots)
+	{
+		for (deUint32 slotNdx = hash & (m_numIndexSlots - 1); m_indexSlots[slotNdx].offset != 0; slotNdx = (slotNdx + 1) & (m_numIndexSlots - 1))
+		{
+			if (m_indexSlots[slotNdx].hash == hash)
+			{
+				const deUint8* recordPtr = findRecord(m_indexSlots[slotNdx].offset, hash, key);
+
+				if (recordPtr)
+				{
+					RecordHeader header;
+
+					deMemcpy(&header, recordPtr, sizeof(header));
+
+					return new ProgramBinary((ProgramFormat)header.format, header.binarySize, recordPtr + sizeof(RecordHeader) + header.keySize);
+				}
+			}
+		}
+	}
+
+	for (const Entry* entry = m_buckets[hash % NUM_BUCKETS]; entry; entry = entry->next)
+	{
+		if (entry->hash == hash && entry->key == key)
+			return new ProgramBinary(entry->format, entry->binary.size(), &entry->binary[0]);
+	}
+
+	return DE_NULL;
+}
+
+void ShaderCache::store (const ProgramBinary& binary, const std::string& key)
+{
+	Entry*				entry		= new Entry();
+	RecordHeader		header;
+	vector<deUint8>		record;
+
+	entry->hash		= deStringHash(key.c_str());
+	entry->offset	= 0;
+	entry->format	= binary.getFormat();
+	entry->key		= key;
+	entry->binary	= vector<deUint8>(binary.getBinary(), binary.getBinary() + binary.getSize());
+	entry->next		= DE_NULL;
+
+	header.hash			= entry->hash;
+	header.format		= (deUint32)entry->format;
+	header.keySize		= (deUint32)key.size();
+	header.binarySize	= (deUint32)binary.getSize();
+
+	record.resize(getRecordSize(header), 0);
+	deMemcpy(&record[0], &header, sizeof(header));
+	deMemcpy(&record[sizeof(header)], key.c_str(), key.size());
+	deMemcpy(&record[sizeof(header) + key.size()], binary.getBinary(), binary.getSize());
+
+	{
+		const de::ScopedLock	lock		(m_writeLock);
+		const ScopedFileLock	fileLock	(getLockFile());
+
+		if (fileLock.isLocked())
+			entry->offset = appendRecord(record);
+
+		// Entry is usable even if it couldn't be written
+		addEntry(entry);
+
+		if (entry->offset != 0)
+		{
+			IndexSlot pending;
+
+			pending.hash		= entry->hash;
+			pending.reserved	= 0;
+			pending.offset		= entry->offset;
+
+			m_pendingEntries.push_back(pending);
+			m_numUncommittedEntries += 1;
+
+			if (m_numUncommittedEntries >= de::max<size_t>(MIN_COMMIT_ENTRIES, m_numCommittedEntries / 4))
+				commitIndex();
+		}
+	}
+}
+
+deFile* ShaderCache::getLockFile (void)
+{
+	if (!m_lockFile)
+		m_lockFile = deFile_create(m_lockFilename.c_str(), DE_FILEMODE_WRITE|DE_FILEMODE_CREATE|DE_FILEMODE_OPEN);
+
+	return m_lockFile;
+}
+
+bool ShaderCache::isDataFileValid (void) const
+{
+	deFile*		file	= deFile_create(m_dataFilename.c_str(), DE_FILEMODE_READ|DE_FILEMODE_OPEN);
+	DataHeader	header;
+	bool		isValid	= false;
+
+	if (file)
+	{
+		isValid = readAt(file, 0, &header, sizeof(header)) && header.magic == DATA_MAGIC && header.version == VERSION;
+		deFile_destroy(file);
+	}
+
+	return isValid;
+}
+
+deUint64 ShaderCache::appendRecord (const vector<deUint8>& record)
+{
+	deFile*		file	= DE_NULL;
+	deUint64	offset	= 0;
+
+	// Data file may have been replaced by another process since it was mapped
+	if (!isDataFileValid())
+		return 0;
+
+	file = deFile_create(m_dataFilename.c_str(), DE_FILEMODE_WRITE|DE_FILEMODE_OPEN);
+
+	if (!file)
+		return 0;
+
+	// Other processes may have appended records, so offset comes from the file
+	if (deFile_seek(file, DE_FILEPOSITION_END, 0))
+	{
+		const deInt64 endOffset = deFile_getPosition(file);
+
+		if (endOffset >= (deInt64)sizeof(DataHeader) && writeAll(file, &record[0], record.size()))
+			offset = (deUint64)endOffset;
+	}
+
+	deFile_destroy(file);
+
+	return offset;
+}
+
+void ShaderCache::addEntry (Entry* entry)
+{
+	Entry* volatile* const bucket = &m_buckets[entry->hash % NUM_BUCKETS];
+
+	m_entries.push_back(entry);
+
+	// Publish entry to concurrent readers
+	for (;;)
+	{
+		Entry* const head = *bucket;
+
+		entry->next = head;
+
+		if (deAtomicCompareExchangePtr((void* volatile*)bucket, head, entry) == head)
+			break;
+	}
+}
+
+void ShaderCache::commit (void)
+{
+	const de::ScopedLock lock (m_writeLock);
+
+	if (m_numUncommittedEntries > 0)
+	{
+		const ScopedFileLock fileLock (getLockFile());
+
+		if (fileLock.isLocked())
+			commitIndex();
+	}
+}
+
+void ShaderCache::readIndexEntries (deUint64 dataFileSize, vector<IndexSlot>& entries, deUint64& dataSize) const
+{
+	deFile*		file	= deFile_create(m_indexFilename.c_str(), DE_FILEMODE_READ|DE_FILEMODE_OPEN);
+	IndexHeader	header;
+
+	if (!file)
+		return;
+
+	if (readAt(file, 0, &header, sizeof(header)) && isIndexValid(header, (deUint64)deFile_getSize(file), dataFileSize))
+	{
+		vector<IndexSlot> slots (header.numSlots);
+
+		if (readAt(file, sizeof(IndexHeader), &slots[0], slots.size() * sizeof(IndexSlot)))
+		{
+			for (size_t slotNdx = 0; slotNdx < slots.size(); slotNdx++)
+			{
+				if (slots[slotNdx].offset != 0)
+					entries.push_back(slots[slotNdx]);
+			}
+
+			dataSize = header.dataSize;
+		}
+	}
+
+	deFile_destroy(file);
+}
+
+deUint64 ShaderCache::scanRecords (deFile* file, deUint64 offset, deUint64 endOffset, vector<IndexSlot>& entries)
+{
+	vector<char> key;
+
+	while (offset + sizeof(RecordHeader) <= endOffset)
+	{
+		RecordHeader	header;
+		IndexSlot		entry;
+
+		if (!readAt(file, offset, &header, sizeof(header)) || offset + getRecordSize(header) > endOffset)
+			break;
+
+		key.resize(header.keySize + 1);
+
+		if (!readAt(file, offset + sizeof(RecordHeader), &key[0], header.keySize))
+			break;
+
+		key[header.keySize] = 0;
+
+		// Partially written record
+		if (deStringHash(&key[0]) != header.hash)
+			break;
+
+		entry.hash		= header.hash;
+		entry.reserved	= 0;
+		entry.offset	= offset;
+
+		entries.push_back(entry);
+
+		offset += getRecordSize(header);
+	}
+
+	return offset;
+}
+
+void ShaderCache::commitIndex (void)
+{
+	// Other processes may have appended records and committed the index since
+	// this process mapped the files. Index is rebuilt from the files on disk
+	// instead: entries of the current index file, and records after the part
+	// of the data file it covers.
+	deFile*				dataFile	= isDataFileValid() ? deFile_create(m_dataFilename.c_str(), DE_FILEMODE_READ|DE_FILEMODE_OPEN) : DE_NULL;
+	vector<IndexSlot>	entries;
+	deUint64			dataSize	= sizeof(DataHeader);
+
+	if (!dataFile)
+		return;
+
+	{
+		const deUint64		dataFileSize	= (deUint64)de::max<deInt64>(deFile_getSize(dataFile), 0);
+		std::set<deUint64>	offsets;
+
+		readIndexEntries(dataFileSize, entries, dataSize);
+		dataSize = scanRecords(dataFile, dataSize, dataFileSize, entries);
+
+		for (size_t entryNdx = 0; entryNdx < entries.size(); entryNdx++)
+			offsets.insert(entries[entryNdx].offset);
+
+		// Scan stops at a record left partially written by a crashed process,
+		// records this process appended after it are added from memory.
+		for (size_t entryNdx = 0; entryNdx < m_pendingEntries.size(); entryNdx++)
+		{
+			const IndexSlot&	pending	= m_pendingEntries[entryNdx];
+			RecordHeader		header;
+
+			// Data file may have been replaced by another process
+			if (offsets.find(pending.offset) == offsets.end()				&&
+				readAt(dataFile, pending.offset, &header, sizeof(header))	&&
+				header.hash == pending.hash									&&
+				pending.offset + getRecordSize(header) <= dataFileSize)
+			{
+				entries.push_back(pending);
+				offsets.insert(pending.offset);
+			}
+		}
+	}
+
+	deFile_destroy(dataFile);
+
+	{
+		const deUint32		numSlots	= de::max<deUint32>(MIN_INDEX_SLOTS, deSmallestGreaterOrEquallPowerOfTwoU32((deUint32)(entries.size() * 2 + 1)));
+		vector<deUint8>		data		(sizeof(IndexHeader) + numSlots * sizeof(IndexSlot), 0);
+		IndexSlot* const	slots		= (IndexSlot*)&data[sizeof(IndexHeader)];
+		IndexHeader			header;
+
+		for (size_t entryNdx = 0; entryNdx < entries.size(); entryNdx++)
+		{
+			deUint32 slotNdx = entries[entryNdx].hash & (numSlots - 1);
+
+			while (slots[slotNdx].offset != 0)
+				slotNdx = (slotNdx + 1) & (numSlots - 1);
+
+			slots[slotNdx] = entries[entryNdx];
+		}
+
+		header.magic		= INDEX_MAGIC;
+		header.version		= VERSION;
+		header.numSlots		= numSlots;
+		header.numEntries	= (deUint32)entries.size();
+		header.dataSize		= dataSize;
+
+		deMemcpy(&data[0], &header, sizeof(header));
+
+		if (!deWriteFileAtomic(m_indexFilename.c_str(), &data[0], (deInt64)data.size()))
+			return;
+	}
+
+	m_pendingEntries.clear();
+	m_numCommittedEntries	= entries.size();
+	m_numUncommittedEntries	= 0;
+}
+
+void ShaderCache::clear (bool force)
+{
+	if (m_data)
+	{
+		deMappedFile_destroy(m_data);
+		m_data = DE_NULL;
+	}
+
+	m_dataPtr			= DE_NULL;
+	m_dataMappedSize	= 0;
+
+	{
+		const de::FilePath filePath (m_dataFilename);
+
+		if (!de::FilePath(filePath.getDirName()).exists())
+			de::createDirectoryAndParents(filePath.getDirName().c_str());
+	}
+
+	{
+		// Files are replaced without the lock if lock file can't be created,
+		// writing to such a directory will most likely fail anyway.
+		const ScopedFileLock fileLock (getLockFile());
+
+		// Another process may have started a new data file since this one was opened
+		if (!force && isDataFileValid())
+			return;
+
+		deDeleteFile(m_indexFilename.c_str());
+
+		// Start new data file. Replace instead of truncating, other processes
+		// may have the old file mapped. On failure nothing is written to disk.
+		{
+			DataHeader header;
+
+			header.magic	= DATA_MAGIC;
+			header.version	= VERSION;
+
+			deWriteFileAtomic(m_dataFilename.c_str(), &header, (deInt64)sizeof(header));
+		}
+	}
+}
+
+} // vk
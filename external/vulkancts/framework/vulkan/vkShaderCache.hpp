@@ -0,0 +1,182 @@
+#ifndef _VKSHADERCACHE_HPP
+#define _VKSHADERCACHE_HPP
+/*-------------------------------------------------------------------------
+ * Vulkan CTS Framework
+ * --------------------
+ *
+ * Copyright (c) 2018 Google Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Persistent shader binary cache.
+ *//*--------------------------------------------------------------------*/
+
+#include "vkDefs.hpp"
+#include "vkPrograms.hpp"
+#include "deMutex.hpp"
+#include "deMappedFile.h"
+#include "deFile.h"
+
+#include <string>
+#include <vector>
+
+namespace vk
+{
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Persistent shader cache backed by memory-mapped files
+ *
+ * Cache consists of two files:
+ *  - Data file (<name>): header followed by records appended in order of
+ *    insertion. Each record holds cache key and binary.
+ *  - Index file (<name>.idx): open-addressing hash table from key hash to
+ *    record offset, covering the first dataSize bytes of the data file.
+ *    Index is rewritten to a temporary file and renamed in place on commit.
+ *
+ * Both files are mapped at startup and never modified through the mapping,
+ * so startup and lookups do not depend on cache size. Records appended
+ * after the last index commit (including ones from a run that crashed or
+ * didn't call commit()) are scanned from the end of the data file at
+ * startup.
+ *
+ * The data file is append-only while mapped: existing bytes are never
+ * rewritten and the file is never truncated in place. Starting over writes
+ * a new file and renames it over the old one, so processes sharing the
+ * cache keep reading the file they mapped. Truncating the data file by
+ * other means while a process has it mapped makes that process crash with
+ * SIGBUS on its next lookup past the new end of file.
+ *
+ * Records added during the run are published through lock-free per-bucket
+ * lists, so lookups never take a lock. Only writers serialize on a mutex.
+ *
+ * Several processes may share the cache. Appending records, writing the
+ * index and starting over are serialized between processes with a lock on
+ * <name>.lock. Record offsets are taken from the end of the data file at
+ * the time of the append, and the index is rebuilt from the index and data
+ * files on disk, so records appended by other processes are not lost.
+ * Records stored by other processes after startup are not visible to
+ * lookups until the next run.
+ *//*--------------------------------------------------------------------*/
+class ShaderCache
+{
+public:
+								ShaderCache				(const std::string& filename, bool truncate);
+								~ShaderCache			(void);
+
+	ProgramBinary*				load					(const std::string& key) const;
+	void						store					(const ProgramBinary& binary, const std::string& key);
+
+	//! Write index covering all stored records. Called at end of session.
+	void						commit					(void);
+
+private:
+								ShaderCache				(const ShaderCache&); // Not allowed!
+	ShaderCache&				operator=				(const ShaderCache&); // Not allowed!
+
+	enum
+	{
+		DATA_MAGIC			= 0x43534B56,	//!< "VKSC"
+		INDEX_MAGIC			= 0x49534B56,	//!< "VKSI"
+		VERSION				= 1,
+
+		NUM_BUCKETS			= 1<<16,		//!< In-memory buckets for entries not in mapped index
+		MIN_INDEX_SLOTS		= 1<<10,
+		MIN_COMMIT_ENTRIES	= 1<<10			//!< Uncommitted entries needed before index is rewritten
+	};
+
+	struct DataHeader
+	{
+		deUint32	magic;
+		deUint32	version;
+	};
+
+	struct RecordHeader
+	{
+		deUint32	hash;
+		deUint32	format;
+		deUint32	keySize;
+		deUint32	binarySize;
+	};
+
+	struct IndexHeader
+	{
+		deUint32	magic;
+		deUint32	version;
+		deUint32	numSlots;
+		deUint32	numEntries;
+		deUint64	dataSize;				//!< Size of data file covered by index
+	};
+
+	struct IndexSlot
+	{
+		deUint32	hash;
+		deUint32	reserved;
+		deUint64	offset;					//!< Record offset in data file, 0 if slot is empty
+	};
+
+	struct Entry
+	{
+		deUint32				hash;
+		deUint64				offset;
+		ProgramFormat			format;
+		std::string				key;
+		std::vector<deUint8>	binary;
+		Entry*					next;
+	};
+
+	static size_t				getRecordSize			(const RecordHeader& header);
+	static bool					isIndexValid			(const IndexHeader& header, deUint64 indexFileSize, deUint64 dataFileSize);
+	static deUint64				scanRecords				(deFile* file, deUint64 offset, deUint64 endOffset, std::vector<IndexSlot>& entries);
+
+	bool						openData				(void);
+	void						openIndex				(void);
+	void						scanData				(deUint64 offset);
+	const deUint8*				findRecord				(deUint64 offset, deUint32 hash, const std::string& key) const;
+	void						addEntry				(Entry* entry);
+
+	// appendRecord(), readIndexEntries() and commitIndex() require the file lock
+	deFile*						getLockFile				(void);
+	bool						isDataFileValid			(void) const;
+	deUint64					appendRecord			(const std::vector<deUint8>& record);
+	void						readIndexEntries		(deUint64 dataFileSize, std::vector<IndexSlot>& entries, deUint64& dataSize) const;
+	void						commitIndex				(void);
+	void						clear					(bool force);
+
+	const std::string			m_dataFilename;
+	const std::string			m_indexFilename;
+	const std::string			m_lockFilename;
+
+	deMappedFile*				m_data;
+	deMappedFile*				m_index;
+	const deUint8*				m_dataPtr;
+	deUint64					m_dataMappedSize;
+	const IndexSlot*			m_indexSlots;
+	deUint32					m_numIndexSlots;
+	deUint32					m_numIndexEntries;
+
+	Entry* volatile				m_buckets[NUM_BUCKETS];
+
+	de::Mutex					m_writeLock;
+	deFile*						m_lockFile;				//!< Opened on first write
+	deUint64					m_dataSize;				//!< Size of data file covered by mapped index
+	std::vector<Entry*>			m_entries;				//!< All entries not in mapped index
+	std::vector<IndexSlot>		m_pendingEntries;		//!< Entries written by this process since last index commit
+	size_t						m_numCommittedEntries;	//!< Entries in last written index
+	size_t						m_numUncommittedEntries;
+};
+
+} // vk
+
+#endif // _VKSHADERCACHE_HPP
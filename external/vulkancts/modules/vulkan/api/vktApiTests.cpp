@@ -67,27 +67,27 @@ void createApiTests (tcu::TestCaseGroup* apiTests)
 {
 	tcu::TestContext&	testCtx		= apiTests->getTestContext();
 
-	apiTests->addChild(createVersionSanityCheckTests			(testCtx));
-	apiTests->addChild(createDriverPropertiesTests				(testCtx));
-	apiTests->addChild(createSmokeTests							(testCtx));
-	apiTests->addChild(api::createFeatureInfoTests				(testCtx));
-	apiTests->addChild(createDeviceInitializationTests			(testCtx));
-	apiTests->addChild(createObjectManagementTests				(testCtx));
-	apiTests->addChild(createBufferTests						(testCtx));
-	apiTests->addChild(createTestGroup							(testCtx, "buffer_view",	"BufferView tests",		createBufferViewTests));
-	apiTests->addChild(createCommandBuffersTests				(testCtx));
-	apiTests->addChild(createCopiesAndBlittingTests				(testCtx));
-	apiTests->addChild(createImageClearingTests					(testCtx));
-	apiTests->addChild(createFillAndUpdateBufferTests			(testCtx));
-	apiTests->addChild(createDescriptorPoolTests				(testCtx));
-	apiTests->addChild(createNullHandleTests					(testCtx));
-	apiTests->addChild(createGranularityQueryTests				(testCtx));
-	apiTests->addChild(createMemoryCommitmentTests				(testCtx));
-	apiTests->addChild(createExternalMemoryTests				(testCtx));
-	apiTests->addChild(createMaintenance3Tests					(testCtx));
-	apiTests->addChild(createDescriptorSetTests					(testCtx));
-	apiTests->addChild(createPipelineTests						(testCtx));
-	apiTests->addChild(createMemoryRequirementInvarianceTests	(testCtx));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "version_check",			"API Version Tests",						createVersionSanityCheckTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "driver_properties",		"VK_KHR_driver_properties tests",			createDriverPropertiesTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "smoke",					"Smoke Tests",								createSmokeTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "info",					"Platform Information Tests",				api::createFeatureInfoTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "device_init",			"Device Initialization Tests",				createDeviceInitializationTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "object_management",		"Object management tests",					createObjectManagementTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "buffer",					"Buffer Tests",								createBufferTests));
+	apiTests->addChild(createTestGroup		(testCtx, "buffer_view",			"BufferView tests",							createBufferViewTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "command_buffers",		"Command Buffers Tests",					createCommandBuffersTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "copy_and_blit",			"Copies And Blitting Tests",				createCopiesAndBlittingTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "image_clearing",			"Image Clearing Tests",						createImageClearingTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "fill_and_update_buffer",	"Fill and Update Buffer Tests",				createFillAndUpdateBufferTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "descriptor_pool",		"Descriptor Pool Tests",					createDescriptorPoolTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "null_handle",			"Destroying/freeing a VK_NULL_HANDLE should be silently ignored", createNullHandleTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "granularity",			"Granularity query tests",					createGranularityQueryTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "get_memory_commitment",	"Memory Commitment Tests",					createMemoryCommitmentTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "external",				"Tests for external Vulkan objects",		createExternalMemoryTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "maintenance3_check",		"Maintenance3 Tests",						createMaintenance3Tests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "descriptor_set",			"Descriptor set tests",						createDescriptorSetTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "pipeline",				"Descriptor set tests",						createPipelineTests));
+	apiTests->addChild(createLazyTestGroup	(testCtx, "invariance",				"Memory requirement invariance tests",		createMemoryRequirementInvarianceTests));
 }
 
 } // anonymous
@@ -1533,6 +1533,13 @@ protected:
 	void					uploadInputBuffer	(const void* const* inputPtrs, int numValues);
 	void					readOutputBuffer	(void* const* outputPtrs, int numValues);
 
+	Move<VkBuffer>			createIoBuffer		(VkDeviceSize size, de::MovePtr<Allocation>* alloc) const;
+
+	//! Pack values [firstValue, firstValue+numValues) of inputPtrs into buffer memory at dstPtr.
+	void					packInputs			(const void* const* inputPtrs, int firstValue, int numValues, void* dstPtr) const;
+	//! Unpack numValues outputs from buffer memory at srcPtr into outputPtrs starting at firstValue.
+	void					unpackOutputs		(const void* srcPtr, int firstValue, int numValues, void* const* outputPtrs) const;
+
 	static void				declareBufferBlocks	(std::ostream& src, const ShaderSpec& spec);
 	static void				generateExecBufferIo(std::ostream& src, const ShaderSpec& spec, const char* invocationNdxName);
 
@@ -1729,6 +1736,42 @@ void BufferIoExecutor::generateExecBufferIo (std::ostream& src, const ShaderSpec
 	}
 }
 
+template<size_t Size>
+static void copyStridedElements (deUint8* dstPtr, size_t dstStride, const deUint8* srcPtr, size_t srcStride, int numElements)
+{
+	// Constant-size copies compile to plain (vector) loads and stores.
+	for (int elemNdx = 0; elemNdx < numElements; elemNdx++)
+		deMemcpy(dstPtr + dstStride * elemNdx, srcPtr + srcStride * elemNdx, Size);
+}
+
+static void copyStrided (deUint8* dstPtr, size_t dstStride, const deUint8* srcPtr, size_t srcStride, size_t elemSize, int numElements)
+{
+	if (dstStride == elemSize && srcStride == elemSize)
+	{
+		deMemcpy(dstPtr, srcPtr, elemSize * numElements);
+		return;
+	}
+
+	switch (elemSize)
+	{
+		case 2:		copyStridedElements<2>(dstPtr, dstStride, srcPtr, srcStride, numElements);		break;
+		case 4:		copyStridedElements<4>(dstPtr, dstStride, srcPtr, srcStride, numElements);		break;
+		case 6:		copyStridedElements<6>(dstPtr, dstStride, srcPtr, srcStride, numElements);		break;
+		case 8:		copyStridedElements<8>(dstPtr, dstStride, srcPtr, srcStride, numElements);		break;
+		case 12:	copyStridedElements<12>(dstPtr, dstStride, srcPtr, srcStride, numElements);		break;
+		case 16:	copyStridedElements<16>(dstPtr, dstStride, srcPtr, srcStride, numElements);		break;
+		default:
+			for (int elemNdx = 0; elemNdx < numElements; elemNdx++)
+				deMemcpy(dstPtr + dstStride * elemNdx, srcPtr + srcStride * elemNdx, elemSize);
+			break;
+	}
+}
+
+static size_t getHostValueSize (glu::DataType basicType)
+{
+	return (size_t)glu::getDataTypeScalarSize(basicType) * (glu::isDataTypeFloat16OrVec(basicType) ? sizeof(deUint16) : sizeof(deUint32));
+}
+
 void BufferIoExecutor::copyToBuffer (const glu::VarType& varType, const VarLayout& layout, int numValues, const void* srcBasePtr, void* dstBasePtr)
 {
 	if (varType.isBasicType())
@@ -1738,19 +1781,14 @@ void BufferIoExecutor::copyToBuffer (const glu::VarType& varType, const VarLayou
 		const int				scalarSize		= glu::getDataTypeScalarSize(basicType);
 		const int				numVecs			= isMatrix ? glu::getDataTypeMatrixNumColumns(basicType) : 1;
 		const int				numComps		= scalarSize / numVecs;
+		const size_t			size			= (glu::isDataTypeFloat16OrVec(basicType) ? sizeof(deUint16) : sizeof(deUint32));
 
-		for (int elemNdx = 0; elemNdx < numValues; elemNdx++)
+		for (int vecNdx = 0; vecNdx < numVecs; vecNdx++)
 		{
-			for (int vecNdx = 0; vecNdx < numVecs; vecNdx++)
-			{
-				const int		size			= (glu::isDataTypeFloat16OrVec(basicType) ? (int)sizeof(deUint16) : (int)sizeof(deUint32));
-				const int		srcOffset		= size * (elemNdx * scalarSize + vecNdx * numComps);
-				const int		dstOffset		= layout.offset + layout.stride * elemNdx + (isMatrix ? layout.matrixStride * vecNdx : 0);
-				const deUint8*	srcPtr			= (const deUint8*)srcBasePtr + srcOffset;
-				deUint8*		dstPtr			= (deUint8*)dstBasePtr + dstOffset;
+			const size_t	srcOffset	= size * (vecNdx * numComps);
+			const size_t	dstOffset	= layout.offset + (isMatrix ? layout.matrixStride * vecNdx : 0);
 
-				deMemcpy(dstPtr, srcPtr, size * numComps);
-			}
+			copyStrided((deUint8*)dstBasePtr + dstOffset, layout.stride, (const deUint8*)srcBasePtr + srcOffset, size * scalarSize, size * numComps, numValues);
 		}
 	}
 	else
@@ -1766,25 +1804,46 @@ void BufferIoExecutor::copyFromBuffer (const glu::VarType& varType, const VarLay
 		const int				scalarSize		= glu::getDataTypeScalarSize(basicType);
 		const int				numVecs			= isMatrix ? glu::getDataTypeMatrixNumColumns(basicType) : 1;
 		const int				numComps		= scalarSize / numVecs;
+		const size_t			size			= (glu::isDataTypeFloat16OrVec(basicType) ? sizeof(deUint16) : sizeof(deUint32));
 
-		for (int elemNdx = 0; elemNdx < numValues; elemNdx++)
+		for (int vecNdx = 0; vecNdx < numVecs; vecNdx++)
 		{
-			for (int vecNdx = 0; vecNdx < numVecs; vecNdx++)
-			{
-				const int		size			= (glu::isDataTypeFloat16OrVec(basicType) ? (int)sizeof(deUint16) : (int)sizeof(deUint32));
-				const int		srcOffset		= layout.offset + layout.stride * elemNdx + (isMatrix ? layout.matrixStride * vecNdx : 0);
-				const int		dstOffset		= size * (elemNdx * scalarSize + vecNdx * numComps);
-				const deUint8*	srcPtr			= (const deUint8*)srcBasePtr + srcOffset;
-				deUint8*		dstPtr			= (deUint8*)dstBasePtr + dstOffset;
+			const size_t	srcOffset	= layout.offset + (isMatrix ? layout.matrixStride * vecNdx : 0);
+			const size_t	dstOffset	= size * (vecNdx * numComps);
 
-				deMemcpy(dstPtr, srcPtr, size * numComps);
-			}
+			copyStrided((deUint8*)dstBasePtr + dstOffset, size * scalarSize, (const deUint8*)srcBasePtr + srcOffset, layout.stride, size * numComps, numValues);
 		}
 	}
 	else
 		throw tcu::InternalError("Unsupported type");
 }
 
+void BufferIoExecutor::packInputs (const void* const* inputPtrs, int firstValue, int numValues, void* dstPtr) const
+{
+	DE_ASSERT(m_shaderSpec.inputs.size() == m_inputLayout.size());
+	for (size_t inputNdx = 0; inputNdx < m_shaderSpec.inputs.size(); ++inputNdx)
+	{
+		const glu::VarType&		varType		= m_shaderSpec.inputs[inputNdx].varType;
+		const VarLayout&		layout		= m_inputLayout[inputNdx];
+		const deUint8*			srcPtr		= (const deUint8*)inputPtrs[inputNdx] + getHostValueSize(varType.getBasicType()) * firstValue;
+
+		copyToBuffer(varType, layout, numValues, srcPtr, dstPtr);
+	}
+}
+
+void BufferIoExecutor::unpackOutputs (const void* srcPtr, int firstValue, int numValues, void* const* outputPtrs) const
+{
+	DE_ASSERT(m_shaderSpec.outputs.size() == m_outputLayout.size());
+	for (size_t outputNdx = 0; outputNdx < m_shaderSpec.outputs.size(); ++outputNdx)
+	{
+		const glu::VarType&		varType		= m_shaderSpec.outputs[outputNdx].varType;
+		const VarLayout&		layout		= m_outputLayout[outputNdx];
+		deUint8*				dstPtr		= (deUint8*)outputPtrs[outputNdx] + getHostValueSize(varType.getBasicType()) * firstValue;
+
+		copyFromBuffer(varType, layout, numValues, srcPtr, dstPtr);
+	}
+}
+
 void BufferIoExecutor::uploadInputBuffer (const void* const* inputPtrs, int numValues)
 {
 	const VkDevice			vkDevice			= m_context.getDevice();
@@ -1796,14 +1855,7 @@ void BufferIoExecutor::uploadInputBuffer (const void* const* inputPtrs, int numV
 	if (inputBufferSize == 0)
 		return; // No inputs
 
-	DE_ASSERT(m_shaderSpec.inputs.size() == m_inputLayout.size());
-	for (size_t inputNdx = 0; inputNdx < m_shaderSpec.inputs.size(); ++inputNdx)
-	{
-		const glu::VarType&		varType		= m_shaderSpec.inputs[inputNdx].varType;
-		const VarLayout&		layout		= m_inputLayout[inputNdx];
-
-		copyToBuffer(varType, layout, numValues, inputPtrs[inputNdx], m_inputAlloc->getHostPtr());
-	}
+	packInputs(inputPtrs, 0, numValues, m_inputAlloc->getHostPtr());
 
 	flushAlloc(vk, vkDevice, *m_inputAlloc);
 }
@@ -1817,63 +1869,46 @@ void BufferIoExecutor::readOutputBuffer (void* const* outputPtrs, int numValues)
 
 	invalidateAlloc(vk, vkDevice, *m_outputAlloc);
 
-	DE_ASSERT(m_shaderSpec.outputs.size() == m_outputLayout.size());
-	for (size_t outputNdx = 0; outputNdx < m_shaderSpec.outputs.size(); ++outputNdx)
-	{
-		const glu::VarType&		varType		= m_shaderSpec.outputs[outputNdx].varType;
-		const VarLayout&		layout		= m_outputLayout[outputNdx];
-
-		copyFromBuffer(varType, layout, numValues, m_outputAlloc->getHostPtr(), outputPtrs[outputNdx]);
-	}
+	unpackOutputs(m_outputAlloc->getHostPtr(), 0, numValues, outputPtrs);
 }
 
-void BufferIoExecutor::initBuffers (int numValues)
+Move<VkBuffer> BufferIoExecutor::createIoBuffer (VkDeviceSize size, de::MovePtr<Allocation>* alloc) const
 {
-	const deUint32				inputStride			= getLayoutStride(m_inputLayout);
-	const deUint32				outputStride		= getLayoutStride(m_outputLayout);
-	// Avoid creating zero-sized buffer/memory
-	const size_t				inputBufferSize		= de::max(numValues * inputStride, 1u);
-	const size_t				outputBufferSize	= numValues * outputStride;
-
-	// Upload data to buffer
 	const VkDevice				vkDevice			= m_context.getDevice();
 	const DeviceInterface&		vk					= m_context.getDeviceInterface();
 	const deUint32				queueFamilyIndex	= m_context.getUniversalQueueFamilyIndex();
 	Allocator&					memAlloc			= m_context.getDefaultAllocator();
 
-	const VkBufferCreateInfo inputBufferParams =
+	const VkBufferCreateInfo bufferParams =
 	{
 		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,		// VkStructureType		sType;
 		DE_NULL,									// const void*			pNext;
 		0u,											// VkBufferCreateFlags	flags;
-		inputBufferSize,							// VkDeviceSize			size;
+		size,										// VkDeviceSize			size;
 		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,			// VkBufferUsageFlags	usage;
 		VK_SHARING_MODE_EXCLUSIVE,					// VkSharingMode		sharingMode;
 		1u,											// deUint32				queueFamilyCount;
 		&queueFamilyIndex							// const deUint32*		pQueueFamilyIndices;
 	};
 
-	m_inputBuffer = createBuffer(vk, vkDevice, &inputBufferParams);
-	m_inputAlloc = memAlloc.allocate(getBufferMemoryRequirements(vk, vkDevice, *m_inputBuffer), MemoryRequirement::HostVisible);
+	Move<VkBuffer> buffer = createBuffer(vk, vkDevice, &bufferParams);
+	*alloc = memAlloc.allocate(getBufferMemoryRequirements(vk, vkDevice, *buffer), MemoryRequirement::HostVisible);
 
-	VK_CHECK(vk.bindBufferMemory(vkDevice, *m_inputBuffer, m_inputAlloc->getMemory(), m_inputAlloc->getOffset()));
+	VK_CHECK(vk.bindBufferMemory(vkDevice, *buffer, (*alloc)->getMemory(), (*alloc)->getOffset()));
 
-	const VkBufferCreateInfo outputBufferParams =
-	{
-		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,		// VkStructureType		sType;
-		DE_NULL,									// const void*			pNext;
-		0u,											// VkBufferCreateFlags	flags;
-		outputBufferSize,							// VkDeviceSize			size;
-		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,			// VkBufferUsageFlags	usage;
-		VK_SHARING_MODE_EXCLUSIVE,					// VkSharingMode		sharingMode;
-		1u,											// deUint32				queueFamilyCount;
-		&queueFamilyIndex							// const deUint32*		pQueueFamilyIndices;
-	};
+	return buffer;
+}
 
-	m_outputBuffer = createBuffer(vk, vkDevice, &outputBufferParams);
-	m_outputAlloc = memAlloc.allocate(getBufferMemoryRequirements(vk, vkDevice, *m_outputBuffer), MemoryRequirement::HostVisible);
+void BufferIoExecutor::initBuffers (int numValues)
+{
+	const deUint32				inputStride			= getLayoutStride(m_inputLayout);
+	const deUint32				outputStride		= getLayoutStride(m_outputLayout);
+	// Avoid creating zero-sized buffer/memory
+	const size_t				inputBufferSize		= de::max(numValues * inputStride, 1u);
+	const size_t				outputBufferSize	= numValues * outputStride;
 
-	VK_CHECK(vk.bindBufferMemory(vkDevice, *m_outputBuffer, m_outputAlloc->getMemory(), m_outputAlloc->getOffset()));
+	m_inputBuffer	= createIoBuffer(inputBufferSize, &m_inputAlloc);
+	m_outputBuffer	= createIoBuffer(outputBufferSize, &m_outputAlloc);
 }
 
 // ComputeShaderExecutor
@@ -1892,6 +1927,29 @@ protected:
 	static std::string	generateComputeShader	(const ShaderSpec& spec);
 
 private:
+	enum
+	{
+		MAX_CHUNKS_IN_FLIGHT	= 2
+	};
+
+	//! Per-chunk resources. Chunks are submitted round-robin over slots.
+	struct ChunkSlot
+	{
+		Move<VkBuffer>				inputBuffer;
+		de::MovePtr<Allocation>		inputAlloc;
+		Move<VkBuffer>				outputBuffer;
+		de::MovePtr<Allocation>		outputAlloc;
+		Move<VkDescriptorSet>		descriptorSet;
+		Move<VkCommandBuffer>		cmdBuffer;
+		Move<VkFence>				fence;
+		int							firstValue;
+		int							numValues;		//!< Number of values in flight, 0 if slot is idle.
+
+		ChunkSlot (void) : firstValue(0), numValues(0) {}
+	};
+
+	void				finishChunk				(ChunkSlot& slot, void* const* outputs);
+
 	const VkDescriptorSetLayout					m_extraResourcesLayout;
 };
 
@@ -2335,39 +2393,77 @@ void ComputeShaderExecutor::execute (int numValues, const void* const* inputs, v
 	Move<VkCommandPool>				cmdPool;
 	Move<VkDescriptorPool>			descriptorPool;
 	Move<VkDescriptorSetLayout>		descriptorSetLayout;
-	Move<VkDescriptorSet>			descriptorSet;
 	const deUint32					numDescriptorSets		= (m_extraResourcesLayout != 0) ? 2u : 1u;
 
-	DE_ASSERT((m_extraResourcesLayout != 0) == (extraResources != 0));
+	const int						maxValuesPerInvocation	= m_context.getDeviceProperties().limits.maxComputeWorkGroupSize[0];
+	const int						chunkSize				= de::min(maxValuesPerInvocation, numValues);
+	const int						numChunks				= (numValues + chunkSize - 1) / chunkSize;
+	const int						numSlots				= de::min(numChunks, (int)MAX_CHUNKS_IN_FLIGHT);
+	const deUint32					inputStride				= getInputStride();
+	const deUint32					outputStride			= getOutputStride();
+	ChunkSlot						slots[MAX_CHUNKS_IN_FLIGHT];
 
-	initBuffers(numValues);
-
-	// Setup input buffer & copy data
-	uploadInputBuffer(inputs, numValues);
+	DE_ASSERT((m_extraResourcesLayout != 0) == (extraResources != 0));
+	DE_ASSERT(numValues > 0);
 
 	// Create command pool
-	cmdPool = createCommandPool(vk, vkDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, queueFamilyIndex);
-
-	// Create command buffer
+	cmdPool = createCommandPool(vk, vkDevice, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, queueFamilyIndex);
 
 	descriptorSetLayoutBuilder.addSingleBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
-	descriptorPoolBuilder.addType(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	descriptorPoolBuilder.addType(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (deUint32)numSlots);
 	descriptorSetLayoutBuilder.addSingleBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
-	descriptorPoolBuilder.addType(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	descriptorPoolBuilder.addType(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (deUint32)numSlots);
 
 	descriptorSetLayout = descriptorSetLayoutBuilder.build(vk, vkDevice);
-	descriptorPool = descriptorPoolBuilder.build(vk, vkDevice, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, 1u);
+	descriptorPool = descriptorPoolBuilder.build(vk, vkDevice, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, (deUint32)numSlots);
 
-	const VkDescriptorSetAllocateInfo allocInfo =
+	// Each slot owns buffers for one chunk so that the host can pack the next
+	// chunk and unpack the previous one while the device executes.
+	for (int slotNdx = 0; slotNdx < numSlots; slotNdx++)
 	{
-		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-		DE_NULL,
-		*descriptorPool,
-		1u,
-		&*descriptorSetLayout
-	};
+		ChunkSlot&							slot		= slots[slotNdx];
+		DescriptorSetUpdateBuilder			descriptorSetUpdateBuilder;
+		const VkDescriptorSetAllocateInfo	allocInfo	=
+		{
+			VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			DE_NULL,
+			*descriptorPool,
+			1u,
+			&*descriptorSetLayout
+		};
+
+		slot.descriptorSet	= allocateDescriptorSet(vk, vkDevice, &allocInfo);
+		slot.cmdBuffer		= allocateCommandBuffer(vk, vkDevice, *cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		slot.fence			= createFence(vk, vkDevice);
+		slot.outputBuffer	= createIoBuffer(chunkSize * outputStride, &slot.outputAlloc);
+
+		{
+			const VkDescriptorBufferInfo outputDescriptorBufferInfo =
+			{
+				*slot.outputBuffer,				// VkBuffer			buffer;
+				0u,								// VkDeviceSize		offset;
+				VK_WHOLE_SIZE					// VkDeviceSize		range;
+			};
+
+			descriptorSetUpdateBuilder.writeSingle(*slot.descriptorSet, vk::DescriptorSetUpdateBuilder::Location::binding((deUint32)OUTPUT_BUFFER_BINDING), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &outputDescriptorBufferInfo);
+		}
+
+		if (inputStride)
+		{
+			slot.inputBuffer = createIoBuffer(chunkSize * inputStride, &slot.inputAlloc);
+
+			const VkDescriptorBufferInfo inputDescriptorBufferInfo =
+			{
+				*slot.inputBuffer,				// VkBuffer			buffer;
+				0u,								// VkDeviceSize		offset;
+				VK_WHOLE_SIZE					// VkDeviceSize		range;
+			};
 
-	descriptorSet = allocateDescriptorSet(vk, vkDevice, &allocInfo);
+			descriptorSetUpdateBuilder.writeSingle(*slot.descriptorSet, vk::DescriptorSetUpdateBuilder::Location::binding((deUint32)INPUT_BUFFER_BINDING), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &inputDescriptorBufferInfo);
+		}
+
+		descriptorSetUpdateBuilder.update(vk, vkDevice);
+	}
 
 	// Create pipeline layout
 	{
@@ -2424,65 +2520,96 @@ void ComputeShaderExecutor::execute (int numValues, const void* const* inputs, v
 		computePipeline = createComputePipeline(vk, vkDevice, DE_NULL, &computePipelineParams);
 	}
 
-	const int			maxValuesPerInvocation	= m_context.getDeviceProperties().limits.maxComputeWorkGroupSize[0];
-	int					curOffset				= 0;
-	const deUint32		inputStride				= getInputStride();
-	const deUint32		outputStride			= getOutputStride();
-
-	while (curOffset < numValues)
 	{
-		Move<VkCommandBuffer>	cmdBuffer;
-		const int				numToExec	= de::min(maxValuesPerInvocation, numValues-curOffset);
+		int		curOffset	= 0;
+		int		slotNdx		= 0;
 
-		// Update descriptors
+		while (curOffset < numValues)
 		{
-			DescriptorSetUpdateBuilder descriptorSetUpdateBuilder;
+			ChunkSlot&	slot		= slots[slotNdx];
+			const int	numToExec	= de::min(chunkSize, numValues-curOffset);
 
-			const VkDescriptorBufferInfo outputDescriptorBufferInfo =
-			{
-				*m_outputBuffer,				// VkBuffer			buffer;
-				curOffset * outputStride,		// VkDeviceSize		offset;
-				numToExec * outputStride		// VkDeviceSize		range;
-			};
+			// Slot is still in use by chunk submitted numSlots iterations ago
+			if (slot.numValues > 0)
+				finishChunk(slot, outputs);
 
-			descriptorSetUpdateBuilder.writeSingle(*descriptorSet, vk::DescriptorSetUpdateBuilder::Location::binding((deUint32)OUTPUT_BUFFER_BINDING), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &outputDescriptorBufferInfo);
+			slot.firstValue	= curOffset;
+			slot.numValues	= numToExec;
 
 			if (inputStride)
 			{
-				const VkDescriptorBufferInfo inputDescriptorBufferInfo =
+				packInputs(inputs, curOffset, numToExec, slot.inputAlloc->getHostPtr());
+				flushAlloc(vk, vkDevice, *slot.inputAlloc);
+			}
+
+			beginCommandBuffer(vk, *slot.cmdBuffer);
+			vk.cmdBindPipeline(*slot.cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *computePipeline);
+
+			{
+				const VkDescriptorSet	descriptorSets[]	= { *slot.descriptorSet, extraResources };
+				vk.cmdBindDescriptorSets(*slot.cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *pipelineLayout, 0u, numDescriptorSets, descriptorSets, 0u, DE_NULL);
+			}
+
+			vk.cmdDispatch(*slot.cmdBuffer, numToExec, 1, 1);
+
+			{
+				const VkMemoryBarrier	hostReadBarrier	=
 				{
-					*m_inputBuffer,					// VkBuffer			buffer;
-					curOffset * inputStride,		// VkDeviceSize		offset;
-					numToExec * inputStride			// VkDeviceSize		range;
+					VK_STRUCTURE_TYPE_MEMORY_BARRIER,	// VkStructureType	sType;
+					DE_NULL,							// const void*		pNext;
+					VK_ACCESS_SHADER_WRITE_BIT,			// VkAccessFlags	srcAccessMask;
+					VK_ACCESS_HOST_READ_BIT				// VkAccessFlags	dstAccessMask;
 				};
+				vk.cmdPipelineBarrier(*slot.cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0u, 1u, &hostReadBarrier, 0u, DE_NULL, 0u, DE_NULL);
+			}
 
-				descriptorSetUpdateBuilder.writeSingle(*descriptorSet, vk::DescriptorSetUpdateBuilder::Location::binding((deUint32)INPUT_BUFFER_BINDING), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &inputDescriptorBufferInfo);
+			endCommandBuffer(vk, *slot.cmdBuffer);
+
+			// Submit without waiting; results are read back when the slot is reused or at the end
+			{
+				const VkSubmitInfo	submitInfo	=
+				{
+					VK_STRUCTURE_TYPE_SUBMIT_INFO,		// VkStructureType				sType;
+					DE_NULL,							// const void*					pNext;
+					0u,									// deUint32						waitSemaphoreCount;
+					DE_NULL,							// const VkSemaphore*			pWaitSemaphores;
+					DE_NULL,							// const VkPipelineStageFlags*	pWaitDstStageMask;
+					1u,									// deUint32						commandBufferCount;
+					&slot.cmdBuffer.get(),				// const VkCommandBuffer*		pCommandBuffers;
+					0u,									// deUint32						signalSemaphoreCount;
+					DE_NULL								// const VkSemaphore*			pSignalSemaphores;
+				};
+
+				VK_CHECK(vk.queueSubmit(queue, 1u, &submitInfo, *slot.fence));
 			}
 
-			descriptorSetUpdateBuilder.update(vk, vkDevice);
+			curOffset	+= numToExec;
+			slotNdx		= (slotNdx + 1) % numSlots;
 		}
 
-		cmdBuffer = allocateCommandBuffer(vk, vkDevice, *cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-		beginCommandBuffer(vk, *cmdBuffer);
-		vk.cmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *computePipeline);
-
+		// Read back remaining chunks in submission order
+		for (int ndx = 0; ndx < numSlots; ndx++)
 		{
-			const VkDescriptorSet	descriptorSets[]	= { *descriptorSet, extraResources };
-			vk.cmdBindDescriptorSets(*cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, *pipelineLayout, 0u, numDescriptorSets, descriptorSets, 0u, DE_NULL);
-		}
+			ChunkSlot& slot = slots[(slotNdx + ndx) % numSlots];
 
-		vk.cmdDispatch(*cmdBuffer, numToExec, 1, 1);
+			if (slot.numValues > 0)
+				finishChunk(slot, outputs);
+		}
+	}
+}
 
-		endCommandBuffer(vk, *cmdBuffer);
+void ComputeShaderExecutor::finishChunk (ChunkSlot& slot, void* const* outputs)
+{
+	const VkDevice					vkDevice				= m_context.getDevice();
+	const DeviceInterface&			vk						= m_context.getDeviceInterface();
 
-		curOffset += numToExec;
+	VK_CHECK(vk.waitForFences(vkDevice, 1u, &slot.fence.get(), VK_TRUE, ~0ull));
+	VK_CHECK(vk.resetFences(vkDevice, 1u, &slot.fence.get()));
 
-		// Execute
-		submitCommandsAndWait(vk, vkDevice, queue, cmdBuffer.get());
-	}
+	invalidateAlloc(vk, vkDevice, *slot.outputAlloc);
+	unpackOutputs(slot.outputAlloc->getHostPtr(), slot.firstValue, slot.numValues, outputs);
 
-	// Read back data
-	readOutputBuffer(outputs, numValues);
+	slot.numValues = 0;
 }
 
 // Tessellation utils
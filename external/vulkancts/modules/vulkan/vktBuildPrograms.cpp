@@ -38,8 +38,14 @@
 #include "deThread.hpp"
 #include "deThreadSafeRingBuffer.hpp"
 #include "dePoolArray.hpp"
+#include "deSha1.hpp"
+#include "deFilePath.hpp"
+#include "deClock.h"
+#include "deFile.h"
+#include "qpInfo.h"
 
 #include <iostream>
+#include <fstream>
 
 using std::vector;
 using std::string;
@@ -57,6 +63,162 @@ typedef de::SharedPtr<glu::ProgramSources>	ProgramSourcesSp;
 typedef de::SharedPtr<vk::SpirVAsmSource>	SpirVAsmSourceSp;
 typedef de::SharedPtr<vk::ProgramBinary>	ProgramBinarySp;
 
+enum BuildStage
+{
+	// Shader compilation stages are indexed with glu::ShaderType
+	BUILDSTAGE_LINK = glu::SHADERTYPE_LAST,
+	BUILDSTAGE_ASSEMBLY,
+
+	BUILDSTAGE_LAST
+};
+
+const char* getBuildStageName (int stage)
+{
+	if (stage < glu::SHADERTYPE_LAST)
+		return glu::getShaderTypeName((glu::ShaderType)stage);
+	else if (stage == BUILDSTAGE_LINK)
+		return "link";
+	else
+	{
+		DE_ASSERT(stage == BUILDSTAGE_ASSEMBLY);
+		return "spirv-asm";
+	}
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Persistent content-addressed binary cache
+ *
+ * Binaries are stored as <path>/<xx>/<sha1>.spv, where sha1 is computed
+ * from everything that affects the compiled binary: program sources,
+ * build options, optimization settings, compiler versions and the CTS
+ * release. Entries
+ * are never modified; they are written with deWriteFileAtomic(), so
+ * concurrent builds sharing a cache only ever see complete entries.
+ *//*--------------------------------------------------------------------*/
+class BinaryCache
+{
+public:
+	enum
+	{
+		//! Bump when compile wrappers (e.g. default resource limits in vkShaderToSpirV.cpp) change in ways the release id doesn't cover.
+		VERSION = 1
+	};
+
+	explicit				BinaryCache		(const std::string& path);
+
+	//! Returns DE_NULL if binary is not in cache.
+	vk::ProgramBinary*		load			(const de::Sha1& key) const;
+
+	//! Failures are ignored; the binary is compiled again on next run.
+	void					store			(const de::Sha1& key, const vk::ProgramBinary& binary) const;
+
+private:
+	std::string				getEntryPath	(const std::string& keyStr) const;
+
+	const std::string		m_path;
+};
+
+BinaryCache::BinaryCache (const std::string& path)
+	: m_path(path)
+{
+}
+
+std::string BinaryCache::getEntryPath (const std::string& keyStr) const
+{
+	return de::FilePath::join(de::FilePath::join(m_path, keyStr.substr(0, 2)), keyStr + ".spv").getPath();
+}
+
+vk::ProgramBinary* BinaryCache::load (const de::Sha1& key) const
+{
+	const std::string	path	= getEntryPath(key.toString());
+	std::ifstream		in		(path.c_str(), std::ios::binary | std::ios::ate);
+
+	if (!in.is_open() || !in.good())
+		return DE_NULL;
+
+	{
+		const std::streamoff	size	= in.tellg();
+		std::vector<deUint8>	data;
+
+		// Entries are SPIR-V binaries; anything else is a damaged file
+		if (size <= 0 || (size % sizeof(deUint32)) != 0)
+			return DE_NULL;
+
+		data.resize((size_t)size);
+		in.seekg(0, std::ios::beg);
+		in.read((char*)&data[0], (std::streamsize)size);
+
+		if (!in.good())
+			return DE_NULL;
+
+		return new vk::ProgramBinary(vk::PROGRAM_FORMAT_SPIRV, data.size(), &data[0]);
+	}
+}
+
+void BinaryCache::store (const de::Sha1& key, const vk::ProgramBinary& binary) const
+{
+	const std::string	path		= getEntryPath(key.toString());
+	const de::FilePath	dirPath		= de::FilePath(path).getDirName();
+
+	DE_ASSERT(binary.getFormat() == vk::PROGRAM_FORMAT_SPIRV);
+
+	try
+	{
+		if (!dirPath.exists())
+			de::createDirectoryAndParents(dirPath.getPath());
+
+		deWriteFileAtomic(path.c_str(), binary.getBinary(), (deInt64)binary.getSize());
+	}
+	catch (const std::exception&)
+	{
+		// Caching is an optimization only
+	}
+}
+
+void addCompileEnvironment (de::Sha1Stream& stream, vk::ShaderLanguage language, const tcu::CommandLine& commandLine)
+{
+	stream << (deUint32)BinaryCache::VERSION
+		   << std::string(qpGetReleaseName())
+		   << qpGetReleaseId()
+		   << std::string(qpGetReleaseGlslName())
+		   << std::string(qpGetReleaseSpirvToolsName())
+		   << std::string(qpGetReleaseSpirvHeadersName())
+		   << (deUint32)language
+		   << commandLine.isSpirvOptimizationEnabled()
+		   << (deInt32)commandLine.getOptimizationRecipe();
+}
+
+template <typename Source>
+de::Sha1 computeCacheKey (const Source& source, const tcu::CommandLine& commandLine)
+{
+	de::Sha1Stream stream;
+
+	addCompileEnvironment(stream, Source::shaderLanguage, commandLine);
+
+	stream << source.buildOptions.vulkanVersion
+		   << (deUint32)source.buildOptions.targetVersion
+		   << source.buildOptions.flags;
+
+	for (int shaderType = 0; shaderType < glu::SHADERTYPE_LAST; shaderType++)
+		stream << source.sources[shaderType];
+
+	return stream.finalize();
+}
+
+de::Sha1 computeCacheKey (const vk::SpirVAsmSource& source, const tcu::CommandLine& commandLine)
+{
+	de::Sha1Stream stream;
+
+	// \note Language enum does not have value for SPIR-V assembly
+	addCompileEnvironment(stream, vk::SHADER_LANGUAGE_LAST, commandLine);
+
+	stream << source.buildOptions.vulkanVersion
+		   << (deUint32)source.buildOptions.targetVersion
+		   << source.source;
+
+	return stream.finalize();
+}
+
 class Task
 {
 public:
@@ -203,20 +365,62 @@ struct Program
 
 	vk::SpirvValidatorOptions	validatorOptions;
 
+	bool					loadedFromCache;
+	deUint64				buildTimeUs;					//!< Total time spent in build task
+	deUint64				stageTimeUs[BUILDSTAGE_LAST];	//!< Compile time per stage, as reported by compiler
+	bool					stageUsed[BUILDSTAGE_LAST];
+
 	explicit				Program		(const vk::ProgramIdentifier& id_, const vk::SpirvValidatorOptions& valOptions_)
 								: id				(id_)
 								, buildStatus		(STATUS_NOT_COMPLETED)
 								, validationStatus	(STATUS_NOT_COMPLETED)
 								, validatorOptions	(valOptions_)
-							{}
+								, loadedFromCache	(false)
+								, buildTimeUs		(0)
+							{
+								resetStageTimes();
+							}
 							Program		(void)
 								: id				("", "")
 								, buildStatus		(STATUS_NOT_COMPLETED)
 								, validationStatus	(STATUS_NOT_COMPLETED)
 								, validatorOptions()
-							{}
+								, loadedFromCache	(false)
+								, buildTimeUs		(0)
+							{
+								resetStageTimes();
+							}
+
+	void					resetStageTimes	(void)
+							{
+								for (int stage = 0; stage < BUILDSTAGE_LAST; stage++)
+								{
+									stageTimeUs[stage]	= 0;
+									stageUsed[stage]	= false;
+								}
+							}
+
+	void					addStageTime	(int stage, deUint64 timeUs)
+							{
+								stageTimeUs[stage]	+= timeUs;
+								stageUsed[stage]	= true;
+							}
 };
 
+void addStageTimes (const glu::ShaderProgramInfo& buildInfo, Program* program)
+{
+	for (size_t shaderNdx = 0; shaderNdx < buildInfo.shaders.size(); shaderNdx++)
+		program->addStageTime(buildInfo.shaders[shaderNdx].type, buildInfo.shaders[shaderNdx].compileTimeUs);
+
+	if (!buildInfo.shaders.empty())
+		program->addStageTime(BUILDSTAGE_LINK, buildInfo.program.linkTimeUs);
+}
+
+void addStageTimes (const vk::SpirVProgramInfo& buildInfo, Program* program)
+{
+	program->addStageTime(BUILDSTAGE_ASSEMBLY, buildInfo.compileTimeUs);
+}
+
 void writeBuildLogs (const glu::ShaderProgramInfo& buildInfo, std::ostream& dst)
 {
 	for (size_t shaderNdx = 0; shaderNdx < buildInfo.shaders.size(); shaderNdx++)
@@ -245,13 +449,14 @@ class BuildHighLevelShaderTask : public Task
 {
 public:
 
-	BuildHighLevelShaderTask (const Source& source, Program* program)
+	BuildHighLevelShaderTask (const Source& source, Program* program, const BinaryCache* cache)
 		: m_source		(source)
 		, m_program		(program)
 		, m_commandLine	(0)
+		, m_cache		(cache)
 	{}
 
-	BuildHighLevelShaderTask (void) : m_program(DE_NULL) {}
+	BuildHighLevelShaderTask (void) : m_program(DE_NULL), m_cache(DE_NULL) {}
 
 	void setCommandline (const tcu::CommandLine &commandLine)
 	{
@@ -260,31 +465,53 @@ public:
 
 	void execute (void)
 	{
-		glu::ShaderProgramInfo buildInfo;
+		const deUint64			startTime	= deGetMicroseconds();
+		glu::ShaderProgramInfo	buildInfo;
+
+		DE_ASSERT(m_commandLine != DE_NULL);
 
-		try
+		m_program->validatorOptions	= m_source.buildOptions.getSpirvValidatorOptions();
+
+		if (m_cache)
+			m_program->binary = ProgramBinarySp(m_cache->load(computeCacheKey(m_source, *m_commandLine)));
+
+		if (m_program->binary)
 		{
-			DE_ASSERT(m_source.buildOptions.targetVersion < vk::SPIRV_VERSION_LAST);
-			DE_ASSERT(m_commandLine != DE_NULL);
-			m_program->binary			= ProgramBinarySp(vk::buildProgram(m_source, &buildInfo, *m_commandLine));
 			m_program->buildStatus		= Program::STATUS_PASSED;
-			m_program->validatorOptions	= m_source.buildOptions.getSpirvValidatorOptions();
+			m_program->loadedFromCache	= true;
 		}
-		catch (const tcu::Exception&)
+		else
 		{
-			std::ostringstream log;
+			try
+			{
+				DE_ASSERT(m_source.buildOptions.targetVersion < vk::SPIRV_VERSION_LAST);
+				m_program->binary			= ProgramBinarySp(vk::buildProgram(m_source, &buildInfo, *m_commandLine));
+				m_program->buildStatus		= Program::STATUS_PASSED;
 
-			writeBuildLogs(buildInfo, log);
+				if (m_cache)
+					m_cache->store(computeCacheKey(m_source, *m_commandLine), *m_program->binary);
+			}
+			catch (const tcu::Exception&)
+			{
+				std::ostringstream log;
 
-			m_program->buildStatus	= Program::STATUS_FAILED;
-			m_program->buildLog		= log.str();
+				writeBuildLogs(buildInfo, log);
+
+				m_program->buildStatus	= Program::STATUS_FAILED;
+				m_program->buildLog		= log.str();
+			}
+
+			addStageTimes(buildInfo, m_program);
 		}
+
+		m_program->buildTimeUs = deGetMicroseconds() - startTime;
 	}
 
 private:
 	Source					m_source;
 	Program*				m_program;
 	const tcu::CommandLine*	m_commandLine;
+	const BinaryCache*		m_cache;
 };
 
 void writeBuildLogs (const vk::SpirVProgramInfo& buildInfo, std::ostream& dst)
@@ -300,13 +527,14 @@ void writeBuildLogs (const vk::SpirVProgramInfo& buildInfo, std::ostream& dst)
 class BuildSpirVAsmTask : public Task
 {
 public:
-	BuildSpirVAsmTask (const vk::SpirVAsmSource& source, Program* program)
+	BuildSpirVAsmTask (const vk::SpirVAsmSource& source, Program* program, const BinaryCache* cache)
 		: m_source		(source)
 		, m_program		(program)
 		, m_commandLine	(0)
+		, m_cache		(cache)
 	{}
 
-	BuildSpirVAsmTask (void) : m_program(DE_NULL) {}
+	BuildSpirVAsmTask (void) : m_program(DE_NULL), m_cache(DE_NULL) {}
 
 	void setCommandline (const tcu::CommandLine &commandLine)
 	{
@@ -315,30 +543,51 @@ public:
 
 	void execute (void)
 	{
-		vk::SpirVProgramInfo buildInfo;
+		const deUint64			startTime	= deGetMicroseconds();
+		vk::SpirVProgramInfo	buildInfo;
+
+		DE_ASSERT(m_commandLine != DE_NULL);
+
+		if (m_cache)
+			m_program->binary = ProgramBinarySp(m_cache->load(computeCacheKey(m_source, *m_commandLine)));
 
-		try
+		if (m_program->binary)
 		{
-			DE_ASSERT(m_source.buildOptions.targetVersion < vk::SPIRV_VERSION_LAST);
-			DE_ASSERT(m_commandLine != DE_NULL);
-			m_program->binary		= ProgramBinarySp(vk::assembleProgram(m_source, &buildInfo, *m_commandLine));
-			m_program->buildStatus	= Program::STATUS_PASSED;
+			m_program->buildStatus		= Program::STATUS_PASSED;
+			m_program->loadedFromCache	= true;
 		}
-		catch (const tcu::Exception&)
+		else
 		{
-			std::ostringstream log;
+			try
+			{
+				DE_ASSERT(m_source.buildOptions.targetVersion < vk::SPIRV_VERSION_LAST);
+				m_program->binary		= ProgramBinarySp(vk::assembleProgram(m_source, &buildInfo, *m_commandLine));
+				m_program->buildStatus	= Program::STATUS_PASSED;
 
-			writeBuildLogs(buildInfo, log);
+				if (m_cache)
+					m_cache->store(computeCacheKey(m_source, *m_commandLine), *m_program->binary);
+			}
+			catch (const tcu::Exception&)
+			{
+				std::ostringstream log;
+
+				writeBuildLogs(buildInfo, log);
+
+				m_program->buildStatus	= Program::STATUS_FAILED;
+				m_program->buildLog		= log.str();
+			}
 
-			m_program->buildStatus	= Program::STATUS_FAILED;
-			m_program->buildLog		= log.str();
+			addStageTimes(buildInfo, m_program);
 		}
+
+		m_program->buildTimeUs = deGetMicroseconds() - startTime;
 	}
 
 private:
 	vk::SpirVAsmSource		m_source;
 	Program*				m_program;
 	const tcu::CommandLine*	m_commandLine;
+	const BinaryCache*		m_cache;
 };
 
 class ValidateBinaryTask : public Task
@@ -377,28 +626,65 @@ tcu::TestPackageRoot* createRoot (tcu::TestContext& testCtx)
 
 struct BuildStats
 {
-	int		numSucceeded;
-	int		numFailed;
-	int		notSupported;
+	int			numSucceeded;
+	int			numFailed;
+	int			notSupported;
+
+	int			numCacheHits;
+	int			numCacheMisses;
+
+	deUint64	buildTimeUs;					//!< Sum of build task times over all threads
+	deUint64	stageTimeUs[BUILDSTAGE_LAST];
+	int			stageCount[BUILDSTAGE_LAST];
 
 	BuildStats (void)
 		: numSucceeded	(0)
 		, numFailed		(0)
 		, notSupported	(0)
+		, numCacheHits	(0)
+		, numCacheMisses(0)
+		, buildTimeUs	(0)
 	{
+		for (int stage = 0; stage < BUILDSTAGE_LAST; stage++)
+		{
+			stageTimeUs[stage]	= 0;
+			stageCount[stage]	= 0;
+		}
 	}
 };
 
+void printBuildReport (const BuildStats& stats, deUint64 wallTimeUs, bool cacheEnabled)
+{
+	if (cacheEnabled)
+	{
+		const int numLookups = stats.numCacheHits + stats.numCacheMisses;
+
+		tcu::print("Binary cache: %d hits, %d misses (%.1f%% hit rate)\n",
+				   stats.numCacheHits, stats.numCacheMisses,
+				   (numLookups > 0) ? (100.0 * (double)stats.numCacheHits / (double)numLookups) : 0.0);
+	}
+
+	tcu::print("Build time: %.2f s wall clock, %.2f s in build tasks\n", (double)wallTimeUs / 1e6, (double)stats.buildTimeUs / 1e6);
+
+	for (int stage = 0; stage < BUILDSTAGE_LAST; stage++)
+	{
+		if (stats.stageCount[stage] > 0)
+			tcu::print("  %-24s %8d compiled, %10.2f s\n", getBuildStageName(stage), stats.stageCount[stage], (double)stats.stageTimeUs[stage] / 1e6);
+	}
+}
+
 BuildStats buildPrograms (tcu::TestContext&			testCtx,
 						  const std::string&		dstPath,
 						  const bool				validateBinaries,
 						  const deUint32			usedVulkanVersion,
 						  const vk::SpirvVersion	baselineSpirvVersion,
-						  const vk::SpirvVersion	maxSpirvVersion)
+						  const vk::SpirvVersion	maxSpirvVersion,
+						  const std::string&		binaryCachePath)
 {
 	const deUint32						numThreads			= deGetNumAvailableLogicalCores();
 
 	TaskExecutor						executor			(numThreads);
+	const UniquePtr<BinaryCache>		binaryCache			(binaryCachePath.empty() ? DE_NULL : new BinaryCache(binaryCachePath));
 
 	// de::PoolArray<> is faster to build than std::vector
 	de::MemPool							programPool;
@@ -450,7 +736,7 @@ BuildStats buildPrograms (tcu::TestContext&			testCtx,
 							continue;
 
 						programs.pushBack(Program(vk::ProgramIdentifier(casePath, progIter.getName()), progIter.getProgram().buildOptions.getSpirvValidatorOptions()));
-						buildGlslTasks.pushBack(BuildHighLevelShaderTask<vk::GlslSource>(progIter.getProgram(), &programs.back()));
+						buildGlslTasks.pushBack(BuildHighLevelShaderTask<vk::GlslSource>(progIter.getProgram(), &programs.back(), binaryCache.get()));
 						buildGlslTasks.back().setCommandline(testCtx.getCommandLine());
 						executor.submit(&buildGlslTasks.back());
 					}
@@ -464,7 +750,7 @@ BuildStats buildPrograms (tcu::TestContext&			testCtx,
 							continue;
 
 						programs.pushBack(Program(vk::ProgramIdentifier(casePath, progIter.getName()), progIter.getProgram().buildOptions.getSpirvValidatorOptions()));
-						buildHlslTasks.pushBack(BuildHighLevelShaderTask<vk::HlslSource>(progIter.getProgram(), &programs.back()));
+						buildHlslTasks.pushBack(BuildHighLevelShaderTask<vk::HlslSource>(progIter.getProgram(), &programs.back(), binaryCache.get()));
 						buildHlslTasks.back().setCommandline(testCtx.getCommandLine());
 						executor.submit(&buildHlslTasks.back());
 					}
@@ -478,7 +764,7 @@ BuildStats buildPrograms (tcu::TestContext&			testCtx,
 							continue;
 
 						programs.pushBack(Program(vk::ProgramIdentifier(casePath, progIter.getName()), progIter.getProgram().buildOptions.getSpirvValidatorOptions()));
-						buildSpirvAsmTasks.pushBack(BuildSpirVAsmTask(progIter.getProgram(), &programs.back()));
+						buildSpirvAsmTasks.pushBack(BuildSpirVAsmTask(progIter.getProgram(), &programs.back(), binaryCache.get()));
 						buildSpirvAsmTasks.back().setCommandline(testCtx.getCommandLine());
 						executor.submit(&buildSpirvAsmTasks.back());
 					}
@@ -492,6 +778,8 @@ BuildStats buildPrograms (tcu::TestContext&			testCtx,
 		executor.waitForComplete();
 	}
 
+	vk::closeShaderCache();
+
 	if (validateBinaries)
 	{
 		std::vector<ValidateBinaryTask>	validationTasks;
@@ -530,6 +818,25 @@ BuildStats buildPrograms (tcu::TestContext&			testCtx,
 			const bool	buildOk			= progIter->buildStatus == Program::STATUS_PASSED;
 			const bool	validationOk	= progIter->validationStatus != Program::STATUS_FAILED;
 
+			if (binaryCache)
+			{
+				if (progIter->loadedFromCache)
+					stats.numCacheHits += 1;
+				else
+					stats.numCacheMisses += 1;
+			}
+
+			stats.buildTimeUs += progIter->buildTimeUs;
+
+			for (int stage = 0; stage < BUILDSTAGE_LAST; stage++)
+			{
+				if (progIter->stageUsed[stage])
+				{
+					stats.stageTimeUs[stage]	+= progIter->stageTimeUs[stage];
+					stats.stageCount[stage]		+= 1;
+				}
+			}
+
 			if (buildOk && validationOk)
 				stats.numSucceeded += 1;
 			else
@@ -561,6 +868,7 @@ DE_DECLARE_COMMAND_LINE_OPT(ShaderCacheFilename,	std::string);
 DE_DECLARE_COMMAND_LINE_OPT(ShaderCacheTruncate,	bool);
 DE_DECLARE_COMMAND_LINE_OPT(SpirvOptimize,			bool);
 DE_DECLARE_COMMAND_LINE_OPT(SpirvOptimizationRecipe,std::string);
+DE_DECLARE_COMMAND_LINE_OPT(BinaryCache,			std::string);
 
 static const de::cmdline::NamedValue<bool> s_enableNames[] =
 {
@@ -589,7 +897,8 @@ void registerOptions (de::cmdline::Parser& parser)
 		<< Option<opt::ShaderCacheFilename>("r", "shadercache-filename", "Write shader cache to given file", "shadercache.bin")
 		<< Option<opt::ShaderCacheTruncate>("x", "shadercache-truncate", "Truncate shader cache before running", s_enableNames, "enable")
 		<< Option<opt::SpirvOptimize>("o", "deqp-optimize-spirv", "Enable optimization for SPIR-V", s_enableNames, "disable")
-		<< Option<opt::SpirvOptimizationRecipe>("p","deqp-optimization-recipe", "Shader optimization recipe");
+		<< Option<opt::SpirvOptimizationRecipe>("p","deqp-optimization-recipe", "Shader optimization recipe")
+		<< Option<opt::BinaryCache>("c", "binary-cache", "Persistent binary cache directory, reused across runs (disabled if empty)", "");
 }
 
 } // opt
@@ -676,12 +985,16 @@ int main (int argc, const char* argv[])
 					getSpirvVersionName(baselineSpirvVersion).c_str(),
 					getSpirvVersionName(maxSpirvVersion).c_str());
 
+		const deUint64			startTime	= deGetMicroseconds();
 		const vkt::BuildStats	stats		= vkt::buildPrograms(testCtx,
 																 cmdLine.getOption<opt::DstPath>(),
 																 cmdLine.getOption<opt::Validate>(),
 																 cmdLine.getOption<opt::VulkanVersion>(),
 																 baselineSpirvVersion,
-																 maxSpirvVersion);
+																 maxSpirvVersion,
+																 cmdLine.getOption<opt::BinaryCache>());
+
+		vkt::printBuildReport(stats, deGetMicroseconds() - startTime, !cmdLine.getOption<opt::BinaryCache>().empty());
 
 		tcu::print("DONE: %d passed, %d failed, %d not supported\n", stats.numSucceeded, stats.numFailed, stats.notSupported);
 
@@ -30,6 +30,7 @@
 #include "vkMemUtil.hpp"
 #include "vkPlatform.hpp"
 #include "vkDebugReportUtil.hpp"
+#include "vkPipelineCacheUtil.hpp"
 
 #include "tcuCommandLine.hpp"
 
@@ -435,6 +436,14 @@ public:
 	}
 };
 
+PersistentPipelineCache* createPersistentPipelineCache (const DeviceInterface& vkd, VkDevice device, const VkPhysicalDeviceProperties& deviceProperties, const tcu::CommandLine& cmdLine)
+{
+	if (cmdLine.isVKPipelineCacheEnabled())
+		return new PersistentPipelineCache(vkd, device, deviceProperties, cmdLine.getVKPipelineCacheDir());
+	else
+		return DE_NULL;
+}
+
 } // anonymous
 
 class DefaultDevice
@@ -466,6 +475,7 @@ public:
 	const DeviceInterface&									getDeviceInterface					(void) const	{ return m_deviceInterface;									}
 	const VkPhysicalDeviceProperties&						getDeviceProperties					(void) const	{ return m_deviceProperties;								}
 	const vector<string>&									getDeviceExtensions					(void) const	{ return m_deviceExtensions;								}
+	VkPipelineCache											getPipelineCache					(void) const	{ return m_deviceInterface.getPipelineCache();				}
 
 	deUint32												getUsedApiVersion					(void) const	{ return m_usedApiVersion;									}
 
@@ -496,7 +506,8 @@ private:
 	const VkPhysicalDeviceProperties	m_deviceProperties;
 
 	const Unique<VkDevice>				m_device;
-	const DeviceDriver					m_deviceInterface;
+	PipelineCacheDeviceDriver			m_deviceInterface;
+	const de::UniquePtr<PersistentPipelineCache>	m_pipelineCache;
 
 };
 
@@ -524,8 +535,12 @@ DefaultDevice::DefaultDevice (const PlatformInterface& vkPlatform, const tcu::Co
 	, m_deviceProperties			(getPhysicalDeviceProperties(m_instanceInterface, m_physicalDevice))
 	, m_device						(createDefaultDevice(vkPlatform, *m_instance, m_instanceInterface, m_physicalDevice, m_usedApiVersion, m_universalQueueFamilyIndex, m_sparseQueueFamilyIndex, m_deviceFeatures.coreFeatures, m_deviceExtensions, cmdLine))
 	, m_deviceInterface				(vkPlatform, *m_instance, *m_device)
+	, m_pipelineCache				(createPersistentPipelineCache(m_deviceInterface, *m_device, m_deviceProperties, cmdLine))
 {
 	DE_ASSERT(m_deviceVersions.first == m_deviceVersion);
+
+	if (m_pipelineCache)
+		m_deviceInterface.setPipelineCache(m_pipelineCache->get(), cmdLine.isVKPipelineCacheSizeStatsEnabled());
 }
 
 DefaultDevice::~DefaultDevice (void)
@@ -549,12 +564,14 @@ namespace
 {
 // Allocator utilities
 
-vk::Allocator* createAllocator (DefaultDevice* device)
+vk::Allocator* createAllocator (DefaultDevice* device, const tcu::CommandLine& cmdLine)
 {
 	const VkPhysicalDeviceMemoryProperties memoryProperties = vk::getPhysicalDeviceMemoryProperties(device->getInstanceInterface(), device->getPhysicalDevice());
 
-	// \todo [2015-07-24 jarkko] support allocator selection/configuration from command line (or compile time)
-	return new SimpleAllocator(device->getDeviceInterface(), device->getDevice(), memoryProperties);
+	if (cmdLine.isVKSuballocationEnabled())
+		return new SuballocatingAllocator(device->getDeviceInterface(), device->getDevice(), memoryProperties, device->getDeviceProperties().limits);
+	else
+		return new SimpleAllocator(device->getDeviceInterface(), device->getDevice(), memoryProperties);
 }
 
 } // anonymous
@@ -568,7 +585,7 @@ Context::Context (tcu::TestContext&				testCtx,
 	, m_platformInterface	(platformInterface)
 	, m_progCollection		(progCollection)
 	, m_device				(new DefaultDevice(m_platformInterface, testCtx.getCommandLine()))
-	, m_allocator			(createAllocator(m_device.get()))
+	, m_allocator			(createAllocator(m_device.get(), testCtx.getCommandLine()))
 {
 }
 
@@ -614,6 +631,7 @@ vk::VkQueue								Context::getUniversalQueue				(void) const { return m_device-
 deUint32								Context::getSparseQueueFamilyIndex		(void) const { return m_device->getSparseQueueFamilyIndex();	}
 vk::VkQueue								Context::getSparseQueue					(void) const { return m_device->getSparseQueue();				}
 vk::Allocator&							Context::getDefaultAllocator			(void) const { return *m_allocator;								}
+vk::VkPipelineCache						Context::getPipelineCache				(void) const { return m_device->getPipelineCache();				}
 deUint32								Context::getUsedApiVersion				(void) const { return m_device->getUsedApiVersion();			}
 bool									Context::contextSupports				(const deUint32 majorNum, const deUint32 minorNum, const deUint32 patchNum) const
 																							{ return m_device->getUsedApiVersion() >= VK_MAKE_VERSION(majorNum, minorNum, patchNum); }
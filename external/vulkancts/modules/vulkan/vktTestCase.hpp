@@ -100,6 +100,10 @@ public:
 	deUint32									getSparseQueueFamilyIndex		(void) const;
 	vk::VkQueue									getSparseQueue					(void) const;
 	vk::Allocator&								getDefaultAllocator				(void) const;
+
+	// Shared persistent pipeline cache, VK_NULL_HANDLE unless enabled with --deqp-vk-pipeline-cache
+	vk::VkPipelineCache							getPipelineCache				(void) const;
+
 	bool										contextSupports					(const deUint32 majorNum, const deUint32 minorNum, const deUint32 patchNum) const;
 	bool										contextSupports					(const vk::ApiVersion version) const;
 	bool										contextSupports					(const deUint32 requiredApiVersionBits) const;
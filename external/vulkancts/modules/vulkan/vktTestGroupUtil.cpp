@@ -44,4 +44,47 @@ void TestGroupHelper0::init (void)
 	m_createChildren(this);
 }
 
+LazyTestGroup::LazyTestGroup (tcu::TestContext&		testCtx,
+							  const std::string&	name,
+							  const std::string&	description,
+							  CreateGroupFunc		createGroup)
+	: tcu::TestCaseGroup	(testCtx, name.c_str(), description.c_str())
+	, m_createGroup			(createGroup)
+{
+}
+
+LazyTestGroup::~LazyTestGroup (void)
+{
+	LazyTestGroup::deinit();
+}
+
+void LazyTestGroup::init (void)
+{
+	std::vector<tcu::TestNode*> children;
+
+	DE_ASSERT(!m_group);
+
+	m_group = de::MovePtr<tcu::TestCaseGroup>(m_createGroup(m_testCtx));
+	TCU_CHECK_INTERNAL(m_group->getName() == std::string(getName()));
+
+	// Factory may itself defer creation of children until init().
+	m_group->init();
+	m_group->releaseChildren(children);
+
+	for (size_t childNdx = 0; childNdx < children.size(); childNdx++)
+		addChild(children[childNdx]);
+}
+
+void LazyTestGroup::deinit (void)
+{
+	// Children may refer to resources owned by the created group.
+	tcu::TestCaseGroup::deinit();
+
+	if (m_group)
+	{
+		m_group->deinit();
+		m_group.clear();
+	}
+}
+
 } // vkt
@@ -25,6 +25,7 @@
 
 #include "tcuDefs.hpp"
 #include "tcuTestCase.hpp"
+#include "deUniquePtr.hpp"
 
 namespace vkt
 {
@@ -69,6 +70,43 @@ private:
 	const Arg0					m_arg0;
 };
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Test group that creates its contents from a group factory
+ *
+ * The factory is not called until the group is entered by the test
+ * hierarchy iterator, so groups excluded by the case list filter are never
+ * created. The created group's children are adopted on init() and destroyed
+ * on deinit(), so the subtree only exists while it is being executed.
+ *
+ * Name of the factory-created group must match name of this group.
+ *//*--------------------------------------------------------------------*/
+class LazyTestGroup : public tcu::TestCaseGroup
+{
+public:
+	typedef tcu::TestCaseGroup* (*CreateGroupFunc) (tcu::TestContext& testCtx);
+
+										LazyTestGroup	(tcu::TestContext&		testCtx,
+														 const std::string&		name,
+														 const std::string&		description,
+														 CreateGroupFunc		createGroup);
+										~LazyTestGroup	(void);
+
+	void								init			(void);
+	void								deinit			(void);
+
+private:
+	const CreateGroupFunc				m_createGroup;
+	de::MovePtr<tcu::TestCaseGroup>		m_group;
+};
+
+inline tcu::TestCaseGroup* createLazyTestGroup (tcu::TestContext&				testCtx,
+												const std::string&				name,
+												const std::string&				description,
+												LazyTestGroup::CreateGroupFunc	createGroup)
+{
+	return new LazyTestGroup(testCtx, name, description, createGroup);
+}
+
 inline tcu::TestCaseGroup* createTestGroup (tcu::TestContext&						testCtx,
 											const std::string&						name,
 											const std::string&						description,
@@ -27,6 +27,7 @@
 #include "tcuTestCase.hpp"
 #include "tcuTestLog.hpp"
 #include "tcuCommandLine.hpp"
+#include "tcuTestProfiler.hpp"
 
 #include "vkPlatform.hpp"
 #include "vkPrograms.hpp"
@@ -36,6 +37,8 @@
 #include "vkQueryUtil.hpp"
 #include "vkApiVersion.hpp"
 #include "vkRenderDocUtil.hpp"
+#include "vkMemUtil.hpp"
+#include "vkPipelineCacheUtil.hpp"
 
 #include "deUniquePtr.hpp"
 
@@ -228,6 +231,9 @@ TestCaseExecutor::TestCaseExecutor (tcu::TestContext& testCtx)
 TestCaseExecutor::~TestCaseExecutor (void)
 {
 	delete m_instance;
+
+	// Session ends with executor
+	vk::closeShaderCache();
 }
 
 void TestCaseExecutor::init (tcu::TestCase* testCase, const std::string& casePath)
@@ -242,77 +248,97 @@ void TestCaseExecutor::init (tcu::TestCase* testCase, const std::string& casePat
 	vk::SourceCollections		sourceProgs					(usedVulkanVersion, defaultGlslBuildOptions, defaultHlslBuildOptions, defaultSpirvAsmBuildOptions);
 	const bool					doShaderLog					= log.isShaderLoggingEnabled();
 	const tcu::CommandLine&		commandLine					= m_context.getTestContext().getCommandLine();
+	tcu::TestProfiler* const	profiler					= m_context.getTestContext().getProfiler();
 
 	DE_UNREF(casePath); // \todo [2015-03-13 pyry] Use this to identify ProgramCollection storage path
 
 	if (!vktCase)
 		TCU_THROW(InternalError, "Test node not an instance of vkt::TestCase");
 
-	vktCase->checkSupport(m_context);
+	{
+		const tcu::ScopedProfilePhase	phase	(profiler, "checkSupport");
+		vktCase->checkSupport(m_context);
+	}
 
 	m_progCollection.clear();
-	vktCase->initPrograms(sourceProgs);
 
-	for (vk::GlslSourceCollection::Iterator progIter = sourceProgs.glslSources.begin(); progIter != sourceProgs.glslSources.end(); ++progIter)
 	{
-		if (progIter.getProgram().buildOptions.targetVersion > vk::getMaxSpirvVersionForGlsl(m_context.getUsedApiVersion()))
-			TCU_THROW(NotSupportedError, "Shader requires SPIR-V higher than available");
+		const tcu::ScopedProfilePhase	phase	(profiler, "initPrograms");
+		vktCase->initPrograms(sourceProgs);
+	}
 
-		const vk::ProgramBinary* const binProg = buildProgram<glu::ShaderProgramInfo, vk::GlslSourceCollection::Iterator>(casePath, progIter, m_prebuiltBinRegistry, log, &m_progCollection, commandLine);
+	// Compile programs or load them from prebuilt binaries / shader cache
+	{
+		const tcu::ScopedProfilePhase	phase	(profiler, "buildPrograms");
 
-		if (doShaderLog)
+		for (vk::GlslSourceCollection::Iterator progIter = sourceProgs.glslSources.begin(); progIter != sourceProgs.glslSources.end(); ++progIter)
 		{
-			try
-			{
-				std::ostringstream disasm;
+			if (progIter.getProgram().buildOptions.targetVersion > vk::getMaxSpirvVersionForGlsl(m_context.getUsedApiVersion()))
+				TCU_THROW(NotSupportedError, "Shader requires SPIR-V higher than available");
 
-				vk::disassembleProgram(*binProg, &disasm);
+			const vk::ProgramBinary* const binProg = buildProgram<glu::ShaderProgramInfo, vk::GlslSourceCollection::Iterator>(casePath, progIter, m_prebuiltBinRegistry, log, &m_progCollection, commandLine);
 
-				log << vk::SpirVAsmSource(disasm.str());
-			}
-			catch (const tcu::NotSupportedError& err)
+			if (doShaderLog)
 			{
-				log << err;
+				try
+				{
+					std::ostringstream disasm;
+
+					vk::disassembleProgram(*binProg, &disasm);
+
+					log << vk::SpirVAsmSource(disasm.str());
+				}
+				catch (const tcu::NotSupportedError& err)
+				{
+					log << err;
+				}
 			}
 		}
-	}
-
-	for (vk::HlslSourceCollection::Iterator progIter = sourceProgs.hlslSources.begin(); progIter != sourceProgs.hlslSources.end(); ++progIter)
-	{
-		if (progIter.getProgram().buildOptions.targetVersion > vk::getMaxSpirvVersionForGlsl(m_context.getUsedApiVersion()))
-			TCU_THROW(NotSupportedError, "Shader requires SPIR-V higher than available");
 
-		const vk::ProgramBinary* const binProg = buildProgram<glu::ShaderProgramInfo, vk::HlslSourceCollection::Iterator>(casePath, progIter, m_prebuiltBinRegistry, log, &m_progCollection, commandLine);
-
-		if (doShaderLog)
+		for (vk::HlslSourceCollection::Iterator progIter = sourceProgs.hlslSources.begin(); progIter != sourceProgs.hlslSources.end(); ++progIter)
 		{
-			try
-			{
-				std::ostringstream disasm;
+			if (progIter.getProgram().buildOptions.targetVersion > vk::getMaxSpirvVersionForGlsl(m_context.getUsedApiVersion()))
+				TCU_THROW(NotSupportedError, "Shader requires SPIR-V higher than available");
 
-				vk::disassembleProgram(*binProg, &disasm);
+			const vk::ProgramBinary* const binProg = buildProgram<glu::ShaderProgramInfo, vk::HlslSourceCollection::Iterator>(casePath, progIter, m_prebuiltBinRegistry, log, &m_progCollection, commandLine);
 
-				log << vk::SpirVAsmSource(disasm.str());
-			}
-			catch (const tcu::NotSupportedError& err)
+			if (doShaderLog)
 			{
-				log << err;
+				try
+				{
+					std::ostringstream disasm;
+
+					vk::disassembleProgram(*binProg, &disasm);
+
+					log << vk::SpirVAsmSource(disasm.str());
+				}
+				catch (const tcu::NotSupportedError& err)
+				{
+					log << err;
+				}
 			}
 		}
-	}
 
-	for (vk::SpirVAsmCollection::Iterator asmIterator = sourceProgs.spirvAsmSources.begin(); asmIterator != sourceProgs.spirvAsmSources.end(); ++asmIterator)
-	{
-		if (asmIterator.getProgram().buildOptions.targetVersion > vk::getMaxSpirvVersionForAsm(m_context.getUsedApiVersion()))
-			TCU_THROW(NotSupportedError, "Shader requires SPIR-V higher than available");
+		for (vk::SpirVAsmCollection::Iterator asmIterator = sourceProgs.spirvAsmSources.begin(); asmIterator != sourceProgs.spirvAsmSources.end(); ++asmIterator)
+		{
+			if (asmIterator.getProgram().buildOptions.targetVersion > vk::getMaxSpirvVersionForAsm(m_context.getUsedApiVersion()))
+				TCU_THROW(NotSupportedError, "Shader requires SPIR-V higher than available");
 
-		buildProgram<vk::SpirVProgramInfo, vk::SpirVAsmCollection::Iterator>(casePath, asmIterator, m_prebuiltBinRegistry, log, &m_progCollection, commandLine);
+			buildProgram<vk::SpirVProgramInfo, vk::SpirVAsmCollection::Iterator>(casePath, asmIterator, m_prebuiltBinRegistry, log, &m_progCollection, commandLine);
+		}
 	}
 
 	if (m_renderDoc) m_renderDoc->startFrame(m_context.getInstance());
 
+	if (const vk::PipelineCacheDeviceDriver* const driver = dynamic_cast<const vk::PipelineCacheDeviceDriver*>(&m_context.getDeviceInterface()))
+		driver->resetStatistics();
+
 	DE_ASSERT(!m_instance);
-	m_instance = vktCase->createInstance(m_context);
+
+	{
+		const tcu::ScopedProfilePhase	phase	(profiler, "createInstance");
+		m_instance = vktCase->createInstance(m_context);
+	}
 }
 
 void TestCaseExecutor::deinit (tcu::TestCase*)
@@ -322,6 +348,41 @@ void TestCaseExecutor::deinit (tcu::TestCase*)
 
 	if (m_renderDoc) m_renderDoc->endFrame(m_context.getInstance());
 
+	// Report memory usage of the case and release its memory blocks
+	if (vk::SuballocatingAllocator* const allocator = dynamic_cast<vk::SuballocatingAllocator*>(&m_context.getDefaultAllocator()))
+	{
+		const vk::AllocatorStatistics	stats	= allocator->getStatistics();
+
+		if (stats.numAllocations > 0)
+		{
+			m_context.getTestContext().getLog()
+				<< tcu::TestLog::Message
+				<< "Default allocator: " << stats.numAllocations << " allocations in " << stats.numDeviceMemoryAllocations << " device memory allocations, "
+				<< "peak " << stats.peakBytesInUse << " bytes used of " << stats.peakDeviceMemorySize << " bytes allocated"
+				<< tcu::TestLog::EndMessage;
+		}
+
+		allocator->reset();
+	}
+
+	// Report pipelines created through the shared pipeline cache
+	if (const vk::PipelineCacheDeviceDriver* const driver = dynamic_cast<const vk::PipelineCacheDeviceDriver*>(&m_context.getDeviceInterface()))
+	{
+		const vk::PipelineCacheStatistics	stats	= driver->getStatistics();
+
+		if (stats.numCreatedPipelines > 0)
+		{
+			tcu::MessageBuilder msg (&m_context.getTestContext().getLog());
+
+			msg << "Pipeline cache: " << stats.numCreatedPipelines << " pipelines created through shared cache";
+
+			if (stats.hasDataSizeGrowth)
+				msg << ", cache data size grew by " << stats.dataSizeGrowth << " bytes";
+
+			msg << tcu::TestLog::EndMessage;
+		}
+	}
+
 	// Collect and report any debug messages
 	if (m_debugReportRecorder)
 	{
@@ -463,39 +524,40 @@ tcu::TestCaseExecutor* TestPackage::createExecutor (void) const
 
 void TestPackage::init (void)
 {
-	addChild(createTestGroup				(m_testCtx, "info", "Build and Device Info Tests", createInfoTests));
-	addChild(api::createTests				(m_testCtx));
-	addChild(memory::createTests			(m_testCtx));
-	addChild(pipeline::createTests			(m_testCtx));
-	addChild(BindingModel::createTests		(m_testCtx));
-	addChild(SpirVAssembly::createTests		(m_testCtx));
-	addChild(createTestGroup				(m_testCtx, "glsl", "GLSL shader execution tests", createGlslTests));
-	addChild(createRenderPassTests			(m_testCtx));
-	addChild(createRenderPass2Tests			(m_testCtx));
-	addChild(ubo::createTests				(m_testCtx));
-	addChild(DynamicState::createTests		(m_testCtx));
-	addChild(ssbo::createTests				(m_testCtx));
-	addChild(QueryPool::createTests			(m_testCtx));
-	addChild(Draw::createTests				(m_testCtx));
-	addChild(compute::createTests			(m_testCtx));
-	addChild(image::createTests				(m_testCtx));
-	addChild(wsi::createTests				(m_testCtx));
-	addChild(synchronization::createTests	(m_testCtx));
-	addChild(sparse::createTests			(m_testCtx));
-	addChild(tessellation::createTests		(m_testCtx));
-	addChild(rasterization::createTests		(m_testCtx));
-	addChild(clipping::createTests			(m_testCtx));
-	addChild(FragmentOperations::createTests(m_testCtx));
-	addChild(texture::createTests			(m_testCtx));
-	addChild(geometry::createTests			(m_testCtx));
-	addChild(robustness::createTests		(m_testCtx));
-	addChild(MultiView::createTests			(m_testCtx));
-	addChild(subgroups::createTests			(m_testCtx));
-	addChild(ycbcr::createTests				(m_testCtx));
-	addChild(ProtectedMem::createTests		(m_testCtx));
-	addChild(DeviceGroup::createTests		(m_testCtx));
-	addChild(MemoryModel::createTests		(m_testCtx));
-	addChild(conditional::createTests		(m_testCtx));
+	// \note Groups are created only when the test hierarchy iterator enters them.
+	addChild(createTestGroup				(m_testCtx, "info",						"Build and Device Info Tests",			createInfoTests));
+	addChild(createLazyTestGroup			(m_testCtx, "api",						"API Tests",							api::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "memory",					"Memory Tests",							memory::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "pipeline",					"Pipeline Tests",						pipeline::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "binding_model",			"Resource binding tests",				BindingModel::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "spirv_assembly",			"SPIR-V Assembly tests",				SpirVAssembly::createTests));
+	addChild(createTestGroup				(m_testCtx, "glsl",						"GLSL shader execution tests",			createGlslTests));
+	addChild(createLazyTestGroup			(m_testCtx, "renderpass",				"RenderPass Tests",						createRenderPassTests));
+	addChild(createLazyTestGroup			(m_testCtx, "renderpass2",				"RenderPass2 Tests",					createRenderPass2Tests));
+	addChild(createLazyTestGroup			(m_testCtx, "ubo",						"Uniform Block tests",					ubo::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "dynamic_state",			"Dynamic State Tests",					DynamicState::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "ssbo",						"Shader Storage Buffer Object Tests",	ssbo::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "query_pool",				"query pool tests",						QueryPool::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "draw",						"Spimple Draw tests",					Draw::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "compute",					"Compute shader tests",					compute::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "image",					"Image tests",							image::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "wsi",						"WSI Tests",							wsi::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "synchronization",			"Synchronization tests",				synchronization::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "sparse_resources",			"Sparse Resources Tests",				sparse::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "tessellation",				"Tessellation tests",					tessellation::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "rasterization",			"Rasterization Tests",					rasterization::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "clipping",					"Clipping tests",						clipping::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "fragment_operations",		"Fragment operations tests",			FragmentOperations::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "texture",					"Texture Tests",						texture::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "geometry",					"Geometry shader tests",				geometry::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "robustness",				"",										robustness::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "multiview",				"MultiView render tests",				MultiView::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "subgroups",				"Subgroups tests",						subgroups::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "ycbcr",					"YCbCr Conversion Tests",				ycbcr::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "protected_memory",			"Protected Memory Tests",				ProtectedMem::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "device_group",				"Testing device group test cases",		DeviceGroup::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "memory_model",				"Memory model tests",					MemoryModel::createTests));
+	addChild(createLazyTestGroup			(m_testCtx, "conditional_rendering",	"Conditional Rendering Tests",			conditional::createTests));
 }
 
 } // vkt
@@ -1162,6 +1162,8 @@ def writeNullDriverImpl (api, filename):
 				"vkGetPhysicalDeviceFormatProperties",
 				"vkGetPhysicalDeviceImageFormatProperties",
 				"vkGetDeviceQueue",
+				"vkGetPipelineCacheData",
+				"vkMergePipelineCaches",
 				"vkGetBufferMemoryRequirements",
 				"vkGetBufferMemoryRequirements2KHR",
 				"vkGetImageMemoryRequirements",
@@ -28,6 +28,7 @@
 #include "tcuTestHierarchyUtil.hpp"
 #include "tcuCommandLine.hpp"
 #include "tcuTestLog.hpp"
+#include "tcuParallelFor.hpp"
 
 #include "qpInfo.h"
 #include "qpDebugOut.h"
@@ -105,6 +106,9 @@ App::App (Platform& platform, Archive& archive, TestLog& log, const CommandLine&
 		if (cmdLine.isCrashHandlingEnabled())
 			TCU_CHECK_INTERNAL(m_crashHandler = qpCrashHandler_create(onCrash, this));
 
+		// Reference computation and result verification threads
+		setDefaultParallelForThreadCount(de::max(0, cmdLine.getVerificationThreadCount()));
+
 		// Create test context
 		m_testCtx = new TestContext(m_platform, archive, log, cmdLine, m_watchDog);
 
@@ -120,6 +124,8 @@ App::App (Platform& platform, Archive& archive, TestLog& log, const CommandLine&
 			writeXmlCaselistsToFiles(*m_testRoot, *m_testCtx, cmdLine);
 		else if (runMode == RUNMODE_DUMP_TEXT_CASELIST)
 			writeTxtCaselistsToFiles(*m_testRoot, *m_testCtx, cmdLine);
+		else if (runMode == RUNMODE_DUMP_BINARY_CASELIST)
+			writeBinCaselistsToFiles(*m_testRoot, *m_testCtx, cmdLine);
 		else
 			DE_ASSERT(false);
 	}
@@ -30,6 +30,8 @@
 #include "deString.h"
 #include "deInt32.h"
 #include "deCommandLine.h"
+#include "deMemory.h"
+#include "deMappedFile.h"
 #include "qpTestLog.h"
 #include "qpDebugOut.h"
 
@@ -38,6 +40,8 @@
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <algorithm>
 
 using std::string;
 using std::vector;
@@ -61,6 +65,7 @@ DE_DECLARE_COMMAND_LINE_OPT(CaseListFile,				std::string);
 DE_DECLARE_COMMAND_LINE_OPT(CaseListResource,			std::string);
 DE_DECLARE_COMMAND_LINE_OPT(StdinCaseList,				bool);
 DE_DECLARE_COMMAND_LINE_OPT(LogFilename,				std::string);
+DE_DECLARE_COMMAND_LINE_OPT(ProfileFilename,			std::string);
 DE_DECLARE_COMMAND_LINE_OPT(RunMode,					tcu::RunMode);
 DE_DECLARE_COMMAND_LINE_OPT(ExportFilenamePattern,		std::string);
 DE_DECLARE_COMMAND_LINE_OPT(WatchDog,					bool);
@@ -87,14 +92,25 @@ DE_DECLARE_COMMAND_LINE_OPT(LogShaderSources,			bool);
 DE_DECLARE_COMMAND_LINE_OPT(TestOOM,					bool);
 DE_DECLARE_COMMAND_LINE_OPT(VKDeviceID,					int);
 DE_DECLARE_COMMAND_LINE_OPT(VKDeviceGroupID,			int);
+DE_DECLARE_COMMAND_LINE_OPT(VKSuballocation,			bool);
+DE_DECLARE_COMMAND_LINE_OPT(VKPipelineCache,			bool);
+DE_DECLARE_COMMAND_LINE_OPT(VKPipelineCacheDir,			std::string);
+DE_DECLARE_COMMAND_LINE_OPT(VKPipelineCacheSizeStats,	bool);
 DE_DECLARE_COMMAND_LINE_OPT(LogFlush,					bool);
+DE_DECLARE_COMMAND_LINE_OPT(LogAsync,					bool);
+DE_DECLARE_COMMAND_LINE_OPT(LogImageThreads,			bool);
+DE_DECLARE_COMMAND_LINE_OPT(LogImageCompression,		deUint32);
 DE_DECLARE_COMMAND_LINE_OPT(Validation,					bool);
 DE_DECLARE_COMMAND_LINE_OPT(ShaderCache,				bool);
 DE_DECLARE_COMMAND_LINE_OPT(ShaderCacheFilename,		std::string);
 DE_DECLARE_COMMAND_LINE_OPT(Optimization,				int);
 DE_DECLARE_COMMAND_LINE_OPT(OptimizeSpirv,				bool);
 DE_DECLARE_COMMAND_LINE_OPT(ShaderCacheTruncate,		bool);
+DE_DECLARE_COMMAND_LINE_OPT(ShaderLibraryCache,			bool);
+DE_DECLARE_COMMAND_LINE_OPT(ShaderLibraryCacheDir,		std::string);
 DE_DECLARE_COMMAND_LINE_OPT(RenderDoc,					bool);
+DE_DECLARE_COMMAND_LINE_OPT(RefRendererThreadCount,		int);
+DE_DECLARE_COMMAND_LINE_OPT(VerificationThreadCount,	int);
 
 static void parseIntList (const char* src, std::vector<int>* dst)
 {
@@ -124,7 +140,8 @@ void registerOptions (de::cmdline::Parser& parser)
 		{ "execute",		RUNMODE_EXECUTE				},
 		{ "xml-caselist",	RUNMODE_DUMP_XML_CASELIST	},
 		{ "txt-caselist",	RUNMODE_DUMP_TEXT_CASELIST	},
-		{ "stdout-caselist",RUNMODE_DUMP_STDOUT_CASELIST}
+		{ "stdout-caselist",RUNMODE_DUMP_STDOUT_CASELIST},
+		{ "bin-caselist",	RUNMODE_DUMP_BINARY_CASELIST}
 	};
 	static const NamedValue<WindowVisibility> s_visibilites[] =
 	{
@@ -147,6 +164,12 @@ void registerOptions (de::cmdline::Parser& parser)
 		{ "180",			SCREENROTATION_180			},
 		{ "270",			SCREENROTATION_270			}
 	};
+	static const NamedValue<deUint32> s_imageCompressionModes[] =
+	{
+		{ "default",		0									},
+		{ "fast",			QP_TEST_LOG_FAST_IMAGE_COMPRESSION	},
+		{ "none",			QP_TEST_LOG_NO_IMAGE_COMPRESSION	}
+	};
 
 	parser
 		<< Option<CasePath>				("n",		"deqp-case",					"Test case(s) to run, supports wildcards (e.g. dEQP-GLES2.info.*)")
@@ -155,6 +178,7 @@ void registerOptions (de::cmdline::Parser& parser)
 		<< Option<CaseListResource>		(DE_NULL,	"deqp-caselist-resource",		"Read case list (in trie format) from given file located application's assets")
 		<< Option<StdinCaseList>		(DE_NULL,	"deqp-stdin-caselist",			"Read case list (in trie format) from stdin")
 		<< Option<LogFilename>			(DE_NULL,	"deqp-log-filename",			"Write test results to given file",					"TestResults.qpa")
+		<< Option<ProfileFilename>		(DE_NULL,	"deqp-profile-filename",		"Write per-case and per-phase timings to given file (Chrome trace format)")
 		<< Option<RunMode>				(DE_NULL,	"deqp-runmode",					"Execute tests, or write list of test cases into a file",
 																																		s_runModes,			"execute")
 		<< Option<ExportFilenamePattern>(DE_NULL,	"deqp-caselist-export-file",	"Set the target file name pattern for caselist export",					"${packageName}-cases.${typeExtension}")
@@ -179,17 +203,28 @@ void registerOptions (de::cmdline::Parser& parser)
 		<< Option<EGLPixmapType>		(DE_NULL,	"deqp-egl-pixmap-type",			"EGL native pixmap type")
 		<< Option<VKDeviceID>			(DE_NULL,	"deqp-vk-device-id",			"Vulkan device ID (IDs start from 1)",									"1")
 		<< Option<VKDeviceGroupID>		(DE_NULL,	"deqp-vk-device-group-id",		"Vulkan device Group ID (IDs start from 1)",							"1")
+		<< Option<VKSuballocation>		(DE_NULL,	"deqp-vk-suballocation",		"Sub-allocate device memory in the default Vulkan allocator",	s_enableNames,	"disable")
+		<< Option<VKPipelineCache>		(DE_NULL,	"deqp-vk-pipeline-cache",		"Create pipelines through a shared persistent pipeline cache",	s_enableNames,	"disable")
+		<< Option<VKPipelineCacheDir>	(DE_NULL,	"deqp-vk-pipeline-cache-dir",	"Directory for shared Vulkan pipeline cache files",						"pipelinecache")
+		<< Option<VKPipelineCacheSizeStats>(DE_NULL,	"deqp-vk-pipeline-cache-size-stats",	"Log growth of shared pipeline cache data size for each case",	s_enableNames,	"disable")
 		<< Option<LogImages>			(DE_NULL,	"deqp-log-images",				"Enable or disable logging of result images",		s_enableNames,		"enable")
 		<< Option<LogShaderSources>		(DE_NULL,	"deqp-log-shader-sources",		"Enable or disable logging of shader sources",		s_enableNames,		"enable")
 		<< Option<TestOOM>				(DE_NULL,	"deqp-test-oom",				"Run tests that exhaust memory on purpose",			s_enableNames,		TEST_OOM_DEFAULT)
 		<< Option<LogFlush>				(DE_NULL,	"deqp-log-flush",				"Enable or disable log file fflush",				s_enableNames,		"enable")
+		<< Option<LogAsync>				(DE_NULL,	"deqp-log-async",				"Write log file from a background thread",			s_enableNames,		"disable")
+		<< Option<LogImageThreads>		(DE_NULL,	"deqp-log-image-threads",		"Compress logged images on background threads",		s_enableNames,		"disable")
+		<< Option<LogImageCompression>	(DE_NULL,	"deqp-log-image-compression",	"Compression of logged images",						s_imageCompressionModes,	"default")
 		<< Option<Validation>			(DE_NULL,	"deqp-validation",				"Enable or disable test case validation",			s_enableNames,		"disable")
 		<< Option<Optimization>			(DE_NULL,	"deqp-optimization-recipe",		"Shader optimization recipe (0=disabled)",								"0")
 		<< Option<OptimizeSpirv>		(DE_NULL,	"deqp-optimize-spirv",			"Apply optimization to spir-v shaders as well",		s_enableNames,		"disable")
 		<< Option<ShaderCache>			(DE_NULL,	"deqp-shadercache",				"Enable or disable shader cache",					s_enableNames,		"enable")
 		<< Option<ShaderCacheFilename>	(DE_NULL,	"deqp-shadercache-filename",	"Write shader cache to given file",										"shadercache.bin")
 		<< Option<ShaderCacheTruncate>	(DE_NULL,	"deqp-shadercache-truncate",	"Truncate shader cache before running tests",		s_enableNames,		"enable")
-		<< Option<RenderDoc>			(DE_NULL,	"deqp-renderdoc",				"Enable RenderDoc frame markers and workarounds",	s_enableNames,		"disable");
+		<< Option<ShaderLibraryCache>	(DE_NULL,	"deqp-shader-library-cache",	"Enable or disable cache of parsed shader library files",	s_enableNames,	"disable")
+		<< Option<ShaderLibraryCacheDir>(DE_NULL,	"deqp-shader-library-cache-dir",	"Directory for cache of parsed shader library files",				"shaderlibrarycache")
+		<< Option<RenderDoc>			(DE_NULL,	"deqp-renderdoc",				"Enable RenderDoc frame markers and workarounds",	s_enableNames,		"disable")
+		<< Option<RefRendererThreadCount>(DE_NULL,	"deqp-ref-renderer-thread-count",	"Number of threads used by the reference renderer",					"1")
+		<< Option<VerificationThreadCount>(DE_NULL,	"deqp-verification-thread-count",	"Number of threads used for reference computation and result verification (0=number of cores)",	"0");
 }
 
 void registerLegacyOptions (de::cmdline::Parser& parser)
@@ -269,24 +304,33 @@ public:
 
 	const std::string&					getName				(void) const { return m_name;				}
 	bool								hasChildren			(void) const { return !m_children.empty();	}
+	int									getNumChildren		(void) const { return (int)m_children.size();	}
+	const CaseTreeNode*					getChild			(int ndx) const { return m_children[ndx];	}
 
 	bool								hasChild			(const std::string& name) const;
 	const CaseTreeNode*					getChild			(const std::string& name) const;
 	CaseTreeNode*						getChild			(const std::string& name);
+	const CaseTreeNode*					getChild			(const char* name, int nameLen) const;
 
-	void								addChild			(CaseTreeNode* child) { m_children.push_back(child); }
+	void								addChild			(CaseTreeNode* child);
 
 private:
 										CaseTreeNode		(const CaseTreeNode&);
 	CaseTreeNode&						operator=			(const CaseTreeNode&);
 
-	enum { NOT_FOUND = -1 };
+	enum
+	{
+		NOT_FOUND				= -1,
+		MIN_INDEXED_CHILDREN	= 8		//!< Groups smaller than this are searched linearly
+	};
 
-	// \todo [2014-10-30 pyry] Speed up with hash / sorting
-	int									findChildNdx		(const std::string& name) const;
+	int									findChildNdx		(const char* name, int nameLen) const;
+	void								insertToIndex		(int childNdx);
+	void								rebuildIndex		(void);
 
 	std::string							m_name;
 	std::vector<CaseTreeNode*>			m_children;
+	std::vector<int>					m_childIndex;		//!< Open-addressing hash table of child indices, NOT_FOUND if empty
 };
 
 CaseTreeNode::~CaseTreeNode (void)
@@ -295,30 +339,96 @@ CaseTreeNode::~CaseTreeNode (void)
 		delete *i;
 }
 
-int CaseTreeNode::findChildNdx (const std::string& name) const
+static inline bool nameEquals (const std::string& a, const char* b, int bLen)
 {
-	for (int ndx = 0; ndx < (int)m_children.size(); ++ndx)
+	return (int)a.size() == bLen && deMemCmp(a.c_str(), b, (size_t)bLen) == 0;
+}
+
+int CaseTreeNode::findChildNdx (const char* name, int nameLen) const
+{
+	if (m_childIndex.empty())
+	{
+		for (int ndx = 0; ndx < (int)m_children.size(); ++ndx)
+		{
+			if (nameEquals(m_children[ndx]->getName(), name, nameLen))
+				return ndx;
+		}
+	}
+	else
 	{
-		if (m_children[ndx]->getName() == name)
-			return ndx;
+		const deUint32 mask = (deUint32)m_childIndex.size() - 1u;
+
+		for (deUint32 slot = deMemoryHash(name, (size_t)nameLen) & mask; m_childIndex[slot] != NOT_FOUND; slot = (slot + 1u) & mask)
+		{
+			if (nameEquals(m_children[m_childIndex[slot]]->getName(), name, nameLen))
+				return m_childIndex[slot];
+		}
 	}
+
 	return NOT_FOUND;
 }
 
+void CaseTreeNode::insertToIndex (int childNdx)
+{
+	const std::string&	name	= m_children[childNdx]->getName();
+	const deUint32		mask	= (deUint32)m_childIndex.size() - 1u;
+	deUint32			slot	= deMemoryHash(name.c_str(), name.size()) & mask;
+
+	while (m_childIndex[slot] != NOT_FOUND)
+		slot = (slot + 1u) & mask;
+
+	m_childIndex[slot] = childNdx;
+}
+
+void CaseTreeNode::rebuildIndex (void)
+{
+	// Keep load factor at or below 1/2
+	m_childIndex.assign(deSmallestGreaterOrEquallPowerOfTwoU32((deUint32)m_children.size() * 4u), (int)NOT_FOUND);
+
+	for (int ndx = 0; ndx < (int)m_children.size(); ++ndx)
+		insertToIndex(ndx);
+}
+
+void CaseTreeNode::addChild (CaseTreeNode* child)
+{
+	m_children.push_back(child);
+
+	if ((int)m_children.size() < MIN_INDEXED_CHILDREN)
+		return;
+
+	try
+	{
+		if (m_children.size() * 2 > m_childIndex.size())
+			rebuildIndex();
+		else
+			insertToIndex((int)m_children.size() - 1);
+	}
+	catch (...)
+	{
+		m_children.pop_back();
+		throw;
+	}
+}
+
 inline bool CaseTreeNode::hasChild (const std::string& name) const
 {
-	return findChildNdx(name) != NOT_FOUND;
+	return findChildNdx(name.c_str(), (int)name.size()) != NOT_FOUND;
 }
 
 inline const CaseTreeNode* CaseTreeNode::getChild (const std::string& name) const
 {
-	const int ndx = findChildNdx(name);
-	return ndx == NOT_FOUND ? DE_NULL : m_children[ndx];
+	return getChild(name.c_str(), (int)name.size());
 }
 
 inline CaseTreeNode* CaseTreeNode::getChild (const std::string& name)
 {
-	const int ndx = findChildNdx(name);
+	const int ndx = findChildNdx(name.c_str(), (int)name.size());
+	return ndx == NOT_FOUND ? DE_NULL : m_children[ndx];
+}
+
+inline const CaseTreeNode* CaseTreeNode::getChild (const char* name, int nameLen) const
+{
+	const int ndx = findChildNdx(name, nameLen);
 	return ndx == NOT_FOUND ? DE_NULL : m_children[ndx];
 }
 
@@ -337,7 +447,7 @@ static const CaseTreeNode* findNode (const CaseTreeNode* root, const char* path)
 
 	for (;;)
 	{
-		curNode = curNode->getChild(std::string(curPath, curPath+curLen));
+		curNode = curNode->getChild(curPath, curLen);
 
 		if (!curNode)
 			break;
@@ -542,6 +652,267 @@ static CaseTreeNode* parseCaseList (std::istream& in)
 	}
 }
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Binary case trie
+ *
+ * Binary case trie is a serialized CaseTreeNode hierarchy that is used
+ * directly from a memory-mapped file, so filter setup cost does not depend
+ * on case list size. File consists of:
+ *  - Header
+ *  - Node array, root first. Children of each node are stored
+ *    contiguously and sorted by name for binary search.
+ *  - String pool holding node names, shared by nodes with equal names.
+ *
+ * All values are in native byte order, so files are not portable
+ * between hosts of different endianness (see writeBinaryCaseList()).
+ *//*--------------------------------------------------------------------*/
+class BinaryCaseTrie
+{
+public:
+	enum
+	{
+		MAGIC	= 0x544C437F,	//!< "\x7f" "CLT", not a valid start for a text case list
+		VERSION	= 1
+	};
+
+	struct Header
+	{
+		deUint32	magic;
+		deUint32	version;
+		deUint32	numNodes;
+		deUint32	stringPoolSize;
+	};
+
+	struct Node
+	{
+		deUint32	nameOffset;
+		deUint32	nameLength;
+		deUint32	firstChild;
+		deUint32	numChildren;
+	};
+
+	explicit							BinaryCaseTrie		(const char* filename);
+										~BinaryCaseTrie		(void);
+
+	bool								checkTestGroupName	(const char* groupPath) const;
+	bool								checkTestCaseName	(const char* casePath) const;
+
+	static bool							isBinaryCaseTrie	(std::istream& in);
+	static void							write				(const CaseTreeNode* root, std::ostream& dst);
+
+private:
+										BinaryCaseTrie		(const BinaryCaseTrie&);
+	BinaryCaseTrie&						operator=			(const BinaryCaseTrie&);
+
+	const Node*							findChild			(const Node* parent, const char* name, int nameLen) const;
+	const Node*							findNode			(const char* path) const;
+
+	deMappedFile*						m_file;
+	const Node*							m_nodes;
+	const char*							m_stringPool;
+	deUint32							m_numNodes;
+	deUint32							m_stringPoolSize;
+};
+
+static int compareNames (const char* a, int aLen, const char* b, int bLen)
+{
+	const int cmp = deMemCmp(a, b, (size_t)de::min(aLen, bLen));
+
+	if (cmp != 0)
+		return cmp;
+	else
+		return aLen - bLen;
+}
+
+static bool nodeNameLess (const CaseTreeNode* a, const CaseTreeNode* b)
+{
+	return compareNames(a->getName().c_str(), (int)a->getName().size(), b->getName().c_str(), (int)b->getName().size()) < 0;
+}
+
+BinaryCaseTrie::BinaryCaseTrie (const char* filename)
+	: m_file			(deMappedFile_create(filename))
+	, m_nodes			(DE_NULL)
+	, m_stringPool		(DE_NULL)
+	, m_numNodes		(0)
+	, m_stringPoolSize	(0)
+{
+	Header header;
+
+	if (!m_file)
+		throw Exception(string("Failed to map case list file '") + filename + "'");
+
+	if (deMappedFile_getSize(m_file) < (deInt64)sizeof(Header))
+	{
+		deMappedFile_destroy(m_file);
+		throw Exception(string("Truncated case list file '") + filename + "'");
+	}
+
+	deMemcpy(&header, deMappedFile_getPtr(m_file), sizeof(header));
+
+	if (header.magic != MAGIC || header.version != VERSION || header.numNodes == 0 ||
+		deMappedFile_getSize(m_file) != (deInt64)(sizeof(Header) + (deUint64)header.numNodes * sizeof(Node) + header.stringPoolSize))
+	{
+		deMappedFile_destroy(m_file);
+		throw Exception(string("Invalid binary case list file '") + filename + "'");
+	}
+
+	// \note Node contents are validated on access to avoid touching the whole file here
+	m_nodes				= (const Node*)((const deUint8*)deMappedFile_getPtr(m_file) + sizeof(Header));
+	m_stringPool		= (const char*)(m_nodes + header.numNodes);
+	m_numNodes			= header.numNodes;
+	m_stringPoolSize	= header.stringPoolSize;
+}
+
+BinaryCaseTrie::~BinaryCaseTrie (void)
+{
+	deMappedFile_destroy(m_file);
+}
+
+bool BinaryCaseTrie::isBinaryCaseTrie (std::istream& in)
+{
+	deUint32 magic = 0;
+
+	in.read((char*)&magic, sizeof(magic));
+
+	const bool isBinary = in.gcount() == (std::streamsize)sizeof(magic) && magic == (deUint32)MAGIC;
+
+	in.clear();
+	in.seekg(0, std::ios_base::beg);
+
+	return isBinary;
+}
+
+const BinaryCaseTrie::Node* BinaryCaseTrie::findChild (const Node* parent, const char* name, int nameLen) const
+{
+	deUint32	first	= parent->firstChild;
+	deUint32	last	= parent->firstChild + parent->numChildren;
+
+	if (last < first || last > m_numNodes)
+		throw Exception("Corrupted binary case list");
+
+	while (first < last)
+	{
+		const deUint32	mid		= first + (last - first) / 2;
+		const Node&		node	= m_nodes[mid];
+
+		if (node.nameOffset > m_stringPoolSize || node.nameLength > m_stringPoolSize - node.nameOffset)
+			throw Exception("Corrupted binary case list");
+
+		{
+			const int cmp = compareNames(m_stringPool + node.nameOffset, (int)node.nameLength, name, nameLen);
+
+			if (cmp == 0)
+				return &node;
+			else if (cmp < 0)
+				first = mid + 1;
+			else
+				last = mid;
+		}
+	}
+
+	return DE_NULL;
+}
+
+const BinaryCaseTrie::Node* BinaryCaseTrie::findNode (const char* path) const
+{
+	const Node*		curNode		= &m_nodes[0];
+	const char*		curPath		= path;
+
+	for (;;)
+	{
+		const int curLen = getCurrentComponentLen(curPath);
+
+		curNode = findChild(curNode, curPath, curLen);
+
+		if (!curNode)
+			break;
+
+		curPath	+= curLen;
+
+		if (curPath[0] == 0)
+			break;
+
+		DE_ASSERT(curPath[0] == '.');
+		curPath += 1;
+	}
+
+	return curNode;
+}
+
+bool BinaryCaseTrie::checkTestGroupName (const char* groupPath) const
+{
+	const Node* node = findNode(groupPath);
+	return node && node->numChildren > 0;
+}
+
+bool BinaryCaseTrie::checkTestCaseName (const char* casePath) const
+{
+	const Node* node = findNode(casePath);
+	return node && node->numChildren == 0;
+}
+
+void BinaryCaseTrie::write (const CaseTreeNode* root, std::ostream& dst)
+{
+	vector<const CaseTreeNode*>		nodes;
+	vector<Node>					binaryNodes;
+	string							stringPool;
+	std::map<string, deUint32>		stringOffsets;
+	Header							header;
+
+	// Breadth-first order keeps children of each node contiguous
+	nodes.push_back(root);
+
+	for (size_t nodeNdx = 0; nodeNdx < nodes.size(); nodeNdx++)
+	{
+		const CaseTreeNode* const	node		= nodes[nodeNdx];
+		const size_t				firstChild	= nodes.size();
+		Node						binaryNode;
+
+		for (int childNdx = 0; childNdx < node->getNumChildren(); childNdx++)
+			nodes.push_back(node->getChild(childNdx));
+
+		std::sort(nodes.begin() + firstChild, nodes.end(), nodeNameLess);
+
+		{
+			const std::map<string, deUint32>::const_iterator existing = stringOffsets.find(node->getName());
+
+			if (existing != stringOffsets.end())
+				binaryNode.nameOffset = existing->second;
+			else
+			{
+				binaryNode.nameOffset = (deUint32)stringPool.size();
+				stringOffsets[node->getName()] = binaryNode.nameOffset;
+				stringPool += node->getName();
+			}
+		}
+
+		binaryNode.nameLength	= (deUint32)node->getName().size();
+		binaryNode.firstChild	= (deUint32)firstChild;
+		binaryNode.numChildren	= (deUint32)node->getNumChildren();
+
+		binaryNodes.push_back(binaryNode);
+	}
+
+	header.magic			= MAGIC;
+	header.version			= VERSION;
+	header.numNodes			= (deUint32)binaryNodes.size();
+	header.stringPoolSize	= (deUint32)stringPool.size();
+
+	dst.write((const char*)&header, sizeof(header));
+	dst.write((const char*)&binaryNodes[0], (std::streamsize)(binaryNodes.size() * sizeof(Node)));
+	dst.write(stringPool.c_str(), (std::streamsize)stringPool.size());
+
+	if (!dst.good())
+		throw Exception("Failed to write binary case list");
+}
+
+void writeBinaryCaseList (std::istream& caseList, std::ostream& dst)
+{
+	const de::UniquePtr<CaseTreeNode> root (parseCaseList(caseList));
+
+	BinaryCaseTrie::write(root.get(), dst);
+}
+
 class CasePaths
 {
 public:
@@ -743,6 +1114,14 @@ bool CommandLine::parse (int argc, const char* const* argv)
 	if (!m_cmdLine.getOption<opt::LogFlush>())
 		m_logFlags |= QP_TEST_LOG_NO_FLUSH;
 
+	if (m_cmdLine.getOption<opt::LogAsync>())
+		m_logFlags |= QP_TEST_LOG_ASYNC;
+
+	if (m_cmdLine.getOption<opt::LogImageThreads>())
+		m_logFlags |= QP_TEST_LOG_IMAGE_THREADS;
+
+	m_logFlags |= m_cmdLine.getOption<opt::LogImageCompression>();
+
 	if ((m_cmdLine.hasOption<opt::CasePath>()?1:0) +
 		(m_cmdLine.hasOption<opt::CaseList>()?1:0) +
 		(m_cmdLine.hasOption<opt::CaseListFile>()?1:0) +
@@ -801,14 +1180,30 @@ int						CommandLine::getCLPlatformId				(void) const	{ return m_cmdLine.getOpti
 const std::vector<int>&	CommandLine::getCLDeviceIds					(void) const	{ return m_cmdLine.getOption<opt::CLDeviceIDs>();					}
 int						CommandLine::getVKDeviceId					(void) const	{ return m_cmdLine.getOption<opt::VKDeviceID>();					}
 int						CommandLine::getVKDeviceGroupId				(void) const	{ return m_cmdLine.getOption<opt::VKDeviceGroupID>();				}
+bool					CommandLine::isVKSuballocationEnabled		(void) const	{ return m_cmdLine.getOption<opt::VKSuballocation>();				}
+bool					CommandLine::isVKPipelineCacheEnabled		(void) const	{ return m_cmdLine.getOption<opt::VKPipelineCache>();				}
+const char*				CommandLine::getVKPipelineCacheDir			(void) const	{ return m_cmdLine.getOption<opt::VKPipelineCacheDir>().c_str();	}
+bool					CommandLine::isVKPipelineCacheSizeStatsEnabled	(void) const	{ return m_cmdLine.getOption<opt::VKPipelineCacheSizeStats>();		}
 bool					CommandLine::isValidationEnabled			(void) const	{ return m_cmdLine.getOption<opt::Validation>();					}
 bool					CommandLine::isOutOfMemoryTestEnabled		(void) const	{ return m_cmdLine.getOption<opt::TestOOM>();						}
 bool					CommandLine::isShadercacheEnabled			(void) const	{ return m_cmdLine.getOption<opt::ShaderCache>();					}
 const char*				CommandLine::getShaderCacheFilename			(void) const	{ return m_cmdLine.getOption<opt::ShaderCacheFilename>().c_str();	}
 bool					CommandLine::isShaderCacheTruncateEnabled	(void) const	{ return m_cmdLine.getOption<opt::ShaderCacheTruncate>();			}
+bool					CommandLine::isShaderLibraryCacheEnabled	(void) const	{ return m_cmdLine.getOption<opt::ShaderLibraryCache>();			}
+const char*				CommandLine::getShaderLibraryCacheDir		(void) const	{ return m_cmdLine.getOption<opt::ShaderLibraryCacheDir>().c_str();	}
 int						CommandLine::getOptimizationRecipe			(void) const	{ return m_cmdLine.getOption<opt::Optimization>();					}
 bool					CommandLine::isSpirvOptimizationEnabled		(void) const	{ return m_cmdLine.getOption<opt::OptimizeSpirv>();					}
 bool					CommandLine::isRenderDocEnabled				(void) const	{ return m_cmdLine.getOption<opt::RenderDoc>();						}
+int						CommandLine::getRefRendererThreadCount		(void) const	{ return m_cmdLine.getOption<opt::RefRendererThreadCount>();		}
+int						CommandLine::getVerificationThreadCount		(void) const	{ return m_cmdLine.getOption<opt::VerificationThreadCount>();		}
+
+const char* CommandLine::getProfileFileName (void) const
+{
+	if (m_cmdLine.hasOption<opt::ProfileFilename>())
+		return m_cmdLine.getOption<opt::ProfileFilename>().c_str();
+	else
+		return DE_NULL;
+}
 
 const char* CommandLine::getGLContextType (void) const
 {
@@ -888,6 +1283,8 @@ bool CaseListFilter::checkTestGroupName (const char* groupName) const
 		return m_casePaths->matches(groupName, true);
 	else if (m_caseTree)
 		return groupName[0] == 0 || tcu::checkTestGroupName(m_caseTree, groupName);
+	else if (m_binaryCaseTrie)
+		return groupName[0] == 0 || m_binaryCaseTrie->checkTestGroupName(groupName);
 	else
 		return true;
 }
@@ -898,6 +1295,8 @@ bool CaseListFilter::checkTestCaseName (const char* caseName) const
 		return m_casePaths->matches(caseName, false);
 	else if (m_caseTree)
 		return tcu::checkTestCaseName(m_caseTree, caseName);
+	else if (m_binaryCaseTrie)
+		return m_binaryCaseTrie->checkTestCaseName(caseName);
 	else
 		return true;
 }
@@ -923,7 +1322,10 @@ CaseListFilter::CaseListFilter (const de::cmdline::CommandLine& cmdLine, const t
 		if (!in.is_open() || !in.good())
 			throw Exception("Failed to open case list file '" + cmdLine.getOption<opt::CaseListFile>() + "'");
 
-		m_caseTree = parseCaseList(in);
+		if (BinaryCaseTrie::isBinaryCaseTrie(in))
+			m_binaryCaseTrie = de::MovePtr<const BinaryCaseTrie>(new BinaryCaseTrie(cmdLine.getOption<opt::CaseListFile>().c_str()));
+		else
+			m_caseTree = parseCaseList(in);
 	}
 	else if (cmdLine.hasOption<opt::CaseListResource>())
 	{
@@ -30,6 +30,7 @@
 #include <string>
 #include <vector>
 #include <istream>
+#include <ostream>
 
 namespace tcu
 {
@@ -44,6 +45,7 @@ enum RunMode
 	RUNMODE_DUMP_XML_CASELIST,		//! Test program dumps the list of contained test cases in XML format.
 	RUNMODE_DUMP_TEXT_CASELIST,		//! Test program dumps the list of contained test cases in plain-text format.
 	RUNMODE_DUMP_STDOUT_CASELIST,	//! Test program dumps the list of contained test cases in plain-text format into stdout.
+	RUNMODE_DUMP_BINARY_CASELIST,	//! Test program dumps the list of contained test cases in binary trie format.
 
 	RUNMODE_LAST
 };
@@ -89,6 +91,7 @@ enum ScreenRotation
 
 class CaseTreeNode;
 class CasePaths;
+class BinaryCaseTrie;
 class Archive;
 
 class CaseListFilter
@@ -108,10 +111,26 @@ private:
 	CaseListFilter												(const CaseListFilter&);	// not allowed!
 	CaseListFilter&					operator=					(const CaseListFilter&);	// not allowed!
 
-	CaseTreeNode*					m_caseTree;
-	de::MovePtr<const CasePaths>	m_casePaths;
+	CaseTreeNode*						m_caseTree;
+	de::MovePtr<const CasePaths>		m_casePaths;
+	de::MovePtr<const BinaryCaseTrie>	m_binaryCaseTrie;
 };
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Write case list in binary trie format
+ *
+ * Converts case list given in text or trie format into a binary trie
+ * that --deqp-caselist-file maps directly, avoiding parsing at startup.
+ * --deqp-runmode=bin-caselist uses this to write the (filtered) case
+ * list of each package.
+ *
+ * \note Binary case lists are written in native byte order and are not
+ *		 portable between hosts of different endianness. A list produced
+ *		 on a little-endian host fails the magic check on a big-endian
+ *		 target and must be regenerated there, or the text list used.
+ *//*--------------------------------------------------------------------*/
+void	writeBinaryCaseList		(std::istream& caseList, std::ostream& dst);
+
 /*--------------------------------------------------------------------*//*!
  * \brief Test command line
  *
@@ -132,6 +151,9 @@ public:
 	//! Get log file name (--deqp-log-filename)
 	const char*						getLogFileName					(void) const;
 
+	//! Get timing profile file name (--deqp-profile-filename), null if profiling is disabled
+	const char*						getProfileFileName				(void) const;
+
 	//! Get logging flags
 	deUint32						getLogFlags						(void) const;
 
@@ -205,6 +227,18 @@ public:
 	//! Get Vulkan device group ID (--deqp-vk-device-group-id)
 	int								getVKDeviceGroupId				(void) const;
 
+	//! Should the default Vulkan allocator sub-allocate device memory (--deqp-vk-suballocation)
+	bool							isVKSuballocationEnabled		(void) const;
+
+	//! Should pipelines be created through a shared persistent pipeline cache (--deqp-vk-pipeline-cache)
+	bool							isVKPipelineCacheEnabled		(void) const;
+
+	//! Get the directory for Vulkan pipeline cache files (--deqp-vk-pipeline-cache-dir)
+	const char*						getVKPipelineCacheDir			(void) const;
+
+	//! Should growth of pipeline cache data size be logged for each case (--deqp-vk-pipeline-cache-size-stats)
+	bool							isVKPipelineCacheSizeStatsEnabled	(void) const;
+
 	//! Enable development-time test case validation checks
 	bool							isValidationEnabled				(void) const;
 
@@ -220,6 +254,12 @@ public:
 	//! Should the shader cache be truncated before run (--deqp-shadercache-truncate)
 	bool							isShaderCacheTruncateEnabled	(void) const;
 
+	//! Should parsed shader library files be cached (--deqp-shader-library-cache)
+	bool							isShaderLibraryCacheEnabled		(void) const;
+
+	//! Get the directory for parsed shader library cache (--deqp-shader-library-cache-dir)
+	const char*						getShaderLibraryCacheDir		(void) const;
+
 	//! Get shader optimization recipe (--deqp-optimization-recipe)
 	int								getOptimizationRecipe		(void) const;
 
@@ -229,6 +269,12 @@ public:
 	//! Should we mark frames and enable WAs for RenderDoc (--deqp-renderdoc)
 	bool							isRenderDocEnabled			(void) const;
 
+	//! Get number of threads used by the reference renderer (--deqp-ref-renderer-thread-count)
+	int								getRefRendererThreadCount	(void) const;
+
+	//! Get number of threads used by tcu::parallelFor(), 0 for number of cores (--deqp-verification-thread-count)
+	int								getVerificationThreadCount	(void) const;
+
 	/*--------------------------------------------------------------------*//*!
 	 * \brief Creates case list filter
 	 * \param archive Resources
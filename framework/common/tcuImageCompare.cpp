@@ -34,6 +34,7 @@
 #include "tcuFloat.hpp"
 
 #include <string.h>
+#include <vector>
 
 namespace tcu
 {
@@ -294,22 +295,29 @@ static deInt64 computeSquaredDiffSum (const ConstPixelBufferAccess& ref, const C
 	DE_ASSERT(ref.getWidth() == cmp.getWidth() && ref.getWidth() == diffMask.getWidth());
 	DE_ASSERT(ref.getHeight() == cmp.getHeight() && ref.getHeight() == diffMask.getHeight());
 
-	deInt64 diffSum = 0;
+	const int			width	= cmp.getWidth();
+	std::vector<IVec4>	refRow	(width);
+	std::vector<IVec4>	cmpRow	(width);
+	std::vector<IVec4>	maskRow	(width);
+	deInt64				diffSum	= 0;
 
-	for (int y = 0; y < cmp.getHeight(); y++)
+	for (int y = 0; width > 0 && y < cmp.getHeight(); y++)
 	{
-		for (int x = 0; x < cmp.getWidth(); x++)
+		ref.getPixelsInt(&refRow[0], width, 0, y);
+		cmp.getPixelsInt(&cmpRow[0], width, 0, y);
+
+		for (int x = 0; x < width; x++)
 		{
-			IVec4	a		= ref.getPixelInt(x, y);
-			IVec4	b		= cmp.getPixelInt(x, y);
-			IVec4	diff	= abs(a - b);
+			IVec4	diff	= abs(refRow[x] - cmpRow[x]);
 			int		sum		= diff.x() + diff.y() + diff.z() + diff.w();
 			int		sqSum	= diff.x()*diff.x() + diff.y()*diff.y() + diff.z()*diff.z() + diff.w()*diff.w();
 
-			diffMask.setPixel(tcu::RGBA(deClamp32(sum*diffFactor, 0, 255), deClamp32(255-sum*diffFactor, 0, 255), 0, 255).toVec(), x, y);
+			maskRow[x] = IVec4(deClamp32(sum*diffFactor, 0, 255), deClamp32(255-sum*diffFactor, 0, 255), 0, 255);
 
 			diffSum += (deInt64)sqSum;
 		}
+
+		diffMask.setPixels(&maskRow[0], width, 0, y);
 	}
 
 	return diffSum;
@@ -496,23 +504,30 @@ bool floatUlpThresholdCompare (TestLog& log, const char* imageSetName, const cha
 	Vec4				pixelBias			(0.0f, 0.0f, 0.0f, 0.0f);
 	Vec4				pixelScale			(1.0f, 1.0f, 1.0f, 1.0f);
 
+	std::vector<Vec4>	refRow				(width);
+	std::vector<Vec4>	cmpRow				(width);
+	std::vector<IVec4>	maskRow				(width);
+
 	TCU_CHECK(result.getWidth() == width && result.getHeight() == height && result.getDepth() == depth);
 
 	for (int z = 0; z < depth; z++)
 	{
-		for (int y = 0; y < height; y++)
+		for (int y = 0; width > 0 && y < height; y++)
 		{
+			reference.getPixels(&refRow[0], width, 0, y, z);
+			result.getPixels(&cmpRow[0], width, 0, y, z);
+
 			for (int x = 0; x < width; x++)
 			{
-				const Vec4	refPix	= reference.getPixel(x, y, z);
-				const Vec4	cmpPix	= result.getPixel(x, y, z);
-				const UVec4	diff	= computeFlushRelaxedULPDiff(refPix, cmpPix);
+				const UVec4	diff	= computeFlushRelaxedULPDiff(refRow[x], cmpRow[x]);
 				const bool	isOk	= boolAll(lessThanEqual(diff, threshold));
 
 				maxDiff = max(maxDiff, diff);
 
-				errorMask.setPixel(isOk ? Vec4(0.0f, 1.0f, 0.0f, 1.0f) : Vec4(1.0f, 0.0f, 0.0f, 1.0f), x, y, z);
+				maskRow[x] = isOk ? IVec4(0, 0xff, 0, 0xff) : IVec4(0xff, 0, 0, 0xff);
 			}
+
+			errorMask.setPixels(&maskRow[0], width, 0, y, z);
 		}
 	}
 
@@ -582,24 +597,30 @@ bool floatThresholdCompare (TestLog& log, const char* imageSetName, const char*
 	Vec4				pixelBias			(0.0f, 0.0f, 0.0f, 0.0f);
 	Vec4				pixelScale			(1.0f, 1.0f, 1.0f, 1.0f);
 
+	std::vector<Vec4>	refRow				(width);
+	std::vector<Vec4>	cmpRow				(width);
+	std::vector<IVec4>	maskRow				(width);
+
 	TCU_CHECK_INTERNAL(result.getWidth() == width && result.getHeight() == height && result.getDepth() == depth);
 
 	for (int z = 0; z < depth; z++)
 	{
-		for (int y = 0; y < height; y++)
+		for (int y = 0; width > 0 && y < height; y++)
 		{
+			reference.getPixels(&refRow[0], width, 0, y, z);
+			result.getPixels(&cmpRow[0], width, 0, y, z);
+
 			for (int x = 0; x < width; x++)
 			{
-				Vec4	refPix		= reference.getPixel(x, y, z);
-				Vec4	cmpPix		= result.getPixel(x, y, z);
-
-				Vec4	diff		= abs(refPix - cmpPix);
+				Vec4	diff		= abs(refRow[x] - cmpRow[x]);
 				bool	isOk		= boolAll(lessThanEqual(diff, threshold));
 
 				maxDiff = max(maxDiff, diff);
 
-				errorMask.setPixel(isOk ? Vec4(0.0f, 1.0f, 0.0f, 1.0f) : Vec4(1.0f, 0.0f, 0.0f, 1.0f), x, y, z);
+				maskRow[x] = isOk ? IVec4(0, 0xff, 0, 0xff) : IVec4(0xff, 0, 0, 0xff);
 			}
+
+			errorMask.setPixels(&maskRow[0], width, 0, y, z);
 		}
 	}
 
@@ -669,21 +690,26 @@ bool floatThresholdCompare (TestLog& log, const char* imageSetName, const char*
 	Vec4				maxDiff				(0.0f, 0.0f, 0.0f, 0.0f);
 	Vec4				pixelBias			(0.0f, 0.0f, 0.0f, 0.0f);
 	Vec4				pixelScale			(1.0f, 1.0f, 1.0f, 1.0f);
+	std::vector<Vec4>	cmpRow				(width);
+	std::vector<IVec4>	maskRow				(width);
 
 	for (int z = 0; z < depth; z++)
 	{
-		for (int y = 0; y < height; y++)
+		for (int y = 0; width > 0 && y < height; y++)
 		{
+			result.getPixels(&cmpRow[0], width, 0, y, z);
+
 			for (int x = 0; x < width; x++)
 			{
-				const Vec4	cmpPix		= result.getPixel(x, y, z);
-				const Vec4	diff		= abs(reference - cmpPix);
+				const Vec4	diff		= abs(reference - cmpRow[x]);
 				const bool	isOk		= boolAll(lessThanEqual(diff, threshold));
 
 				maxDiff = max(maxDiff, diff);
 
-				errorMask.setPixel(isOk ? Vec4(0.0f, 1.0f, 0.0f, 1.0f) : Vec4(1.0f, 0.0f, 0.0f, 1.0f), x, y, z);
+				maskRow[x] = isOk ? IVec4(0, 0xff, 0, 0xff) : IVec4(0xff, 0, 0, 0xff);
 			}
+
+			errorMask.setPixels(&maskRow[0], width, 0, y, z);
 		}
 	}
 
@@ -751,24 +777,30 @@ bool intThresholdCompare (TestLog& log, const char* imageSetName, const char* im
 	Vec4				pixelBias			(0.0f, 0.0f, 0.0f, 0.0f);
 	Vec4				pixelScale			(1.0f, 1.0f, 1.0f, 1.0f);
 
+	std::vector<IVec4>	refRow				(width);
+	std::vector<IVec4>	cmpRow				(width);
+	std::vector<IVec4>	maskRow				(width);
+
 	TCU_CHECK_INTERNAL(result.getWidth() == width && result.getHeight() == height && result.getDepth() == depth);
 
 	for (int z = 0; z < depth; z++)
 	{
-		for (int y = 0; y < height; y++)
+		for (int y = 0; width > 0 && y < height; y++)
 		{
+			reference.getPixelsInt(&refRow[0], width, 0, y, z);
+			result.getPixelsInt(&cmpRow[0], width, 0, y, z);
+
 			for (int x = 0; x < width; x++)
 			{
-				IVec4	refPix		= reference.getPixelInt(x, y, z);
-				IVec4	cmpPix		= result.getPixelInt(x, y, z);
-
-				UVec4	diff		= abs(refPix - cmpPix).cast<deUint32>();
+				UVec4	diff		= abs(refRow[x] - cmpRow[x]).cast<deUint32>();
 				bool	isOk		= boolAll(lessThanEqual(diff, threshold));
 
 				maxDiff = max(maxDiff, diff);
 
-				errorMask.setPixel(isOk ? IVec4(0, 0xff, 0, 0xff) : IVec4(0xff, 0, 0, 0xff), x, y, z);
+				maskRow[x] = isOk ? IVec4(0, 0xff, 0, 0xff) : IVec4(0xff, 0, 0, 0xff);
 			}
+
+			errorMask.setPixels(&maskRow[0], width, 0, y, z);
 		}
 	}
 
@@ -24,14 +24,450 @@
 #include "tcuInterval.hpp"
 
 #include "deMath.h"
+#include "deMemory.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <math.h>
+
+// Error-free transformations are only exact when every operation is rounded
+// to double precision once. Platforms evaluating in extended precision (x87)
+// fall back to switching the rounding mode.
+#if (defined(__FLT_EVAL_METHOD__) && (__FLT_EVAL_METHOD__ != 0)) || \
+	((DE_COMPILER == DE_COMPILER_MSC) && (DE_CPU == DE_CPU_X86_32) && (!defined(_M_IX86_FP) || (_M_IX86_FP < 2)))
+#	define TCU_INTERVAL_USE_ROUNDING_MODE 1
+#else
+#	define TCU_INTERVAL_USE_ROUNDING_MODE 0
+#endif
+
+// With hardware FMA, rounding errors of products are computed directly with
+// fma() instead of Dekker's algorithm.
+#if defined(FP_FAST_FMA) && !TCU_INTERVAL_USE_ROUNDING_MODE
+#	define TCU_INTERVAL_USE_FMA 1
+#else
+#	define TCU_INTERVAL_USE_FMA 0
+#endif
 
 namespace tcu
 {
 
 using std::ldexp;
 
+namespace
+{
+
+enum IntervalOp
+{
+	INTERVALOP_ADD = 0,
+	INTERVALOP_SUB,
+	INTERVALOP_MUL,
+	INTERVALOP_DIV,
+
+	INTERVALOP_LAST
+};
+
+inline bool isFinite (double x)
+{
+	return !deIsInf(x) && !deIsNaN(x);
+}
+
+inline bool isPositiveZero (double x)
+{
+	deUint64 bits;
+	deMemcpy(&bits, &x, sizeof(bits));
+	return bits == 0;
+}
+
+inline double nextUp (double x)
+{
+	deUint64 bits;
+
+	if (deIsNaN(x) || x == std::numeric_limits<double>::infinity())
+		return x;
+
+	if (x == 0.0)
+		return std::numeric_limits<double>::denorm_min();
+
+	deMemcpy(&bits, &x, sizeof(bits));
+	bits = (x > 0.0) ? bits + 1 : bits - 1;
+	deMemcpy(&x, &bits, sizeof(bits));
+
+	return x;
+}
+
+inline double nextDown (double x)
+{
+	return -nextUp(-x);
+}
+
+//! Bounds of the exact value, given a round-to-nearest result and the sign
+//! of exact - rounded.
+inline void roundedBounds (double rounded, double errorSign, double& lo, double& hi)
+{
+	lo = errorSign < 0.0 ? nextDown(rounded) : rounded;
+	hi = errorSign > 0.0 ? nextUp(rounded) : rounded;
+}
+
+// Operations rounded with the FPU rounding mode. Used on platforms with excess
+// precision, and for the rare cases where the error-free transformations below
+// could over- or underflow.
+double modeRoundedOp (deRoundingMode mode, IntervalOp op, double a, double b)
+{
+	const ScopedRoundingMode	ctx		(mode);
+	// Volatile operands keep the compiler from evaluating the operation before the mode switch
+	volatile double				va		= a;
+	volatile double				vb		= b;
+	volatile double				result	= 0.0;
+
+	switch (op)
+	{
+		case INTERVALOP_ADD:	result = va + vb;	break;
+		case INTERVALOP_SUB:	result = va - vb;	break;
+		case INTERVALOP_MUL:	result = va * vb;	break;
+		case INTERVALOP_DIV:	result = va / vb;	break;
+		default:
+			DE_ASSERT(false);
+	}
+
+	return result;
+}
+
+double modeRoundedSqrt (deRoundingMode mode, double a)
+{
+	const ScopedRoundingMode	ctx		(mode);
+	volatile double				va		= a;
+	volatile double				result	= std::sqrt(va);
+
+	return result;
+}
+
+void modeRoundedBounds (IntervalOp op, double a, double b, double& lo, double& hi)
+{
+	lo = modeRoundedOp(DE_ROUNDINGMODE_TO_NEGATIVE_INF, op, a, b);
+	hi = modeRoundedOp(DE_ROUNDINGMODE_TO_POSITIVE_INF, op, a, b);
+}
+
+// The error-free transformations below are only exact if the compiler does
+// not contract multiplies and adds into fused multiply-adds. Separate
+// statements are not enough for that: GCC contracts across statements by
+// default, so this file is built with FP contraction disabled (see
+// CMakeLists.txt). Where FMA is available in hardware, it is used explicitly
+// for product errors, which doesn't depend on the compiler flags.
+
+//! Knuth's TwoSum: s + e == a + b exactly, for finite s.
+inline void twoSum (double a, double b, double& s, double& e)
+{
+	s = a + b;
+
+	const double	bv	= s - a;
+	const double	av	= s - bv;
+	const double	be	= b - bv;
+	const double	ae	= a - av;
+
+	e = ae + be;
+}
+
+//! Veltkamp split of a into two 26-bit halves.
+inline void split (double a, double& hi, double& lo)
+{
+	const double	c	= 134217729.0 * a; // 2^27 + 1
+	const double	d	= c - a;
+
+	hi = c - d;
+	lo = a - hi;
+}
+
+#if TCU_INTERVAL_USE_FMA
+inline double fusedMultiplyAdd (double a, double b, double c)
+{
+	// fma() is not a builtin in strict C++03 mode
+#	if (DE_COMPILER == DE_COMPILER_GCC) || (DE_COMPILER == DE_COMPILER_CLANG)
+	return __builtin_fma(a, b, c);
+#	else
+	return fma(a, b, c);
+#	endif
+}
+#endif
+
+//! TwoProduct: p + e == a * b exactly, given no over- or underflow.
+inline void twoProduct (double a, double b, double& p, double& e)
+{
+	p = a * b;
+
+#if TCU_INTERVAL_USE_FMA
+	e = fusedMultiplyAdd(a, b, -p);
+#else
+	// Dekker's algorithm
+	double ah, al, bh, bl;
+
+	split(a, ah, al);
+	split(b, bh, bl);
+
+	const double	hh	= ah * bh;
+	const double	hl	= ah * bl;
+	const double	lh	= al * bh;
+	const double	ll	= al * bl;
+	const double	e0	= hh - p;
+	const double	e1	= e0 + hl;
+	const double	e2	= e1 + lh;
+
+	e = e2 + ll;
+#endif
+}
+
+//! Exact a - q * b, given that it is representable and that twoProduct(q, b)
+//! neither over- nor underflows.
+inline double productRemainder (double a, double q, double b)
+{
+#if TCU_INTERVAL_USE_FMA
+	return fusedMultiplyAdd(-q, b, a);
+#else
+	double p, e;
+
+	twoProduct(q, b, p, e);
+
+	// a - p is exact by Sterbenz
+	const double	ap	= a - p;
+
+	return ap - e;
+#endif
+}
+
+//! Magnitudes for which twoProduct() can neither overflow nor lose bits to
+//! underflow.
+inline bool inProductRange (double x)
+{
+	const double ax = std::fabs(x);
+	return ax >= 1e-270 && ax <= 1e270;
+}
+
+inline void addBounds (double a, double b, double& lo, double& hi)
+{
+	double s, e;
+
+	twoSum(a, b, s, e);
+
+	if (!isFinite(s))
+	{
+		lo = s;
+		hi = s;
+
+		// Overflow from finite operands rounds towards zero to the largest finite value.
+		if (deIsInf(s) && isFinite(a) && isFinite(b))
+		{
+			if (s > 0.0)
+				lo = std::numeric_limits<double>::max();
+			else
+				hi = -std::numeric_limits<double>::max();
+		}
+	}
+	else if (s == 0.0)
+	{
+		// Exact zero sum is -0 when rounding down, unless both operands are +0.
+		lo = (isPositiveZero(a) && isPositiveZero(b)) ? 0.0 : -0.0;
+		hi = s;
+	}
+	else
+		roundedBounds(s, e, lo, hi);
+}
+
+inline void mulBounds (double a, double b, double& lo, double& hi)
+{
+	if (a == 0.0 || b == 0.0 || !isFinite(a) || !isFinite(b))
+	{
+		// Exact
+		lo = a * b;
+		hi = lo;
+		return;
+	}
+
+	{
+		double p, e;
+
+		twoProduct(a, b, p, e);
+
+		if (inProductRange(a) && inProductRange(b) && inProductRange(p))
+		{
+			roundedBounds(p, e, lo, hi);
+			return;
+		}
+	}
+
+	modeRoundedBounds(INTERVALOP_MUL, a, b, lo, hi);
+}
+
+inline void divBounds (double a, double b, double& lo, double& hi)
+{
+	if (a == 0.0 || b == 0.0 || !isFinite(a) || !isFinite(b))
+	{
+		// Exact
+		lo = a / b;
+		hi = lo;
+		return;
+	}
+
+	{
+		const double q = a / b;
+
+		if (inProductRange(a) && inProductRange(b) && inProductRange(q))
+		{
+			// Remainder a - q*b is exactly representable
+			const double r = productRemainder(a, q, b);
+
+			roundedBounds(q, (b > 0.0) ? r : -r, lo, hi);
+			return;
+		}
+	}
+
+	modeRoundedBounds(INTERVALOP_DIV, a, b, lo, hi);
+}
+
+inline void sqrtBounds (double a, double& lo, double& hi)
+{
+	if (TCU_INTERVAL_USE_ROUNDING_MODE || (a > 0.0 && isFinite(a) && !inProductRange(a)))
+	{
+		lo = modeRoundedSqrt(DE_ROUNDINGMODE_TO_NEGATIVE_INF, a);
+		hi = modeRoundedSqrt(DE_ROUNDINGMODE_TO_POSITIVE_INF, a);
+	}
+	else if (a <= 0.0 || !isFinite(a))
+	{
+		// Exact or NaN
+		lo = std::sqrt(a);
+		hi = lo;
+	}
+	else
+	{
+		const double	s	= std::sqrt(a);
+		const double	r	= productRemainder(a, s, s);
+
+		roundedBounds(s, r, lo, hi);
+	}
+}
+
+//! Round-down and round-up results of a op b.
+inline void opBounds (IntervalOp op, double a, double b, double& lo, double& hi)
+{
+	if (TCU_INTERVAL_USE_ROUNDING_MODE)
+	{
+		modeRoundedBounds(op, a, b, lo, hi);
+		return;
+	}
+
+	switch (op)
+	{
+		case INTERVALOP_ADD:	addBounds(a, b, lo, hi);	break;
+		case INTERVALOP_SUB:	addBounds(a, -b, lo, hi);	break;
+		case INTERVALOP_MUL:	mulBounds(a, b, lo, hi);	break;
+		case INTERVALOP_DIV:	divBounds(a, b, lo, hi);	break;
+		default:
+			DE_ASSERT(false);
+			lo = hi = 0.0;
+	}
+}
+
+inline double opRoundDown (IntervalOp op, double a, double b)
+{
+	double lo, hi;
+	opBounds(op, a, b, lo, hi);
+	return lo;
+}
+
+inline double opRoundUp (IntervalOp op, double a, double b)
+{
+	double lo, hi;
+	opBounds(op, a, b, lo, hi);
+	return hi;
+}
+
+//! Bounds of x + y, as computed by TCU_SET_INTERVAL_BOUNDS on the endpoints.
+inline Interval addIntervals (const Interval& x, const Interval& y)
+{
+	Interval ret;
+
+	if (!x.empty() && !y.empty())
+		ret = Interval(opRoundDown(INTERVALOP_ADD, x.lo(), y.lo())) | Interval(opRoundUp(INTERVALOP_ADD, x.hi(), y.hi()));
+	if (x.hasNaN() || y.hasNaN())
+		ret |= TCU_NAN;
+
+	return ret;
+}
+
+//! Image of a monotone operation, evaluated on every pair of endpoints in
+//! both rounding directions as TCU_INTERVAL_APPLY_MONOTONE2 would.
+template <IntervalOp Op>
+Interval applyMonotoneOp (const Interval& x, const Interval& y)
+{
+	Interval ret;
+
+	if (!x.empty())
+	{
+		const double	xs[]	= { x.lo(), x.hi() };
+		const double	ys[]	= { y.lo(), y.hi() };
+
+		for (int xNdx = 0; xNdx < DE_LENGTH_OF_ARRAY(xs); xNdx++)
+		{
+			Interval inner;
+
+			if (!y.empty())
+			{
+				for (int yNdx = 0; yNdx < DE_LENGTH_OF_ARRAY(ys); yNdx++)
+				{
+					double lo, hi;
+
+					opBounds(Op, xs[xNdx], ys[yNdx], lo, hi);
+					inner |= Interval(lo) | Interval(hi);
+				}
+			}
+			if (y.hasNaN())
+				inner |= TCU_NAN;
+
+			ret |= inner;
+		}
+	}
+	if (x.hasNaN())
+		ret |= TCU_NAN;
+
+	return ret;
+}
+
+inline Interval divIntervals (const Interval& nom, const Interval& den)
+{
+	if (den.contains(0.0))
+	{
+		// \todo [2014-03-21 lauri] Non-inf endpoint when one den endpoint is
+		// zero and nom doesn't cross zero?
+		return Interval::unbounded();
+	}
+	else
+		return applyMonotoneOp<INTERVALOP_DIV>(nom, den);
+}
+
+} // anonymous
+
+double addRoundDown		(double a, double b)	{ return opRoundDown(INTERVALOP_ADD, a, b);	}
+double addRoundUp		(double a, double b)	{ return opRoundUp(INTERVALOP_ADD, a, b);	}
+double subRoundDown		(double a, double b)	{ return opRoundDown(INTERVALOP_SUB, a, b);	}
+double subRoundUp		(double a, double b)	{ return opRoundUp(INTERVALOP_SUB, a, b);	}
+double mulRoundDown		(double a, double b)	{ return opRoundDown(INTERVALOP_MUL, a, b);	}
+double mulRoundUp		(double a, double b)	{ return opRoundUp(INTERVALOP_MUL, a, b);	}
+double divRoundDown		(double a, double b)	{ return opRoundDown(INTERVALOP_DIV, a, b);	}
+double divRoundUp		(double a, double b)	{ return opRoundUp(INTERVALOP_DIV, a, b);	}
+
+double sqrtRoundDown (double a)
+{
+	double lo, hi;
+	sqrtBounds(a, lo, hi);
+	return lo;
+}
+
+double sqrtRoundUp (double a)
+{
+	double lo, hi;
+	sqrtBounds(a, lo, hi);
+	return hi;
+}
+
 Interval applyMonotone (DoubleFunc1& func, const Interval& arg0)
 {
 	Interval ret;
@@ -64,50 +500,22 @@ Interval applyMonotone (DoubleIntervalFunc2& func, const Interval& arg0, const I
 
 Interval operator+ (const Interval& x, const Interval& y)
 {
-	Interval ret;
-
-	if (!x.empty() && !y.empty())
-		TCU_SET_INTERVAL_BOUNDS(ret, p, p = x.lo() + y.lo(), p = x.hi() + y.hi());
-	if (x.hasNaN() || y.hasNaN())
-		ret |= TCU_NAN;
-
-	return ret;
+	return addIntervals(x, y);
 }
 
 Interval operator- (const Interval& x, const Interval& y)
 {
-	Interval ret;
-
-	TCU_INTERVAL_APPLY_MONOTONE2(ret, xp, x, yp, y, val,
-								 TCU_SET_INTERVAL(val, point, point = xp - yp));
-	return ret;
+	return applyMonotoneOp<INTERVALOP_SUB>(x, y);
 }
 
 Interval operator* (const Interval& x, const Interval& y)
 {
-	Interval ret;
-
-	TCU_INTERVAL_APPLY_MONOTONE2(ret, xp, x, yp, y, val,
-								 TCU_SET_INTERVAL(val, point, point = xp * yp));
-	return ret;
+	return applyMonotoneOp<INTERVALOP_MUL>(x, y);
 }
 
 Interval operator/ (const Interval& nom, const Interval& den)
 {
-	if (den.contains(0.0))
-	{
-		// \todo [2014-03-21 lauri] Non-inf endpoint when one den endpoint is
-		// zero and nom doesn't cross zero?
-		return Interval::unbounded();
-	}
-	else
-	{
-		Interval ret;
-
-		TCU_INTERVAL_APPLY_MONOTONE2(ret, nomp, nom, denp, den, val,
-									 TCU_SET_INTERVAL(val, point, point = nomp / denp));
-		return ret;
-	}
+	return divIntervals(nom, den);
 }
 
 static double negate (double x)
@@ -132,7 +540,22 @@ Interval exp (const Interval& x)
 
 Interval sqrt (const Interval& x)
 {
-	return applyMonotone(std::sqrt, x);
+	Interval ret;
+
+	if (!x.empty())
+	{
+		double lo, hi;
+
+		sqrtBounds(x.lo(), lo, hi);
+		ret = Interval(lo) | Interval(hi);
+
+		sqrtBounds(x.hi(), lo, hi);
+		ret |= Interval(lo) | Interval(hi);
+	}
+	if (x.hasNaN())
+		ret |= TCU_NAN;
+
+	return ret;
 }
 
 Interval inverseSqrt (const Interval& x)
@@ -150,6 +573,79 @@ Interval abs (const Interval& x)
 	return mono;
 }
 
+IntervalExpr::IntervalExpr (int numInputs)
+	: m_numInputs(numInputs)
+{
+	DE_ASSERT(numInputs > 0);
+}
+
+int IntervalExpr::add	(int a, int b)	{ return addNode(OP_ADD, a, b);		}
+int IntervalExpr::sub	(int a, int b)	{ return addNode(OP_SUB, a, b);		}
+int IntervalExpr::mul	(int a, int b)	{ return addNode(OP_MUL, a, b);		}
+int IntervalExpr::div	(int a, int b)	{ return addNode(OP_DIV, a, b);		}
+int IntervalExpr::neg	(int a)			{ return addNode(OP_NEG, a, a);		}
+
+int IntervalExpr::addNode (Op op, int a, int b)
+{
+	const int	nodeNdx	= m_numInputs + (int)m_nodes.size();
+	Node		node;
+
+	DE_ASSERT(de::inBounds(a, 0, nodeNdx) && de::inBounds(b, 0, nodeNdx));
+
+	node.op	= op;
+	node.a	= a;
+	node.b	= b;
+
+	m_nodes.push_back(node);
+
+	return nodeNdx;
+}
+
+void IntervalExpr::evaluate (const Interval* const* inputs, Interval* dst, size_t numValues) const
+{
+	// Values are processed in blocks so that intermediate results stay in cache.
+	const size_t			blockSize	= 64;
+	const int				numNodes	= m_numInputs + (int)m_nodes.size();
+	std::vector<Interval>	temps		(m_nodes.size() * blockSize);
+	std::vector<Interval*>	nodeValues	(numNodes);
+
+	for (int nodeNdx = 0; nodeNdx < (int)m_nodes.size(); nodeNdx++)
+		nodeValues[m_numInputs + nodeNdx] = &temps[nodeNdx * blockSize];
+
+	for (size_t blockStart = 0; blockStart < numValues; blockStart += blockSize)
+	{
+		const size_t numInBlock = de::min(blockSize, numValues - blockStart);
+
+		for (int inputNdx = 0; inputNdx < m_numInputs; inputNdx++)
+			nodeValues[inputNdx] = const_cast<Interval*>(inputs[inputNdx] + blockStart);
+
+		for (int nodeNdx = 0; nodeNdx < (int)m_nodes.size(); nodeNdx++)
+		{
+			const Node&				node	= m_nodes[nodeNdx];
+			const Interval* const	a		= nodeValues[node.a];
+			const Interval* const	b		= nodeValues[node.b];
+			Interval* const			res		= nodeValues[m_numInputs + nodeNdx];
+
+			switch (node.op)
+			{
+				case OP_ADD:	for (size_t ndx = 0; ndx < numInBlock; ndx++) res[ndx] = addIntervals(a[ndx], b[ndx]);						break;
+				case OP_SUB:	for (size_t ndx = 0; ndx < numInBlock; ndx++) res[ndx] = applyMonotoneOp<INTERVALOP_SUB>(a[ndx], b[ndx]);	break;
+				case OP_MUL:	for (size_t ndx = 0; ndx < numInBlock; ndx++) res[ndx] = applyMonotoneOp<INTERVALOP_MUL>(a[ndx], b[ndx]);	break;
+				case OP_DIV:	for (size_t ndx = 0; ndx < numInBlock; ndx++) res[ndx] = divIntervals(a[ndx], b[ndx]);						break;
+				case OP_NEG:	for (size_t ndx = 0; ndx < numInBlock; ndx++) res[ndx] = a[ndx].operator-();								break;
+				default:
+					DE_ASSERT(false);
+			}
+		}
+
+		// Written last, as dst may alias an input.
+		if (m_nodes.empty())
+			std::copy(inputs[0] + blockStart, inputs[0] + blockStart + numInBlock, dst + blockStart);
+		else
+			std::copy(nodeValues[numNodes - 1], nodeValues[numNodes - 1] + numInBlock, dst + blockStart);
+	}
+}
+
 std::ostream& operator<< (std::ostream& os, const Interval& interval)
 {
 	if (interval.empty())
@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <limits>
+#include <vector>
 
 #define TCU_INFINITY	(::std::numeric_limits<float>::infinity())
 #define TCU_NAN			(::std::numeric_limits<float>::quiet_NaN())
@@ -193,6 +194,71 @@ Interval		operator-	(const Interval& x,		const Interval& y);
 Interval		operator*	(const Interval& x,		const Interval& y);
 Interval		operator/	(const Interval& nom,	const Interval& den);
 
+// Directed rounding of basic operations. Unlike TCU_SET_INTERVAL_BOUNDS these
+// do not touch the FPU rounding mode: the result is computed in the default
+// round-to-nearest mode and the rounding error, recovered exactly with an
+// error-free transformation, decides whether the result must be stepped to the
+// neighbouring double. Results are bit-exact with the rounding mode path.
+double			addRoundDown	(double a, double b);
+double			addRoundUp		(double a, double b);
+double			subRoundDown	(double a, double b);
+double			subRoundUp		(double a, double b);
+double			mulRoundDown	(double a, double b);
+double			mulRoundUp		(double a, double b);
+double			divRoundDown	(double a, double b);
+double			divRoundUp		(double a, double b);
+double			sqrtRoundDown	(double a);
+double			sqrtRoundUp		(double a);
+
+//! Straight-line interval expression evaluated over arrays of inputs.
+//! Nodes 0 .. numInputs-1 are the inputs, every operation appends a node and
+//! returns its index, and the last node appended is the result. evaluate()
+//! runs one operation at a time over a block of values. Results are identical
+//! to evaluating the expression value by value with the Interval operators.
+class IntervalExpr
+{
+public:
+	explicit		IntervalExpr	(int numInputs);
+
+	int				getNumInputs	(void) const { return m_numInputs;	}
+
+	int				add				(int a, int b);
+	int				sub				(int a, int b);
+	int				mul				(int a, int b);
+	int				div				(int a, int b);
+	int				neg				(int a);
+
+	//! Evaluate dst[i] = expr(inputs[0][i], ..., inputs[numInputs-1][i]) for
+	//! numValues elements. dst may alias an input array.
+	void			evaluate		(const Interval* const*	inputs,
+									 Interval*				dst,
+									 size_t					numValues) const;
+
+private:
+	enum Op
+	{
+		OP_ADD = 0,
+		OP_SUB,
+		OP_MUL,
+		OP_DIV,
+		OP_NEG,
+
+		OP_LAST
+	};
+
+	struct Node
+	{
+		Op		op;
+		int		a;
+		int		b;
+	};
+
+	int				addNode			(Op op, int a, int b);
+
+	int					m_numInputs;
+	std::vector<Node>	m_nodes;
+};
+
 inline Interval& operator+=	(Interval& x,	const Interval& y) { return (x = x + y); }
 inline Interval& operator-=	(Interval& x,	const Interval& y) { return (x = x - y); }
 inline Interval& operator*=	(Interval& x,	const Interval& y) { return (x = x * y); }
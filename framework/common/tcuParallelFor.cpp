@@ -0,0 +1,385 @@
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Tester Core
+ * ----------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Parallel execution of independent work items.
+ *//*--------------------------------------------------------------------*/
+
+#include "tcuParallelFor.hpp"
+
+#include "deThread.hpp"
+#include "deMutex.hpp"
+#include "deSemaphore.hpp"
+#include "deAtomic.h"
+#include "deSharedPtr.hpp"
+
+#include <vector>
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <new>
+
+namespace tcu
+{
+
+namespace
+{
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Copy of an exception thrown in a worker thread
+ *
+ * C++03 has no std::exception_ptr, so the error is recorded as its most
+ * derived tcu exception type (or std::bad_alloc) and message, and thrown
+ * again as that type in the calling thread. Test result codes of
+ * TestException and types derived outside tcu (such as glu::Error) fall
+ * back to the nearest tcu base class.
+ *//*--------------------------------------------------------------------*/
+class CapturedError
+{
+public:
+	enum Type
+	{
+		TYPE_NONE = 0,
+		TYPE_TEST_ERROR,
+		TYPE_INTERNAL_ERROR,
+		TYPE_RESOURCE_ERROR,
+		TYPE_NOT_SUPPORTED_ERROR,
+		TYPE_TEST_EXCEPTION,
+		TYPE_EXCEPTION,
+		TYPE_BAD_ALLOC,
+		TYPE_STD_EXCEPTION,
+		TYPE_UNKNOWN,
+
+		TYPE_LAST
+	};
+
+					CapturedError	(void) : m_type(TYPE_NONE), m_result(QP_TEST_RESULT_LAST) {}
+
+	//! Record exception currently being handled. Must be called from a catch block.
+	void			capture			(void);
+	void			rethrow			(void) const;
+
+	bool			isSet			(void) const { return m_type != TYPE_NONE; }
+
+private:
+	Type			m_type;
+	std::string		m_message;
+	qpTestResult	m_result;
+};
+
+void CapturedError::capture (void)
+{
+	try
+	{
+		throw;
+	}
+	catch (const TestError& e)			{ m_type = TYPE_TEST_ERROR;				m_message = e.what();									}
+	catch (const InternalError& e)		{ m_type = TYPE_INTERNAL_ERROR;			m_message = e.what();									}
+	catch (const ResourceError& e)		{ m_type = TYPE_RESOURCE_ERROR;			m_message = e.what();									}
+	catch (const NotSupportedError& e)	{ m_type = TYPE_NOT_SUPPORTED_ERROR;	m_message = e.what();									}
+	catch (const TestException& e)		{ m_type = TYPE_TEST_EXCEPTION;			m_message = e.what();	m_result = e.getTestResult();	}
+	catch (const Exception& e)			{ m_type = TYPE_EXCEPTION;				m_message = e.what();									}
+	catch (const std::bad_alloc&)		{ m_type = TYPE_BAD_ALLOC;																		}
+	catch (const std::exception& e)		{ m_type = TYPE_STD_EXCEPTION;			m_message = e.what();									}
+	catch (...)							{ m_type = TYPE_UNKNOWN;				m_message = "Unknown error in worker thread";			}
+}
+
+void CapturedError::rethrow (void) const
+{
+	switch (m_type)
+	{
+		case TYPE_TEST_ERROR:			throw TestError(m_message);
+		case TYPE_INTERNAL_ERROR:		throw InternalError(m_message);
+		case TYPE_RESOURCE_ERROR:		throw ResourceError(m_message);
+		case TYPE_NOT_SUPPORTED_ERROR:	throw NotSupportedError(m_message);
+		case TYPE_TEST_EXCEPTION:		throw TestException(m_message, m_result);
+		case TYPE_EXCEPTION:			throw Exception(m_message);
+		case TYPE_BAD_ALLOC:			throw std::bad_alloc();
+		case TYPE_STD_EXCEPTION:		throw std::runtime_error(m_message);
+		case TYPE_UNKNOWN:				throw InternalError(m_message);
+		default:
+			DE_ASSERT(false);
+	}
+}
+
+class ChunkQueue
+{
+public:
+					ChunkQueue		(ParallelJob& job, size_t numItems, size_t chunkSize)
+						: m_job			(job)
+						, m_numItems	(numItems)
+						, m_chunkSize	(chunkSize)
+						, m_numChunks	((deUint32)((numItems + chunkSize - 1) / chunkSize))
+						, m_nextChunk	(0)
+						, m_aborted		(false)
+					{
+					}
+
+	//! Process chunks until all have been handed out or an error occurred.
+	void			execute			(int threadNdx)
+	{
+		while (!m_aborted)
+		{
+			const deUint32 chunkNdx = deAtomicIncrementUint32(&m_nextChunk) - 1;
+
+			if (chunkNdx >= m_numChunks)
+				break;
+
+			{
+				const size_t begin	= (size_t)chunkNdx * m_chunkSize;
+				const size_t end	= de::min(begin + m_chunkSize, m_numItems);
+
+				m_job.execute(begin, end, threadNdx);
+			}
+		}
+	}
+
+	//! Process chunks in a worker thread, recording the first error.
+	void			executeWorker	(int threadNdx)
+	{
+		try
+		{
+			execute(threadNdx);
+		}
+		catch (...)
+		{
+			const de::ScopedLock lock (m_errorLock);
+
+			if (!m_error.isSet())
+				m_error.capture();
+
+			m_aborted = true;
+		}
+	}
+
+	//! Stop handing out chunks after an error in the calling thread.
+	void			abort			(void) { m_aborted = true; }
+
+	deUint32				getNumChunks	(void) const { return m_numChunks;	}
+	const CapturedError&	getError		(void) const { return m_error;		}
+
+private:
+					ChunkQueue		(const ChunkQueue&); // Not allowed!
+	ChunkQueue&		operator=		(const ChunkQueue&); // Not allowed!
+
+	ParallelJob&		m_job;
+	const size_t		m_numItems;
+	const size_t		m_chunkSize;
+	const deUint32		m_numChunks;
+	volatile deUint32	m_nextChunk;
+	volatile bool		m_aborted;
+
+	de::Mutex			m_errorLock;
+	CapturedError		m_error;
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Worker threads shared by all parallelFor() calls
+ *
+ * Threads are created on first use, as many as the largest thread count
+ * requested so far, and live until the program exits. Only one
+ * parallelFor() uses the pool at a time; tryRun() fails if the pool is
+ * busy, for example when parallelFor() is called from within a job.
+ *//*--------------------------------------------------------------------*/
+class WorkerPool
+{
+public:
+							WorkerPool		(void);
+							~WorkerPool		(void);
+
+	//! Process queue with calling thread and numWorkers pool threads. Returns false if pool is busy.
+	bool					tryRun			(ChunkQueue& queue, int numWorkers);
+
+private:
+	class WorkerThread : public de::Thread
+	{
+	public:
+								WorkerThread	(WorkerPool& pool, int threadNdx);
+
+		void					run				(void);
+		void					wakeUp			(void) { m_wakeUp.increment(); }
+
+	private:
+		WorkerPool&				m_pool;
+		const int				m_threadNdx;
+		de::Semaphore			m_wakeUp;
+	};
+
+							WorkerPool		(const WorkerPool&); // Not allowed!
+	WorkerPool&				operator=		(const WorkerPool&); // Not allowed!
+
+	void					addThreads		(int numThreads);
+	void					wait			(int numWorkers);
+
+	typedef de::SharedPtr<WorkerThread> WorkerThreadSp;
+
+	std::vector<WorkerThreadSp>	m_threads;
+	de::Semaphore				m_finished;
+	de::Mutex					m_runLock;
+
+	// Current queue, written only while workers are idle.
+	ChunkQueue*					m_queue;
+	bool						m_exit;
+};
+
+WorkerPool::WorkerThread::WorkerThread (WorkerPool& pool, int threadNdx)
+	: m_pool		(pool)
+	, m_threadNdx	(threadNdx)
+	, m_wakeUp		(0)
+{
+}
+
+void WorkerPool::WorkerThread::run (void)
+{
+	for (;;)
+	{
+		m_wakeUp.decrement();
+
+		if (m_pool.m_exit)
+			break;
+
+		m_pool.m_queue->executeWorker(m_threadNdx);
+		m_pool.m_finished.increment();
+	}
+}
+
+WorkerPool::WorkerPool (void)
+	: m_finished	(0)
+	, m_queue		(DE_NULL)
+	, m_exit		(false)
+{
+}
+
+WorkerPool::~WorkerPool (void)
+{
+	m_exit = true;
+
+	for (size_t threadNdx = 0; threadNdx < m_threads.size(); ++threadNdx)
+		m_threads[threadNdx]->wakeUp();
+
+	for (size_t threadNdx = 0; threadNdx < m_threads.size(); ++threadNdx)
+		m_threads[threadNdx]->join();
+}
+
+void WorkerPool::addThreads (int numThreads)
+{
+	// Calling thread executes chunks as thread 0.
+	while ((int)m_threads.size() < numThreads)
+	{
+		const WorkerThreadSp thread (new WorkerThread(*this, (int)m_threads.size() + 1));
+
+		thread->start();
+		m_threads.push_back(thread);
+	}
+}
+
+void WorkerPool::wait (int numWorkers)
+{
+	for (int threadNdx = 0; threadNdx < numWorkers; ++threadNdx)
+		m_finished.decrement();
+
+	m_queue = DE_NULL;
+	m_runLock.unlock();
+}
+
+bool WorkerPool::tryRun (ChunkQueue& queue, int numWorkers)
+{
+	if (!m_runLock.tryLock())
+		return false;
+
+	try
+	{
+		addThreads(numWorkers);
+	}
+	catch (...)
+	{
+		m_runLock.unlock();
+		throw;
+	}
+
+	m_queue = &queue;
+
+	for (int threadNdx = 0; threadNdx < numWorkers; ++threadNdx)
+		m_threads[threadNdx]->wakeUp();
+
+	try
+	{
+		queue.execute(0);
+	}
+	catch (...)
+	{
+		queue.abort();
+		wait(numWorkers);
+		throw;
+	}
+
+	wait(numWorkers);
+
+	return true;
+}
+
+WorkerPool		s_workerPool;
+int				s_defaultNumThreads	= 0;
+
+} // anonymous
+
+void parallelFor (ParallelJob& job, size_t numItems, size_t chunkSize, int numThreads)
+{
+	DE_ASSERT(chunkSize > 0);
+
+	if (numItems == 0)
+		return;
+
+	if (numThreads <= 1 || numItems <= chunkSize)
+	{
+		job.execute(0, numItems, 0);
+		return;
+	}
+
+	{
+		ChunkQueue	queue		(job, numItems, chunkSize);
+		const int	numWorkers	= de::min(numThreads, (int)queue.getNumChunks()) - 1;
+
+		// Pool is busy with another parallelFor(), process all chunks in calling thread
+		if (!s_workerPool.tryRun(queue, numWorkers))
+		{
+			queue.execute(0);
+			return;
+		}
+
+		if (queue.getError().isSet())
+			queue.getError().rethrow();
+	}
+}
+
+int getDefaultParallelForThreadCount (void)
+{
+	if (s_defaultNumThreads > 0)
+		return s_defaultNumThreads;
+	else
+		return de::max(1, (int)deGetNumAvailableLogicalCores());
+}
+
+void setDefaultParallelForThreadCount (int numThreads)
+{
+	DE_ASSERT(numThreads >= 0);
+	s_defaultNumThreads = numThreads;
+}
+
+} // tcu
@@ -0,0 +1,73 @@
+#ifndef _TCUPARALLELFOR_HPP
+#define _TCUPARALLELFOR_HPP
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Tester Core
+ * ----------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Parallel execution of independent work items.
+ *//*--------------------------------------------------------------------*/
+
+#include "tcuDefs.hpp"
+
+namespace tcu
+{
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Work executed by parallelFor()
+ *
+ * execute() is called concurrently from several threads, each call with a
+ * distinct range of items. Thread 0 is always the calling thread and
+ * other thread indices are unique within one parallelFor() call, so they
+ * can index per-thread scratch data.
+ *//*--------------------------------------------------------------------*/
+class ParallelJob
+{
+public:
+	virtual			~ParallelJob	(void) {}
+	virtual void	execute			(size_t begin, size_t end, int threadNdx) = 0;
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Execute job for all items in range [0, numItems)
+ *
+ * Items are handed out in chunks of chunkSize to the calling thread and up
+ * to numThreads-1 threads from a worker pool that persists across calls.
+ * Returns when all items have been processed. Calls made while the pool
+ * is in use, including nested calls from execute(), process all chunks in
+ * the calling thread.
+ *
+ * If execute() throws, remaining chunks are skipped and the first error
+ * is rethrown in the calling thread. Errors from worker threads are
+ * rethrown as the same tcu exception type (TestError, NotSupportedError,
+ * ResourceError, ...) with the same message.
+ *
+ * Results should be written per item and consumed after parallelFor()
+ * returns to keep any output independent of the thread count.
+ *//*--------------------------------------------------------------------*/
+void	parallelFor		(ParallelJob& job, size_t numItems, size_t chunkSize, int numThreads);
+
+//! Default thread count for parallelFor(): the number set with setDefaultParallelForThreadCount(), or the number of available cores.
+int		getDefaultParallelForThreadCount	(void);
+
+//! Set default thread count for parallelFor(). 0 selects the number of available cores.
+void	setDefaultParallelForThreadCount	(int numThreads);
+
+} // tcu
+
+#endif // _TCUPARALLELFOR_HPP
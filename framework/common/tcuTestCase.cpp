@@ -97,6 +97,13 @@ void TestNode::addChild (TestNode* node)
 	m_children.push_back(node);
 }
 
+//! Remove all child nodes without destroying them. Caller takes ownership.
+void TestNode::releaseChildren (vector<TestNode*>& res)
+{
+	res.clear();
+	res.swap(m_children);
+}
+
 void TestNode::init (void)
 {
 }
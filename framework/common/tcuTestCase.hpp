@@ -114,6 +114,7 @@ public:
 	const char*				getDescription	(void) const	{ return m_description.c_str(); }
 	void					getChildren		(std::vector<TestNode*>& children);
 	void					addChild		(TestNode* node);
+	void					releaseChildren	(std::vector<TestNode*>& children);
 
 	virtual void			init			(void);
 	virtual void			deinit			(void);
@@ -39,6 +39,7 @@ TestContext::TestContext (
 	, m_log				(log)
 	, m_cmdLine			(cmdLine)
 	, m_watchDog		(watchDog)
+	, m_profiler		(DE_NULL)
 	, m_curArchive		(DE_NULL)
 	, m_testResult		(QP_TEST_RESULT_LAST)
 	, m_terminateAfter	(false)
@@ -36,6 +36,7 @@ class Archive;
 class Platform;
 class CommandLine;
 class TestLog;
+class TestProfiler;
 
 /*--------------------------------------------------------------------*//*!
  * \brief Test context
@@ -58,6 +59,7 @@ public:
 	void					setTestResult		(qpTestResult result, const char* description);
 	void					touchWatchdog		(void);
 	const CommandLine&		getCommandLine		(void) const	{ return m_cmdLine;		}
+	TestProfiler*			getProfiler			(void)			{ return m_profiler;	} //!< Null if profiling is disabled.
 
 	// API for test framework
 	qpTestResult			getTestResult		(void) const	{ return m_testResult;				}
@@ -68,6 +70,7 @@ public:
 	void					setCurrentArchive	(Archive& archive)	{ m_curArchive = &archive;	}
 
 	void					setTerminateAfter	(bool terminate)	{ m_terminateAfter = terminate;	}
+	void					setProfiler			(TestProfiler* profiler)	{ m_profiler = profiler;	}
 	bool					getTerminateAfter	(void) const		{ return m_terminateAfter;		}
 
 protected:
@@ -79,6 +82,7 @@ protected:
 	TestLog&				m_log;				//!< Test log.
 	const CommandLine&		m_cmdLine;			//!< Command line.
 	qpWatchDog*				m_watchDog;			//!< Watchdog (can be null).
+	TestProfiler*			m_profiler;			//!< Timing profiler (can be null).
 
 	Archive*				m_curArchive;		//!< Current archive for test cases.
 	qpTestResult			m_testResult;		//!< Latest test result.
@@ -28,6 +28,7 @@
 #include "qpXmlWriter.h"
 
 #include <fstream>
+#include <sstream>
 
 namespace tcu
 {
@@ -218,4 +219,63 @@ void writeTxtCaselistsToFiles (TestPackageRoot& root, TestContext& testCtx, cons
 	}
 }
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Export the test list of each package into a separate binary file.
+ *
+ * Files are in the binary trie format accepted by --deqp-caselist-file,
+ * written in native byte order (see writeBinaryCaseList()). Combined
+ * with --deqp-caselist-file or --deqp-caselist this converts a text case
+ * list, dropping paths that don't match any case in the package.
+ *//*--------------------------------------------------------------------*/
+void writeBinCaselistsToFiles (TestPackageRoot& root, TestContext& testCtx, const CommandLine& cmdLine)
+{
+	DefaultHierarchyInflater			inflater		(testCtx);
+	de::MovePtr<const CaseListFilter>	caseListFilter	(testCtx.getCommandLine().createCaseListFilter(testCtx.getArchive()));
+
+	TestHierarchyIterator				iter			(root, inflater, *caseListFilter);
+	const char* const					filenamePattern = cmdLine.getCaseListExportFile();
+
+	while (iter.getState() != TestHierarchyIterator::STATE_FINISHED)
+	{
+		const TestNode*		node		= iter.getNode();
+		const char*			pkgName		= node->getName();
+		const string		filename	= makePackageFilename(filenamePattern, pkgName, "bin");
+		std::ostringstream	caseList;
+
+		DE_ASSERT(iter.getState() == TestHierarchyIterator::STATE_ENTER_NODE &&
+				  node->getNodeType() == NODETYPE_PACKAGE);
+
+		iter.next();
+
+		while (iter.getNode()->getNodeType() != NODETYPE_PACKAGE)
+		{
+			if (iter.getState() == TestHierarchyIterator::STATE_ENTER_NODE && isTestNodeTypeExecutable(iter.getNode()->getNodeType()))
+				caseList << iter.getNodePath() << "\n";
+			iter.next();
+		}
+
+		DE_ASSERT(iter.getState() == TestHierarchyIterator::STATE_LEAVE_NODE &&
+				  iter.getNode()->getNodeType() == NODETYPE_PACKAGE);
+		iter.next();
+
+		if (caseList.str().empty())
+		{
+			print("No test cases from '%s' match the case list, skipping\n", pkgName);
+			continue;
+		}
+
+		{
+			std::istringstream	in	(caseList.str());
+			std::ofstream		out	(filename.c_str(), std::ios_base::binary);
+
+			if (!out.is_open() || !out.good())
+				throw Exception("Failed to open " + filename);
+
+			print("Writing test cases from '%s' to file '%s'..\n", pkgName, filename.c_str());
+
+			writeBinaryCaseList(in, out);
+		}
+	}
+}
+
 } // tcu
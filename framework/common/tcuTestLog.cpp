@@ -530,6 +530,11 @@ bool TestLog::isShaderLoggingEnabled (void)
 	return (qpTestLog_getLogFlags(m_log) & QP_TEST_LOG_EXCLUDE_SHADER_SOURCES) == 0;
 }
 
+void TestLog::setImageCompressionLevel (int compressionLevel)
+{
+	qpTestLog_setImageCompressionLevel(m_log, compressionLevel);
+}
+
 const TestLog::BeginMessageToken		TestLog::Message			= TestLog::BeginMessageToken();
 const TestLog::EndMessageToken			TestLog::EndMessage			= TestLog::EndMessageToken();
 const TestLog::EndImageSetToken			TestLog::EndImageSet		= TestLog::EndImageSetToken();
@@ -175,6 +175,8 @@ public:
 	void				endSampleList			(void);
 
 	bool				isShaderLoggingEnabled	(void);
+
+	void				setImageCompressionLevel(int compressionLevel);
 private:
 						TestLog					(const TestLog& other); // Not allowed!
 	TestLog&			operator=				(const TestLog& other); // Not allowed!
@@ -0,0 +1,204 @@
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Tester Core
+ * ----------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Test case timing profiler.
+ *//*--------------------------------------------------------------------*/
+
+#include "tcuTestProfiler.hpp"
+
+#include "deClock.h"
+
+#include <algorithm>
+
+namespace tcu
+{
+
+namespace
+{
+
+struct SlowerThan
+{
+	template<typename T>
+	bool operator() (const T& a, const T& b) const { return a.duration > b.duration; }
+};
+
+void writeJsonString (std::ostream& str, const std::string& value)
+{
+	str << '"';
+
+	for (std::string::const_iterator ch = value.begin(); ch != value.end(); ++ch)
+	{
+		if (*ch == '"' || *ch == '\\')
+			str << '\\' << *ch;
+		else if ((unsigned char)*ch < 0x20)
+			str << ' ';
+		else
+			str << *ch;
+	}
+
+	str << '"';
+}
+
+} // anonymous
+
+TestProfiler::TestProfiler (const char* filename)
+	: m_out					(filename, std::ios_base::binary)
+	, m_sessionStartTime	(deGetMicroseconds())
+	, m_firstEvent			(true)
+	, m_curCaseStartTime	(0)
+{
+	if (!m_out.good())
+		throw ResourceError(std::string("Failed to open profile file ") + filename);
+
+	// Array format is valid without the closing bracket, so trace of a crashed run can be loaded too.
+	m_out << "[";
+}
+
+TestProfiler::~TestProfiler (void)
+{
+	writeSummary();
+}
+
+void TestProfiler::startGroup (const std::string& groupPath)
+{
+	m_openGroups.push_back(OpenNode(groupPath, deGetMicroseconds()));
+}
+
+void TestProfiler::endGroup (const std::string& groupPath)
+{
+	DE_ASSERT(!m_openGroups.empty() && m_openGroups.back().path == groupPath);
+	DE_UNREF(groupPath);
+
+	const OpenNode	group		= m_openGroups.back();
+	const deUint64	duration	= deGetMicroseconds() - group.startTime;
+
+	m_openGroups.pop_back();
+
+	writeEvent("group", group.path, group.startTime, duration, DE_NULL);
+	addSlowest(m_slowestGroups, group.path, duration);
+}
+
+void TestProfiler::startCase (const std::string& casePath)
+{
+	DE_ASSERT(m_curCasePath.empty());
+
+	m_curCasePath		= casePath;
+	m_curCaseStartTime	= deGetMicroseconds();
+}
+
+void TestProfiler::endCase (qpTestResult result)
+{
+	const deUint64	duration	= deGetMicroseconds() - m_curCaseStartTime;
+
+	DE_ASSERT(!m_curCasePath.empty());
+
+	writeEvent("case", m_curCasePath, m_curCaseStartTime, duration, qpGetTestResultName(result));
+	addSlowest(m_slowestCases, m_curCasePath, duration);
+
+	m_curCasePath.clear();
+	m_out.flush();
+}
+
+void TestProfiler::addPhase (const char* name, deUint64 startTime, deUint64 duration)
+{
+	writeEvent("phase", name, startTime, duration, DE_NULL);
+}
+
+void TestProfiler::beginEvent (void)
+{
+	m_out << (m_firstEvent ? "\n" : ",\n");
+	m_firstEvent = false;
+}
+
+void TestProfiler::writeEvent (const char* category, const std::string& name, deUint64 startTime, deUint64 duration, const char* result)
+{
+	beginEvent();
+
+	m_out << "{\"name\":";
+	writeJsonString(m_out, name);
+	m_out << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"ts\":" << (startTime - m_sessionStartTime) << ",\"dur\":" << duration << ",\"pid\":0,\"tid\":0";
+
+	if (result)
+		m_out << ",\"args\":{\"result\":\"" << result << "\"}";
+
+	m_out << "}";
+}
+
+void TestProfiler::addSlowest (std::vector<Entry>& entries, const std::string& path, deUint64 duration)
+{
+	if (entries.size() < (size_t)NUM_SLOWEST_ENTRIES)
+	{
+		entries.push_back(Entry(path, duration));
+		std::push_heap(entries.begin(), entries.end(), SlowerThan());
+	}
+	else if (duration > entries.front().duration)
+	{
+		std::pop_heap(entries.begin(), entries.end(), SlowerThan());
+		entries.back() = Entry(path, duration);
+		std::push_heap(entries.begin(), entries.end(), SlowerThan());
+	}
+}
+
+void TestProfiler::writeSummaryList (const char* name, const char* title, std::vector<Entry>& entries, deUint64 time)
+{
+	std::sort_heap(entries.begin(), entries.end(), SlowerThan());
+
+	print("\n%s:\n", title);
+
+	// Global instant event at end of trace, entries in args
+	beginEvent();
+	m_out << "{\"name\":\"" << name << "\",\"cat\":\"summary\",\"ph\":\"i\",\"s\":\"g\",\"ts\":" << (time - m_sessionStartTime) << ",\"pid\":0,\"tid\":0,\"args\":{\"entries\":[";
+
+	for (size_t entryNdx = 0; entryNdx < entries.size(); entryNdx++)
+	{
+		print("  %10.3f ms  %s\n", (double)entries[entryNdx].duration / 1000.0, entries[entryNdx].path.c_str());
+
+		m_out << (entryNdx == 0 ? "\n" : ",\n") << "{\"path\":";
+		writeJsonString(m_out, entries[entryNdx].path);
+		m_out << ",\"dur\":" << entries[entryNdx].duration << "}";
+	}
+
+	m_out << "]}}";
+}
+
+void TestProfiler::writeSummary (void)
+{
+	const deUint64 endTime = deGetMicroseconds();
+
+	writeSummaryList("slowestCases", "Slowest test cases", m_slowestCases, endTime);
+	writeSummaryList("slowestGroups", "Slowest test groups", m_slowestGroups, endTime);
+
+	m_out << "\n]\n";
+}
+
+ScopedProfilePhase::ScopedProfilePhase (TestProfiler* profiler, const char* name)
+	: m_profiler	(profiler)
+	, m_name		(name)
+	, m_startTime	(profiler ? deGetMicroseconds() : 0)
+{
+}
+
+ScopedProfilePhase::~ScopedProfilePhase (void)
+{
+	if (m_profiler)
+		m_profiler->addPhase(m_name, m_startTime, deGetMicroseconds() - m_startTime);
+}
+
+} // tcu
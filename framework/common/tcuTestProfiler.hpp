@@ -0,0 +1,129 @@
+#ifndef _TCUTESTPROFILER_HPP
+#define _TCUTESTPROFILER_HPP
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Tester Core
+ * ----------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Test case timing profiler.
+ *//*--------------------------------------------------------------------*/
+
+#include "tcuDefs.hpp"
+#include "qpTestLog.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace tcu
+{
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Records durations of test cases, groups and case phases
+ *
+ * Events are streamed to a file in the JSON array variant of Chrome trace
+ * event format (chrome://tracing, Perfetto) as they complete, so the file
+ * can be loaded even if the run crashes. When the profiler is destroyed a
+ * summary of the slowest cases and groups is printed to stdout and added
+ * to the trace as slowestCases and slowestGroups instant events.
+ *
+ * Phases are nested inside the currently open case. Test code can add its
+ * own phases with ScopedProfilePhase using TestContext::getProfiler().
+ *//*--------------------------------------------------------------------*/
+class TestProfiler
+{
+public:
+	enum
+	{
+		NUM_SLOWEST_ENTRIES	= 20	//!< Number of cases and groups listed in summary.
+	};
+
+								TestProfiler		(const char* filename);
+								~TestProfiler		(void);
+
+	void						startGroup			(const std::string& groupPath);
+	void						endGroup			(const std::string& groupPath);
+
+	void						startCase			(const std::string& casePath);
+	void						endCase				(qpTestResult result);
+
+	//! Record phase of the current case. Times are from deGetMicroseconds().
+	void						addPhase			(const char* name, deUint64 startTime, deUint64 duration);
+
+private:
+								TestProfiler		(const TestProfiler&);
+	TestProfiler&				operator=			(const TestProfiler&);
+
+	struct Entry
+	{
+		std::string		path;
+		deUint64		duration;
+
+		Entry (const std::string& path_, deUint64 duration_) : path(path_), duration(duration_) {}
+	};
+
+	struct OpenNode
+	{
+		std::string		path;
+		deUint64		startTime;
+
+		OpenNode (const std::string& path_, deUint64 startTime_) : path(path_), startTime(startTime_) {}
+	};
+
+	void						beginEvent			(void);
+	void						writeEvent			(const char* category, const std::string& name, deUint64 startTime, deUint64 duration, const char* result);
+	void						writeSummary		(void);
+	void						writeSummaryList	(const char* name, const char* title, std::vector<Entry>& entries, deUint64 time);
+
+	static void					addSlowest			(std::vector<Entry>& entries, const std::string& path, deUint64 duration);
+
+	std::ofstream				m_out;
+	const deUint64				m_sessionStartTime;
+	bool						m_firstEvent;
+
+	std::vector<OpenNode>		m_openGroups;
+	std::string					m_curCasePath;
+	deUint64					m_curCaseStartTime;
+
+	std::vector<Entry>			m_slowestCases;		//!< Min-heap of slowest cases.
+	std::vector<Entry>			m_slowestGroups;	//!< Min-heap of slowest groups.
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Times a scope as a phase of the current case
+ *
+ * Does nothing if profiler is null.
+ *//*--------------------------------------------------------------------*/
+class ScopedProfilePhase
+{
+public:
+								ScopedProfilePhase	(TestProfiler* profiler, const char* name);
+								~ScopedProfilePhase	(void);
+
+private:
+								ScopedProfilePhase	(const ScopedProfilePhase&);
+	ScopedProfilePhase&			operator=			(const ScopedProfilePhase&);
+
+	TestProfiler* const			m_profiler;
+	const char* const			m_name;
+	const deUint64				m_startTime;
+};
+
+} // tcu
+
+#endif // _TCUTESTPROFILER_HPP
@@ -57,10 +57,16 @@ TestSessionExecutor::TestSessionExecutor (TestPackageRoot& root, TestContext& te
 	, m_testStartTime		(0)
 	, m_packageStartTime	(0)
 {
+	if (const char* const profileFileName = testCtx.getCommandLine().getProfileFileName())
+	{
+		m_profiler = de::MovePtr<TestProfiler>(new TestProfiler(profileFileName));
+		m_testCtx.setProfiler(m_profiler.get());
+	}
 }
 
 TestSessionExecutor::~TestSessionExecutor (void)
 {
+	m_testCtx.setProfiler(DE_NULL);
 }
 
 bool TestSessionExecutor::iterate (void)
@@ -159,12 +165,19 @@ void TestSessionExecutor::enterTestPackage (TestPackage* testPackage)
 	DE_ASSERT(!m_caseExecutor);
 	m_caseExecutor = de::MovePtr<TestCaseExecutor>(testPackage->createExecutor());
 	m_packageStartTime	= deGetMicroseconds();
+
+	if (m_profiler)
+		m_profiler->startGroup(testPackage->getName());
 }
 
 void TestSessionExecutor::leaveTestPackage (TestPackage* testPackage)
 {
 	DE_UNREF(testPackage);
 	m_caseExecutor.clear();
+
+	if (m_profiler)
+		m_profiler->endGroup(testPackage->getName());
+
 	m_testCtx.getLog().startTestsCasesTime();
 
 	{
@@ -182,11 +195,17 @@ void TestSessionExecutor::leaveTestPackage (TestPackage* testPackage)
 void TestSessionExecutor::enterTestGroup (const std::string& casePath)
 {
 	m_groupsDurationTime[casePath] = deGetMicroseconds();
+
+	if (m_profiler)
+		m_profiler->startGroup(casePath);
 }
 
 void TestSessionExecutor::leaveTestGroup (const std::string& casePath)
 {
 	m_groupsDurationTime[casePath] = deGetMicroseconds() - m_groupsDurationTime[casePath];
+
+	if (m_profiler)
+		m_profiler->endGroup(casePath);
 }
 
 bool TestSessionExecutor::enterTestCase (TestCase* testCase, const std::string& casePath)
@@ -204,8 +223,12 @@ bool TestSessionExecutor::enterTestCase (TestCase* testCase, const std::string&
 	m_isInTestCase	= true;
 	m_testStartTime	= deGetMicroseconds();
 
+	if (m_profiler)
+		m_profiler->startCase(casePath);
+
 	try
 	{
+		const ScopedProfilePhase	phase	(m_profiler.get(), "init");
 		m_caseExecutor->init(testCase, casePath);
 		initOk = true;
 	}
@@ -242,6 +265,7 @@ void TestSessionExecutor::leaveTestCase (TestCase* testCase)
 	// De-init case.
 	try
 	{
+		const ScopedProfilePhase	phase	(m_profiler.get(), "deinit");
 		m_caseExecutor->deinit(testCase);
 	}
 	catch (const tcu::Exception& e)
@@ -263,7 +287,14 @@ void TestSessionExecutor::leaveTestCase (TestCase* testCase)
 		DE_ASSERT(testResult != QP_TEST_RESULT_LAST);
 
 		m_isInTestCase = false;
-		m_testCtx.getLog().endCase(testResult, testResultDesc);
+
+		{
+			const ScopedProfilePhase	phase	(m_profiler.get(), "writeLog");
+			m_testCtx.getLog().endCase(testResult, testResultDesc);
+		}
+
+		if (m_profiler)
+			m_profiler->endCase(testResult);
 
 		// Update statistics.
 		print("  %s (%s)\n", qpGetTestResultName(testResult), testResultDesc);
@@ -296,6 +327,7 @@ TestCase::IterateResult TestSessionExecutor::iterateTestCase (TestCase* testCase
 
 	try
 	{
+		const ScopedProfilePhase	phase	(m_profiler.get(), "iterate");
 		iterateResult = m_caseExecutor->iterate(testCase);
 	}
 	catch (const std::bad_alloc&)
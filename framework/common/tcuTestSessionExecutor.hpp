@@ -28,6 +28,7 @@
 #include "tcuTestCase.hpp"
 #include "tcuTestPackage.hpp"
 #include "tcuTestHierarchyIterator.hpp"
+#include "tcuTestProfiler.hpp"
 #include "deUniquePtr.hpp"
 #include <map>
 
@@ -95,6 +96,7 @@ private:
 	TestHierarchyIterator			m_iterator;
 
 	de::MovePtr<TestCaseExecutor>	m_caseExecutor;
+	de::MovePtr<TestProfiler>		m_profiler;
 	TestRunStatus					m_status;
 	State							m_state;
 	bool							m_abortSession;
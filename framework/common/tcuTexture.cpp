@@ -35,6 +35,14 @@
 
 #include <limits>
 
+#if (DE_CPU == DE_CPU_X86_64)
+#	include <emmintrin.h>
+#	define TCU_TEXTURE_USE_SSE2
+#elif (DE_CPU == DE_CPU_ARM_64)
+#	include <arm_neon.h>
+#	define TCU_TEXTURE_USE_NEON
+#endif
+
 namespace tcu
 {
 
@@ -1498,6 +1506,328 @@ void PixelBufferAccess::setPixel (const IVec4& color, int x, int y, int z) const
 #undef PI
 }
 
+namespace
+{
+
+// Row kernels for common formats. Each must produce exactly the same
+// values as the corresponding per-pixel getter or setter.
+
+typedef void (*ReadPixelsFunc)		(const deUint8* src, int pixelPitch, int numPixels, Vec4* dst);
+typedef void (*ReadPixelsIntFunc)	(const deUint8* src, int pixelPitch, int numPixels, IVec4* dst);
+typedef void (*WritePixelsFunc)		(const Vec4* src, int numPixels, deUint8* dst, int pixelPitch);
+typedef void (*WritePixelsIntFunc)	(const IVec4* src, int numPixels, deUint8* dst, int pixelPitch);
+
+void readRGBA8888FloatPixels (const deUint8* src, int pixelPitch, int numPixels, Vec4* dst)
+{
+	int ndx = 0;
+
+#if defined(TCU_TEXTURE_USE_SSE2)
+	if (pixelPitch == 4)
+	{
+		const __m128i	zero	= _mm_setzero_si128();
+		const __m128	maxVal	= _mm_set1_ps(255.0f);
+
+		for (; ndx+4 <= numPixels; ndx += 4)
+		{
+			const __m128i	packed	= _mm_loadu_si128((const __m128i*)(src + ndx*4));
+			const __m128i	lo		= _mm_unpacklo_epi8(packed, zero);
+			const __m128i	hi		= _mm_unpackhi_epi8(packed, zero);
+
+			_mm_storeu_ps(dst[ndx+0].getPtr(), _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), maxVal));
+			_mm_storeu_ps(dst[ndx+1].getPtr(), _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), maxVal));
+			_mm_storeu_ps(dst[ndx+2].getPtr(), _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), maxVal));
+			_mm_storeu_ps(dst[ndx+3].getPtr(), _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), maxVal));
+		}
+	}
+#elif defined(TCU_TEXTURE_USE_NEON)
+	if (pixelPitch == 4)
+	{
+		const float32x4_t	maxVal	= vdupq_n_f32(255.0f);
+
+		for (; ndx+4 <= numPixels; ndx += 4)
+		{
+			const uint8x16_t	packed	= vld1q_u8(src + ndx*4);
+			const uint16x8_t	lo		= vmovl_u8(vget_low_u8(packed));
+			const uint16x8_t	hi		= vmovl_u8(vget_high_u8(packed));
+
+			vst1q_f32(dst[ndx+0].getPtr(), vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), maxVal));
+			vst1q_f32(dst[ndx+1].getPtr(), vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), maxVal));
+			vst1q_f32(dst[ndx+2].getPtr(), vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), maxVal));
+			vst1q_f32(dst[ndx+3].getPtr(), vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), maxVal));
+		}
+	}
+#endif
+
+	for (; ndx < numPixels; ndx++)
+		dst[ndx] = readRGBA8888Float(src + ndx*pixelPitch);
+}
+
+void readRGBA8888IntPixels (const deUint8* src, int pixelPitch, int numPixels, IVec4* dst)
+{
+	int ndx = 0;
+
+#if defined(TCU_TEXTURE_USE_SSE2)
+	if (pixelPitch == 4)
+	{
+		const __m128i	zero	= _mm_setzero_si128();
+
+		for (; ndx+4 <= numPixels; ndx += 4)
+		{
+			const __m128i	packed	= _mm_loadu_si128((const __m128i*)(src + ndx*4));
+			const __m128i	lo		= _mm_unpacklo_epi8(packed, zero);
+			const __m128i	hi		= _mm_unpackhi_epi8(packed, zero);
+
+			_mm_storeu_si128((__m128i*)dst[ndx+0].getPtr(), _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128((__m128i*)dst[ndx+1].getPtr(), _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128((__m128i*)dst[ndx+2].getPtr(), _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128((__m128i*)dst[ndx+3].getPtr(), _mm_unpackhi_epi16(hi, zero));
+		}
+	}
+#elif defined(TCU_TEXTURE_USE_NEON)
+	if (pixelPitch == 4)
+	{
+		for (; ndx+4 <= numPixels; ndx += 4)
+		{
+			const uint8x16_t	packed	= vld1q_u8(src + ndx*4);
+			const uint16x8_t	lo		= vmovl_u8(vget_low_u8(packed));
+			const uint16x8_t	hi		= vmovl_u8(vget_high_u8(packed));
+
+			vst1q_s32(dst[ndx+0].getPtr(), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(lo))));
+			vst1q_s32(dst[ndx+1].getPtr(), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(lo))));
+			vst1q_s32(dst[ndx+2].getPtr(), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(hi))));
+			vst1q_s32(dst[ndx+3].getPtr(), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(hi))));
+		}
+	}
+#endif
+
+	for (; ndx < numPixels; ndx++)
+		dst[ndx] = readRGBA8888Int(src + ndx*pixelPitch);
+}
+
+void writeRGBA8888IntPixels (const IVec4* src, int numPixels, deUint8* dst, int pixelPitch)
+{
+	int ndx = 0;
+
+	// \note Signed saturation to 16 bits followed by unsigned saturation to 8 bits equals clamp to [0, 255].
+#if defined(TCU_TEXTURE_USE_SSE2)
+	if (pixelPitch == 4)
+	{
+		for (; ndx+4 <= numPixels; ndx += 4)
+		{
+			const __m128i	p0	= _mm_loadu_si128((const __m128i*)src[ndx+0].getPtr());
+			const __m128i	p1	= _mm_loadu_si128((const __m128i*)src[ndx+1].getPtr());
+			const __m128i	p2	= _mm_loadu_si128((const __m128i*)src[ndx+2].getPtr());
+			const __m128i	p3	= _mm_loadu_si128((const __m128i*)src[ndx+3].getPtr());
+
+			_mm_storeu_si128((__m128i*)(dst + ndx*4), _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3)));
+		}
+	}
+#elif defined(TCU_TEXTURE_USE_NEON)
+	if (pixelPitch == 4)
+	{
+		for (; ndx+4 <= numPixels; ndx += 4)
+		{
+			const int16x8_t	p01	= vcombine_s16(vqmovn_s32(vld1q_s32(src[ndx+0].getPtr())), vqmovn_s32(vld1q_s32(src[ndx+1].getPtr())));
+			const int16x8_t	p23	= vcombine_s16(vqmovn_s32(vld1q_s32(src[ndx+2].getPtr())), vqmovn_s32(vld1q_s32(src[ndx+3].getPtr())));
+
+			vst1q_u8(dst + ndx*4, vcombine_u8(vqmovun_s16(p01), vqmovun_s16(p23)));
+		}
+	}
+#endif
+
+	for (; ndx < numPixels; ndx++)
+		writeRGBA8888Int(dst + ndx*pixelPitch, src[ndx]);
+}
+
+void readRGB888FloatPixels (const deUint8* src, int pixelPitch, int numPixels, Vec4* dst)
+{
+	for (int ndx = 0; ndx < numPixels; ndx++)
+		dst[ndx] = readRGB888Float(src + ndx*pixelPitch);
+}
+
+void readRGB888IntPixels (const deUint8* src, int pixelPitch, int numPixels, IVec4* dst)
+{
+	for (int ndx = 0; ndx < numPixels; ndx++)
+		dst[ndx] = readRGB888Int(src + ndx*pixelPitch);
+}
+
+void writeRGBA8888FloatPixels (const Vec4* src, int numPixels, deUint8* dst, int pixelPitch)
+{
+	for (int ndx = 0; ndx < numPixels; ndx++)
+		writeRGBA8888Float(dst + ndx*pixelPitch, src[ndx]);
+}
+
+void writeRGB888FloatPixels (const Vec4* src, int numPixels, deUint8* dst, int pixelPitch)
+{
+	for (int ndx = 0; ndx < numPixels; ndx++)
+		writeRGB888Float(dst + ndx*pixelPitch, src[ndx]);
+}
+
+void writeRGB888IntPixels (const IVec4* src, int numPixels, deUint8* dst, int pixelPitch)
+{
+	for (int ndx = 0; ndx < numPixels; ndx++)
+		writeRGB888Int(dst + ndx*pixelPitch, src[ndx]);
+}
+
+//! Pixels that are stored exactly as Vec4 or IVec4 (32-bit RGBA formats).
+template<typename VecType>
+void readVec4Pixels (const deUint8* src, int pixelPitch, int numPixels, VecType* dst)
+{
+	DE_STATIC_ASSERT(sizeof(VecType) == 4*sizeof(deUint32));
+
+	if (pixelPitch == (int)sizeof(VecType))
+		deMemcpy(dst, src, numPixels*sizeof(VecType));
+	else
+	{
+		for (int ndx = 0; ndx < numPixels; ndx++)
+			deMemcpy(&dst[ndx], src + ndx*pixelPitch, sizeof(VecType));
+	}
+}
+
+template<typename VecType>
+void writeVec4Pixels (const VecType* src, int numPixels, deUint8* dst, int pixelPitch)
+{
+	DE_STATIC_ASSERT(sizeof(VecType) == 4*sizeof(deUint32));
+
+	if (pixelPitch == (int)sizeof(VecType))
+		deMemcpy(dst, src, numPixels*sizeof(VecType));
+	else
+	{
+		for (int ndx = 0; ndx < numPixels; ndx++)
+			deMemcpy(dst + ndx*pixelPitch, &src[ndx], sizeof(VecType));
+	}
+}
+
+inline bool isRGBA8888Order (TextureFormat::ChannelOrder order)
+{
+	return order == TextureFormat::RGBA || order == TextureFormat::sRGBA;
+}
+
+inline bool isRGB888Order (TextureFormat::ChannelOrder order)
+{
+	return order == TextureFormat::RGB || order == TextureFormat::sRGB;
+}
+
+ReadPixelsFunc getReadPixelsFunc (const TextureFormat& format)
+{
+	if (format.type == TextureFormat::UNORM_INT8 && isRGBA8888Order(format.order))
+		return readRGBA8888FloatPixels;
+	else if (format.type == TextureFormat::UNORM_INT8 && isRGB888Order(format.order))
+		return readRGB888FloatPixels;
+	else if (format.type == TextureFormat::FLOAT && format.order == TextureFormat::RGBA)
+		return readVec4Pixels<Vec4>;
+	else
+		return DE_NULL;
+}
+
+ReadPixelsIntFunc getReadPixelsIntFunc (const TextureFormat& format)
+{
+	if ((format.type == TextureFormat::UNORM_INT8 && isRGBA8888Order(format.order)) ||
+		(format.type == TextureFormat::UNSIGNED_INT8 && format.order == TextureFormat::RGBA))
+		return readRGBA8888IntPixels;
+	else if (format.type == TextureFormat::UNORM_INT8 && isRGB888Order(format.order))
+		return readRGB888IntPixels;
+	else if ((format.type == TextureFormat::SIGNED_INT32 || format.type == TextureFormat::UNSIGNED_INT32) && format.order == TextureFormat::RGBA)
+		return readVec4Pixels<IVec4>;
+	else
+		return DE_NULL;
+}
+
+WritePixelsFunc getWritePixelsFunc (const TextureFormat& format)
+{
+	if (format.type == TextureFormat::UNORM_INT8 && isRGBA8888Order(format.order))
+		return writeRGBA8888FloatPixels;
+	else if (format.type == TextureFormat::UNORM_INT8 && isRGB888Order(format.order))
+		return writeRGB888FloatPixels;
+	else if (format.type == TextureFormat::FLOAT && format.order == TextureFormat::RGBA)
+		return writeVec4Pixels<Vec4>;
+	else
+		return DE_NULL;
+}
+
+WritePixelsIntFunc getWritePixelsIntFunc (const TextureFormat& format)
+{
+	// \note UNSIGNED_INT8 saturates negative values to 255 and can't use the RGBA8888 kernel.
+	if (format.type == TextureFormat::UNORM_INT8 && isRGBA8888Order(format.order))
+		return writeRGBA8888IntPixels;
+	else if (format.type == TextureFormat::UNORM_INT8 && isRGB888Order(format.order))
+		return writeRGB888IntPixels;
+	else if ((format.type == TextureFormat::SIGNED_INT32 || format.type == TextureFormat::UNSIGNED_INT32) && format.order == TextureFormat::RGBA)
+		return writeVec4Pixels<IVec4>;
+	else
+		return DE_NULL;
+}
+
+} // anonymous
+
+void ConstPixelBufferAccess::getPixels (Vec4* dst, int numPixels, int x, int y, int z) const
+{
+	DE_ASSERT(numPixels >= 0 && x >= 0 && x + numPixels <= m_size.x());
+	DE_ASSERT(de::inBounds(y, 0, m_size.y()));
+	DE_ASSERT(de::inBounds(z, 0, m_size.z()));
+
+	const ReadPixelsFunc readPixels = getReadPixelsFunc(m_format);
+
+	if (readPixels)
+		readPixels((const deUint8*)getPixelPtr(x, y, z), m_pitch.x(), numPixels, dst);
+	else
+	{
+		for (int ndx = 0; ndx < numPixels; ndx++)
+			dst[ndx] = getPixel(x + ndx, y, z);
+	}
+}
+
+void ConstPixelBufferAccess::getPixelsInt (IVec4* dst, int numPixels, int x, int y, int z) const
+{
+	DE_ASSERT(numPixels >= 0 && x >= 0 && x + numPixels <= m_size.x());
+	DE_ASSERT(de::inBounds(y, 0, m_size.y()));
+	DE_ASSERT(de::inBounds(z, 0, m_size.z()));
+
+	const ReadPixelsIntFunc readPixels = getReadPixelsIntFunc(m_format);
+
+	if (readPixels)
+		readPixels((const deUint8*)getPixelPtr(x, y, z), m_pitch.x(), numPixels, dst);
+	else
+	{
+		for (int ndx = 0; ndx < numPixels; ndx++)
+			dst[ndx] = getPixelInt(x + ndx, y, z);
+	}
+}
+
+void PixelBufferAccess::setPixels (const Vec4* colors, int numPixels, int x, int y, int z) const
+{
+	DE_ASSERT(numPixels >= 0 && x >= 0 && x + numPixels <= getWidth());
+	DE_ASSERT(de::inBounds(y, 0, getHeight()));
+	DE_ASSERT(de::inBounds(z, 0, getDepth()));
+
+	const WritePixelsFunc writePixels = getWritePixelsFunc(m_format);
+
+	if (writePixels)
+		writePixels(colors, numPixels, (deUint8*)getPixelPtr(x, y, z), m_pitch.x());
+	else
+	{
+		for (int ndx = 0; ndx < numPixels; ndx++)
+			setPixel(colors[ndx], x + ndx, y, z);
+	}
+}
+
+void PixelBufferAccess::setPixels (const IVec4* colors, int numPixels, int x, int y, int z) const
+{
+	DE_ASSERT(numPixels >= 0 && x >= 0 && x + numPixels <= getWidth());
+	DE_ASSERT(de::inBounds(y, 0, getHeight()));
+	DE_ASSERT(de::inBounds(z, 0, getDepth()));
+
+	const WritePixelsIntFunc writePixels = getWritePixelsIntFunc(m_format);
+
+	if (writePixels)
+		writePixels(colors, numPixels, (deUint8*)getPixelPtr(x, y, z), m_pitch.x());
+	else
+	{
+		for (int ndx = 0; ndx < numPixels; ndx++)
+			setPixel(colors[ndx], x + ndx, y, z);
+	}
+}
+
 void PixelBufferAccess::setPixDepth (float depth, int x, int y, int z) const
 {
 	DE_ASSERT(de::inBounds(x, 0, getWidth()));
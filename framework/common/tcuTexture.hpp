@@ -332,6 +332,10 @@ class TextureLevel;
  *
  * Access objects are like iterators or pointers. They can be passed around
  * as values and are valid as long as the storage doesn't change.
+ *
+ * getPixels() and getPixelsInt() read a run of pixels along x axis and
+ * resolve the format only once per call. Results are identical to calling
+ * getPixel() or getPixelInt() for each pixel.
  *//*--------------------------------------------------------------------*/
 class ConstPixelBufferAccess
 {
@@ -363,6 +367,9 @@ public:
 	template<typename T>
 	Vector<T, 4>			getPixelT					(int x, int y, int z = 0) const;
 
+	void					getPixels					(Vec4* dst, int numPixels, int x, int y, int z = 0) const;
+	void					getPixelsInt				(IVec4* dst, int numPixels, int x, int y, int z = 0) const;
+
 	float					getPixDepth					(int x, int y, int z = 0) const;
 	int						getPixStencil				(int x, int y, int z = 0) const;
 
@@ -410,6 +417,9 @@ public:
 	void				setPixel			(const tcu::IVec4& color, int x, int y, int z = 0) const;
 	void				setPixel			(const tcu::UVec4& color, int x, int y, int z = 0) const { setPixel(color.cast<int>(), x, y, z); }
 
+	void				setPixels			(const tcu::Vec4* colors, int numPixels, int x, int y, int z = 0) const;
+	void				setPixels			(const tcu::IVec4* colors, int numPixels, int x, int y, int z = 0) const;
+
 	void				setPixDepth			(float depth, int x, int y, int z = 0) const;
 	void				setPixStencil		(int stencil, int x, int y, int z = 0) const;
 } DE_WARN_UNUSED_TYPE;
@@ -28,6 +28,7 @@
 #include "deMemory.h"
 
 #include <limits>
+#include <vector>
 
 namespace tcu
 {
@@ -735,10 +736,11 @@ void clear (const PixelBufferAccess& access, const Vec4& color)
 	}
 	else
 	{
+		const std::vector<Vec4> row (access.getWidth(), color);
+
 		for (int z = 0; z < access.getDepth(); z++)
-			for (int y = 0; y < access.getHeight(); y++)
-				for (int x = 0; x < access.getWidth(); x++)
-					access.setPixel(color, x, y, z);
+			for (int y = 0; !row.empty() && y < access.getHeight(); y++)
+				access.setPixels(&row[0], access.getWidth(), 0, y, z);
 	}
 }
 
@@ -766,10 +768,11 @@ void clear (const PixelBufferAccess& access, const IVec4& color)
 	}
 	else
 	{
+		const std::vector<IVec4> row (access.getWidth(), color);
+
 		for (int z = 0; z < access.getDepth(); z++)
-			for (int y = 0; y < access.getHeight(); y++)
-				for (int x = 0; x < access.getWidth(); x++)
-					access.setPixel(color, x, y, z);
+			for (int y = 0; !row.empty() && y < access.getHeight(); y++)
+				access.setPixels(&row[0], access.getWidth(), 0, y, z);
 	}
 }
 
@@ -1091,17 +1094,25 @@ void copy (const PixelBufferAccess& dst, const ConstPixelBufferAccess& src)
 
 		if (srcIsInt && dstIsInt)
 		{
+			std::vector<IVec4> row (width);
+
 			for (int z = 0; z < depth; z++)
-			for (int y = 0; y < height; y++)
-			for (int x = 0; x < width; x++)
-				dst.setPixel(src.getPixelInt(x, y, z), x, y, z);
+			for (int y = 0; !row.empty() && y < height; y++)
+			{
+				src.getPixelsInt(&row[0], width, 0, y, z);
+				dst.setPixels(&row[0], width, 0, y, z);
+			}
 		}
 		else
 		{
+			std::vector<Vec4> row (width);
+
 			for (int z = 0; z < depth; z++)
-			for (int y = 0; y < height; y++)
-			for (int x = 0; x < width; x++)
-				dst.setPixel(src.getPixel(x, y, z), x, y, z);
+			for (int y = 0; !row.empty() && y < height; y++)
+			{
+				src.getPixels(&row[0], width, 0, y, z);
+				dst.setPixels(&row[0], width, 0, y, z);
+			}
 		}
 	}
 }
@@ -1117,18 +1128,28 @@ void scale (const PixelBufferAccess& dst, const ConstPixelBufferAccess& src, Sam
 	float sY = (float)src.getHeight() / (float)dst.getHeight();
 	float sZ = (float)src.getDepth() / (float)dst.getDepth();
 
+	std::vector<Vec4> row (dst.getWidth());
+
 	if (dst.getDepth() == 1 && src.getDepth() == 1)
 	{
-		for (int y = 0; y < dst.getHeight(); y++)
-		for (int x = 0; x < dst.getWidth(); x++)
-			dst.setPixel(linearToSRGBIfNeeded(dst.getFormat(), src.sample2D(sampler, filter, ((float)x+0.5f)*sX, ((float)y+0.5f)*sY, 0)), x, y);
+		for (int y = 0; !row.empty() && y < dst.getHeight(); y++)
+		{
+			for (int x = 0; x < dst.getWidth(); x++)
+				row[x] = linearToSRGBIfNeeded(dst.getFormat(), src.sample2D(sampler, filter, ((float)x+0.5f)*sX, ((float)y+0.5f)*sY, 0));
+
+			dst.setPixels(&row[0], dst.getWidth(), 0, y);
+		}
 	}
 	else
 	{
 		for (int z = 0; z < dst.getDepth(); z++)
-		for (int y = 0; y < dst.getHeight(); y++)
-		for (int x = 0; x < dst.getWidth(); x++)
-			dst.setPixel(linearToSRGBIfNeeded(dst.getFormat(), src.sample3D(sampler, filter, ((float)x+0.5f)*sX, ((float)y+0.5f)*sY, ((float)z+0.5f)*sZ)), x, y, z);
+		for (int y = 0; !row.empty() && y < dst.getHeight(); y++)
+		{
+			for (int x = 0; x < dst.getWidth(); x++)
+				row[x] = linearToSRGBIfNeeded(dst.getFormat(), src.sample3D(sampler, filter, ((float)x+0.5f)*sX, ((float)y+0.5f)*sY, ((float)z+0.5f)*sZ));
+
+			dst.setPixels(&row[0], dst.getWidth(), 0, y, z);
+		}
 	}
 }
 
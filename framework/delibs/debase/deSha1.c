@@ -172,7 +172,11 @@ void deSha1Stream_finalize (deSha1Stream* stream, deSha1* hash)
 		if (spaceLeftInChunk >= 1 + sizeof(lengthData))
 			deSha1Stream_process(stream, (size_t)(spaceLeftInChunk - sizeof(lengthData)), padding);
 		else
-			deSha1Stream_process(stream, (size_t)(CHUNK_BYTE_SIZE - (sizeof(lengthData)) - spaceLeftInChunk), padding);
+		{
+			/* Length doesn't fit into current chunk, pad it and the next one. */
+			deSha1Stream_process(stream, (size_t)spaceLeftInChunk, padding);
+			deSha1Stream_process(stream, CHUNK_BYTE_SIZE - sizeof(lengthData), padding + 1);
+		}
 	}
 
 	deSha1Stream_process(stream, sizeof(lengthData), lengthData);
@@ -276,6 +280,26 @@ void deSha1_selfTest (void)
 		}
 	};
 
+	/* Hashes of 'a' repeated length times, around the point where the length
+	 * field no longer fits into the last chunk. Generated using sha1sum. */
+	const struct
+	{
+		size_t				length;
+		const char* const	hash;
+	} paddingHashPairs[] =
+	{
+		{ 55,	"c1c8bbdc22796e28c0e15163d20899b65621d65a" },
+		{ 56,	"c2db330f6083854c99d4b5bfb6e8f29f201be699" },
+		{ 57,	"f08f24908d682555111be7ff6f004e78283d989a" },
+		{ 58,	"5ee0f8895f4e1aae6a6661de5c432e34188a5a2d" },
+		{ 59,	"dbc8b8f59ff85a2b1448ed873484b14bf0507246" },
+		{ 60,	"13d956033d9af449bfe2c4ef78c17c20469c4bf1" },
+		{ 61,	"aeab141db28af3353283b5ccb2a322df0b9b5f56" },
+		{ 62,	"67b4b3923fa178d788a9611b76446c96431071f2" },
+		{ 63,	"03f09f5b158a7a8cdad920bddc29b81c18a551f5" },
+		{ 64,	"0098ba824b5c16427bd7a1122a5a442a25ec644d" }
+	};
+
 	const int garbage = 0xde;
 
 	/* Test parsing valid sha1 strings. */
@@ -409,6 +433,32 @@ void deSha1_selfTest (void)
 			DE_TEST_ASSERT(deSha1_equal(&reference, &result));
 		}
 	}
+
+	/* Test padding with lengths close to chunk size. */
+	{
+		size_t ndx;
+
+		for (ndx = 0; ndx < DE_LENGTH_OF_ARRAY(paddingHashPairs); ndx++)
+		{
+			char			data[64];
+			deSha1Stream	stream;
+			deSha1			result;
+			deSha1			reference;
+
+			DE_ASSERT(paddingHashPairs[ndx].length <= sizeof(data));
+			deMemset(data, 'a', sizeof(data));
+			DE_TEST_ASSERT(deSha1_parse(&reference, paddingHashPairs[ndx].hash));
+
+			deSha1_compute(&result, paddingHashPairs[ndx].length, data);
+			DE_TEST_ASSERT(deSha1_equal(&reference, &result));
+
+			deSha1Stream_init(&stream);
+			deSha1Stream_process(&stream, 1, data);
+			deSha1Stream_process(&stream, paddingHashPairs[ndx].length - 1, data + 1);
+			deSha1Stream_finalize(&stream, &result);
+			DE_TEST_ASSERT(deSha1_equal(&reference, &result));
+		}
+	}
 }
 
 DE_END_EXTERN_C
@@ -23,6 +23,12 @@
 
 #include "deFile.h"
 #include "deMemory.h"
+#include "deString.h"
+#include "deClock.h"
+#include "deAtomic.h"
+
+#include <stdio.h>
+#include <string.h>
 
 #if (DE_OS == DE_OS_UNIX) || (DE_OS == DE_OS_OSX) || (DE_OS == DE_OS_IOS) || (DE_OS == DE_OS_ANDROID) || (DE_OS == DE_OS_SYMBIAN) || (DE_OS == DE_OS_QNX)
 
@@ -49,6 +55,16 @@ deBool deDeleteFile (const char* filename)
 	return unlink(filename) == 0;
 }
 
+deInt64 deGetFileModificationTime (const char* filename)
+{
+	struct stat st;
+
+	if (stat(filename, &st) != 0)
+		return -1;
+
+	return (deInt64)st.st_mtime;
+}
+
 deFile* deFile_createFromHandle (deUintptr handle)
 {
 	int		fd		= (int)handle;
@@ -204,6 +220,35 @@ deFileResult deFile_write (deFile* file, const void* buf, deInt64 bufSize, deInt
 	return mapReadWriteResult(numWritten);
 }
 
+static deBool setLock (deFile* file, short type)
+{
+	struct flock	lock;
+	int				result;
+
+	deMemset(&lock, 0, sizeof(lock));
+	lock.l_type		= type;
+	lock.l_whence	= SEEK_SET;
+	lock.l_start	= 0;
+	lock.l_len		= 0; /* Whole file. */
+
+	do
+	{
+		result = fcntl(file->fd, F_SETLKW, &lock);
+	} while (result != 0 && errno == EINTR);
+
+	return result == 0;
+}
+
+deBool deFile_lock (deFile* file)
+{
+	return setLock(file, F_WRLCK);
+}
+
+deBool deFile_unlock (deFile* file)
+{
+	return setLock(file, F_UNLCK);
+}
+
 #elif (DE_OS == DE_OS_WIN32)
 
 #define VC_EXTRALEAN
@@ -225,6 +270,16 @@ deBool deDeleteFile (const char* filename)
 	return DeleteFile(filename) == TRUE;
 }
 
+deInt64 deGetFileModificationTime (const char* filename)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attribs;
+
+	if (!GetFileAttributesEx(filename, GetFileExInfoStandard, &attribs))
+		return -1;
+
+	return (deInt64)(((deUint64)attribs.ftLastWriteTime.dwHighDateTime << 32) | (deUint64)attribs.ftLastWriteTime.dwLowDateTime);
+}
+
 deFile* deFile_createFromHandle (deUintptr handle)
 {
 	deFile* file = (deFile*)deCalloc(sizeof(deFile));
@@ -396,6 +451,181 @@ deFileResult deFile_write (deFile* file, const void* buf, deInt64 bufSize, deInt
 	return mapReadWriteResult(result, numWritten32);
 }
 
+deBool deFile_lock (deFile* file)
+{
+	OVERLAPPED overlapped;
+
+	deMemset(&overlapped, 0, sizeof(overlapped));
+
+	return LockFileEx(file->handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+}
+
+deBool deFile_unlock (deFile* file)
+{
+	OVERLAPPED overlapped;
+
+	deMemset(&overlapped, 0, sizeof(overlapped));
+
+	return UnlockFileEx(file->handle, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+}
+
 #else
 #	error Implement deFile for your OS.
 #endif
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Replace file contents atomically
+ * \param filename	File name
+ * \param data		Data to write
+ * \param dataSize	Size of data in bytes
+ * \return True on success
+ *
+ * Data is written to a uniquely named temporary file next to filename,
+ * which is then renamed over filename. Readers that have the old file
+ * open or mapped keep seeing the old contents, and other readers see
+ * either the old or the new file, never a partially written one.
+ *
+ * Renaming over an existing file is not supported on all platforms. If
+ * rename fails, filename is deleted and rename is retried, so filename
+ * may be briefly missing. On failure the temporary file is removed.
+ *//*--------------------------------------------------------------------*/
+deBool deWriteFileAtomic (const char* filename, const void* data, deInt64 dataSize)
+{
+	static volatile deUint32	s_tmpFileCounter	= 0;
+	const size_t				tmpNameSize			= strlen(filename) + 64;
+	char*						tmpName				= (char*)deMalloc(tmpNameSize);
+	deFile*						file				= DE_NULL;
+	deBool						ok					= DE_FALSE;
+	int							attemptNdx;
+
+	if (!tmpName)
+		return DE_FALSE;
+
+	/* File is created exclusively, so concurrent writers never share a temporary file. */
+	for (attemptNdx = 0; attemptNdx < 16 && !file; attemptNdx++)
+	{
+		deSprintf(tmpName, tmpNameSize, "%s.%llu.%u.tmp", filename, (unsigned long long)deGetMicroseconds(), deAtomicIncrementUint32(&s_tmpFileCounter));
+		file = deFile_create(tmpName, DE_FILEMODE_WRITE|DE_FILEMODE_CREATE);
+	}
+
+	if (file)
+	{
+		const deUint8*	ptr		= (const deUint8*)data;
+		deInt64			numLeft	= dataSize;
+
+		ok = DE_TRUE;
+
+		while (ok && numLeft > 0)
+		{
+			deInt64 numWritten = 0;
+
+			ok		= deFile_write(file, ptr, numLeft, &numWritten) == DE_FILERESULT_SUCCESS;
+			ptr		+= numWritten;
+			numLeft	-= numWritten;
+		}
+
+		deFile_destroy(file);
+
+		if (ok && rename(tmpName, filename) != 0)
+		{
+			deDeleteFile(filename);
+			ok = rename(tmpName, filename) == 0;
+		}
+
+		if (!ok)
+			deDeleteFile(tmpName);
+	}
+
+	deFree(tmpName);
+	return ok;
+}
+
+static deBool fileContentsEqual (const char* filename, const deUint8* data, deInt64 dataSize)
+{
+	deFile*		file		= deFile_create(filename, DE_FILEMODE_READ|DE_FILEMODE_OPEN);
+	deUint8*	buf			= (deUint8*)deMalloc((size_t)dataSize + 1);
+	deInt64		numRead		= 0;
+	deBool		isEqual		= DE_FALSE;
+
+	if (file && buf)
+	{
+		while (numRead <= dataSize)
+		{
+			deInt64 curRead = 0;
+
+			if (deFile_read(file, buf + numRead, dataSize + 1 - numRead, &curRead) != DE_FILERESULT_SUCCESS)
+				break;
+
+			numRead += curRead;
+		}
+
+		isEqual = numRead == dataSize && deMemCmp(buf, data, (size_t)dataSize) == 0;
+	}
+
+	if (file)
+		deFile_destroy(file);
+
+	deFree(buf);
+	return isEqual;
+}
+
+void deFile_selfTest (void)
+{
+	const char* const	filename	= "deFile_selfTest.tmp";
+	deUint8				data[4096 + 17];
+	int					ndx;
+
+	for (ndx = 0; ndx < DE_LENGTH_OF_ARRAY(data); ndx++)
+		data[ndx] = (deUint8)(ndx * 31 + 7);
+
+	deDeleteFile(filename);
+	DE_TEST_ASSERT(!deFileExists(filename));
+	DE_TEST_ASSERT(deGetFileModificationTime(filename) == -1);
+
+	/* New file. */
+	DE_TEST_ASSERT(deWriteFileAtomic(filename, data, (deInt64)sizeof(data)));
+	DE_TEST_ASSERT(fileContentsEqual(filename, data, (deInt64)sizeof(data)));
+	DE_TEST_ASSERT(deGetFileModificationTime(filename) >= 0);
+
+	/* Replace with shorter contents, old file stays readable through open handle. Open files can't be replaced on Win32. */
+#if (DE_OS != DE_OS_WIN32)
+	{
+		deFile*		oldFile		= deFile_create(filename, DE_FILEMODE_READ|DE_FILEMODE_OPEN);
+		deUint8		buf[17];
+		deInt64		numRead		= 0;
+
+		DE_TEST_ASSERT(oldFile);
+		DE_TEST_ASSERT(deWriteFileAtomic(filename, data + 17, 17));
+		DE_TEST_ASSERT(fileContentsEqual(filename, data + 17, 17));
+
+		DE_TEST_ASSERT(deFile_seek(oldFile, DE_FILEPOSITION_END, -17));
+		DE_TEST_ASSERT(deFile_read(oldFile, buf, 17, &numRead) == DE_FILERESULT_SUCCESS && numRead == 17);
+		DE_TEST_ASSERT(deMemCmp(buf, data + sizeof(data) - 17, 17) == 0);
+
+		deFile_destroy(oldFile);
+	}
+#else
+	DE_TEST_ASSERT(deWriteFileAtomic(filename, data + 17, 17));
+	DE_TEST_ASSERT(fileContentsEqual(filename, data + 17, 17));
+#endif
+
+	/* Empty file. */
+	DE_TEST_ASSERT(deWriteFileAtomic(filename, DE_NULL, 0));
+	DE_TEST_ASSERT(fileContentsEqual(filename, data, 0));
+
+	/* Lock can be released and acquired again. */
+	{
+		deFile* file = deFile_create(filename, DE_FILEMODE_WRITE|DE_FILEMODE_OPEN);
+
+		DE_TEST_ASSERT(file);
+		DE_TEST_ASSERT(deFile_lock(file));
+		DE_TEST_ASSERT(deFile_unlock(file));
+		DE_TEST_ASSERT(deFile_lock(file));
+		deFile_destroy(file);
+	}
+
+	/* Missing directory, no file is created. */
+	DE_TEST_ASSERT(!deWriteFileAtomic("deFile_selfTest.missing/file.tmp", data, 1));
+
+	DE_TEST_ASSERT(deDeleteFile(filename));
+}
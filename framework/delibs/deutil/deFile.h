@@ -68,6 +68,8 @@ typedef enum deFilePosition_e
 
 deBool			deFileExists			(const char* filename);
 deBool			deDeleteFile			(const char* filename);
+deInt64			deGetFileModificationTime	(const char* filename);	/*!< Platform-specific units, only comparable to other results. -1 on failure. */
+deBool			deWriteFileAtomic		(const char* filename, const void* data, deInt64 dataSize);
 
 deFile*			deFile_create			(const char* filename, deUint32 mode);
 deFile*			deFile_createFromHandle	(deUintptr handle);
@@ -82,6 +84,14 @@ deInt64			deFile_getSize			(const deFile* file);
 deFileResult	deFile_read				(deFile* file, void* buf, deInt64 bufSize, deInt64* numRead);
 deFileResult	deFile_write			(deFile* file, const void* buf, deInt64 bufSize, deInt64* numWritten);
 
+/* Exclusive lock on the whole file, waits until lock is available. Locks are
+ * advisory on Unix and held by the process: they don't exclude other threads
+ * and are released when any descriptor of the file in the process is closed. */
+deBool			deFile_lock				(deFile* file);
+deBool			deFile_unlock			(deFile* file);
+
+void			deFile_selfTest			(void);
+
 DE_END_EXTERN_C
 
 #endif /* _DEFILE_H */
@@ -0,0 +1,298 @@
+/*-------------------------------------------------------------------------
+ * drawElements Utility Library
+ * ----------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Read-only memory-mapped file.
+ *//*--------------------------------------------------------------------*/
+
+#include "deMappedFile.h"
+#include "deMemory.h"
+#include "deFile.h"
+
+#if (DE_OS == DE_OS_UNIX) || (DE_OS == DE_OS_OSX) || (DE_OS == DE_OS_IOS) || (DE_OS == DE_OS_ANDROID) || (DE_OS == DE_OS_QNX)
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct deMappedFile_s
+{
+	void*	ptr;
+	deInt64	size;
+};
+
+deMappedFile* deMappedFile_create (const char* filename)
+{
+	deMappedFile*	file	= DE_NULL;
+	struct stat		st;
+	int				fd		= open(filename, O_RDONLY);
+
+	if (fd < 0)
+		return DE_NULL;
+
+	if (fstat(fd, &st) != 0 || (deInt64)(size_t)st.st_size != (deInt64)st.st_size)
+	{
+		close(fd);
+		return DE_NULL;
+	}
+
+	file = (deMappedFile*)deCalloc(sizeof(deMappedFile));
+	if (!file)
+	{
+		close(fd);
+		return DE_NULL;
+	}
+
+	file->size = (deInt64)st.st_size;
+
+	/* Zero-sized mappings are not allowed. */
+	if (file->size > 0)
+	{
+		file->ptr = mmap(DE_NULL, (size_t)file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (file->ptr == MAP_FAILED)
+		{
+			close(fd);
+			deFree(file);
+			return DE_NULL;
+		}
+	}
+
+	/* Mapping holds a reference to the file. */
+	close(fd);
+
+	return file;
+}
+
+void deMappedFile_destroy (deMappedFile* file)
+{
+	if (file->ptr)
+		munmap(file->ptr, (size_t)file->size);
+
+	deFree(file);
+}
+
+#elif (DE_OS == DE_OS_WIN32)
+
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+struct deMappedFile_s
+{
+	void*	ptr;
+	deInt64	size;
+};
+
+deMappedFile* deMappedFile_create (const char* filename)
+{
+	deMappedFile*	file		= DE_NULL;
+	HANDLE			handle		= CreateFile(filename, GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, DE_NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, DE_NULL);
+	HANDLE			mapping		= DE_NULL;
+	LARGE_INTEGER	size;
+
+	if (handle == INVALID_HANDLE_VALUE)
+		return DE_NULL;
+
+	if (!GetFileSizeEx(handle, &size) || (deInt64)(SIZE_T)size.QuadPart != (deInt64)size.QuadPart)
+	{
+		CloseHandle(handle);
+		return DE_NULL;
+	}
+
+	file = (deMappedFile*)deCalloc(sizeof(deMappedFile));
+	if (!file)
+	{
+		CloseHandle(handle);
+		return DE_NULL;
+	}
+
+	file->size = (deInt64)size.QuadPart;
+
+	/* Zero-sized mappings are not allowed. */
+	if (file->size > 0)
+	{
+		mapping = CreateFileMapping(handle, DE_NULL, PAGE_READONLY, 0, 0, DE_NULL);
+
+		if (mapping)
+		{
+			file->ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)file->size);
+			CloseHandle(mapping);
+		}
+
+		if (!file->ptr)
+		{
+			CloseHandle(handle);
+			deFree(file);
+			return DE_NULL;
+		}
+	}
+
+	/* View holds a reference to the file. */
+	CloseHandle(handle);
+
+	return file;
+}
+
+void deMappedFile_destroy (deMappedFile* file)
+{
+	if (file->ptr)
+		UnmapViewOfFile(file->ptr);
+
+	deFree(file);
+}
+
+#else
+
+/* Fall back to reading the whole file. */
+
+struct deMappedFile_s
+{
+	void*	ptr;
+	deInt64	size;
+};
+
+deMappedFile* deMappedFile_create (const char* filename)
+{
+	deFile*			src		= deFile_create(filename, DE_FILEMODE_READ|DE_FILEMODE_OPEN);
+	deMappedFile*	file	= DE_NULL;
+	deInt64			numRead	= 0;
+
+	if (!src)
+		return DE_NULL;
+
+	file = (deMappedFile*)deCalloc(sizeof(deMappedFile));
+	if (!file)
+	{
+		deFile_destroy(src);
+		return DE_NULL;
+	}
+
+	file->size = deFile_getSize(src);
+
+	if (file->size > 0)
+	{
+		file->ptr = deMalloc((size_t)file->size);
+
+		if (!file->ptr || deFile_read(src, file->ptr, file->size, &numRead) != DE_FILERESULT_SUCCESS || numRead != file->size)
+		{
+			deFree(file->ptr);
+			deFree(file);
+			file = DE_NULL;
+		}
+	}
+
+	deFile_destroy(src);
+
+	return file;
+}
+
+void deMappedFile_destroy (deMappedFile* file)
+{
+	deFree(file->ptr);
+	deFree(file);
+}
+
+#endif
+
+const void* deMappedFile_getPtr (const deMappedFile* file)
+{
+	return file->ptr;
+}
+
+deInt64 deMappedFile_getSize (const deMappedFile* file)
+{
+	return file->size;
+}
+
+static void writeTestFile (const char* filename, const deUint8* data, deInt64 size, deUint32 mode)
+{
+	deFile*	file		= deFile_create(filename, mode);
+	deInt64	numWritten	= 0;
+
+	DE_TEST_ASSERT(file);
+	DE_TEST_ASSERT(size == 0 || deFile_write(file, data, size, &numWritten) == DE_FILERESULT_SUCCESS);
+	DE_TEST_ASSERT(numWritten == size);
+
+	deFile_destroy(file);
+}
+
+void deMappedFile_selfTest (void)
+{
+	const char* const	filename	= "deMappedFile_selfTest.tmp";
+	deUint8				data[3*4096 + 17];
+	int					ndx;
+
+	for (ndx = 0; ndx < DE_LENGTH_OF_ARRAY(data); ndx++)
+		data[ndx] = (deUint8)(ndx * 31 + 7);
+
+	deDeleteFile(filename);
+
+	/* Missing file. */
+	DE_TEST_ASSERT(!deMappedFile_create(filename));
+
+	/* Empty file. */
+	{
+		deMappedFile* file;
+
+		writeTestFile(filename, data, 0, DE_FILEMODE_WRITE|DE_FILEMODE_CREATE|DE_FILEMODE_OPEN|DE_FILEMODE_TRUNCATE);
+
+		file = deMappedFile_create(filename);
+		DE_TEST_ASSERT(file);
+		DE_TEST_ASSERT(deMappedFile_getSize(file) == 0);
+		DE_TEST_ASSERT(deMappedFile_getPtr(file) == DE_NULL);
+		deMappedFile_destroy(file);
+	}
+
+	/* Contents, and appended data is not visible through existing mapping. */
+	{
+		deMappedFile* file;
+
+		writeTestFile(filename, data, (deInt64)sizeof(data) - 17, DE_FILEMODE_WRITE|DE_FILEMODE_CREATE|DE_FILEMODE_OPEN|DE_FILEMODE_TRUNCATE);
+
+		file = deMappedFile_create(filename);
+		DE_TEST_ASSERT(file);
+		DE_TEST_ASSERT(deMappedFile_getSize(file) == (deInt64)sizeof(data) - 17);
+		DE_TEST_ASSERT(deMemCmp(deMappedFile_getPtr(file), data, sizeof(data) - 17) == 0);
+
+		{
+			deFile* appendFile = deFile_create(filename, DE_FILEMODE_WRITE|DE_FILEMODE_OPEN);
+			deInt64 numWritten = 0;
+
+			DE_TEST_ASSERT(appendFile);
+			DE_TEST_ASSERT(deFile_seek(appendFile, DE_FILEPOSITION_END, 0));
+			DE_TEST_ASSERT(deFile_write(appendFile, &data[sizeof(data) - 17], 17, &numWritten) == DE_FILERESULT_SUCCESS && numWritten == 17);
+			deFile_destroy(appendFile);
+		}
+
+		DE_TEST_ASSERT(deMappedFile_getSize(file) == (deInt64)sizeof(data) - 17);
+		DE_TEST_ASSERT(deMemCmp(deMappedFile_getPtr(file), data, sizeof(data) - 17) == 0);
+		deMappedFile_destroy(file);
+
+		file = deMappedFile_create(filename);
+		DE_TEST_ASSERT(file);
+		DE_TEST_ASSERT(deMappedFile_getSize(file) == (deInt64)sizeof(data));
+		DE_TEST_ASSERT(deMemCmp(deMappedFile_getPtr(file), data, sizeof(data)) == 0);
+		deMappedFile_destroy(file);
+	}
+
+	deDeleteFile(filename);
+}
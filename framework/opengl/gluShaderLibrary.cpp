@@ -26,10 +26,15 @@
 #include "tcuStringTemplate.hpp"
 #include "tcuResource.hpp"
 #include "tcuTestLog.hpp"
+#include "tcuCommandLine.hpp"
 
 #include "deStringUtil.hpp"
 #include "deUniquePtr.hpp"
 #include "deFilePath.hpp"
+#include "deSha1.hpp"
+#include "deMemory.h"
+#include "deMappedFile.h"
+#include "deFile.h"
 
 #include "glwEnums.hpp"
 
@@ -246,6 +251,393 @@ bool isCapabilityRequired(CapabilityFlag capabilityFlag, const ShaderCaseSpecifi
 	return false;
 }
 
+// Serialized form
+
+/*--------------------------------------------------------------------*//*!
+ * Parsed files are stored as a node stream in host byte order:
+ *
+ *  NodeList	:= u32 numNodes, Node*
+ *  Node		:= u32 nodeType, string name, string description,
+ *				   u32 payloadSize, payload
+ *  payload		:= NodeList (groups) | ShaderCaseSpecification (cases)
+ *  string		:= u32 length, char*
+ *
+ * Payload size allows skipping over groups that are not entered.
+ *//*--------------------------------------------------------------------*/
+
+enum SerializedNodeType
+{
+	SERIALIZED_NODE_GROUP	= 0,
+	SERIALIZED_NODE_CASE,
+
+	SERIALIZED_NODE_LAST
+};
+
+class DataWriter
+{
+public:
+							DataWriter		(vector<deUint8>& dst) : m_dst(dst) {}
+
+	size_t					getSize			(void) const	{ return m_dst.size(); }
+
+	void					write			(deUint32 value);
+	void					write			(const string& value);
+	void					write			(const vector<string>& values);
+
+	//! Overwrite value written earlier at offset.
+	void					patch			(size_t offset, deUint32 value);
+
+private:
+	vector<deUint8>&		m_dst;
+};
+
+void DataWriter::write (deUint32 value)
+{
+	const size_t offset = m_dst.size();
+
+	m_dst.resize(offset + sizeof(value));
+	deMemcpy(&m_dst[offset], &value, sizeof(value));
+}
+
+void DataWriter::write (const string& value)
+{
+	write((deUint32)value.size());
+	m_dst.insert(m_dst.end(), value.begin(), value.end());
+}
+
+void DataWriter::write (const vector<string>& values)
+{
+	write((deUint32)values.size());
+
+	for (size_t ndx = 0; ndx < values.size(); ndx++)
+		write(values[ndx]);
+}
+
+void DataWriter::patch (size_t offset, deUint32 value)
+{
+	DE_ASSERT(offset + sizeof(value) <= m_dst.size());
+	deMemcpy(&m_dst[offset], &value, sizeof(value));
+}
+
+//! Reads data written by DataWriter. Throws on reads past end of data.
+class DataReader
+{
+public:
+							DataReader		(const deUint8* begin, const deUint8* end) : m_cur(begin), m_end(end) {}
+
+	const deUint8*			getPtr			(void) const	{ return m_cur; }
+
+	deUint32				readUint32		(void);
+	string					readString		(void);
+	void					readStrings		(vector<string>& dst);
+	void					skip			(size_t numBytes);
+
+private:
+	void					checkSize		(size_t numBytes) const;
+
+	const deUint8*			m_cur;
+	const deUint8*			m_end;
+};
+
+void DataReader::checkSize (size_t numBytes) const
+{
+	if ((size_t)(m_end - m_cur) < numBytes)
+		throw tcu::InternalError("Truncated shader library data");
+}
+
+deUint32 DataReader::readUint32 (void)
+{
+	deUint32 value;
+
+	checkSize(sizeof(value));
+	deMemcpy(&value, m_cur, sizeof(value));
+	m_cur += sizeof(value);
+
+	return value;
+}
+
+string DataReader::readString (void)
+{
+	const deUint32	length	= readUint32();
+	const char*		start	= (const char*)m_cur;
+
+	checkSize(length);
+	m_cur += length;
+
+	return string(start, start + length);
+}
+
+void DataReader::readStrings (vector<string>& dst)
+{
+	dst.resize(readUint32());
+
+	for (size_t ndx = 0; ndx < dst.size(); ndx++)
+		dst[ndx] = readString();
+}
+
+void DataReader::skip (size_t numBytes)
+{
+	checkSize(numBytes);
+	m_cur += numBytes;
+}
+
+static void writeValues (DataWriter& dst, const vector<Value>& values)
+{
+	dst.write((deUint32)values.size());
+
+	for (size_t valueNdx = 0; valueNdx < values.size(); valueNdx++)
+	{
+		const Value& value = values[valueNdx];
+
+		// Parser only produces values of basic types
+		if (!value.type.isBasicType())
+			throw tcu::InternalError("Can't serialize value of non-basic type");
+
+		dst.write((deUint32)value.type.getBasicType());
+		dst.write((deUint32)value.type.getPrecision());
+		dst.write(value.name);
+		dst.write((deUint32)value.elements.size());
+
+		for (size_t elemNdx = 0; elemNdx < value.elements.size(); elemNdx++)
+			dst.write((deUint32)value.elements[elemNdx].int32);
+	}
+}
+
+static void readValues (DataReader& src, vector<Value>& values)
+{
+	values.resize(src.readUint32());
+
+	for (size_t valueNdx = 0; valueNdx < values.size(); valueNdx++)
+	{
+		Value&				value		= values[valueNdx];
+		const DataType		basicType	= (DataType)src.readUint32();
+		const Precision		precision	= (Precision)src.readUint32();
+
+		value.type	= VarType(basicType, precision);
+		value.name	= src.readString();
+		value.elements.resize(src.readUint32());
+
+		for (size_t elemNdx = 0; elemNdx < value.elements.size(); elemNdx++)
+			value.elements[elemNdx].int32 = (deInt32)src.readUint32();
+	}
+}
+
+static void writeSpec (DataWriter& dst, const ShaderCaseSpecification& spec)
+{
+	dst.write((deUint32)spec.caseType);
+	dst.write((deUint32)spec.expectResult);
+	dst.write((deUint32)spec.outputType);
+	dst.write((deUint32)spec.outputFormat);
+	dst.write((deUint32)spec.targetVersion);
+
+	dst.write((deUint32)spec.requiredCaps.size());
+	for (size_t capNdx = 0; capNdx < spec.requiredCaps.size(); capNdx++)
+	{
+		const RequiredCapability& cap = spec.requiredCaps[capNdx];
+
+		dst.write((deUint32)cap.type);
+		dst.write(cap.type == CAPABILITY_FLAG ? (deUint32)cap.flagName : cap.enumName);
+		dst.write((deUint32)cap.referenceValue);
+	}
+
+	writeValues(dst, spec.values.inputs);
+	writeValues(dst, spec.values.outputs);
+	writeValues(dst, spec.values.uniforms);
+
+	dst.write((deUint32)spec.programs.size());
+	for (size_t progNdx = 0; progNdx < spec.programs.size(); progNdx++)
+	{
+		const ProgramSpecification&	program	= spec.programs[progNdx];
+		const ProgramSources&		sources	= program.sources;
+
+		for (int shaderType = 0; shaderType < SHADERTYPE_LAST; shaderType++)
+			dst.write(sources.sources[shaderType]);
+
+		dst.write((deUint32)sources.attribLocationBindings.size());
+		for (size_t bindingNdx = 0; bindingNdx < sources.attribLocationBindings.size(); bindingNdx++)
+		{
+			dst.write(sources.attribLocationBindings[bindingNdx].name);
+			dst.write(sources.attribLocationBindings[bindingNdx].location);
+		}
+
+		dst.write(sources.transformFeedbackBufferMode);
+		dst.write(sources.transformFeedbackVaryings);
+		dst.write(sources.separable ? 1u : 0u);
+
+		dst.write((deUint32)program.requiredExtensions.size());
+		for (size_t extNdx = 0; extNdx < program.requiredExtensions.size(); extNdx++)
+		{
+			dst.write(program.requiredExtensions[extNdx].alternatives);
+			dst.write(program.requiredExtensions[extNdx].effectiveStages);
+		}
+
+		dst.write(program.activeStages);
+	}
+}
+
+static void readSpec (DataReader& src, ShaderCaseSpecification& spec)
+{
+	spec.caseType		= (CaseType)src.readUint32();
+	spec.expectResult	= (ExpectResult)src.readUint32();
+	spec.outputType		= (OutputType)src.readUint32();
+	spec.outputFormat	= (DataType)src.readUint32();
+	spec.targetVersion	= (GLSLVersion)src.readUint32();
+
+	{
+		const deUint32 numCaps = src.readUint32();
+
+		for (deUint32 capNdx = 0; capNdx < numCaps; capNdx++)
+		{
+			const CapabilityType	type			= (CapabilityType)src.readUint32();
+			const deUint32			name			= src.readUint32();
+			const int				referenceValue	= (int)src.readUint32();
+
+			if (type == CAPABILITY_FLAG)
+				spec.requiredCaps.push_back(RequiredCapability((CapabilityFlag)name));
+			else
+				spec.requiredCaps.push_back(RequiredCapability(name, referenceValue));
+		}
+	}
+
+	readValues(src, spec.values.inputs);
+	readValues(src, spec.values.outputs);
+	readValues(src, spec.values.uniforms);
+
+	spec.programs.resize(src.readUint32());
+	for (size_t progNdx = 0; progNdx < spec.programs.size(); progNdx++)
+	{
+		ProgramSpecification&	program	= spec.programs[progNdx];
+		ProgramSources&			sources	= program.sources;
+
+		for (int shaderType = 0; shaderType < SHADERTYPE_LAST; shaderType++)
+			src.readStrings(sources.sources[shaderType]);
+
+		{
+			const deUint32 numBindings = src.readUint32();
+
+			for (deUint32 bindingNdx = 0; bindingNdx < numBindings; bindingNdx++)
+			{
+				const string	name		= src.readString();
+				const deUint32	location	= src.readUint32();
+
+				sources.attribLocationBindings.push_back(AttribLocationBinding(name, location));
+			}
+		}
+
+		sources.transformFeedbackBufferMode	= src.readUint32();
+		src.readStrings(sources.transformFeedbackVaryings);
+		sources.separable					= src.readUint32() != 0;
+
+		program.requiredExtensions.resize(src.readUint32());
+		for (size_t extNdx = 0; extNdx < program.requiredExtensions.size(); extNdx++)
+		{
+			src.readStrings(program.requiredExtensions[extNdx].alternatives);
+			program.requiredExtensions[extNdx].effectiveStages = src.readUint32();
+		}
+
+		program.activeStages = src.readUint32();
+	}
+}
+
+//! Writes parsed groups and cases as node stream.
+class NodeWriter
+{
+public:
+							NodeWriter		(vector<deUint8>& dst);
+
+	void					beginGroup		(const string& name, const string& description);
+	void					endGroup		(void);
+	void					addCase			(const string& name, const string& description, const ShaderCaseSpecification& spec);
+
+	//! Complete top-level node list.
+	void					finish			(void);
+
+private:
+	struct NodeList
+	{
+		size_t		payloadSizeOffset;	//!< Offset of group payload size, unused for top-level list
+		size_t		numNodesOffset;
+		deUint32	numNodes;
+	};
+
+	void					beginNode		(SerializedNodeType type, const string& name, const string& description);
+	void					endPayload		(size_t payloadSizeOffset);
+
+	DataWriter				m_writer;
+	vector<NodeList>		m_lists;
+};
+
+NodeWriter::NodeWriter (vector<deUint8>& dst)
+	: m_writer(dst)
+{
+	NodeList topLevel;
+
+	topLevel.payloadSizeOffset	= 0;
+	topLevel.numNodesOffset		= m_writer.getSize();
+	topLevel.numNodes			= 0;
+
+	m_lists.push_back(topLevel);
+	m_writer.write(0u);
+}
+
+void NodeWriter::beginNode (SerializedNodeType type, const string& name, const string& description)
+{
+	m_lists.back().numNodes += 1;
+
+	m_writer.write((deUint32)type);
+	m_writer.write(name);
+	m_writer.write(description);
+}
+
+void NodeWriter::endPayload (size_t payloadSizeOffset)
+{
+	m_writer.patch(payloadSizeOffset, (deUint32)(m_writer.getSize() - payloadSizeOffset - sizeof(deUint32)));
+}
+
+void NodeWriter::beginGroup (const string& name, const string& description)
+{
+	NodeList group;
+
+	beginNode(SERIALIZED_NODE_GROUP, name, description);
+
+	group.payloadSizeOffset	= m_writer.getSize();
+	group.numNodesOffset	= group.payloadSizeOffset + sizeof(deUint32);
+	group.numNodes			= 0;
+
+	m_lists.push_back(group);
+	m_writer.write(0u);
+	m_writer.write(0u);
+}
+
+void NodeWriter::endGroup (void)
+{
+	const NodeList group = m_lists.back();
+
+	DE_ASSERT(m_lists.size() > 1);
+	m_lists.pop_back();
+
+	m_writer.patch(group.numNodesOffset, group.numNodes);
+	endPayload(group.payloadSizeOffset);
+}
+
+void NodeWriter::addCase (const string& name, const string& description, const ShaderCaseSpecification& spec)
+{
+	size_t payloadSizeOffset;
+
+	beginNode(SERIALIZED_NODE_CASE, name, description);
+
+	payloadSizeOffset = m_writer.getSize();
+	m_writer.write(0u);
+	writeSpec(m_writer, spec);
+	endPayload(payloadSizeOffset);
+}
+
+void NodeWriter::finish (void)
+{
+	DE_ASSERT(m_lists.size() == 1);
+	m_writer.patch(m_lists.front().numNodesOffset, m_lists.front().numNodes);
+}
+
 // Parser
 
 static const glu::GLSLVersion DEFAULT_GLSL_VERSION = glu::GLSL_VERSION_100_ES;
@@ -278,10 +670,10 @@ DE_INLINE deBool isCaseNameChar (char c)
 class ShaderParser
 {
 public:
-							ShaderParser			(const tcu::Archive& archive, const std::string& filename, ShaderCaseFactory* caseFactory);
+							ShaderParser			(const tcu::Archive& archive, const std::string& filename, NodeWriter& writer, vector<string>& imports);
 							~ShaderParser			(void);
 
-	vector<tcu::TestNode*>	parse					(void);
+	void					parse					(void);
 
 private:
 	enum Token
@@ -387,13 +779,14 @@ private:
 	void						parseFormat					(DataType& format);
 	void						parseGLSLVersion			(glu::GLSLVersion& version);
 	void						parsePipelineProgram		(ProgramSpecification& program);
-	void						parseShaderCase				(vector<tcu::TestNode*>& shaderNodeList);
-	void						parseShaderGroup			(vector<tcu::TestNode*>& shaderNodeList);
-	void						parseImport					(vector<tcu::TestNode*>& shaderNodeList);
+	void						parseShaderCase				(void);
+	void						parseShaderGroup			(void);
+	void						parseImport					(void);
 
 	const tcu::Archive&			m_archive;
 	const string				m_filename;
-	ShaderCaseFactory* const	m_caseFactory;
+	NodeWriter&					m_writer;
+	vector<string>&				m_imports;		//!< Files imported directly or indirectly
 
 	UniquePtr<tcu::Resource>	m_resource;
 	vector<char>				m_input;
@@ -403,10 +796,11 @@ private:
 	std::string					m_curTokenStr;
 };
 
-ShaderParser::ShaderParser (const tcu::Archive& archive, const string& filename, ShaderCaseFactory* caseFactroy)
+ShaderParser::ShaderParser (const tcu::Archive& archive, const string& filename, NodeWriter& writer, vector<string>& imports)
 	: m_archive			(archive)
 	, m_filename		(filename)
-	, m_caseFactory		(caseFactroy)
+	, m_writer			(writer)
+	, m_imports			(imports)
 	, m_resource		(archive.getResource(m_filename.c_str()))
 	, m_curPtr			(DE_NULL)
 	, m_curToken		(TOKEN_LAST)
@@ -1328,7 +1722,7 @@ void ShaderParser::parsePipelineProgram (ProgramSpecification& program)
 		parseError("program pipeline object must have active stages");
 }
 
-void ShaderParser::parseShaderCase (vector<tcu::TestNode*>& shaderNodeList)
+void ShaderParser::parseShaderCase (void)
 {
 	// Parse 'case'.
 	PARSE_DBG(("  parseShaderCase()\n"));
@@ -1468,7 +1862,7 @@ void ShaderParser::parseShaderCase (vector<tcu::TestNode*>& shaderNodeList)
 			spec.programs[0].sources << VertexSource(bothSource);
 			spec.programs[0].requiredExtensions	= requiredExts;
 
-			shaderNodeList.push_back(m_caseFactory->createCase(caseName + "_vertex", description, ShaderCaseSpecification(spec)));
+			m_writer.addCase(caseName + "_vertex", description, spec);
 		}
 
 		// fragment
@@ -1484,7 +1878,7 @@ void ShaderParser::parseShaderCase (vector<tcu::TestNode*>& shaderNodeList)
 			spec.programs[0].sources << FragmentSource(bothSource);
 			spec.programs[0].requiredExtensions	= requiredExts;
 
-			shaderNodeList.push_back(m_caseFactory->createCase(caseName + "_fragment", description, ShaderCaseSpecification(spec)));
+			m_writer.addCase(caseName + "_fragment", description, spec);
 		}
 	}
 	else if (pipelinePrograms.empty())
@@ -1506,7 +1900,7 @@ void ShaderParser::parseShaderCase (vector<tcu::TestNode*>& shaderNodeList)
 		spec.programs[0].sources.sources[SHADERTYPE_GEOMETRY].swap(geometrySources);
 		spec.programs[0].requiredExtensions.swap(requiredExts);
 
-		shaderNodeList.push_back(m_caseFactory->createCase(caseName, description, ShaderCaseSpecification(spec)));
+		m_writer.addCase(caseName, description, spec);
 	}
 	else
 	{
@@ -1533,12 +1927,12 @@ void ShaderParser::parseShaderCase (vector<tcu::TestNode*>& shaderNodeList)
 
 			spec.programs.swap(pipelinePrograms);
 
-			shaderNodeList.push_back(m_caseFactory->createCase(caseName, description, ShaderCaseSpecification(spec)));
+			m_writer.addCase(caseName, description, spec);
 		}
 	}
 }
 
-void ShaderParser::parseShaderGroup (vector<tcu::TestNode*>& shaderNodeList)
+void ShaderParser::parseShaderGroup (void)
 {
 	// Parse 'case'.
 	PARSE_DBG(("  parseShaderGroup()\n"));
@@ -1553,7 +1947,7 @@ void ShaderParser::parseShaderGroup (vector<tcu::TestNode*>& shaderNodeList)
 	string description = parseStringLiteral(m_curTokenStr.c_str());
 	advanceToken(TOKEN_STRING);
 
-	std::vector<tcu::TestNode*> children;
+	m_writer.beginGroup(name, description);
 
 	// Parse group children.
 	for (;;)
@@ -1561,23 +1955,21 @@ void ShaderParser::parseShaderGroup (vector<tcu::TestNode*>& shaderNodeList)
 		if (m_curToken == TOKEN_END)
 			break;
 		else if (m_curToken == TOKEN_GROUP)
-			parseShaderGroup(children);
+			parseShaderGroup();
 		else if (m_curToken == TOKEN_CASE)
-			parseShaderCase(children);
+			parseShaderCase();
 		else if (m_curToken == TOKEN_IMPORT)
-			parseImport(children);
+			parseImport();
 		else
 			parseError(string("unexpected token while parsing shader group: " + m_curTokenStr));
 	}
 
 	advanceToken(TOKEN_END); // group end
 
-	// Create group node.
-	tcu::TestCaseGroup* groupNode = m_caseFactory->createGroup(name, description, children);
-	shaderNodeList.push_back(groupNode);
+	m_writer.endGroup();
 }
 
-void ShaderParser::parseImport (vector<tcu::TestNode*>& shaderNodeList)
+void ShaderParser::parseImport (void)
 {
 	std::string	importFileName;
 
@@ -1588,15 +1980,15 @@ void ShaderParser::parseImport (vector<tcu::TestNode*>& shaderNodeList)
 	advanceToken(TOKEN_STRING);
 
 	{
-		ShaderParser					subParser		(m_archive, de::FilePath::join(de::FilePath(m_filename).getDirName(), importFileName).getPath(), m_caseFactory);
-		const vector<tcu::TestNode*>	importedCases = subParser.parse();
+		const string	importPath	= de::FilePath::join(de::FilePath(m_filename).getDirName(), importFileName).getPath();
+		ShaderParser	subParser	(m_archive, importPath, m_writer, m_imports);
 
-		// \todo [2015-08-03 pyry] Not exception safe
-		shaderNodeList.insert(shaderNodeList.end(), importedCases.begin(), importedCases.end());
+		m_imports.push_back(importPath);
+		subParser.parse();
 	}
 }
 
-vector<tcu::TestNode*> ShaderParser::parse (void)
+void ShaderParser::parse (void)
 {
 	const int	dataLen		= m_resource->getSize();
 
@@ -1611,18 +2003,16 @@ vector<tcu::TestNode*> ShaderParser::parse (void)
 	m_curTokenStr	= "";
 	advanceToken();
 
-	vector<tcu::TestNode*> nodeList;
-
 	// Parse all cases.
 	PARSE_DBG(("parse()\n"));
 	for (;;)
 	{
 		if (m_curToken == TOKEN_CASE)
-			parseShaderCase(nodeList);
+			parseShaderCase();
 		else if (m_curToken == TOKEN_GROUP)
-			parseShaderGroup(nodeList);
+			parseShaderGroup();
 		else if (m_curToken == TOKEN_IMPORT)
-			parseImport(nodeList);
+			parseImport();
 		else if (m_curToken == TOKEN_EOF)
 			break;
 		else
@@ -1630,15 +2020,478 @@ vector<tcu::TestNode*> ShaderParser::parse (void)
 	}
 
 	assumeToken(TOKEN_EOF);
-//	printf("  parsed %d test cases.\n", caseList.size());
-	return nodeList;
+}
+
+// Serialized library
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Serialized shader library file
+ *
+ * Data starts with a header followed by the files imported by the library
+ * and their hashes, and then the top-level node list. Layout of cache
+ * files is identical; data is either mapped from a cache file or owned.
+ *//*--------------------------------------------------------------------*/
+class LibraryData
+{
+public:
+	enum
+	{
+		MAGIC		= 0x434C5344,	//!< "DSLC"
+		VERSION		= 1
+	};
+
+	explicit				LibraryData		(deMappedFile* file);		//!< Takes ownership of file
+	explicit				LibraryData		(vector<deUint8>& data);	//!< Takes contents of data
+							~LibraryData	(void);
+
+	const deUint8*			getNodes		(void) const	{ return m_nodes;	}
+	const deUint8*			getEnd			(void) const	{ return m_end;		}
+
+	//! Check that imported files have not changed.
+	bool					isUpToDate		(const tcu::Archive& archive) const;
+
+private:
+							LibraryData		(const LibraryData&);
+	LibraryData&			operator=		(const LibraryData&);
+
+	void					readHeader		(void);
+
+	deMappedFile*			m_file;
+	vector<deUint8>			m_data;
+
+	const deUint8*			m_begin;
+	const deUint8*			m_end;
+	const deUint8*			m_nodes;
+
+	vector<string>			m_imports;
+	vector<string>			m_importHashes;
+};
+
+LibraryData::LibraryData (deMappedFile* file)
+	: m_file	(file)
+	, m_begin	((const deUint8*)deMappedFile_getPtr(file))
+	, m_end		(m_begin + (size_t)deMappedFile_getSize(file))
+	, m_nodes	(DE_NULL)
+{
+	try
+	{
+		readHeader();
+	}
+	catch (...)
+	{
+		deMappedFile_destroy(m_file);
+		throw;
+	}
+}
+
+LibraryData::LibraryData (vector<deUint8>& data)
+	: m_file	(DE_NULL)
+	, m_begin	(DE_NULL)
+	, m_end		(DE_NULL)
+	, m_nodes	(DE_NULL)
+{
+	m_data.swap(data);
+
+	m_begin	= m_data.empty() ? DE_NULL : &m_data[0];
+	m_end	= m_begin + m_data.size();
+
+	readHeader();
+}
+
+LibraryData::~LibraryData (void)
+{
+	if (m_file)
+		deMappedFile_destroy(m_file);
+}
+
+void LibraryData::readHeader (void)
+{
+	DataReader src (m_begin, m_end);
+
+	if (src.readUint32() != MAGIC || src.readUint32() != VERSION || src.readUint32() != (deUint32)(m_end - m_begin))
+		throw tcu::InternalError("Invalid shader library data");
+
+	src.readStrings(m_imports);
+	src.readStrings(m_importHashes);
+
+	if (m_imports.size() != m_importHashes.size())
+		throw tcu::InternalError("Invalid shader library data");
+
+	m_nodes = src.getPtr();
+}
+
+static de::Sha1 computeFileHash (const tcu::Archive& archive, const string& filename)
+{
+	const UniquePtr<tcu::Resource>	resource	(archive.getResource(filename.c_str()));
+	vector<deUint8>					data		(resource->getSize());
+
+	if (!data.empty())
+		resource->read(&data[0], (int)data.size());
+
+	return de::Sha1::compute(data.size(), data.empty() ? DE_NULL : &data[0]);
+}
+
+bool LibraryData::isUpToDate (const tcu::Archive& archive) const
+{
+	for (size_t importNdx = 0; importNdx < m_imports.size(); importNdx++)
+	{
+		if (computeFileHash(archive, m_imports[importNdx]).toString() != m_importHashes[importNdx])
+			return false;
+	}
+
+	return true;
+}
+
+//! Parse file and write it in serialized form, including imported files' hashes.
+static void serializeFile (const tcu::Archive& archive, const string& filename, vector<deUint8>& dst)
+{
+	vector<deUint8>		nodes;
+	vector<string>		imports;
+	vector<string>		importHashes;
+
+	{
+		NodeWriter		writer	(nodes);
+		ShaderParser	parser	(archive, filename, writer, imports);
+
+		parser.parse();
+		writer.finish();
+	}
+
+	for (size_t importNdx = 0; importNdx < imports.size(); importNdx++)
+		importHashes.push_back(computeFileHash(archive, imports[importNdx]).toString());
+
+	{
+		DataWriter writer (dst);
+
+		writer.write((deUint32)LibraryData::MAGIC);
+		writer.write((deUint32)LibraryData::VERSION);
+		writer.write(0u);
+		writer.write(imports);
+		writer.write(importHashes);
+
+		dst.insert(dst.end(), nodes.begin(), nodes.end());
+		writer.patch(2*sizeof(deUint32), (deUint32)dst.size());
+	}
+}
+
+// Cache
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Directory of serialized shader library files
+ *
+ * Entries are named by hash of file name and contents, so an edited file
+ * simply maps to a new entry. Imported files are checked against hashes
+ * stored in the entry. Entries are written with deWriteFileAtomic(), so
+ * concurrent runs can share the directory.
+ *//*--------------------------------------------------------------------*/
+class LibraryCache
+{
+public:
+	explicit						LibraryCache	(const string& path);
+
+	static de::Sha1					computeKey		(const tcu::Archive& archive, const string& filename);
+
+	//! Returns empty pointer if there's no valid entry.
+	de::SharedPtr<LibraryData>		load			(const tcu::Archive& archive, const de::Sha1& key) const;
+
+	//! Failures are ignored; the file is parsed again on next run.
+	void							store			(const de::Sha1& key, const vector<deUint8>& data) const;
+
+private:
+	string							getEntryPath	(const de::Sha1& key) const;
+
+	const string					m_path;
+};
+
+LibraryCache::LibraryCache (const string& path)
+	: m_path(path)
+{
+}
+
+de::Sha1 LibraryCache::computeKey (const tcu::Archive& archive, const string& filename)
+{
+	const UniquePtr<tcu::Resource>	resource	(archive.getResource(filename.c_str()));
+	vector<deUint8>					data		(resource->getSize());
+	de::Sha1Stream					stream;
+
+	if (!data.empty())
+		resource->read(&data[0], (int)data.size());
+
+	// Serialized values depend on these enums
+	stream << (deUint32)LibraryData::VERSION
+		   << (deUint32)SHADERTYPE_LAST
+		   << (deUint32)TYPE_LAST
+		   << (deUint32)GLSL_VERSION_LAST
+		   << filename
+		   << (deUint64)data.size();
+
+	if (!data.empty())
+		stream.process(data.size(), &data[0]);
+
+	return stream.finalize();
+}
+
+string LibraryCache::getEntryPath (const de::Sha1& key) const
+{
+	return de::FilePath::join(m_path, key.toString() + ".bin").getPath();
+}
+
+de::SharedPtr<LibraryData> LibraryCache::load (const tcu::Archive& archive, const de::Sha1& key) const
+{
+	deMappedFile* const file = deMappedFile_create(getEntryPath(key).c_str());
+
+	if (!file)
+		return de::SharedPtr<LibraryData>();
+
+	try
+	{
+		const de::SharedPtr<LibraryData> data (new LibraryData(file));
+
+		if (data->isUpToDate(archive))
+			return data;
+	}
+	catch (const tcu::InternalError&)
+	{
+		// Damaged entry, replaced on store
+	}
+
+	return de::SharedPtr<LibraryData>();
+}
+
+void LibraryCache::store (const de::Sha1& key, const vector<deUint8>& data) const
+{
+	const string		path		= getEntryPath(key);
+	const de::FilePath	dirPath		= de::FilePath(path).getDirName();
+
+	try
+	{
+		if (!dirPath.exists())
+			de::createDirectoryAndParents(dirPath.getPath());
+
+		deWriteFileAtomic(path.c_str(), data.empty() ? DE_NULL : &data[0], (deInt64)data.size());
+	}
+	catch (const std::exception&)
+	{
+		// Caching is an optimization only
+	}
+}
+
+// Node creation
+
+struct NodeHeader
+{
+	SerializedNodeType		type;
+	string					name;
+	string					description;
+	const deUint8*			payload;
+	size_t					payloadSize;
+};
+
+static NodeHeader readNodeHeader (DataReader& src)
+{
+	NodeHeader header;
+
+	header.type			= (SerializedNodeType)src.readUint32();
+	header.name			= src.readString();
+	header.description	= src.readString();
+	header.payloadSize	= src.readUint32();
+	header.payload		= src.getPtr();
+
+	if (header.type != SERIALIZED_NODE_GROUP && header.type != SERIALIZED_NODE_CASE)
+		throw tcu::InternalError("Invalid shader library node");
+
+	src.skip(header.payloadSize);
+
+	return header;
+}
+
+static void deleteNodes (vector<tcu::TestNode*>& nodes)
+{
+	for (size_t ndx = 0; ndx < nodes.size(); ndx++)
+		delete nodes[ndx];
+	nodes.clear();
+}
+
+static tcu::TestCase* createCaseNode (const NodeHeader& header, ShaderCaseFactory& caseFactory)
+{
+	DataReader				src		(header.payload, header.payload + header.payloadSize);
+	ShaderCaseSpecification	spec;
+
+	readSpec(src, spec);
+
+	return caseFactory.createCase(header.name, header.description, spec);
+}
+
+static void createNodes (DataReader& src, ShaderCaseFactory& caseFactory, vector<tcu::TestNode*>& nodes)
+{
+	const deUint32 numNodes = src.readUint32();
+
+	try
+	{
+		for (deUint32 nodeNdx = 0; nodeNdx < numNodes; nodeNdx++)
+		{
+			const NodeHeader header = readNodeHeader(src);
+
+			if (header.type == SERIALIZED_NODE_GROUP)
+			{
+				DataReader					childSrc	(header.payload, header.payload + header.payloadSize);
+				vector<tcu::TestNode*>		children;
+
+				createNodes(childSrc, caseFactory, children);
+				nodes.push_back(caseFactory.createGroup(header.name, header.description, children));
+			}
+			else
+				nodes.push_back(createCaseNode(header, caseFactory));
+		}
+	}
+	catch (...)
+	{
+		deleteNodes(nodes);
+		throw;
+	}
+}
+
+//! Group that creates its children from serialized data on init().
+class LazyShaderGroup : public tcu::TestCaseGroup
+{
+public:
+									LazyShaderGroup		(tcu::TestContext&							testCtx,
+														 const NodeHeader&							header,
+														 const de::SharedPtr<LibraryData>&			data,
+														 const de::SharedPtr<ShaderCaseFactory>&	caseFactory);
+
+	void							init				(void);
+
+private:
+	const de::SharedPtr<LibraryData>			m_data;
+	const de::SharedPtr<ShaderCaseFactory>		m_caseFactory;
+	const deUint8* const						m_children;
+	const size_t								m_childrenSize;
+};
+
+static void createLazyNodes (tcu::TestContext&							testCtx,
+							 DataReader&								src,
+							 const de::SharedPtr<LibraryData>&			data,
+							 const de::SharedPtr<ShaderCaseFactory>&	caseFactory,
+							 vector<tcu::TestNode*>&					nodes)
+{
+	const deUint32 numNodes = src.readUint32();
+
+	try
+	{
+		for (deUint32 nodeNdx = 0; nodeNdx < numNodes; nodeNdx++)
+		{
+			const NodeHeader header = readNodeHeader(src);
+
+			if (header.type == SERIALIZED_NODE_GROUP)
+				nodes.push_back(new LazyShaderGroup(testCtx, header, data, caseFactory));
+			else
+				nodes.push_back(createCaseNode(header, *caseFactory));
+		}
+	}
+	catch (...)
+	{
+		deleteNodes(nodes);
+		throw;
+	}
+}
+
+LazyShaderGroup::LazyShaderGroup (tcu::TestContext&							testCtx,
+								  const NodeHeader&							header,
+								  const de::SharedPtr<LibraryData>&			data,
+								  const de::SharedPtr<ShaderCaseFactory>&	caseFactory)
+	: tcu::TestCaseGroup	(testCtx, header.name.c_str(), header.description.c_str())
+	, m_data				(data)
+	, m_caseFactory			(caseFactory)
+	, m_children			(header.payload)
+	, m_childrenSize		(header.payloadSize)
+{
+}
+
+void LazyShaderGroup::init (void)
+{
+	DataReader				src			(m_children, m_children + m_childrenSize);
+	vector<tcu::TestNode*>	children;
+
+	createLazyNodes(m_testCtx, src, m_data, m_caseFactory, children);
+
+	for (size_t ndx = 0; ndx < children.size(); ndx++)
+	{
+		try
+		{
+			addChild(children[ndx]);
+		}
+		catch (...)
+		{
+			for (; ndx < children.size(); ndx++)
+				delete children[ndx];
+			throw;
+		}
+	}
 }
 
 std::vector<tcu::TestNode*> parseFile (const tcu::Archive& archive, const std::string& filename, ShaderCaseFactory* caseFactory)
 {
-	sl::ShaderParser	parser	(archive, filename, caseFactory);
+	vector<deUint8>			serialized;
+	vector<tcu::TestNode*>	nodes;
+
+	serializeFile(archive, filename, serialized);
+
+	{
+		const LibraryData	data	(serialized);
+		DataReader			src		(data.getNodes(), data.getEnd());
+
+		createNodes(src, *caseFactory, nodes);
+	}
+
+	return nodes;
+}
+
+std::vector<tcu::TestNode*> loadFile (tcu::TestContext& testCtx, const std::string& filename, const de::SharedPtr<ShaderCaseFactory>& caseFactory)
+{
+	const tcu::CommandLine& cmdLine = testCtx.getCommandLine();
+
+	return loadFile(testCtx, filename, caseFactory, cmdLine.isShaderLibraryCacheEnabled() ? cmdLine.getShaderLibraryCacheDir() : DE_NULL);
+}
+
+std::vector<tcu::TestNode*> loadFile (tcu::TestContext& testCtx, const std::string& filename, const de::SharedPtr<ShaderCaseFactory>& caseFactory, const char* cacheDir)
+{
+	const tcu::Archive&			archive		= testCtx.getArchive();
+	de::SharedPtr<LibraryData>	data;
+	vector<tcu::TestNode*>		nodes;
+
+	if (cacheDir)
+	{
+		const LibraryCache	cache	(cacheDir);
+		const de::Sha1		key		= LibraryCache::computeKey(archive, filename);
+
+		data = cache.load(archive, key);
+
+		if (!data)
+		{
+			vector<deUint8> serialized;
+
+			serializeFile(archive, filename, serialized);
+			cache.store(key, serialized);
+
+			data = de::SharedPtr<LibraryData>(new LibraryData(serialized));
+		}
+	}
+	else
+	{
+		vector<deUint8> serialized;
+
+		serializeFile(archive, filename, serialized);
+		data = de::SharedPtr<LibraryData>(new LibraryData(serialized));
+	}
+
+	{
+		DataReader src (data->getNodes(), data->getEnd());
+
+		createLazyNodes(testCtx, src, data, caseFactory, nodes);
+	}
 
-	return parser.parse();
+	return nodes;
 }
 
 // Execution utilities
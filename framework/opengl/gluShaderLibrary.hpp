@@ -27,6 +27,7 @@
 #include "gluVarType.hpp"
 #include "gluShaderProgram.hpp"
 #include "tcuTestCase.hpp"
+#include "deSharedPtr.hpp"
 
 #include <string>
 #include <vector>
@@ -196,12 +197,32 @@ bool	isCapabilityRequired(CapabilityFlag capabilityFlag, const ShaderCaseSpecifi
 class ShaderCaseFactory
 {
 public:
+	virtual						~ShaderCaseFactory	(void) {}
+
 	virtual tcu::TestCaseGroup*	createGroup	(const std::string& name, const std::string& description, const std::vector<tcu::TestNode*>& children) = 0;
 	virtual tcu::TestCase*		createCase	(const std::string& name, const std::string& description, const ShaderCaseSpecification& spec) = 0;
 };
 
 std::vector<tcu::TestNode*>		parseFile	(const tcu::Archive& archive, const std::string& filename, ShaderCaseFactory* caseFactory);
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Load shader library file using parsed file cache
+ *
+ * If --deqp-shader-library-cache=enable is given, parsed file is stored
+ * in compact binary form under --deqp-shader-library-cache-dir, keyed by
+ * hash of file contents, and memory-mapped instead of parsed on later
+ * loads.
+ *
+ * Groups are created as plain tcu::TestCaseGroups that keep a reference
+ * to caseFactory, create their children from the serialized data on init()
+ * and release them on deinit(). createGroup() is not used. If the cache is
+ * disabled, the file is parsed but groups are still populated lazily.
+ *//*--------------------------------------------------------------------*/
+std::vector<tcu::TestNode*>		loadFile	(tcu::TestContext& testCtx, const std::string& filename, const de::SharedPtr<ShaderCaseFactory>& caseFactory);
+
+//! Load shader library file using cache in cacheDir, or without cache if cacheDir is DE_NULL.
+std::vector<tcu::TestNode*>		loadFile	(tcu::TestContext& testCtx, const std::string& filename, const de::SharedPtr<ShaderCaseFactory>& caseFactory, const char* cacheDir);
+
 // Specialization utilties
 
 struct ProgramSpecializationParams
@@ -27,11 +27,13 @@
 
 #include "tcuFloat.hpp"
 #include "tcuImageCompare.hpp"
+#include "tcuParallelFor.hpp"
 #include "tcuTestLog.hpp"
 #include "tcuVectorUtil.hpp"
 
 #include "deMath.h"
 #include "deStringUtil.hpp"
+#include "deMutex.hpp"
 
 #include <string>
 
@@ -1221,16 +1223,171 @@ void computeQuadTexCoordCubeArray (std::vector<float>& dst, tcu::CubeFace face,
 
 // Texture result verification
 
-//! Verifies texture lookup results and returns number of failed pixels.
-int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
-							  const tcu::ConstPixelBufferAccess&	reference,
-							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::Texture1DView&				baseView,
-							  const float*							texCoord,
-							  const ReferenceParams&				sampleParams,
-							  const tcu::LookupPrecision&			lookupPrec,
-							  const tcu::LodPrecision&				lodPrec,
-							  qpWatchDog*							watchDog)
+enum
+{
+	VERIFY_ROWS_PER_CHUNK	= 4
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Verifies result image rows in parallel
+ *
+ * Each chunk of rows writes only its own rows of the error mask and its
+ * own failure count, so results don't depend on the thread count. Rows
+ * are processed by the tcu::parallelFor() worker pool, sized with
+ * --deqp-verification-thread-count. The watchdog is touched by whichever
+ * thread finishes a chunk, so progress is reported even when the calling
+ * thread is stuck in a slow chunk.
+ *//*--------------------------------------------------------------------*/
+class TextureDiffJob : public tcu::ParallelJob
+{
+public:
+					TextureDiffJob	(int numRows, qpWatchDog* watchDog)
+						: m_numFailed	((size_t)numRows, 0)
+						, m_watchDog	(watchDog)
+					{
+					}
+
+	void			execute			(size_t begin, size_t end, int)
+	{
+		m_numFailed[begin] = verifyRows((int)begin, (int)end);
+
+		if (m_watchDog)
+		{
+			// qpWatchDog is not thread-safe
+			const de::ScopedLock lock (m_watchDogLock);
+			qpWatchDog_touch(m_watchDog);
+		}
+	}
+
+	int				run				(void)
+	{
+		int numFailed = 0;
+
+		tcu::parallelFor(*this, m_numFailed.size(), VERIFY_ROWS_PER_CHUNK, tcu::getDefaultParallelForThreadCount());
+
+		for (size_t rowNdx = 0; rowNdx < m_numFailed.size(); rowNdx++)
+			numFailed += m_numFailed[rowNdx];
+
+		return numFailed;
+	}
+
+protected:
+	virtual int		verifyRows		(int rowBegin, int rowEnd) = 0;
+
+private:
+	std::vector<int>	m_numFailed;	//!< Failures per chunk, stored at index of first row.
+	qpWatchDog* const	m_watchDog;
+	de::Mutex			m_watchDogLock;
+};
+
+template<typename TextureViewType>
+class TextureLookupDiffJob : public TextureDiffJob
+{
+public:
+	typedef int (*VerifyRowsFunc) (const tcu::ConstPixelBufferAccess&, const tcu::ConstPixelBufferAccess&, const tcu::PixelBufferAccess&, const TextureViewType&,
+								   const float*, const ReferenceParams&, const tcu::LookupPrecision&, const tcu::LodPrecision&, int, int);
+
+					TextureLookupDiffJob	(VerifyRowsFunc							verifyRowsFunc,
+											 const tcu::ConstPixelBufferAccess&		result,
+											 const tcu::ConstPixelBufferAccess&		reference,
+											 const tcu::PixelBufferAccess&			errorMask,
+											 const TextureViewType&					src,
+											 const float*							texCoord,
+											 const ReferenceParams&					sampleParams,
+											 const tcu::LookupPrecision&			lookupPrec,
+											 const tcu::LodPrecision&				lodPrec,
+											 qpWatchDog*							watchDog)
+						: TextureDiffJob	(result.getHeight(), watchDog)
+						, m_verifyRowsFunc	(verifyRowsFunc)
+						, m_result			(result)
+						, m_reference		(reference)
+						, m_errorMask		(errorMask)
+						, m_src				(src)
+						, m_texCoord		(texCoord)
+						, m_sampleParams	(sampleParams)
+						, m_lookupPrec		(lookupPrec)
+						, m_lodPrec			(lodPrec)
+					{
+					}
+
+protected:
+	int				verifyRows				(int rowBegin, int rowEnd)
+	{
+		return m_verifyRowsFunc(m_result, m_reference, m_errorMask, m_src, m_texCoord, m_sampleParams, m_lookupPrec, m_lodPrec, rowBegin, rowEnd);
+	}
+
+private:
+	const VerifyRowsFunc				m_verifyRowsFunc;
+	const tcu::ConstPixelBufferAccess&	m_result;
+	const tcu::ConstPixelBufferAccess&	m_reference;
+	const tcu::PixelBufferAccess&		m_errorMask;
+	const TextureViewType&				m_src;
+	const float* const					m_texCoord;
+	const ReferenceParams&				m_sampleParams;
+	const tcu::LookupPrecision&			m_lookupPrec;
+	const tcu::LodPrecision&			m_lodPrec;
+};
+
+template<typename TextureViewType>
+class TextureCompareDiffJob : public TextureDiffJob
+{
+public:
+	typedef int (*VerifyRowsFunc) (const tcu::ConstPixelBufferAccess&, const tcu::ConstPixelBufferAccess&, const tcu::PixelBufferAccess&, const TextureViewType&,
+								   const float*, const ReferenceParams&, const tcu::TexComparePrecision&, const tcu::LodPrecision&, const tcu::Vec3&, int, int);
+
+					TextureCompareDiffJob	(VerifyRowsFunc							verifyRowsFunc,
+											 const tcu::ConstPixelBufferAccess&		result,
+											 const tcu::ConstPixelBufferAccess&		reference,
+											 const tcu::PixelBufferAccess&			errorMask,
+											 const TextureViewType&					src,
+											 const float*							texCoord,
+											 const ReferenceParams&					sampleParams,
+											 const tcu::TexComparePrecision&		comparePrec,
+											 const tcu::LodPrecision&				lodPrec,
+											 const tcu::Vec3&						nonShadowThreshold)
+						: TextureDiffJob		(result.getHeight(), DE_NULL)
+						, m_verifyRowsFunc		(verifyRowsFunc)
+						, m_result				(result)
+						, m_reference			(reference)
+						, m_errorMask			(errorMask)
+						, m_src					(src)
+						, m_texCoord			(texCoord)
+						, m_sampleParams		(sampleParams)
+						, m_comparePrec			(comparePrec)
+						, m_lodPrec				(lodPrec)
+						, m_nonShadowThreshold	(nonShadowThreshold)
+					{
+					}
+
+protected:
+	int				verifyRows				(int rowBegin, int rowEnd)
+	{
+		return m_verifyRowsFunc(m_result, m_reference, m_errorMask, m_src, m_texCoord, m_sampleParams, m_comparePrec, m_lodPrec, m_nonShadowThreshold, rowBegin, rowEnd);
+	}
+
+private:
+	const VerifyRowsFunc				m_verifyRowsFunc;
+	const tcu::ConstPixelBufferAccess&	m_result;
+	const tcu::ConstPixelBufferAccess&	m_reference;
+	const tcu::PixelBufferAccess&		m_errorMask;
+	const TextureViewType&				m_src;
+	const float* const					m_texCoord;
+	const ReferenceParams&				m_sampleParams;
+	const tcu::TexComparePrecision&		m_comparePrec;
+	const tcu::LodPrecision&			m_lodPrec;
+	const tcu::Vec3&					m_nonShadowThreshold;
+};
+
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::Texture1DView&			baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -1261,14 +1418,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -1325,15 +1476,32 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+//! Verifies texture lookup results and returns number of failed pixels.
 int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 							  const tcu::ConstPixelBufferAccess&	reference,
 							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::Texture2DView&				baseView,
+							  const tcu::Texture1DView&				baseView,
 							  const float*							texCoord,
 							  const ReferenceParams&				sampleParams,
 							  const tcu::LookupPrecision&			lookupPrec,
 							  const tcu::LodPrecision&				lodPrec,
 							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureLookupDiffJob<tcu::Texture1DView>(computeTextureLookupDiffRows, result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, lodPrec, watchDog).run();
+}
+
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::Texture2DView&			baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -1368,14 +1536,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -1451,6 +1613,21 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
+							  const tcu::ConstPixelBufferAccess&	reference,
+							  const tcu::PixelBufferAccess&			errorMask,
+							  const tcu::Texture2DView&				baseView,
+							  const float*							texCoord,
+							  const ReferenceParams&				sampleParams,
+							  const tcu::LookupPrecision&			lookupPrec,
+							  const tcu::LodPrecision&				lodPrec,
+							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureLookupDiffJob<tcu::Texture2DView>(computeTextureLookupDiffRows, result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, lodPrec, watchDog).run();
+}
+
 bool verifyTextureResult (tcu::TestContext&						testCtx,
 						  const tcu::ConstPixelBufferAccess&	result,
 						  const tcu::Texture1DView&				src,
@@ -1523,16 +1700,16 @@ bool verifyTextureResult (tcu::TestContext&						testCtx,
 	return numFailedPixels == 0;
 }
 
-//! Verifies texture lookup results and returns number of failed pixels.
-int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
-							  const tcu::ConstPixelBufferAccess&	reference,
-							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::TextureCubeView&			baseView,
-							  const float*							texCoord,
-							  const ReferenceParams&				sampleParams,
-							  const tcu::LookupPrecision&			lookupPrec,
-							  const tcu::LodPrecision&				lodPrec,
-							  qpWatchDog*							watchDog)
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::TextureCubeView&		baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -1575,14 +1752,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2(+1, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -1667,6 +1838,22 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+//! Verifies texture lookup results and returns number of failed pixels.
+int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
+							  const tcu::ConstPixelBufferAccess&	reference,
+							  const tcu::PixelBufferAccess&			errorMask,
+							  const tcu::TextureCubeView&			baseView,
+							  const float*							texCoord,
+							  const ReferenceParams&				sampleParams,
+							  const tcu::LookupPrecision&			lookupPrec,
+							  const tcu::LodPrecision&				lodPrec,
+							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureLookupDiffJob<tcu::TextureCubeView>(computeTextureLookupDiffRows, result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, lodPrec, watchDog).run();
+}
+
 bool verifyTextureResult (tcu::TestContext&						testCtx,
 						  const tcu::ConstPixelBufferAccess&	result,
 						  const tcu::TextureCubeView&			src,
@@ -1703,16 +1890,16 @@ bool verifyTextureResult (tcu::TestContext&						testCtx,
 	return numFailedPixels == 0;
 }
 
-//! Verifies texture lookup results and returns number of failed pixels.
-int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
-							  const tcu::ConstPixelBufferAccess&	reference,
-							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::Texture3DView&				baseView,
-							  const float*							texCoord,
-							  const ReferenceParams&				sampleParams,
-							  const tcu::LookupPrecision&			lookupPrec,
-							  const tcu::LodPrecision&				lodPrec,
-							  qpWatchDog*							watchDog)
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::Texture3DView&			baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -1749,14 +1936,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -1838,6 +2019,22 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+//! Verifies texture lookup results and returns number of failed pixels.
+int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
+							  const tcu::ConstPixelBufferAccess&	reference,
+							  const tcu::PixelBufferAccess&			errorMask,
+							  const tcu::Texture3DView&				baseView,
+							  const float*							texCoord,
+							  const ReferenceParams&				sampleParams,
+							  const tcu::LookupPrecision&			lookupPrec,
+							  const tcu::LodPrecision&				lodPrec,
+							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureLookupDiffJob<tcu::Texture3DView>(computeTextureLookupDiffRows, result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, lodPrec, watchDog).run();
+}
+
 bool verifyTextureResult (tcu::TestContext&						testCtx,
 						  const tcu::ConstPixelBufferAccess&	result,
 						  const tcu::Texture3DView&				src,
@@ -1874,16 +2071,16 @@ bool verifyTextureResult (tcu::TestContext&						testCtx,
 	return numFailedPixels == 0;
 }
 
-//! Verifies texture lookup results and returns number of failed pixels.
-int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
-							  const tcu::ConstPixelBufferAccess&	reference,
-							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::Texture1DArrayView&		baseView,
-							  const float*							texCoord,
-							  const ReferenceParams&				sampleParams,
-							  const tcu::LookupPrecision&			lookupPrec,
-							  const tcu::LodPrecision&				lodPrec,
-							  qpWatchDog*							watchDog)
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::Texture1DArrayView&		baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -1916,14 +2113,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -1985,12 +2176,28 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 							  const tcu::ConstPixelBufferAccess&	reference,
 							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::Texture2DArrayView&		baseView,
+							  const tcu::Texture1DArrayView&		baseView,
 							  const float*							texCoord,
 							  const ReferenceParams&				sampleParams,
 							  const tcu::LookupPrecision&			lookupPrec,
 							  const tcu::LodPrecision&				lodPrec,
 							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureLookupDiffJob<tcu::Texture1DArrayView>(computeTextureLookupDiffRows, result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, lodPrec, watchDog).run();
+}
+
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::Texture2DArrayView&		baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -2025,14 +2232,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -2095,6 +2296,22 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+//! Verifies texture lookup results and returns number of failed pixels.
+int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
+							  const tcu::ConstPixelBufferAccess&	reference,
+							  const tcu::PixelBufferAccess&			errorMask,
+							  const tcu::Texture2DArrayView&		baseView,
+							  const float*							texCoord,
+							  const ReferenceParams&				sampleParams,
+							  const tcu::LookupPrecision&			lookupPrec,
+							  const tcu::LodPrecision&				lodPrec,
+							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureLookupDiffJob<tcu::Texture2DArrayView>(computeTextureLookupDiffRows, result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, lodPrec, watchDog).run();
+}
+
 bool verifyTextureResult (tcu::TestContext&						testCtx,
 						  const tcu::ConstPixelBufferAccess&	result,
 						  const tcu::Texture1DArrayView&		src,
@@ -2167,17 +2384,17 @@ bool verifyTextureResult (tcu::TestContext&						testCtx,
 	return numFailedPixels == 0;
 }
 
-//! Verifies texture lookup results and returns number of failed pixels.
-int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
-							  const tcu::ConstPixelBufferAccess&	reference,
-							  const tcu::PixelBufferAccess&			errorMask,
-							  const tcu::TextureCubeArrayView&		baseView,
-							  const float*							texCoord,
-							  const ReferenceParams&				sampleParams,
-							  const tcu::LookupPrecision&			lookupPrec,
-							  const tcu::IVec4&						coordBits,
-							  const tcu::LodPrecision&				lodPrec,
-							  qpWatchDog*							watchDog)
+static int computeTextureLookupDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										 const tcu::ConstPixelBufferAccess&	reference,
+										 const tcu::PixelBufferAccess&		errorMask,
+										 const tcu::TextureCubeArrayView&	baseView,
+										 const float*						texCoord,
+										 const ReferenceParams&				sampleParams,
+										 const tcu::LookupPrecision&		lookupPrec,
+										 const tcu::IVec4&					coordBits,
+										 const tcu::LodPrecision&			lodPrec,
+										 int								rowBegin,
+										 int								rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -2222,14 +2439,8 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2(+1, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
-		// Ugly hack, validation can take way too long at the moment.
-		if (watchDog)
-			qpWatchDog_touch(watchDog);
-
 		for (int px = 0; px < result.getWidth(); px++)
 		{
 			const tcu::Vec4	resPix	= (result.getPixel(px, py)		- sampleParams.colorBias) / sampleParams.colorScale;
@@ -2315,6 +2526,67 @@ int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+//! Verifies texture lookup results and returns number of failed pixels.
+class TextureCubeArrayLookupDiffJob : public TextureDiffJob
+{
+public:
+					TextureCubeArrayLookupDiffJob	(const tcu::ConstPixelBufferAccess&		result,
+													 const tcu::ConstPixelBufferAccess&		reference,
+													 const tcu::PixelBufferAccess&			errorMask,
+													 const tcu::TextureCubeArrayView&		src,
+													 const float*							texCoord,
+													 const ReferenceParams&					sampleParams,
+													 const tcu::LookupPrecision&			lookupPrec,
+													 const tcu::IVec4&						coordBits,
+													 const tcu::LodPrecision&				lodPrec,
+													 qpWatchDog*							watchDog)
+						: TextureDiffJob	(result.getHeight(), watchDog)
+						, m_result			(result)
+						, m_reference		(reference)
+						, m_errorMask		(errorMask)
+						, m_src				(src)
+						, m_texCoord		(texCoord)
+						, m_sampleParams	(sampleParams)
+						, m_lookupPrec		(lookupPrec)
+						, m_coordBits		(coordBits)
+						, m_lodPrec			(lodPrec)
+					{
+					}
+
+protected:
+	int				verifyRows						(int rowBegin, int rowEnd)
+	{
+		return computeTextureLookupDiffRows(m_result, m_reference, m_errorMask, m_src, m_texCoord, m_sampleParams, m_lookupPrec, m_coordBits, m_lodPrec, rowBegin, rowEnd);
+	}
+
+private:
+	const tcu::ConstPixelBufferAccess&	m_result;
+	const tcu::ConstPixelBufferAccess&	m_reference;
+	const tcu::PixelBufferAccess&		m_errorMask;
+	const tcu::TextureCubeArrayView&	m_src;
+	const float* const					m_texCoord;
+	const ReferenceParams&				m_sampleParams;
+	const tcu::LookupPrecision&			m_lookupPrec;
+	const tcu::IVec4&					m_coordBits;
+	const tcu::LodPrecision&			m_lodPrec;
+};
+
+int computeTextureLookupDiff (const tcu::ConstPixelBufferAccess&	result,
+							  const tcu::ConstPixelBufferAccess&	reference,
+							  const tcu::PixelBufferAccess&			errorMask,
+							  const tcu::TextureCubeArrayView&		baseView,
+							  const float*							texCoord,
+							  const ReferenceParams&				sampleParams,
+							  const tcu::LookupPrecision&			lookupPrec,
+							  const tcu::IVec4&						coordBits,
+							  const tcu::LodPrecision&				lodPrec,
+							  qpWatchDog*							watchDog)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureCubeArrayLookupDiffJob(result, reference, errorMask, baseView, texCoord, sampleParams, lookupPrec, coordBits, lodPrec, watchDog).run();
+}
+
 bool verifyTextureResult (tcu::TestContext&						testCtx,
 						  const tcu::ConstPixelBufferAccess&	result,
 						  const tcu::TextureCubeArrayView&		src,
@@ -2354,15 +2626,17 @@ bool verifyTextureResult (tcu::TestContext&						testCtx,
 
 // Shadow lookup verification
 
-int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
-							   const tcu::ConstPixelBufferAccess&	reference,
-							   const tcu::PixelBufferAccess&		errorMask,
-							   const tcu::Texture2DView&			src,
-							   const float*							texCoord,
-							   const ReferenceParams&				sampleParams,
-							   const tcu::TexComparePrecision&		comparePrec,
-							   const tcu::LodPrecision&				lodPrec,
-							   const tcu::Vec3&						nonShadowThreshold)
+static int computeTextureCompareDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										  const tcu::ConstPixelBufferAccess&	reference,
+										  const tcu::PixelBufferAccess&			errorMask,
+										  const tcu::Texture2DView&				src,
+										  const float*							texCoord,
+										  const ReferenceParams&				sampleParams,
+										  const tcu::TexComparePrecision&		comparePrec,
+										  const tcu::LodPrecision&				lodPrec,
+										  const tcu::Vec3&						nonShadowThreshold,
+										  int									rowBegin,
+										  int									rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -2392,9 +2666,7 @@ int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
 		for (int px = 0; px < result.getWidth(); px++)
 		{
@@ -2469,12 +2741,29 @@ int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 							   const tcu::ConstPixelBufferAccess&	reference,
 							   const tcu::PixelBufferAccess&		errorMask,
-							   const tcu::TextureCubeView&			src,
+							   const tcu::Texture2DView&			src,
 							   const float*							texCoord,
 							   const ReferenceParams&				sampleParams,
 							   const tcu::TexComparePrecision&		comparePrec,
 							   const tcu::LodPrecision&				lodPrec,
 							   const tcu::Vec3&						nonShadowThreshold)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureCompareDiffJob<tcu::Texture2DView>(computeTextureCompareDiffRows, result, reference, errorMask, src, texCoord, sampleParams, comparePrec, lodPrec, nonShadowThreshold).run();
+}
+
+static int computeTextureCompareDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										  const tcu::ConstPixelBufferAccess&	reference,
+										  const tcu::PixelBufferAccess&			errorMask,
+										  const tcu::TextureCubeView&			src,
+										  const float*							texCoord,
+										  const ReferenceParams&				sampleParams,
+										  const tcu::TexComparePrecision&		comparePrec,
+										  const tcu::LodPrecision&				lodPrec,
+										  const tcu::Vec3&						nonShadowThreshold,
+										  int									rowBegin,
+										  int									rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -2506,9 +2795,7 @@ int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
 		for (int px = 0; px < result.getWidth(); px++)
 		{
@@ -2591,12 +2878,29 @@ int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 							   const tcu::ConstPixelBufferAccess&	reference,
 							   const tcu::PixelBufferAccess&		errorMask,
-							   const tcu::Texture2DArrayView&		src,
+							   const tcu::TextureCubeView&			src,
 							   const float*							texCoord,
 							   const ReferenceParams&				sampleParams,
 							   const tcu::TexComparePrecision&		comparePrec,
 							   const tcu::LodPrecision&				lodPrec,
 							   const tcu::Vec3&						nonShadowThreshold)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureCompareDiffJob<tcu::TextureCubeView>(computeTextureCompareDiffRows, result, reference, errorMask, src, texCoord, sampleParams, comparePrec, lodPrec, nonShadowThreshold).run();
+}
+
+static int computeTextureCompareDiffRows (const tcu::ConstPixelBufferAccess&	result,
+										  const tcu::ConstPixelBufferAccess&	reference,
+										  const tcu::PixelBufferAccess&			errorMask,
+										  const tcu::Texture2DArrayView&		src,
+										  const float*							texCoord,
+										  const ReferenceParams&				sampleParams,
+										  const tcu::TexComparePrecision&		comparePrec,
+										  const tcu::LodPrecision&				lodPrec,
+										  const tcu::Vec3&						nonShadowThreshold,
+										  int									rowBegin,
+										  int									rowEnd)
 {
 	DE_ASSERT(result.getWidth() == reference.getWidth() && result.getHeight() == reference.getHeight());
 	DE_ASSERT(result.getWidth() == errorMask.getWidth() && result.getHeight() == errorMask.getHeight());
@@ -2628,9 +2932,7 @@ int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 		tcu::Vec2( 0, +1),
 	};
 
-	tcu::clear(errorMask, tcu::RGBA::green().toVec());
-
-	for (int py = 0; py < result.getHeight(); py++)
+	for (int py = rowBegin; py < rowEnd; py++)
 	{
 		for (int px = 0; px < result.getWidth(); px++)
 		{
@@ -2703,6 +3005,21 @@ int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
 	return numFailed;
 }
 
+int computeTextureCompareDiff (const tcu::ConstPixelBufferAccess&	result,
+							   const tcu::ConstPixelBufferAccess&	reference,
+							   const tcu::PixelBufferAccess&		errorMask,
+							   const tcu::Texture2DArrayView&		src,
+							   const float*							texCoord,
+							   const ReferenceParams&				sampleParams,
+							   const tcu::TexComparePrecision&		comparePrec,
+							   const tcu::LodPrecision&				lodPrec,
+							   const tcu::Vec3&						nonShadowThreshold)
+{
+	tcu::clear(errorMask, tcu::RGBA::green().toVec());
+
+	return TextureCompareDiffJob<tcu::Texture2DArrayView>(computeTextureCompareDiffRows, result, reference, errorMask, src, texCoord, sampleParams, comparePrec, lodPrec, nonShadowThreshold).run();
+}
+
 // Mipmap generation comparison.
 
 static int compareGenMipmapBilinear (const tcu::ConstPixelBufferAccess& dst, const tcu::ConstPixelBufferAccess& src, const tcu::PixelBufferAccess& errorMask, const GenMipmapPrecision& precision)
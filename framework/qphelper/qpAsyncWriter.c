@@ -0,0 +1,230 @@
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Helper Library
+ * -------------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Asynchronous buffered file writer.
+ *//*--------------------------------------------------------------------*/
+
+#include "qpAsyncWriter.h"
+
+#include "deThread.h"
+#include "deSemaphore.h"
+#include "deMemory.h"
+
+#if (DE_OS == DE_OS_WIN32)
+#	include <windows.h>
+#	include <io.h>
+#endif
+
+enum
+{
+	NUM_BUFFERS		= 4,
+	BUFFER_SIZE		= 128*1024
+};
+
+typedef struct Buffer_s
+{
+	deUint8*		data;
+	size_t			size;
+	deBool			sync;	/*!< Flush file and signal syncDone once written.	*/
+	deBool			stop;	/*!< Last buffer, writer thread exits after this.	*/
+} Buffer;
+
+/*--------------------------------------------------------------------*//*!
+ * Buffers form a ring shared between one producer and the writer thread.
+ * The producer always owns buffers[writeNdx] and only touches the ring
+ * through the semaphores when handing a buffer over, so appending data
+ * requires no locking.
+ *//*--------------------------------------------------------------------*/
+struct qpAsyncWriter_s
+{
+	FILE*			outputFile;
+	deBool			flushFile;
+
+	Buffer			buffers[NUM_BUFFERS];
+	int				writeNdx;		/*!< Owned by producer.			*/
+	int				readNdx;		/*!< Owned by writer thread.	*/
+
+	deSemaphore		freeBuffers;
+	deSemaphore		fullBuffers;
+	deSemaphore		syncDone;
+
+	deThread		thread;
+};
+
+static void flushOutputFile (FILE* file)
+{
+	fflush(file);
+#if (DE_OS == DE_OS_WIN32) && (DE_COMPILER == DE_COMPILER_MSC)
+	FlushFileBuffers((HANDLE)_get_osfhandle(_fileno(file)));
+#endif
+}
+
+static void writerThreadFunc (void* arg)
+{
+	qpAsyncWriter* writer = (qpAsyncWriter*)arg;
+
+	for (;;)
+	{
+		Buffer*	buffer;
+		deBool	stop;
+
+		deSemaphore_decrement(writer->fullBuffers);
+
+		buffer	= &writer->buffers[writer->readNdx];
+		stop	= buffer->stop;
+
+		if (buffer->size > 0)
+			fwrite(buffer->data, 1, buffer->size, writer->outputFile);
+
+		if (writer->flushFile || buffer->sync)
+			flushOutputFile(writer->outputFile);
+
+		if (buffer->sync)
+			deSemaphore_increment(writer->syncDone);
+
+		if (stop)
+			break;
+
+		writer->readNdx = (writer->readNdx + 1) % NUM_BUFFERS;
+		deSemaphore_increment(writer->freeBuffers);
+	}
+}
+
+static void submitBuffer (qpAsyncWriter* writer, deBool sync)
+{
+	Buffer* next;
+
+	writer->buffers[writer->writeNdx].sync = sync;
+	deSemaphore_increment(writer->fullBuffers);
+
+	writer->writeNdx = (writer->writeNdx + 1) % NUM_BUFFERS;
+	deSemaphore_decrement(writer->freeBuffers);
+
+	next		= &writer->buffers[writer->writeNdx];
+	next->size	= 0;
+	next->sync	= DE_FALSE;
+	next->stop	= DE_FALSE;
+}
+
+qpAsyncWriter* qpAsyncWriter_create (FILE* outputFile, deBool flushFile)
+{
+	qpAsyncWriter*	writer	= (qpAsyncWriter*)deCalloc(sizeof(qpAsyncWriter));
+	int				ndx;
+
+	if (!writer)
+		return DE_NULL;
+
+	writer->outputFile	= outputFile;
+	writer->flushFile	= flushFile;
+
+	for (ndx = 0; ndx < NUM_BUFFERS; ndx++)
+	{
+		writer->buffers[ndx].data = (deUint8*)deMalloc(BUFFER_SIZE);
+		if (!writer->buffers[ndx].data)
+			break;
+	}
+
+	/* Producer starts out owning the first buffer. */
+	writer->freeBuffers	= deSemaphore_create(NUM_BUFFERS-1, DE_NULL);
+	writer->fullBuffers	= deSemaphore_create(0, DE_NULL);
+	writer->syncDone	= deSemaphore_create(0, DE_NULL);
+
+	if (ndx == NUM_BUFFERS && writer->freeBuffers && writer->fullBuffers && writer->syncDone)
+		writer->thread = deThread_create(writerThreadFunc, writer, DE_NULL);
+
+	if (!writer->thread)
+	{
+		for (ndx = 0; ndx < NUM_BUFFERS; ndx++)
+			deFree(writer->buffers[ndx].data);
+
+		if (writer->freeBuffers)
+			deSemaphore_destroy(writer->freeBuffers);
+		if (writer->fullBuffers)
+			deSemaphore_destroy(writer->fullBuffers);
+		if (writer->syncDone)
+			deSemaphore_destroy(writer->syncDone);
+
+		deFree(writer);
+		return DE_NULL;
+	}
+
+	return writer;
+}
+
+void qpAsyncWriter_destroy (qpAsyncWriter* writer)
+{
+	int ndx;
+
+	DE_ASSERT(writer);
+
+	writer->buffers[writer->writeNdx].stop = DE_TRUE;
+	writer->buffers[writer->writeNdx].sync = DE_TRUE;
+	deSemaphore_increment(writer->fullBuffers);
+
+	deThread_join(writer->thread);
+	deThread_destroy(writer->thread);
+
+	deSemaphore_destroy(writer->freeBuffers);
+	deSemaphore_destroy(writer->fullBuffers);
+	deSemaphore_destroy(writer->syncDone);
+
+	for (ndx = 0; ndx < NUM_BUFFERS; ndx++)
+		deFree(writer->buffers[ndx].data);
+
+	deFree(writer);
+}
+
+void qpAsyncWriter_write (qpAsyncWriter* writer, const void* data, size_t numBytes)
+{
+	const deUint8* src = (const deUint8*)data;
+
+	DE_ASSERT(writer);
+
+	while (numBytes > 0)
+	{
+		Buffer*			buffer		= &writer->buffers[writer->writeNdx];
+		const size_t	space		= BUFFER_SIZE - buffer->size;
+		const size_t	chunkSize	= (numBytes < space) ? numBytes : space;
+
+		deMemcpy(buffer->data + buffer->size, src, chunkSize);
+		buffer->size	+= chunkSize;
+		src				+= chunkSize;
+		numBytes		-= chunkSize;
+
+		if (buffer->size == BUFFER_SIZE)
+			submitBuffer(writer, DE_FALSE);
+	}
+}
+
+void qpAsyncWriter_flush (qpAsyncWriter* writer)
+{
+	DE_ASSERT(writer);
+
+	if (writer->buffers[writer->writeNdx].size > 0)
+		submitBuffer(writer, DE_FALSE);
+}
+
+void qpAsyncWriter_sync (qpAsyncWriter* writer)
+{
+	DE_ASSERT(writer);
+
+	submitBuffer(writer, DE_TRUE);
+	deSemaphore_decrement(writer->syncDone);
+}
@@ -0,0 +1,82 @@
+#ifndef _QPASYNCWRITER_H
+#define _QPASYNCWRITER_H
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Helper Library
+ * -------------------------------------------
+ *
+ * Copyright 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief Asynchronous buffered file writer.
+ *
+ * Data is appended into a small ring of preallocated buffers by a single
+ * producer thread and written out to the file by a background thread.
+ * All memory is allocated at creation time.
+ *//*--------------------------------------------------------------------*/
+
+#include "deDefs.h"
+
+#include <stdio.h>
+
+DE_BEGIN_EXTERN_C
+
+typedef struct qpAsyncWriter_s	qpAsyncWriter;
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Create asynchronous writer
+ * \param outputFile	File to write into, must stay open until destroy
+ * \param flushFile		Set to DE_TRUE to fflush file after each buffer
+ * \return qpAsyncWriter instance, or DE_NULL on failure
+ *//*--------------------------------------------------------------------*/
+qpAsyncWriter*	qpAsyncWriter_create	(FILE* outputFile, deBool flushFile);
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Write out all pending data and destroy writer
+ * \param writer	qpAsyncWriter instance
+ *//*--------------------------------------------------------------------*/
+void			qpAsyncWriter_destroy	(qpAsyncWriter* writer);
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Append data
+ *
+ * Blocks only if all buffers are waiting to be written out.
+ *
+ * \param writer	qpAsyncWriter instance
+ * \param data		Data to append
+ * \param numBytes	Size of data in bytes
+ *//*--------------------------------------------------------------------*/
+void			qpAsyncWriter_write		(qpAsyncWriter* writer, const void* data, size_t numBytes);
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Hand pending data over to writer thread without waiting for it
+ * \param writer	qpAsyncWriter instance
+ *//*--------------------------------------------------------------------*/
+void			qpAsyncWriter_flush		(qpAsyncWriter* writer);
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Wait until all data has been written and flushed to the file
+ *
+ * Blocks on the writer thread, so this is not async-signal-safe and
+ * deadlocks if the writer thread itself is stopped, e.g. by a crash on
+ * that thread.
+ *
+ * \param writer	qpAsyncWriter instance
+ *//*--------------------------------------------------------------------*/
+void			qpAsyncWriter_sync		(qpAsyncWriter* writer);
+
+DE_END_EXTERN_C
+
+#endif /* _QPASYNCWRITER_H */
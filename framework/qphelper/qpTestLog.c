@@ -23,6 +23,7 @@
 
 #include "qpTestLog.h"
 #include "qpXmlWriter.h"
+#include "qpAsyncWriter.h"
 #include "qpInfo.h"
 #include "qpDebugOut.h"
 
@@ -31,6 +32,8 @@
 #include "deString.h"
 
 #include "deMutex.h"
+#include "deSemaphore.h"
+#include "deThread.h"
 
 #if defined(QP_SUPPORT_PNG)
 #	include <png.h>
@@ -119,6 +122,86 @@ DE_INLINE ContainerType ContainerStack_getTop (const ContainerStack* stack)
 
 #endif
 
+typedef struct Buffer_s
+{
+	size_t		capacity;
+	size_t		size;
+	deUint8*	data;
+} Buffer;
+
+void Buffer_init (Buffer* buffer)
+{
+	buffer->capacity	= 0;
+	buffer->size		= 0;
+	buffer->data		= DE_NULL;
+}
+
+void Buffer_deinit (Buffer* buffer)
+{
+	deFree(buffer->data);
+	Buffer_init(buffer);
+}
+
+deBool Buffer_resize (Buffer* buffer, size_t newSize)
+{
+	/* Grow buffer if necessary. */
+	if (newSize > buffer->capacity)
+	{
+		size_t		newCapacity	= (size_t)deAlign32(deMax32(2*(int)buffer->capacity, (int)newSize), 512);
+		deUint8*	newData		= (deUint8*)deMalloc(newCapacity);
+		if (!newData)
+			return DE_FALSE;
+
+		memcpy(newData, buffer->data, buffer->size);
+		deFree(buffer->data);
+		buffer->data		= newData;
+		buffer->capacity	= newCapacity;
+	}
+
+	buffer->size = newSize;
+	return DE_TRUE;
+}
+
+deBool Buffer_append (Buffer* buffer, const deUint8* data, size_t numBytes)
+{
+	size_t offset = buffer->size;
+
+	if (!Buffer_resize(buffer, buffer->size + numBytes))
+		return DE_FALSE;
+
+	/* Append bytes. */
+	memcpy(&buffer->data[offset], data, numBytes);
+	return DE_TRUE;
+}
+
+/* Image compressed by an ImageEncoder thread, see qpTestLog_writeImage(). */
+typedef struct ImageJob_s ImageJob;
+struct ImageJob_s
+{
+	ImageJob*				next;				/*!< Next job in log order.					*/
+	ImageJob*				nextPending;		/*!< Next job waiting for an encoder thread.	*/
+
+	char*					name;
+	char*					description;
+	qpImageCompressionMode	compressionMode;
+	qpImageFormat			imageFormat;
+	int						width;
+	int						height;
+	int						compressionLevel;
+	Buffer					pixels;				/*!< Tightly packed copy of pixel data.		*/
+	size_t					pixelDataSize;
+
+	qpXmlWriter*			writer;				/*!< Fragment writer for <Image> element.	*/
+	Buffer					output;				/*!< <Image> element written by encoder.	*/
+	deBool					outputOk;
+	Buffer					trailingOutput;		/*!< Log output following the image.		*/
+	deBool					trailingOutputOk;
+
+	deBool					isDone;				/*!< Protected by encoder lock.				*/
+};
+
+typedef struct ImageEncoder_s ImageEncoder;
+
 /* qpTestLog instance */
 struct qpTestLog_s
 {
@@ -128,10 +211,18 @@ struct qpTestLog_s
 
 	/* State protected by lock. */
 	FILE*					outputFile;
+	qpAsyncWriter*			asyncWriter;		/*!< Non-null if QP_TEST_LOG_ASYNC.		*/
 	qpXmlWriter*			writer;
 	deBool					isSessionOpen;
 	deBool					isCaseOpen;
 
+	int						compressionLevel;	/*!< zlib level for PNG images.			*/
+	ImageEncoder*			imageEncoder;		/*!< Non-null if QP_TEST_LOG_IMAGE_THREADS.	*/
+	ImageJob*				firstImageJob;		/*!< Image jobs in log order.			*/
+	ImageJob*				lastImageJob;		/*!< Output goes here if non-null.		*/
+	int						numImageJobs;
+	size_t					imageJobBytes;
+
 #if defined(DE_DEBUG)
 	ContainerStack			containerStack;		/*!< For container usage verification.	*/
 #endif
@@ -248,9 +339,50 @@ static const qpKeyStringMap s_qpShaderTypeMap[] =
 
 DE_STATIC_ASSERT(DE_LENGTH_OF_ARRAY(s_qpShaderTypeMap) == QP_SHADER_TYPE_LAST + 1);
 
+static void writeFileOutput (qpTestLog* log, const void* data, size_t numBytes)
+{
+	if (log->asyncWriter)
+		qpAsyncWriter_write(log->asyncWriter, data, numBytes);
+	else
+		fwrite(data, 1, numBytes, log->outputFile);
+}
+
+static void writeOutput (qpTestLog* log, const char* str)
+{
+	/* Output must follow any image still being encoded. */
+	if (log->lastImageJob)
+	{
+		ImageJob* job = log->lastImageJob;
+		if (!Buffer_append(&job->trailingOutput, (const deUint8*)str, strlen(str)))
+			job->trailingOutputOk = DE_FALSE;
+	}
+	else if (log->asyncWriter)
+		qpAsyncWriter_write(log->asyncWriter, str, strlen(str));
+	else
+		fputs(str, log->outputFile);
+}
+
+static void writeXmlOutput (void* userPtr, const char* str)
+{
+	writeOutput((qpTestLog*)userPtr, str);
+}
+
+/* Image encoder, defined with qpTestLog_writeImage(). */
+static ImageEncoder*	ImageEncoder_create		(void);
+static void				ImageEncoder_destroy	(ImageEncoder* encoder);
+static void				writeFinishedImages		(qpTestLog* log, deBool waitAll);
+
 static void qpTestLog_flushFile (qpTestLog* log)
 {
 	DE_ASSERT(log && log->outputFile);
+
+	/* Writer thread takes care of fflush, don't wait for it. */
+	if (log->asyncWriter)
+	{
+		qpAsyncWriter_flush(log->asyncWriter);
+		return;
+	}
+
 	fflush(log->outputFile);
 #if (DE_OS == DE_OS_WIN32) && (DE_COMPILER == DE_COMPILER_MSC)
 	/* \todo [petri] Is this really necessary? */
@@ -258,6 +390,19 @@ static void qpTestLog_flushFile (qpTestLog* log)
 #endif
 }
 
+/* Like qpTestLog_flushFile() but waits until buffered data is in the file. */
+static void qpTestLog_syncFile (qpTestLog* log)
+{
+	DE_ASSERT(log && log->outputFile);
+
+	writeFinishedImages(log, DE_TRUE);
+
+	if (log->asyncWriter)
+		qpAsyncWriter_sync(log->asyncWriter);
+	else
+		qpTestLog_flushFile(log);
+}
+
 #define QP_LOOKUP_STRING(KEYMAP, KEY)	qpLookupString(KEYMAP, DE_LENGTH_OF_ARRAY(KEYMAP), (int)(KEY))
 
 static const char* qpLookupString (const qpKeyStringMap* keyMap, int keyMapSize, int key)
@@ -291,15 +436,23 @@ DE_INLINE void doubleToString (double value, char* buf, size_t bufSize)
 
 static deBool beginSession (qpTestLog* log)
 {
+	char releaseIdStr[32];
+
 	DE_ASSERT(log && !log->isSessionOpen);
 
+	deSprintf(releaseIdStr, sizeof(releaseIdStr), "0x%08x", qpGetReleaseId());
+
 	/* Write session info. */
-	fprintf(log->outputFile, "#sessionInfo releaseName %s\n", qpGetReleaseName());
-	fprintf(log->outputFile, "#sessionInfo releaseId 0x%08x\n", qpGetReleaseId());
-	fprintf(log->outputFile, "#sessionInfo targetName \"%s\"\n", qpGetTargetName());
+	writeOutput(log, "#sessionInfo releaseName ");
+	writeOutput(log, qpGetReleaseName());
+	writeOutput(log, "\n#sessionInfo releaseId ");
+	writeOutput(log, releaseIdStr);
+	writeOutput(log, "\n#sessionInfo targetName \"");
+	writeOutput(log, qpGetTargetName());
+	writeOutput(log, "\"\n");
 
     /* Write out #beginSession. */
-	fprintf(log->outputFile, "#beginSession\n");
+	writeOutput(log, "#beginSession\n");
 	qpTestLog_flushFile(log);
 
 	log->isSessionOpen = DE_TRUE;
@@ -315,8 +468,8 @@ static deBool endSession (qpTestLog* log)
     qpXmlWriter_flush(log->writer);
 
     /* Write out #endSession. */
-	fprintf(log->outputFile, "\n#endSession\n");
-	qpTestLog_flushFile(log);
+	writeOutput(log, "\n#endSession\n");
+	qpTestLog_syncFile(log);
 
 	log->isSessionOpen = DE_FALSE;
 
@@ -351,11 +504,28 @@ qpTestLog* qpTestLog_createFileLog (const char* fileName, deUint32 flags)
 		return DE_NULL;
 	}
 
-	log->flags			= flags;
-	log->writer			= qpXmlWriter_createFileWriter(log->outputFile, 0, !(flags & QP_TEST_LOG_NO_FLUSH));
-	log->lock			= deMutex_create(DE_NULL);
-	log->isSessionOpen	= DE_FALSE;
-	log->isCaseOpen		= DE_FALSE;
+	if (flags & QP_TEST_LOG_ASYNC)
+	{
+		log->asyncWriter = qpAsyncWriter_create(log->outputFile, !(flags & QP_TEST_LOG_NO_FLUSH));
+		if (!log->asyncWriter)
+			qpPrintf("WARNING: Unable to create asynchronous log writer, using synchronous writes.\n");
+	}
+
+	if (flags & QP_TEST_LOG_IMAGE_THREADS)
+	{
+		log->imageEncoder = ImageEncoder_create();
+		if (!log->imageEncoder)
+			qpPrintf("WARNING: Unable to create image encoder threads, compressing images on the calling thread.\n");
+	}
+
+	/* Output is routed through the log if it may need to be buffered. */
+	log->flags				= flags;
+	log->writer				= (log->asyncWriter || log->imageEncoder) ? qpXmlWriter_createCallbackWriter(writeXmlOutput, log)
+																	  : qpXmlWriter_createFileWriter(log->outputFile, 0, !(flags & QP_TEST_LOG_NO_FLUSH));
+	log->lock				= deMutex_create(DE_NULL);
+	log->isSessionOpen		= DE_FALSE;
+	log->isCaseOpen			= DE_FALSE;
+	log->compressionLevel	= (flags & QP_TEST_LOG_FAST_IMAGE_COMPRESSION) ? 1 : -1;
 
 	if (!log->writer)
 	{
@@ -387,6 +557,14 @@ void qpTestLog_destroy (qpTestLog* log)
 	if (log->isSessionOpen)
 		endSession(log);
 
+	DE_ASSERT(!log->firstImageJob);
+
+	if (log->imageEncoder)
+		ImageEncoder_destroy(log->imageEncoder);
+
+	if (log->asyncWriter)
+		qpAsyncWriter_destroy(log->asyncWriter);
+
 	if (log->writer)
 		qpXmlWriter_destroy(log->writer);
 
@@ -420,7 +598,9 @@ deBool qpTestLog_startCase (qpTestLog* log, const char* testCasePath, qpTestCase
 
 	/* Flush XML and write out #beginTestCaseResult. */
 	qpXmlWriter_flush(log->writer);
-	fprintf(log->outputFile, "\n#beginTestCaseResult %s\n", testCasePath);
+	writeOutput(log, "\n#beginTestCaseResult ");
+	writeOutput(log, testCasePath);
+	writeOutput(log, "\n");
 	if (!(log->flags & QP_TEST_LOG_NO_FLUSH))
 		qpTestLog_flushFile(log);
 
@@ -476,7 +656,8 @@ deBool qpTestLog_endCase (qpTestLog* log, qpTestResult result, const char* resul
 
 	/* Flush XML and write #endTestCaseResult. */
 	qpXmlWriter_flush(log->writer);
-	fprintf(log->outputFile, "\n#endTestCaseResult\n");
+	writeOutput(log, "\n#endTestCaseResult\n");
+	writeFinishedImages(log, DE_FALSE);
 	if (!(log->flags & QP_TEST_LOG_NO_FLUSH))
 		qpTestLog_flushFile(log);
 
@@ -493,7 +674,7 @@ deBool qpTestLog_startTestsCasesTime (qpTestLog* log)
 
 	/* Flush XML and write out #beginTestCaseResult. */
 	qpXmlWriter_flush(log->writer);
-	fprintf(log->outputFile, "\n#beginTestsCasesTime\n");
+	writeOutput(log, "\n#beginTestsCasesTime\n");
 
 	log->isCaseOpen = DE_TRUE;
 
@@ -526,7 +707,7 @@ deBool qpTestLog_endTestsCasesTime (qpTestLog* log)
 
 	qpXmlWriter_flush(log->writer);
 
-	fprintf(log->outputFile, "\n#endTestsCasesTime\n");
+	writeOutput(log, "\n#endTestsCasesTime\n");
 
 	log->isCaseOpen = DE_FALSE;
 
@@ -558,8 +739,10 @@ deBool qpTestLog_terminateCase (qpTestLog* log, qpTestResult result)
 
 	/* Flush XML and write #terminateTestCaseResult. */
 	qpXmlWriter_flush(log->writer);
-	fprintf(log->outputFile, "\n#terminateTestCaseResult %s\n", resultStr);
-	qpTestLog_flushFile(log);
+	writeOutput(log, "\n#terminateTestCaseResult ");
+	writeOutput(log, resultStr);
+	writeOutput(log, "\n");
+	qpTestLog_syncFile(log);
 
 	log->isCaseOpen = DE_FALSE;
 
@@ -650,58 +833,6 @@ deBool qpTestLog_writeFloat (qpTestLog* log, const char* name, const char* descr
 	return qpTestLog_writeKeyValuePair(log, "Number", name, description, unit, tag, tmpString);
 }
 
-typedef struct Buffer_s
-{
-	size_t		capacity;
-	size_t		size;
-	deUint8*	data;
-} Buffer;
-
-void Buffer_init (Buffer* buffer)
-{
-	buffer->capacity	= 0;
-	buffer->size		= 0;
-	buffer->data		= DE_NULL;
-}
-
-void Buffer_deinit (Buffer* buffer)
-{
-	deFree(buffer->data);
-	Buffer_init(buffer);
-}
-
-deBool Buffer_resize (Buffer* buffer, size_t newSize)
-{
-	/* Grow buffer if necessary. */
-	if (newSize > buffer->capacity)
-	{
-		size_t		newCapacity	= (size_t)deAlign32(deMax32(2*(int)buffer->capacity, (int)newSize), 512);
-		deUint8*	newData		= (deUint8*)deMalloc(newCapacity);
-		if (!newData)
-			return DE_FALSE;
-
-		memcpy(newData, buffer->data, buffer->size);
-		deFree(buffer->data);
-		buffer->data		= newData;
-		buffer->capacity	= newCapacity;
-	}
-
-	buffer->size = newSize;
-	return DE_TRUE;
-}
-
-deBool Buffer_append (Buffer* buffer, const deUint8* data, size_t numBytes)
-{
-	size_t offset = buffer->size;
-
-	if (!Buffer_resize(buffer, buffer->size + numBytes))
-		return DE_FALSE;
-
-	/* Append bytes. */
-	memcpy(&buffer->data[offset], data, numBytes);
-	return DE_TRUE;
-}
-
 #if defined(QP_SUPPORT_PNG)
 void pngWriteData (png_structp png, png_bytep dataPtr, png_size_t numBytes)
 {
@@ -716,10 +847,17 @@ void pngFlushData (png_structp png)
 	/* nada */
 }
 
-static deBool writeCompressedPNG (png_structp png, png_infop info, png_byte** rowPointers, int width, int height, int colorFormat)
+static deBool writeCompressedPNG (png_structp png, png_infop info, png_byte** rowPointers, int width, int height, int colorFormat, int compressionLevel)
 {
 	if (setjmp(png_jmpbuf(png)) == 0)
 	{
+		if (compressionLevel >= 0)
+			png_set_compression_level(png, compressionLevel);
+
+		/* Fast levels trade adaptive filtering for speed. */
+		if (compressionLevel >= 0 && compressionLevel <= 1)
+			png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+
 		/* Write data. */
 		png_set_IHDR(png, info, (png_uint_32)width, (png_uint_32)height,
 			8,
@@ -737,7 +875,7 @@ static deBool writeCompressedPNG (png_structp png, png_infop info, png_byte** ro
 		return DE_FALSE;
 }
 
-static deBool compressImagePNG (Buffer* buffer, qpImageFormat imageFormat, int width, int height, int rowStride, const void* data)
+static deBool compressImagePNG (Buffer* buffer, qpImageFormat imageFormat, int width, int height, int rowStride, const void* data, int compressionLevel)
 {
 	deBool			compressOk		= DE_FALSE;
 	png_structp		png				= DE_NULL;
@@ -766,7 +904,7 @@ static deBool compressImagePNG (Buffer* buffer, qpImageFormat imageFormat, int w
 		png_set_write_fn(png, buffer, pngWriteData, pngFlushData);
 
 		compressOk = writeCompressedPNG(png, info, rowPointers, width, height,
-										hasAlpha ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB);
+										hasAlpha ? PNG_COLOR_TYPE_RGBA : PNG_COLOR_TYPE_RGB, compressionLevel);
 	}
 
 	/* Cleanup & return. */
@@ -840,79 +978,52 @@ deBool qpTestLog_endImageSet (qpTestLog* log)
 	return DE_TRUE;
 }
 
-/*--------------------------------------------------------------------*//*!
- * \brief Write base64 encoded raw image data into log
- * \param log				qpTestLog instance
- * \param name				Unique name (matching names can be compared across BatchResults).
- * \param description		Textual description (shown in Candy).
- * \param compressionMode	Compression mode
- * \param imageFormat		Color format
- * \param width				Width in pixels
- * \param height			Height in pixels
- * \param stride			Data stride (offset between rows)
- * \param data				Pointer to pixel data
- * \return 0 if OK, otherwise <0
- *//*--------------------------------------------------------------------*/
-deBool qpTestLog_writeImage	(
-	qpTestLog*				log,
-	const char*				name,
-	const char*				description,
-	qpImageCompressionMode	compressionMode,
+/* Compress image, writeDataPtr will point to either data or buffer. */
+static deBool encodeImage (
+	Buffer*					buffer,
+	qpImageCompressionMode*	compressionMode,
 	qpImageFormat			imageFormat,
 	int						width,
 	int						height,
 	int						stride,
-	const void*				data)
+	const void*				data,
+	int						compressionLevel,
+	const void**			writeDataPtr,
+	size_t*					writeDataBytes)
 {
-	char			widthStr[32];
-	char			heightStr[32];
-	qpXmlAttribute	attribs[8];
-	int				numAttribs			= 0;
-	Buffer			compressedBuffer;
-	const void*		writeDataPtr		= DE_NULL;
-	size_t			writeDataBytes		= ~(size_t)0;
-
-	DE_ASSERT(log && name);
-	DE_ASSERT(deInRange32(width, 1, 32768));
-	DE_ASSERT(deInRange32(height, 1, 32768));
-	DE_ASSERT(data);
-
-	if (log->flags & QP_TEST_LOG_EXCLUDE_IMAGES)
-		return DE_TRUE; /* Image not logged. */
-
-	Buffer_init(&compressedBuffer);
-
 	/* BEST compression mode defaults to PNG. */
-	if (compressionMode == QP_IMAGE_COMPRESSION_MODE_BEST)
+	if (*compressionMode == QP_IMAGE_COMPRESSION_MODE_BEST)
 	{
 #if defined(QP_SUPPORT_PNG)
-		compressionMode = QP_IMAGE_COMPRESSION_MODE_PNG;
+		*compressionMode = QP_IMAGE_COMPRESSION_MODE_PNG;
 #else
-		compressionMode = QP_IMAGE_COMPRESSION_MODE_NONE;
+		*compressionMode = QP_IMAGE_COMPRESSION_MODE_NONE;
 #endif
 	}
 
 #if defined(QP_SUPPORT_PNG)
 	/* Try storing with PNG compression. */
-	if (compressionMode == QP_IMAGE_COMPRESSION_MODE_PNG)
+	if (*compressionMode == QP_IMAGE_COMPRESSION_MODE_PNG)
 	{
-		deBool compressOk = compressImagePNG(&compressedBuffer, imageFormat, width, height, stride, data);
+		deBool compressOk = compressImagePNG(buffer, imageFormat, width, height, stride, data, compressionLevel);
 		if (compressOk)
 		{
-			writeDataPtr	= compressedBuffer.data;
-			writeDataBytes	= compressedBuffer.size;
+			*writeDataPtr	= buffer->data;
+			*writeDataBytes	= buffer->size;
 		}
 		else
 		{
 			/* Fall-back to default compression. */
 			qpPrintf("WARNING: PNG compression failed -- storing image uncompressed.\n");
-			compressionMode	= QP_IMAGE_COMPRESSION_MODE_NONE;
+			*compressionMode	= QP_IMAGE_COMPRESSION_MODE_NONE;
 		}
 	}
+#else
+	DE_UNREF(compressionLevel);
 #endif
 
 	/* Handle image compression. */
-	switch (compressionMode)
+	switch (*compressionMode)
 	{
 		case QP_IMAGE_COMPRESSION_MODE_NONE:
 		{
@@ -920,40 +1031,59 @@ deBool qpTestLog_writeImage	(
 			int packedStride	= pixelSize*width;
 
 			if (packedStride == stride)
-				writeDataPtr = data;
+				*writeDataPtr = data;
 			else
 			{
 				/* Need to re-pack pixels. */
-				if (Buffer_resize(&compressedBuffer, (size_t)(packedStride*height)))
+				if (Buffer_resize(buffer, (size_t)(packedStride*height)))
 				{
 					int row;
 					for (row = 0; row < height; row++)
-						memcpy(&compressedBuffer.data[packedStride*row], &((const deUint8*)data)[row*stride], (size_t)(pixelSize*width));
+						memcpy(&buffer->data[packedStride*row], &((const deUint8*)data)[row*stride], (size_t)(pixelSize*width));
 				}
 				else
 				{
 					qpPrintf("ERROR: Failed to pack pixels for writing.\n");
-					Buffer_deinit(&compressedBuffer);
 					return DE_FALSE;
 				}
+
+				*writeDataPtr = buffer->data;
 			}
 
-			writeDataBytes = (size_t)(packedStride*height);
+			*writeDataBytes = (size_t)(packedStride*height);
 			break;
 		}
 
 #if defined(QP_SUPPORT_PNG)
 		case QP_IMAGE_COMPRESSION_MODE_PNG:
-			DE_ASSERT(writeDataPtr); /* Already handled. */
+			DE_ASSERT(*writeDataPtr); /* Already handled. */
 			break;
 #endif
 
 		default:
-			qpPrintf("qpTestLog_writeImage(): Unknown compression mode: %s\n", QP_LOOKUP_STRING(s_qpImageCompressionModeMap, compressionMode));
-			Buffer_deinit(&compressedBuffer);
+			qpPrintf("qpTestLog_writeImage(): Unknown compression mode: %s\n", QP_LOOKUP_STRING(s_qpImageCompressionModeMap, *compressionMode));
 			return DE_FALSE;
 	}
 
+	return DE_TRUE;
+}
+
+static deBool writeImageElement (
+	qpXmlWriter*			writer,
+	const char*				name,
+	const char*				description,
+	qpImageCompressionMode	compressionMode,
+	qpImageFormat			imageFormat,
+	int						width,
+	int						height,
+	const void*				writeDataPtr,
+	size_t					writeDataBytes)
+{
+	char			widthStr[32];
+	char			heightStr[32];
+	qpXmlAttribute	attribs[8];
+	int				numAttribs			= 0;
+
 	/* Fill in attributes. */
 	int32ToString(width, widthStr);
 	int32ToString(height, heightStr);
@@ -964,13 +1094,376 @@ deBool qpTestLog_writeImage	(
 	attribs[numAttribs++] = qpSetStringAttrib("CompressionMode", QP_LOOKUP_STRING(s_qpImageCompressionModeMap, compressionMode));
 	if (description) attribs[numAttribs++] = qpSetStringAttrib("Description", description);
 
+	/* <Image ID="result" Name="Foobar" Width="640" Height="480" Format="RGB888" CompressionMode="None">base64 data</Image> */
+	return qpXmlWriter_startElement(writer, "Image", numAttribs, attribs) &&
+		   qpXmlWriter_writeBase64(writer, (const deUint8*)writeDataPtr, writeDataBytes) &&
+		   qpXmlWriter_endElement(writer, "Image");
+}
+
+/* Image encoder threads */
+
+enum
+{
+	MAX_IMAGE_ENCODER_THREADS	= 8,
+	MAX_IMAGE_JOBS_PER_THREAD	= 4,
+	MAX_IMAGE_JOB_BYTES			= 64*1024*1024		/*!< Limit for pixel data waiting to be encoded. */
+};
+
+struct ImageEncoder_s
+{
+	deMutex					lock;				/*!< Protects pending job list and ImageJob::isDone.	*/
+	ImageJob*				firstPending;
+	ImageJob*				lastPending;
+
+	deSemaphore				numPending;
+	deSemaphore				jobDone;			/*!< Signaled each time a job is finished.				*/
+
+	int						numThreads;
+	deThread				threads[MAX_IMAGE_ENCODER_THREADS];
+};
+
+static void ImageJob_destroy (ImageJob* job)
+{
+	if (job->writer)
+		qpXmlWriter_destroy(job->writer);
+
+	deFree(job->name);
+	deFree(job->description);
+	Buffer_deinit(&job->pixels);
+	Buffer_deinit(&job->output);
+	Buffer_deinit(&job->trailingOutput);
+	deFree(job);
+}
+
+static ImageJob* ImageJob_create (
+	const char*				name,
+	const char*				description,
+	qpImageCompressionMode	compressionMode,
+	qpImageFormat			imageFormat,
+	int						width,
+	int						height,
+	int						stride,
+	const void*				data,
+	int						compressionLevel)
+{
+	const int	pixelSize		= imageFormat == QP_IMAGE_FORMAT_RGB888 ? 3 : 4;
+	const int	packedStride	= pixelSize*width;
+	ImageJob*	job				= (ImageJob*)deCalloc(sizeof(ImageJob));
+	int			row;
+
+	if (!job)
+		return DE_NULL;
+
+	job->name				= deStrdup(name);
+	job->description		= description ? deStrdup(description) : DE_NULL;
+	job->compressionMode	= compressionMode;
+	job->imageFormat		= imageFormat;
+	job->width				= width;
+	job->height				= height;
+	job->compressionLevel	= compressionLevel;
+	job->outputOk			= DE_TRUE;
+	job->trailingOutputOk	= DE_TRUE;
+
+	Buffer_init(&job->pixels);
+	Buffer_init(&job->output);
+	Buffer_init(&job->trailingOutput);
+
+	job->pixelDataSize		= (size_t)(packedStride*height);
+
+	if (!job->name || (description && !job->description) || !Buffer_resize(&job->pixels, job->pixelDataSize))
+	{
+		ImageJob_destroy(job);
+		return DE_NULL;
+	}
+
+	/* Caller may release pixel data once writeImage() returns. */
+	for (row = 0; row < height; row++)
+		memcpy(&job->pixels.data[packedStride*row], &((const deUint8*)data)[row*stride], (size_t)packedStride);
+
+	return job;
+}
+
+static void writeImageJobXml (void* userPtr, const char* str)
+{
+	ImageJob* job = (ImageJob*)userPtr;
+	if (!Buffer_append(&job->output, (const deUint8*)str, strlen(str)))
+		job->outputOk = DE_FALSE;
+}
+
+static void ImageJob_execute (ImageJob* job)
+{
+	const int				pixelSize		= job->imageFormat == QP_IMAGE_FORMAT_RGB888 ? 3 : 4;
+	qpImageCompressionMode	compressionMode	= job->compressionMode;
+	Buffer					compressedBuffer;
+	const void*				writeDataPtr	= DE_NULL;
+	size_t					writeDataBytes	= ~(size_t)0;
+
+	Buffer_init(&compressedBuffer);
+
+	if (!encodeImage(&compressedBuffer, &compressionMode, job->imageFormat, job->width, job->height, pixelSize*job->width, job->pixels.data,
+					 job->compressionLevel, &writeDataPtr, &writeDataBytes) ||
+		!writeImageElement(job->writer, job->name, job->description, compressionMode, job->imageFormat, job->width, job->height, writeDataPtr, writeDataBytes))
+		job->outputOk = DE_FALSE;
+
+	Buffer_deinit(&compressedBuffer);
+	Buffer_deinit(&job->pixels);
+}
+
+static void imageEncoderThread (void* arg)
+{
+	ImageEncoder* encoder = (ImageEncoder*)arg;
+
+	for (;;)
+	{
+		ImageJob* job;
+
+		deSemaphore_decrement(encoder->numPending);
+
+		deMutex_lock(encoder->lock);
+		job = encoder->firstPending;
+		if (job)
+		{
+			encoder->firstPending = job->nextPending;
+			if (!encoder->firstPending)
+				encoder->lastPending = DE_NULL;
+		}
+		deMutex_unlock(encoder->lock);
+
+		/* Empty list signals exit. */
+		if (!job)
+			break;
+
+		ImageJob_execute(job);
+
+		deMutex_lock(encoder->lock);
+		job->isDone = DE_TRUE;
+		deMutex_unlock(encoder->lock);
+
+		deSemaphore_increment(encoder->jobDone);
+	}
+}
+
+static void ImageEncoder_destroy (ImageEncoder* encoder)
+{
+	int ndx;
+
+	DE_ASSERT(!encoder->firstPending);
+
+	for (ndx = 0; ndx < encoder->numThreads; ndx++)
+		deSemaphore_increment(encoder->numPending);
+
+	for (ndx = 0; ndx < encoder->numThreads; ndx++)
+	{
+		deThread_join(encoder->threads[ndx]);
+		deThread_destroy(encoder->threads[ndx]);
+	}
+
+	if (encoder->numPending)
+		deSemaphore_destroy(encoder->numPending);
+	if (encoder->jobDone)
+		deSemaphore_destroy(encoder->jobDone);
+	if (encoder->lock)
+		deMutex_destroy(encoder->lock);
+
+	deFree(encoder);
+}
+
+static ImageEncoder* ImageEncoder_create (void)
+{
+	ImageEncoder*	encoder		= (ImageEncoder*)deCalloc(sizeof(ImageEncoder));
+	/* Leave one core for the test itself. */
+	const int		numThreads	= deClamp32((int)deGetNumAvailableLogicalCores() - 1, 1, MAX_IMAGE_ENCODER_THREADS);
+
+	if (!encoder)
+		return DE_NULL;
+
+	encoder->lock		= deMutex_create(DE_NULL);
+	encoder->numPending	= deSemaphore_create(0, DE_NULL);
+	encoder->jobDone	= deSemaphore_create(0, DE_NULL);
+
+	if (!encoder->lock || !encoder->numPending || !encoder->jobDone)
+	{
+		ImageEncoder_destroy(encoder);
+		return DE_NULL;
+	}
+
+	for (encoder->numThreads = 0; encoder->numThreads < numThreads; encoder->numThreads++)
+	{
+		encoder->threads[encoder->numThreads] = deThread_create(imageEncoderThread, encoder, DE_NULL);
+		if (!encoder->threads[encoder->numThreads])
+			break;
+	}
+
+	if (encoder->numThreads == 0)
+	{
+		ImageEncoder_destroy(encoder);
+		return DE_NULL;
+	}
+
+	return encoder;
+}
+
+static void ImageEncoder_submit (ImageEncoder* encoder, ImageJob* job)
+{
+	deMutex_lock(encoder->lock);
+	if (encoder->lastPending)
+		encoder->lastPending->nextPending = job;
+	else
+		encoder->firstPending = job;
+	encoder->lastPending = job;
+	deMutex_unlock(encoder->lock);
+
+	deSemaphore_increment(encoder->numPending);
+}
+
+static deBool ImageEncoder_isDone (ImageEncoder* encoder, const ImageJob* job)
+{
+	deBool isDone;
+
+	deMutex_lock(encoder->lock);
+	isDone = job->isDone;
+	deMutex_unlock(encoder->lock);
+
+	return isDone;
+}
+
+static void ImageEncoder_wait (ImageEncoder* encoder, const ImageJob* job)
+{
+	/* \note jobDone may have stale counts from jobs nobody waited for, so re-check. */
+	while (!ImageEncoder_isDone(encoder, job))
+		deSemaphore_decrement(encoder->jobDone);
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Write out finished images and output following them.
+ * \param log		qpTestLog instance
+ * \param waitAll	Wait for all images, otherwise only until job limits are met
+ *
+ * Must be called with log lock held.
+ *//*--------------------------------------------------------------------*/
+static void writeFinishedImages (qpTestLog* log, deBool waitAll)
+{
+	while (log->firstImageJob)
+	{
+		ImageJob*	job			= log->firstImageJob;
+		const int	maxJobs		= MAX_IMAGE_JOBS_PER_THREAD*log->imageEncoder->numThreads;
+
+		if (waitAll || log->numImageJobs > maxJobs || log->imageJobBytes > MAX_IMAGE_JOB_BYTES)
+			ImageEncoder_wait(log->imageEncoder, job);
+		else if (!ImageEncoder_isDone(log->imageEncoder, job))
+			break;
+
+		log->firstImageJob = job->next;
+		if (!log->firstImageJob)
+			log->lastImageJob = DE_NULL;
+
+		log->numImageJobs	-= 1;
+		log->imageJobBytes	-= job->pixelDataSize;
+
+		if (job->outputOk)
+			writeFileOutput(log, job->output.data, job->output.size);
+		else
+			qpPrintf("qpTestLog_writeImage(): Writing XML failed\n");
+
+		if (!job->trailingOutputOk)
+			qpPrintf("ERROR: Failed to buffer test log output, log will be corrupted.\n");
+
+		writeFileOutput(log, job->trailingOutput.data, job->trailingOutput.size);
+
+		ImageJob_destroy(job);
+	}
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Write base64 encoded raw image data into log
+ * \param log				qpTestLog instance
+ * \param name				Unique name (matching names can be compared across BatchResults).
+ * \param description		Textual description (shown in Candy).
+ * \param compressionMode	Compression mode
+ * \param imageFormat		Color format
+ * \param width				Width in pixels
+ * \param height			Height in pixels
+ * \param stride			Data stride (offset between rows)
+ * \param data				Pointer to pixel data
+ * \return 0 if OK, otherwise <0
+ *
+ * With QP_TEST_LOG_IMAGE_THREADS the image is compressed by encoder
+ * threads and all log output after it is held in memory until it is
+ * done. Encoding failures are then only reported on the console.
+ *//*--------------------------------------------------------------------*/
+deBool qpTestLog_writeImage	(
+	qpTestLog*				log,
+	const char*				name,
+	const char*				description,
+	qpImageCompressionMode	compressionMode,
+	qpImageFormat			imageFormat,
+	int						width,
+	int						height,
+	int						stride,
+	const void*				data)
+{
+	Buffer			compressedBuffer;
+	const void*		writeDataPtr		= DE_NULL;
+	size_t			writeDataBytes		= ~(size_t)0;
+
+	DE_ASSERT(log && name);
+	DE_ASSERT(deInRange32(width, 1, 32768));
+	DE_ASSERT(deInRange32(height, 1, 32768));
+	DE_ASSERT(data);
+
+	if (log->flags & QP_TEST_LOG_EXCLUDE_IMAGES)
+		return DE_TRUE; /* Image not logged. */
+
+	if (log->flags & QP_TEST_LOG_NO_IMAGE_COMPRESSION)
+		compressionMode = QP_IMAGE_COMPRESSION_MODE_NONE;
+
+	if (log->imageEncoder)
+	{
+		ImageJob* job = ImageJob_create(name, description, compressionMode, imageFormat, width, height, stride, data, log->compressionLevel);
+
+		/* Fall back to encoding here if out of memory. */
+		if (job)
+		{
+			deMutex_lock(log->lock);
+
+			job->writer = qpXmlWriter_createFragmentWriter(log->writer, writeImageJobXml, job);
+			if (!job->writer)
+			{
+				deMutex_unlock(log->lock);
+				ImageJob_destroy(job);
+				qpPrintf("qpTestLog_writeImage(): Writing XML failed\n");
+				return DE_FALSE;
+			}
+
+			if (log->lastImageJob)
+				log->lastImageJob->next = job;
+			else
+				log->firstImageJob = job;
+
+			log->lastImageJob	 = job;
+			log->numImageJobs	+= 1;
+			log->imageJobBytes	+= job->pixelDataSize;
+
+			ImageEncoder_submit(log->imageEncoder, job);
+			writeFinishedImages(log, DE_FALSE);
+
+			deMutex_unlock(log->lock);
+			return DE_TRUE;
+		}
+	}
+
+	Buffer_init(&compressedBuffer);
+
+	if (!encodeImage(&compressedBuffer, &compressionMode, imageFormat, width, height, stride, data, log->compressionLevel, &writeDataPtr, &writeDataBytes))
+	{
+		Buffer_deinit(&compressedBuffer);
+		return DE_FALSE;
+	}
+
 	/* \note Log lock is acquired after compression! */
 	deMutex_lock(log->lock);
 
-	/* <Image ID="result" Name="Foobar" Width="640" Height="480" Format="RGB888" CompressionMode="None">base64 data</Image> */
-	if (!qpXmlWriter_startElement(log->writer, "Image", numAttribs, attribs) ||
-		!qpXmlWriter_writeBase64(log->writer, (const deUint8*)writeDataPtr, writeDataBytes) ||
-		!qpXmlWriter_endElement(log->writer, "Image"))
+	if (!writeImageElement(log->writer, name, description, compressionMode, imageFormat, width, height, writeDataPtr, writeDataBytes))
 	{
 		qpPrintf("qpTestLog_writeImage(): Writing XML failed\n");
 		deMutex_unlock(log->lock);
@@ -1501,6 +1994,14 @@ deUint32 qpTestLog_getLogFlags (const qpTestLog* log)
 	return log->flags;
 }
 
+void qpTestLog_setImageCompressionLevel (qpTestLog* log, int compressionLevel)
+{
+	DE_ASSERT(log && deInRange32(compressionLevel, -1, 9));
+	deMutex_lock(log->lock);
+	log->compressionLevel = compressionLevel;
+	deMutex_unlock(log->lock);
+}
+
 const char* qpGetTestResultName (qpTestResult result)
 {
 	return QP_LOOKUP_STRING(s_qpTestResultMap, result);
@@ -134,7 +134,11 @@ typedef enum qpTestLogFlag_e
 {
 	QP_TEST_LOG_EXCLUDE_IMAGES			= (1<<0),		/*!< Do not log images. This reduces log size considerably.			*/
 	QP_TEST_LOG_EXCLUDE_SHADER_SOURCES	= (1<<1),		/*!< Do not log shader sources. Helps to reduce log size further.	*/
-	QP_TEST_LOG_NO_FLUSH				= (1<<2)		/*!< Do not do a fflush after writing the log.						*/
+	QP_TEST_LOG_NO_FLUSH				= (1<<2),		/*!< Do not do a fflush after writing the log.						*/
+	QP_TEST_LOG_ASYNC					= (1<<3),		/*!< Write log file from a background thread.						*/
+	QP_TEST_LOG_IMAGE_THREADS			= (1<<4),		/*!< Compress images on background threads.							*/
+	QP_TEST_LOG_FAST_IMAGE_COMPRESSION	= (1<<5),		/*!< Favor PNG compression speed over image size.					*/
+	QP_TEST_LOG_NO_IMAGE_COMPRESSION	= (1<<6)		/*!< Store images uncompressed.										*/
 } qpTestLogFlag;
 
 /* Shader type. */
@@ -235,6 +239,9 @@ deBool			qpTestLog_endSampleList			(qpTestLog* log);
 
 deUint32		qpTestLog_getLogFlags			(const qpTestLog* log);
 
+/* zlib compression level (0-9) for PNG images, -1 for default. */
+void			qpTestLog_setImageCompressionLevel	(qpTestLog* log, int compressionLevel);
+
 const char*		qpGetTestResultName				(qpTestResult result);
 
 DE_END_EXTERN_C
@@ -36,6 +36,8 @@
 struct qpXmlWriter_s
 {
 	FILE*				outputFile;
+	qpXmlWriteFunc		writeFunc;
+	void*				writeFuncPtr;
 	deBool				flushAfterWrite;
 
 	deBool				xmlPrevIsStartElement;
@@ -43,6 +45,14 @@ struct qpXmlWriter_s
 	int					xmlElementDepth;
 };
 
+static void writeStr (qpXmlWriter* writer, const char* str)
+{
+	if (writer->writeFunc)
+		writer->writeFunc(writer->writeFuncPtr, str);
+	else
+		fputs(str, writer->outputFile);
+}
+
 static deBool writeEscaped (qpXmlWriter* writer, const char* str)
 {
 	char		buf[256 + 10];
@@ -107,10 +117,10 @@ static deBool writeEscaped (qpXmlWriter* writer, const char* str)
 			*d++ = *s++;
 
 		/* Write buffer if EOS or buffer full. */
-		if (isEOS || ((d - &buf[0]) >= 4))
+		if (isEOS || ((d - &buf[0]) >= 256))
 		{
 			*d = 0;
-			fprintf(writer->outputFile, "%s", buf);
+			writeStr(writer, buf);
 			d = &buf[0];
 		}
 	} while (!isEOS);
@@ -135,6 +145,37 @@ qpXmlWriter* qpXmlWriter_createFileWriter (FILE* outputFile, deBool useCompressi
 	return writer;
 }
 
+qpXmlWriter* qpXmlWriter_createCallbackWriter (qpXmlWriteFunc writeFunc, void* userPtr)
+{
+	qpXmlWriter* writer = (qpXmlWriter*)deCalloc(sizeof(qpXmlWriter));
+	if (!writer)
+		return DE_NULL;
+
+	DE_ASSERT(writeFunc);
+
+	writer->writeFunc		= writeFunc;
+	writer->writeFuncPtr	= userPtr;
+
+	return writer;
+}
+
+static deBool closePending (qpXmlWriter* writer);
+
+qpXmlWriter* qpXmlWriter_createFragmentWriter (qpXmlWriter* parent, qpXmlWriteFunc writeFunc, void* userPtr)
+{
+	qpXmlWriter* writer = qpXmlWriter_createCallbackWriter(writeFunc, userPtr);
+	if (!writer)
+		return DE_NULL;
+
+	/* Fragment starts on a new line at parent's current depth. */
+	closePending(parent);
+
+	writer->xmlIsWriting	= parent->xmlIsWriting;
+	writer->xmlElementDepth	= parent->xmlElementDepth;
+
+	return writer;
+}
+
 void qpXmlWriter_destroy (qpXmlWriter* writer)
 {
 	DE_ASSERT(writer);
@@ -146,7 +187,7 @@ static deBool closePending (qpXmlWriter* writer)
 {
 	if (writer->xmlPrevIsStartElement)
 	{
-		fprintf(writer->outputFile, ">\n");
+		writeStr(writer, ">\n");
 		writer->xmlPrevIsStartElement = DE_FALSE;
 	}
 
@@ -164,7 +205,7 @@ deBool qpXmlWriter_startDocument (qpXmlWriter* writer)
 	writer->xmlIsWriting			= DE_TRUE;
 	writer->xmlElementDepth			= 0;
 	writer->xmlPrevIsStartElement	= DE_FALSE;
-	fprintf(writer->outputFile, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	writeStr(writer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
 	return DE_TRUE;
 }
 
@@ -189,7 +230,7 @@ deBool qpXmlWriter_writeString (qpXmlWriter* writer, const char* str)
 {
 	if (writer->xmlPrevIsStartElement)
 	{
-		fprintf(writer->outputFile, ">");
+		writeStr(writer, ">");
 		writer->xmlPrevIsStartElement = DE_FALSE;
 	}
 
@@ -202,12 +243,16 @@ deBool qpXmlWriter_startElement(qpXmlWriter* writer, const char* elementName, in
 
 	closePending(writer);
 
-	fprintf(writer->outputFile, "%s<%s", getIndentStr(writer->xmlElementDepth), elementName);
+	writeStr(writer, getIndentStr(writer->xmlElementDepth));
+	writeStr(writer, "<");
+	writeStr(writer, elementName);
 
 	for (ndx = 0; ndx < numAttribs; ndx++)
 	{
 		const qpXmlAttribute* attrib = &attribs[ndx];
-		fprintf(writer->outputFile, " %s=\"", attrib->name);
+		writeStr(writer, " ");
+		writeStr(writer, attrib->name);
+		writeStr(writer, "=\"");
 		switch (attrib->type)
 		{
 			case QP_XML_ATTRIBUTE_STRING:
@@ -229,7 +274,7 @@ deBool qpXmlWriter_startElement(qpXmlWriter* writer, const char* elementName, in
 			default:
 				DE_ASSERT(DE_FALSE);
 		}
-		fprintf(writer->outputFile, "\"");
+		writeStr(writer, "\"");
 	}
 
 	writer->xmlElementDepth++;
@@ -244,11 +289,15 @@ deBool qpXmlWriter_endElement (qpXmlWriter* writer, const char* elementName)
 
 	if (writer->xmlPrevIsStartElement) /* leave flag as-is */
 	{
-		fprintf(writer->outputFile, " />\n");
+		writeStr(writer, " />\n");
 		writer->xmlPrevIsStartElement = DE_FALSE;
 	}
 	else
-		fprintf(writer->outputFile, "</%s>\n", /*getIndentStr(writer->xmlElementDepth),*/ elementName);
+	{
+		writeStr(writer, "</");
+		writeStr(writer, elementName);
+		writeStr(writer, ">\n");
+	}
 
 	return DE_TRUE;
 }
@@ -297,18 +346,18 @@ deBool qpXmlWriter_writeBase64 (qpXmlWriter* writer, const deUint8* data, size_t
 		/* Write indent (if needed). */
 		if (writeIndent)
 		{
-			fprintf(writer->outputFile, "%s", indentStr);
+			writeStr(writer, indentStr);
 			writeIndent = DE_FALSE;
 		}
 
 		/* Write data. */
-		fprintf(writer->outputFile, "%s", &d[0]);
+		writeStr(writer, &d[0]);
 
 		/* EOL every now and then. */
 		numWritten += 4;
 		if (numWritten >= 64)
 		{
-			fprintf(writer->outputFile, "\n");
+			writeStr(writer, "\n");
 			numWritten = 0;
 			writeIndent = DE_TRUE;
 		}
@@ -316,7 +365,7 @@ deBool qpXmlWriter_writeBase64 (qpXmlWriter* writer, const deUint8* data, size_t
 
 	/* Last EOL. */
 	if (numWritten > 0)
-		fprintf(writer->outputFile, "\n");
+		writeStr(writer, "\n");
 
 	DE_ASSERT(srcNdx == numBytes);
 	return DE_TRUE;
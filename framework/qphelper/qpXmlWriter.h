@@ -31,6 +31,8 @@ DE_BEGIN_EXTERN_C
 
 typedef struct qpXmlWriter_s	qpXmlWriter;
 
+typedef void (*qpXmlWriteFunc) (void* userPtr, const char* str);
+
 typedef enum qpXmlAttributeType_e
 {
 	QP_XML_ATTRIBUTE_STRING = 0,
@@ -90,6 +92,29 @@ DE_INLINE qpXmlAttribute qpSetBoolAttrib (const char* name, deBool value)
  *//*--------------------------------------------------------------------*/
 qpXmlWriter*	qpXmlWriter_createFileWriter (FILE* outFile, deBool useCompression, deBool flushAfterWrite);
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Create an XML Writer instance that passes output to a callback
+ * \param writeFunc Function called with each piece of output
+ * \param userPtr User pointer passed to writeFunc
+ * \return qpXmlWriter instance, or DE_NULL on failure
+ *//*--------------------------------------------------------------------*/
+qpXmlWriter*	qpXmlWriter_createCallbackWriter (qpXmlWriteFunc writeFunc, void* userPtr);
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Create an XML Writer for a fragment of parent's document
+ *
+ * Output of the fragment writer is formatted as if it was written by
+ * parent at its current position. Caller is responsible for inserting
+ * the output at that position, and fragment must end at the depth it
+ * started at.
+ *
+ * \param parent Writer whose document the fragment belongs to
+ * \param writeFunc Function called with each piece of output
+ * \param userPtr User pointer passed to writeFunc
+ * \return qpXmlWriter instance, or DE_NULL on failure
+ *//*--------------------------------------------------------------------*/
+qpXmlWriter*	qpXmlWriter_createFragmentWriter (qpXmlWriter* parent, qpXmlWriteFunc writeFunc, void* userPtr);
+
 /*--------------------------------------------------------------------*//*!
  * \brief XML Writer instance
  * \param a	qpXmlWriter instance
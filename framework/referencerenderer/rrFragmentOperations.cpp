@@ -22,8 +22,11 @@
  *//*--------------------------------------------------------------------*/
 
 #include "rrFragmentOperations.hpp"
+#include "rrSimd.hpp"
 #include "tcuVectorUtil.hpp"
 #include "tcuTextureUtil.hpp"
+#include "deFloat16.h"
+#include "deMemory.h"
 #include <limits>
 
 using tcu::IVec2;
@@ -64,6 +67,276 @@ static inline Vec4 unpremultiply (const Vec4& v)
 	}
 }
 
+namespace
+{
+
+// Direct access to common buffer formats.
+// \note Conversions must match the ones in tcu::PixelBufferAccess exactly.
+
+struct PixelRGBA8
+{
+	static Vec4 read (const deUint8* ptr)
+	{
+		return Vec4(ptr[0]/255.0f, ptr[1]/255.0f, ptr[2]/255.0f, ptr[3]/255.0f);
+	}
+
+	static void write (deUint8* ptr, const Vec4& color)
+	{
+		ptr[0] = tcu::floatToU8(color.x());
+		ptr[1] = tcu::floatToU8(color.y());
+		ptr[2] = tcu::floatToU8(color.z());
+		ptr[3] = tcu::floatToU8(color.w());
+	}
+};
+
+struct PixelRGBA16F
+{
+	static Vec4 read (const deUint8* ptr)
+	{
+		deFloat16 v[4];
+		deMemcpy(v, ptr, sizeof(v));
+		return Vec4(deFloat16To32(v[0]), deFloat16To32(v[1]), deFloat16To32(v[2]), deFloat16To32(v[3]));
+	}
+
+	static void write (deUint8* ptr, const Vec4& color)
+	{
+		const deFloat16 v[4] = { deFloat32To16(color.x()), deFloat32To16(color.y()), deFloat32To16(color.z()), deFloat32To16(color.w()) };
+		deMemcpy(ptr, v, sizeof(v));
+	}
+};
+
+struct PixelRGBA32F
+{
+	static Vec4 read (const deUint8* ptr)
+	{
+		Vec4 color;
+		deMemcpy(color.getPtr(), ptr, sizeof(float[4]));
+		return color;
+	}
+
+	static void write (deUint8* ptr, const Vec4& color)
+	{
+		deMemcpy(ptr, color.getPtr(), sizeof(float[4]));
+	}
+};
+
+//! Depth values are compared in buffer format.
+struct PixelD32F
+{
+	typedef float Value;
+
+	static Value read (const deUint8* ptr)
+	{
+		float v;
+		deMemcpy(&v, ptr, sizeof(v));
+		return v;
+	}
+
+	static void write (deUint8* ptr, Value value)
+	{
+		deMemcpy(ptr, &value, sizeof(value));
+	}
+
+	static Value fromFloat (float depth)
+	{
+		return de::clamp(depth, 0.0f, 1.0f);
+	}
+};
+
+struct PixelD24
+{
+	typedef deUint32 Value;
+
+	static Value read (const deUint8* ptr)
+	{
+#if (DE_ENDIANNESS == DE_LITTLE_ENDIAN)
+		return ((deUint32)ptr[0]) | (((deUint32)ptr[1]) << 8u) | (((deUint32)ptr[2]) << 16u);
+#else
+		return (((deUint32)ptr[0]) << 16u) | (((deUint32)ptr[1]) << 8u) | ((deUint32)ptr[2]);
+#endif
+	}
+
+	static void write (deUint8* ptr, Value value)
+	{
+#if (DE_ENDIANNESS == DE_LITTLE_ENDIAN)
+		ptr[0] = (deUint8)(value & 0xFFu);
+		ptr[1] = (deUint8)((value >> 8u) & 0xFFu);
+		ptr[2] = (deUint8)((value >> 16u) & 0xFFu);
+#else
+		ptr[0] = (deUint8)((value >> 16u) & 0xFFu);
+		ptr[1] = (deUint8)((value >> 8u) & 0xFFu);
+		ptr[2] = (deUint8)(value & 0xFFu);
+#endif
+	}
+
+	//! Round to nearest even and saturate, as in PixelBufferAccess::setPixDepth().
+	static Value fromFloat (float depth)
+	{
+		const float	f		= depth * 16777215.0f;
+		const float	q		= deFloatFrac(f);
+		deInt64		intVal	= (deInt64)(f-q);
+
+		if (q == 0.5f)
+		{
+			if (intVal % 2 != 0)
+				intVal++;
+		}
+		else if (q > 0.5f)
+			intVal++;
+
+		return (deUint32)de::clamp<deInt64>(intVal, 0, 0xFFFFFF);
+	}
+};
+
+//! Buffer access with same interface as tcu::PixelBufferAccess, but without format switches.
+template <typename Pixel>
+class DirectBufferAccess
+{
+public:
+	explicit DirectBufferAccess (const tcu::PixelBufferAccess& buffer)
+		: m_basePtr	((deUint8*)buffer.getDataPtr())
+		, m_pitch	(buffer.getPitch())
+	{
+	}
+
+	deUint8*	getPixelPtr		(int x, int y, int z) const					{ return m_basePtr + x*m_pitch.x() + y*m_pitch.y() + z*m_pitch.z();	}
+
+	Vec4		getPixel		(int x, int y, int z) const					{ return Pixel::read(getPixelPtr(x, y, z));							}
+	void		setPixel		(const Vec4& color, int x, int y, int z) const	{ Pixel::write(getPixelPtr(x, y, z), color);						}
+
+private:
+	deUint8*	m_basePtr;
+	tcu::IVec3	m_pitch;
+};
+
+inline bool isDirectBufferAccess (const tcu::PixelBufferAccess&)
+{
+	return false;
+}
+
+template <typename Pixel>
+inline bool isDirectBufferAccess (const DirectBufferAccess<Pixel>&)
+{
+	return true;
+}
+
+enum ColorBufferFormat
+{
+	COLORBUFFERFORMAT_GENERIC = 0,
+	COLORBUFFERFORMAT_RGBA8,
+	COLORBUFFERFORMAT_RGBA16F,
+	COLORBUFFERFORMAT_RGBA32F,
+
+	COLORBUFFERFORMAT_LAST
+};
+
+enum DepthBufferFormat
+{
+	DEPTHBUFFERFORMAT_GENERIC = 0,
+	DEPTHBUFFERFORMAT_D24,
+	DEPTHBUFFERFORMAT_D32F,
+
+	DEPTHBUFFERFORMAT_LAST
+};
+
+// Blending of one sample in SIMD lanes: xyz hold RGB and w holds alpha.
+// \note Operations must match executeBlendFactorCompute*() and executeBlend().
+
+simd::Lane blendFactorLane (BlendFunc func, const simd::Lane& src, const simd::Lane& src1, const simd::Lane& dst, const simd::Lane& constant)
+{
+	using namespace simd;
+
+	const Lane one = splatLane(1.0f);
+
+	// w is the alpha factor for the same function, except for SRC_ALPHA_SATURATE
+	switch (func)
+	{
+		case BLENDFUNC_ZERO:						return splatLane(0.0f);
+		case BLENDFUNC_ONE:							return one;
+		case BLENDFUNC_SRC_COLOR:					return src;
+		case BLENDFUNC_ONE_MINUS_SRC_COLOR:			return subLane(one, src);
+		case BLENDFUNC_DST_COLOR:					return dst;
+		case BLENDFUNC_ONE_MINUS_DST_COLOR:			return subLane(one, dst);
+		case BLENDFUNC_SRC_ALPHA:					return splatLaneW(src);
+		case BLENDFUNC_ONE_MINUS_SRC_ALPHA:			return subLane(one, splatLaneW(src));
+		case BLENDFUNC_DST_ALPHA:					return splatLaneW(dst);
+		case BLENDFUNC_ONE_MINUS_DST_ALPHA:			return subLane(one, splatLaneW(dst));
+		case BLENDFUNC_CONSTANT_COLOR:				return constant;
+		case BLENDFUNC_ONE_MINUS_CONSTANT_COLOR:	return subLane(one, constant);
+		case BLENDFUNC_CONSTANT_ALPHA:				return splatLaneW(constant);
+		case BLENDFUNC_ONE_MINUS_CONSTANT_ALPHA:	return subLane(one, splatLaneW(constant));
+		case BLENDFUNC_SRC_ALPHA_SATURATE:			return mergeAlphaLane(splatLaneW(minLane(src, subLane(one, dst))), one);
+		case BLENDFUNC_SRC1_COLOR:					return src1;
+		case BLENDFUNC_ONE_MINUS_SRC1_COLOR:		return subLane(one, src1);
+		case BLENDFUNC_SRC1_ALPHA:					return splatLaneW(src1);
+		case BLENDFUNC_ONE_MINUS_SRC1_ALPHA:		return subLane(one, splatLaneW(src1));
+		default:
+			DE_ASSERT(false);
+			return one;
+	}
+}
+
+simd::Lane blendEquationLane (BlendEquation equation, const simd::Lane& src, const simd::Lane& dst, const simd::Lane& srcFactor, const simd::Lane& dstFactor)
+{
+	using namespace simd;
+
+	switch (equation)
+	{
+		case BLENDEQUATION_ADD:					return addLane(mulLane(src, srcFactor), mulLane(dst, dstFactor));
+		case BLENDEQUATION_SUBTRACT:			return subLane(mulLane(src, srcFactor), mulLane(dst, dstFactor));
+		case BLENDEQUATION_REVERSE_SUBTRACT:	return subLane(mulLane(dst, dstFactor), mulLane(src, srcFactor));
+		case BLENDEQUATION_MIN:					return minLane(src, dst);
+		case BLENDEQUATION_MAX:					return maxLane(src, dst);
+		default:
+			DE_ASSERT(false);
+			return src;
+	}
+}
+
+ColorBufferFormat getColorBufferFormat (const tcu::TextureFormat& format)
+{
+	if (format == tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::UNORM_INT8))
+		return COLORBUFFERFORMAT_RGBA8;
+	else if (format == tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::HALF_FLOAT))
+		return COLORBUFFERFORMAT_RGBA16F;
+	else if (format == tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::FLOAT))
+		return COLORBUFFERFORMAT_RGBA32F;
+	else
+		return COLORBUFFERFORMAT_GENERIC;
+}
+
+//! \note D24 matches depth of D24S8 buffers as well.
+DepthBufferFormat getDepthBufferFormat (const tcu::TextureFormat& format)
+{
+	if (format == tcu::TextureFormat(tcu::TextureFormat::D, tcu::TextureFormat::UNORM_INT24))
+		return DEPTHBUFFERFORMAT_D24;
+	else if (format == tcu::TextureFormat(tcu::TextureFormat::D, tcu::TextureFormat::FLOAT))
+		return DEPTHBUFFERFORMAT_D32F;
+	else
+		return DEPTHBUFFERFORMAT_GENERIC;
+}
+
+template <typename T>
+inline bool testDepth (TestFunc func, T sampleDepth, T bufferDepth)
+{
+	switch (func)
+	{
+		case TESTFUNC_NEVER:	return false;
+		case TESTFUNC_ALWAYS:	return true;
+		case TESTFUNC_LESS:		return sampleDepth <  bufferDepth;
+		case TESTFUNC_LEQUAL:	return sampleDepth <= bufferDepth;
+		case TESTFUNC_GREATER:	return sampleDepth >  bufferDepth;
+		case TESTFUNC_GEQUAL:	return sampleDepth >= bufferDepth;
+		case TESTFUNC_EQUAL:	return sampleDepth == bufferDepth;
+		case TESTFUNC_NOTEQUAL:	return sampleDepth != bufferDepth;
+		default:
+			DE_ASSERT(false);
+			return false;
+	}
+}
+
+} // anonymous
+
 void clearMultisampleColorBuffer	(const tcu::PixelBufferAccess& dst, const Vec4& v,	const WindowRectangle& r)	{ tcu::clear(tcu::getSubregion(dst, 0, r.left, r.bottom, dst.getWidth(), r.width, r.height), v);				}
 void clearMultisampleColorBuffer	(const tcu::PixelBufferAccess& dst, const IVec4& v,	const WindowRectangle& r)	{ tcu::clear(tcu::getSubregion(dst, 0, r.left, r.bottom, dst.getWidth(), r.width, r.height), v);				}
 void clearMultisampleColorBuffer	(const tcu::PixelBufferAccess& dst, const UVec4& v,	const WindowRectangle& r)	{ tcu::clear(tcu::getSubregion(dst, 0, r.left, r.bottom, dst.getWidth(), r.width, r.height), v.cast<int>());	}
@@ -71,7 +344,8 @@ void clearMultisampleDepthBuffer	(const tcu::PixelBufferAccess& dst, float v,		c
 void clearMultisampleStencilBuffer	(const tcu::PixelBufferAccess& dst, int v,			const WindowRectangle& r)	{ tcu::clearStencil(tcu::getSubregion(dst, 0, r.left, r.bottom, dst.getWidth(), r.width, r.height), v);			}
 
 FragmentProcessor::FragmentProcessor (void)
-	: m_sampleRegister()
+	: m_sampleRegister		()
+	, m_fastPathsEnabled	(true)
 {
 }
 
@@ -317,6 +591,43 @@ void FragmentProcessor::executeDepthWrite (int fragNdxOffset, int numSamplesPerF
 	}
 }
 
+template <typename Pixel>
+void FragmentProcessor::executeDirectDepthCompare (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, TestFunc depthFunc, const tcu::PixelBufferAccess& depthBuffer)
+{
+	const DirectBufferAccess<Pixel> access (depthBuffer);
+
+	for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+	{
+		if (m_sampleRegister[regSampleNdx].isAlive)
+		{
+			const int					fragSampleNdx		= regSampleNdx % numSamplesPerFragment;
+			const Fragment&				frag				= inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
+			const typename Pixel::Value	depthBufferValue	= Pixel::read(access.getPixelPtr(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y()));
+			const typename Pixel::Value	sampleDepth			= Pixel::fromFloat(frag.sampleDepths[fragSampleNdx]);
+
+			m_sampleRegister[regSampleNdx].depthPassed = testDepth(depthFunc, sampleDepth, depthBufferValue);
+		}
+	}
+}
+
+template <typename Pixel>
+void FragmentProcessor::executeDirectDepthWrite (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::PixelBufferAccess& depthBuffer)
+{
+	const DirectBufferAccess<Pixel> access (depthBuffer);
+
+	for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+	{
+		if (m_sampleRegister[regSampleNdx].isAlive && m_sampleRegister[regSampleNdx].depthPassed)
+		{
+			const int			fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
+			const Fragment&		frag			= inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
+			const float			clampedDepth	= de::clamp(frag.sampleDepths[fragSampleNdx], 0.0f, 1.0f);
+
+			Pixel::write(access.getPixelPtr(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y()), Pixel::fromFloat(clampedDepth));
+		}
+	}
+}
+
 void FragmentProcessor::executeStencilDpFailAndPass (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const StencilState& stencilState, int numStencilBits, const tcu::PixelBufferAccess& stencilBuffer)
 {
 #define SAMPLE_REGISTER_DPFAIL_OR_DPPASS(CONDITION, EXPRESSION)																													\
@@ -691,7 +1002,8 @@ void FragmentProcessor::executeAdvancedBlend (BlendEquationAdvanced equation)
 #undef SAMPLE_REGISTER_ADV_BLEND_HSL
 }
 
-void FragmentProcessor::executeColorWrite (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, bool isSRGB, const tcu::PixelBufferAccess& colorBuffer)
+template <class ColorBuffer>
+void FragmentProcessor::executeColorWrite (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, bool isSRGB, const ColorBuffer& colorBuffer)
 {
 	for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
 	{
@@ -712,30 +1024,8 @@ void FragmentProcessor::executeColorWrite (int fragNdxOffset, int numSamplesPerF
 	}
 }
 
-void FragmentProcessor::executeRGBA8ColorWrite (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::PixelBufferAccess& colorBuffer)
-{
-	const int		fragStride	= 4;
-	const int		xStride		= colorBuffer.getRowPitch();
-	const int		yStride		= colorBuffer.getSlicePitch();
-	deUint8* const	basePtr		= (deUint8*)colorBuffer.getDataPtr();
-
-	for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
-	{
-		if (m_sampleRegister[regSampleNdx].isAlive)
-		{
-			const int			fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
-			const Fragment&		frag			= inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
-			deUint8*			dstPtr			= basePtr + fragSampleNdx*fragStride + frag.pixelCoord.x()*xStride + frag.pixelCoord.y()*yStride;
-
-			dstPtr[0] = tcu::floatToU8(m_sampleRegister[regSampleNdx].blendedRGB.x());
-			dstPtr[1] = tcu::floatToU8(m_sampleRegister[regSampleNdx].blendedRGB.y());
-			dstPtr[2] = tcu::floatToU8(m_sampleRegister[regSampleNdx].blendedRGB.z());
-			dstPtr[3] = tcu::floatToU8(m_sampleRegister[regSampleNdx].blendedA);
-		}
-	}
-}
-
-void FragmentProcessor::executeMaskedColorWrite (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const Vec4& colorMaskFactor, const Vec4& colorMaskNegationFactor, bool isSRGB, const tcu::PixelBufferAccess& colorBuffer)
+template <class ColorBuffer>
+void FragmentProcessor::executeMaskedColorWrite (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const Vec4& colorMaskFactor, const Vec4& colorMaskNegationFactor, bool isSRGB, const ColorBuffer& colorBuffer)
 {
 	for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
 	{
@@ -789,6 +1079,154 @@ void FragmentProcessor::executeUnsignedValueWrite (int fragNdxOffset, int numSam
 	}
 }
 
+template <class ColorBuffer>
+void FragmentProcessor::executeSimdBlend (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const FragmentOperationState& state, bool sRGBTarget, const Vec4& minClampValue, const Vec4& maxClampValue, const ColorBuffer& colorBuffer)
+{
+	using namespace simd;
+
+	const BlendState&	rgbState	= state.blendRGBState;
+	const BlendState&	aState		= state.blendAState;
+	const Lane			minValue	= loadLane(minClampValue.getPtr());
+	const Lane			maxValue	= loadLane(maxClampValue.getPtr());
+	const Lane			constant	= loadLane(state.blendColor.getPtr());
+
+	for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+	{
+		if (m_sampleRegister[regSampleNdx].isAlive)
+		{
+			SampleData&			sample			= m_sampleRegister[regSampleNdx];
+			const int			fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
+			const Fragment&		frag			= inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
+			const Vec4			dstColor		= colorBuffer.getPixel(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y());
+			const Vec4			linearDst		= sRGBTarget ? tcu::sRGBToLinear(dstColor) : dstColor;
+			const Lane			src				= clampLane(loadLane(frag.value.get<float>().getPtr()), minValue, maxValue);
+			const Lane			src1			= clampLane(loadLane(frag.value1.get<float>().getPtr()), minValue, maxValue);
+			const Lane			dst				= clampLane(loadLane(linearDst.getPtr()), minValue, maxValue);
+			const Lane			srcFactor		= mergeAlphaLane(blendFactorLane(rgbState.srcFunc, src, src1, dst, constant), blendFactorLane(aState.srcFunc, src, src1, dst, constant));
+			const Lane			dstFactor		= mergeAlphaLane(blendFactorLane(rgbState.dstFunc, src, src1, dst, constant), blendFactorLane(aState.dstFunc, src, src1, dst, constant));
+			const Lane			blended			= mergeAlphaLane(blendEquationLane(rgbState.equation, src, dst, srcFactor, dstFactor), blendEquationLane(aState.equation, src, dst, srcFactor, dstFactor));
+			float				result[4];
+
+			storeLane(result, blended);
+
+			sample.blendedRGB	= Vec3(result[0], result[1], result[2]);
+			sample.blendedA		= result[3];
+		}
+	}
+}
+
+template <class ColorBuffer>
+void FragmentProcessor::executeFloatColorOutput (int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const FragmentOperationState& state, tcu::TextureChannelClass colorbufferClass, bool sRGBTarget, const Vec4& colorMaskFactor, const Vec4& colorMaskNegationFactor, const ColorBuffer& colorBuffer)
+{
+	// Select min/max clamping values for blending factors and operands
+	Vec4 minClampValue;
+	Vec4 maxClampValue;
+
+	if (colorbufferClass == tcu::TEXTURECHANNELCLASS_UNSIGNED_FIXED_POINT)
+	{
+		minClampValue = Vec4(0.0f);
+		maxClampValue = Vec4(1.0f);
+	}
+	else if (colorbufferClass == tcu::TEXTURECHANNELCLASS_SIGNED_FIXED_POINT)
+	{
+		minClampValue = Vec4(-1.0f);
+		maxClampValue = Vec4(1.0f);
+	}
+	else
+	{
+		// No clamping
+		minClampValue = Vec4(-std::numeric_limits<float>::infinity());
+		maxClampValue = Vec4(std::numeric_limits<float>::infinity());
+	}
+
+	// Blend calculation - only if using blend.
+	if (state.blendMode == BLENDMODE_STANDARD && isDirectBufferAccess(colorBuffer))
+	{
+		// Fast paths blend in SIMD, generic path keeps the scalar blend they are tested against.
+		executeSimdBlend(fragNdxOffset, numSamplesPerFragment, inputFragments, state, sRGBTarget, minClampValue, maxClampValue, colorBuffer);
+	}
+	else if (state.blendMode == BLENDMODE_STANDARD)
+	{
+		// Put dst color to register, doing srgb-to-linear conversion if needed.
+		for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+		{
+			if (m_sampleRegister[regSampleNdx].isAlive)
+			{
+				int					fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
+				const Fragment&		frag			= inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
+				Vec4				dstColor		= colorBuffer.getPixel(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y());
+
+				m_sampleRegister[regSampleNdx].clampedBlendSrcColor		= clamp(frag.value.get<float>(), minClampValue, maxClampValue);
+				m_sampleRegister[regSampleNdx].clampedBlendSrc1Color	= clamp(frag.value1.get<float>(), minClampValue, maxClampValue);
+				m_sampleRegister[regSampleNdx].clampedBlendDstColor		= clamp(sRGBTarget ? tcu::sRGBToLinear(dstColor) : dstColor, minClampValue, maxClampValue);
+			}
+		}
+
+		// Calculate blend factors to register.
+		executeBlendFactorComputeRGB(state.blendColor, state.blendRGBState);
+		executeBlendFactorComputeA(state.blendColor, state.blendAState);
+
+		// Compute blended color.
+		executeBlend(state.blendRGBState, state.blendAState);
+	}
+	else if (state.blendMode == BLENDMODE_ADVANCED)
+	{
+		// Unpremultiply colors for blending, and do sRGB->linear if necessary
+		// \todo [2014-03-17 pyry] Re-consider clampedBlend*Color var names
+		for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+		{
+			if (m_sampleRegister[regSampleNdx].isAlive)
+			{
+				int					fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
+				const Fragment&		frag			= inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
+				const Vec4			srcColor		= frag.value.get<float>();
+				const Vec4			dstColor		= colorBuffer.getPixel(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y());
+
+				m_sampleRegister[regSampleNdx].clampedBlendSrcColor		= unpremultiply(clamp(srcColor, minClampValue, maxClampValue));
+				m_sampleRegister[regSampleNdx].clampedBlendDstColor		= unpremultiply(clamp(sRGBTarget ? tcu::sRGBToLinear(dstColor) : dstColor, minClampValue, maxClampValue));
+			}
+		}
+
+		executeAdvancedBlend(state.blendEquationAdvaced);
+	}
+	else
+	{
+		// Not using blend - just put values to register as-is.
+		DE_ASSERT(state.blendMode == BLENDMODE_NONE);
+
+		for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+		{
+			if (m_sampleRegister[regSampleNdx].isAlive)
+			{
+				const Fragment& frag = inputFragments[fragNdxOffset + regSampleNdx/numSamplesPerFragment];
+
+				m_sampleRegister[regSampleNdx].blendedRGB	= frag.value.get<float>().xyz();
+				m_sampleRegister[regSampleNdx].blendedA		= frag.value.get<float>().w();
+			}
+		}
+	}
+
+	// Clamp result values in sample register
+	if (colorbufferClass != tcu::TEXTURECHANNELCLASS_FLOATING_POINT)
+	{
+		for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
+		{
+			if (m_sampleRegister[regSampleNdx].isAlive)
+			{
+				m_sampleRegister[regSampleNdx].blendedRGB	= clamp(m_sampleRegister[regSampleNdx].blendedRGB, minClampValue.swizzle(0, 1, 2), maxClampValue.swizzle(0, 1, 2));
+				m_sampleRegister[regSampleNdx].blendedA		= clamp(m_sampleRegister[regSampleNdx].blendedA, minClampValue.w(), maxClampValue.w());
+			}
+		}
+	}
+
+	// Finally, write the colors to the color buffer.
+
+	if (state.colorMask[0] && state.colorMask[1] && state.colorMask[2] && state.colorMask[3])
+		executeColorWrite(fragNdxOffset, numSamplesPerFragment, inputFragments, sRGBTarget, colorBuffer);
+	else if (state.colorMask[0] || state.colorMask[1] || state.colorMask[2] || state.colorMask[3])
+		executeMaskedColorWrite(fragNdxOffset, numSamplesPerFragment, inputFragments, colorMaskFactor, colorMaskNegationFactor, sRGBTarget, colorBuffer);
+}
+
 void FragmentProcessor::render (const rr::MultisamplePixelBufferAccess&		msColorBuffer,
 								const rr::MultisamplePixelBufferAccess&		msDepthBuffer,
 								const rr::MultisamplePixelBufferAccess&		msStencilBuffer,
@@ -828,6 +1266,8 @@ void FragmentProcessor::render (const rr::MultisamplePixelBufferAccess&		msColor
 	Vec4					colorMaskFactor				(state.colorMask[0] ? 1.0f : 0.0f, state.colorMask[1] ? 1.0f : 0.0f, state.colorMask[2] ? 1.0f : 0.0f, state.colorMask[3] ? 1.0f : 0.0f);
 	Vec4					colorMaskNegationFactor		(state.colorMask[0] ? 0.0f : 1.0f, state.colorMask[1] ? 0.0f : 1.0f, state.colorMask[2] ? 0.0f : 1.0f, state.colorMask[3] ? 0.0f : 1.0f);
 	bool					sRGBTarget					= state.sRGBEnabled && tcu::isSRGB(colorBuffer.getFormat());
+	ColorBufferFormat		colorFormat					= m_fastPathsEnabled ? getColorBufferFormat(colorBuffer.getFormat()) : COLORBUFFERFORMAT_GENERIC;
+	DepthBufferFormat		depthFormat					= (m_fastPathsEnabled && hasDepth) ? getDepthBufferFormat(depthBuffer.getFormat()) : DEPTHBUFFERFORMAT_GENERIC;
 
 	DE_ASSERT(SAMPLE_REGISTER_SIZE % numSamplesPerFragment == 0);
 
@@ -878,10 +1318,29 @@ void FragmentProcessor::render (const rr::MultisamplePixelBufferAccess&		msColor
 
 		if (doDepthTest)
 		{
-			executeDepthCompare(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state.depthFunc, depthBuffer);
+			switch (depthFormat)
+			{
+				case DEPTHBUFFERFORMAT_D24:
+					executeDirectDepthCompare<PixelD24>(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state.depthFunc, depthBuffer);
+
+					if (state.depthMask)
+						executeDirectDepthWrite<PixelD24>(groupFirstFragNdx, numSamplesPerFragment, inputFragments, depthBuffer);
+					break;
 
-			if (state.depthMask)
-				executeDepthWrite(groupFirstFragNdx, numSamplesPerFragment, inputFragments, depthBuffer);
+				case DEPTHBUFFERFORMAT_D32F:
+					executeDirectDepthCompare<PixelD32F>(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state.depthFunc, depthBuffer);
+
+					if (state.depthMask)
+						executeDirectDepthWrite<PixelD32F>(groupFirstFragNdx, numSamplesPerFragment, inputFragments, depthBuffer);
+					break;
+
+				default:
+					executeDepthCompare(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state.depthFunc, depthBuffer);
+
+					if (state.depthMask)
+						executeDepthWrite(groupFirstFragNdx, numSamplesPerFragment, inputFragments, depthBuffer);
+					break;
+			}
 		}
 
 		// Do dpFail and dpPass stencil writes.
@@ -902,116 +1361,15 @@ void FragmentProcessor::render (const rr::MultisamplePixelBufferAccess&		msColor
 		switch (fragmentDataType)
 		{
 			case rr::GENERICVECTYPE_FLOAT:
-			{
-				// Select min/max clamping values for blending factors and operands
-				Vec4 minClampValue;
-				Vec4 maxClampValue;
-
-				if (colorbufferClass == tcu::TEXTURECHANNELCLASS_UNSIGNED_FIXED_POINT)
-				{
-					minClampValue = Vec4(0.0f);
-					maxClampValue = Vec4(1.0f);
-				}
-				else if (colorbufferClass == tcu::TEXTURECHANNELCLASS_SIGNED_FIXED_POINT)
+				switch (colorFormat)
 				{
-					minClampValue = Vec4(-1.0f);
-					maxClampValue = Vec4(1.0f);
+					case COLORBUFFERFORMAT_RGBA8:	executeFloatColorOutput(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state, colorbufferClass, sRGBTarget, colorMaskFactor, colorMaskNegationFactor, DirectBufferAccess<PixelRGBA8>(colorBuffer));		break;
+					case COLORBUFFERFORMAT_RGBA16F:	executeFloatColorOutput(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state, colorbufferClass, sRGBTarget, colorMaskFactor, colorMaskNegationFactor, DirectBufferAccess<PixelRGBA16F>(colorBuffer));	break;
+					case COLORBUFFERFORMAT_RGBA32F:	executeFloatColorOutput(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state, colorbufferClass, sRGBTarget, colorMaskFactor, colorMaskNegationFactor, DirectBufferAccess<PixelRGBA32F>(colorBuffer));	break;
+					default:						executeFloatColorOutput(groupFirstFragNdx, numSamplesPerFragment, inputFragments, state, colorbufferClass, sRGBTarget, colorMaskFactor, colorMaskNegationFactor, colorBuffer);										break;
 				}
-				else
-				{
-					// No clamping
-					minClampValue = Vec4(-std::numeric_limits<float>::infinity());
-					maxClampValue = Vec4(std::numeric_limits<float>::infinity());
-				}
-
-				// Blend calculation - only if using blend.
-				if (state.blendMode == BLENDMODE_STANDARD)
-				{
-					// Put dst color to register, doing srgb-to-linear conversion if needed.
-					for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
-					{
-						if (m_sampleRegister[regSampleNdx].isAlive)
-						{
-							int					fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
-							const Fragment&		frag			= inputFragments[groupFirstFragNdx + regSampleNdx/numSamplesPerFragment];
-							Vec4				dstColor		= colorBuffer.getPixel(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y());
-
-							m_sampleRegister[regSampleNdx].clampedBlendSrcColor		= clamp(frag.value.get<float>(), minClampValue, maxClampValue);
-							m_sampleRegister[regSampleNdx].clampedBlendSrc1Color	= clamp(frag.value1.get<float>(), minClampValue, maxClampValue);
-							m_sampleRegister[regSampleNdx].clampedBlendDstColor		= clamp(sRGBTarget ? tcu::sRGBToLinear(dstColor) : dstColor, minClampValue, maxClampValue);
-						}
-					}
-
-					// Calculate blend factors to register.
-					executeBlendFactorComputeRGB(state.blendColor, state.blendRGBState);
-					executeBlendFactorComputeA(state.blendColor, state.blendAState);
-
-					// Compute blended color.
-					executeBlend(state.blendRGBState, state.blendAState);
-				}
-				else if (state.blendMode == BLENDMODE_ADVANCED)
-				{
-					// Unpremultiply colors for blending, and do sRGB->linear if necessary
-					// \todo [2014-03-17 pyry] Re-consider clampedBlend*Color var names
-					for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
-					{
-						if (m_sampleRegister[regSampleNdx].isAlive)
-						{
-							int					fragSampleNdx	= regSampleNdx % numSamplesPerFragment;
-							const Fragment&		frag			= inputFragments[groupFirstFragNdx + regSampleNdx/numSamplesPerFragment];
-							const Vec4			srcColor		= frag.value.get<float>();
-							const Vec4			dstColor		= colorBuffer.getPixel(fragSampleNdx, frag.pixelCoord.x(), frag.pixelCoord.y());
-
-							m_sampleRegister[regSampleNdx].clampedBlendSrcColor		= unpremultiply(clamp(srcColor, minClampValue, maxClampValue));
-							m_sampleRegister[regSampleNdx].clampedBlendDstColor		= unpremultiply(clamp(sRGBTarget ? tcu::sRGBToLinear(dstColor) : dstColor, minClampValue, maxClampValue));
-						}
-					}
-
-					executeAdvancedBlend(state.blendEquationAdvaced);
-				}
-				else
-				{
-					// Not using blend - just put values to register as-is.
-					DE_ASSERT(state.blendMode == BLENDMODE_NONE);
-
-					for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
-					{
-						if (m_sampleRegister[regSampleNdx].isAlive)
-						{
-							const Fragment& frag = inputFragments[groupFirstFragNdx + regSampleNdx/numSamplesPerFragment];
-
-							m_sampleRegister[regSampleNdx].blendedRGB	= frag.value.get<float>().xyz();
-							m_sampleRegister[regSampleNdx].blendedA		= frag.value.get<float>().w();
-						}
-					}
-				}
-
-				// Clamp result values in sample register
-				if (colorbufferClass != tcu::TEXTURECHANNELCLASS_FLOATING_POINT)
-				{
-					for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
-					{
-						if (m_sampleRegister[regSampleNdx].isAlive)
-						{
-							m_sampleRegister[regSampleNdx].blendedRGB	= clamp(m_sampleRegister[regSampleNdx].blendedRGB, minClampValue.swizzle(0, 1, 2), maxClampValue.swizzle(0, 1, 2));
-							m_sampleRegister[regSampleNdx].blendedA		= clamp(m_sampleRegister[regSampleNdx].blendedA, minClampValue.w(), maxClampValue.w());
-						}
-					}
-				}
-
-				// Finally, write the colors to the color buffer.
-
-				if (state.colorMask[0] && state.colorMask[1] && state.colorMask[2] && state.colorMask[3])
-				{
-					if (colorBuffer.getFormat() == tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::UNORM_INT8))
-						executeRGBA8ColorWrite(groupFirstFragNdx, numSamplesPerFragment, inputFragments, colorBuffer);
-					else
-						executeColorWrite(groupFirstFragNdx, numSamplesPerFragment, inputFragments, sRGBTarget, colorBuffer);
-				}
-				else if (state.colorMask[0] || state.colorMask[1] || state.colorMask[2] || state.colorMask[3])
-					executeMaskedColorWrite(groupFirstFragNdx, numSamplesPerFragment, inputFragments, colorMaskFactor, colorMaskNegationFactor, sRGBTarget, colorBuffer);
 				break;
-			}
+
 			case rr::GENERICVECTYPE_INT32:
 				// Write fragments
 				for (int regSampleNdx = 0; regSampleNdx < SAMPLE_REGISTER_SIZE; regSampleNdx++)
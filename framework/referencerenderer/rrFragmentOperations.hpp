@@ -36,6 +36,7 @@
 #include "rrDefs.hpp"
 #include "tcuVector.hpp"
 #include "tcuTexture.hpp"
+#include "tcuTextureUtil.hpp"
 #include "rrRenderState.hpp"
 #include "rrGenericVector.hpp"
 #include "rrMultisamplePixelBufferAccess.hpp"
@@ -92,12 +93,18 @@ void clearMultisampleStencilBuffer		(const tcu::PixelBufferAccess& dst, int
  * FragmentProcessor.render() draws a given set of fragments. No two
  * fragments given in one render() call should have the same pixel
  * coordinates coordinates, and they must all have the same facing.
+ *
+ * RGBA8, RGBA16F and RGBA32F color buffers and D24 and D32F depth buffers
+ * are accessed directly instead of through tcu::PixelBufferAccess. Results
+ * are identical; the fast paths can be disabled for testing that.
  *//*--------------------------------------------------------------------*/
 class FragmentProcessor
 {
 public:
 				FragmentProcessor	(void);
 
+	void		setFastPathsEnabled	(bool enabled) { m_fastPathsEnabled = enabled; }
+
 	void		render				(const rr::MultisamplePixelBufferAccess&	colorMultisampleBuffer,
 									 const rr::MultisamplePixelBufferAccess&	depthMultisampleBuffer,
 									 const rr::MultisamplePixelBufferAccess&	stencilMultisampleBuffer,
@@ -137,19 +144,31 @@ private:
 	void		executeDepthBoundsTest			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const float minDepthBound, const float maxDepthBound, const tcu::ConstPixelBufferAccess& depthBuffer);
 	void		executeDepthCompare				(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, TestFunc depthFunc, const tcu::ConstPixelBufferAccess& depthBuffer);
 	void		executeDepthWrite				(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::PixelBufferAccess& depthBuffer);
+	template <typename Pixel>
+	void		executeDirectDepthCompare		(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, TestFunc depthFunc, const tcu::PixelBufferAccess& depthBuffer);
+	template <typename Pixel>
+	void		executeDirectDepthWrite			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::PixelBufferAccess& depthBuffer);
 	void		executeStencilDpFailAndPass		(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const StencilState& stencilState, int numStencilBits, const tcu::PixelBufferAccess& stencilBuffer);
 	void		executeBlendFactorComputeRGB	(const tcu::Vec4& blendColor, const BlendState& blendRGBState);
 	void		executeBlendFactorComputeA		(const tcu::Vec4& blendColor, const BlendState& blendAState);
 	void		executeBlend					(const BlendState& blendRGBState, const BlendState& blendAState);
 	void		executeAdvancedBlend			(BlendEquationAdvanced equation);
 
-	void		executeColorWrite				(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, bool isSRGB, const tcu::PixelBufferAccess& colorBuffer);
-	void		executeRGBA8ColorWrite			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::PixelBufferAccess& colorBuffer);
-	void		executeMaskedColorWrite			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::Vec4& colorMaskFactor, const tcu::Vec4& colorMaskNegationFactor, bool isSRGB, const tcu::PixelBufferAccess& colorBuffer);
+	template <class ColorBuffer>
+	void		executeColorWrite				(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, bool isSRGB, const ColorBuffer& colorBuffer);
+	template <class ColorBuffer>
+	void		executeMaskedColorWrite			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::Vec4& colorMaskFactor, const tcu::Vec4& colorMaskNegationFactor, bool isSRGB, const ColorBuffer& colorBuffer);
 	void		executeSignedValueWrite			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::BVec4& colorMask, const tcu::PixelBufferAccess& colorBuffer);
 	void		executeUnsignedValueWrite		(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const tcu::BVec4& colorMask, const tcu::PixelBufferAccess& colorBuffer);
 
+	template <class ColorBuffer>
+	void		executeSimdBlend				(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const FragmentOperationState& state, bool sRGBTarget, const tcu::Vec4& minClampValue, const tcu::Vec4& maxClampValue, const ColorBuffer& colorBuffer);
+
+	template <class ColorBuffer>
+	void		executeFloatColorOutput			(int fragNdxOffset, int numSamplesPerFragment, const Fragment* inputFragments, const FragmentOperationState& state, tcu::TextureChannelClass colorbufferClass, bool sRGBTarget, const tcu::Vec4& colorMaskFactor, const tcu::Vec4& colorMaskNegationFactor, const ColorBuffer& colorBuffer);
+
 	SampleData	m_sampleRegister[SAMPLE_REGISTER_SIZE];
+	bool		m_fastPathsEnabled;
 } DE_WARN_UNUSED_TYPE;
 
 } // rr
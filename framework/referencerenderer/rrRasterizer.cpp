@@ -91,6 +91,31 @@ static inline bool isInsideCCW (const EdgeFunction& edge, const deInt64 edgeVal)
 	return edge.inclusive ? (edgeVal >= 0) : (edgeVal > 0);
 }
 
+//! Get coverage mask with all samples set for fragments inside viewport.
+static inline deUint64 getFullPacketCoverage (int numSamples, bool outX1, bool outY1)
+{
+	deUint64 coverage = getCoverageFragmentSampleBits(numSamples, 0, 0);
+
+	if (!outX1)
+		coverage |= getCoverageFragmentSampleBits(numSamples, 1, 0);
+	if (!outY1)
+		coverage |= getCoverageFragmentSampleBits(numSamples, 0, 1);
+	if (!outX1 && !outY1)
+		coverage |= getCoverageFragmentSampleBits(numSamples, 1, 1);
+
+	return coverage;
+}
+
+//! Edge values at the four pixel centers of a packet. Steps are exact, result equals evaluating each center.
+static inline tcu::Vector<deInt64, 4> evaluatePacketEdge (const EdgeFunction& edge, const deInt64 sx0, const deInt64 sy0)
+{
+	const deInt64	e0		= evaluateEdge(edge, sx0, sy0);
+	const deInt64	stepX	= edge.a * (1ll << RASTERIZER_SUBPIXEL_BITS);
+	const deInt64	stepY	= edge.b * (1ll << RASTERIZER_SUBPIXEL_BITS);
+
+	return tcu::Vector<deInt64, 4>(e0, e0 + stepX, e0 + stepY, e0 + stepX + stepY);
+}
+
 namespace LineRasterUtil
 {
 
@@ -451,7 +476,9 @@ TriangleRasterizer::TriangleRasterizer (const tcu::IVec4& viewport, const int nu
 	, m_winding					(state.winding)
 	, m_horizontalFill			(state.horizontalFill)
 	, m_verticalFill			(state.verticalFill)
+	, m_hierarchicalEnabled		(true)
 	, m_face					(FACETYPE_LAST)
+	, m_curBlockFullyCovered	(false)
 	, m_viewportOrientation		(state.viewportOrientation)
 {
 }
@@ -530,7 +557,135 @@ void TriangleRasterizer::init (const tcu::Vec4& v0, const tcu::Vec4& v1, const t
 	m_bboxMax.x() = de::clamp(m_bboxMax.x(), wX0, wX1);
 	m_bboxMax.y() = de::clamp(m_bboxMax.y(), wY0, wY1);
 
-	m_curPos = m_bboxMin;
+	m_curBlockMin = m_bboxMin;
+	findNextBlock();
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Restrict rasterization to packets overlapping a rectangle
+ *
+ * Only fragment packets that overlap rect (x, y, width, height) will be
+ * generated by subsequent rasterize() calls. Packet alignment is not
+ * changed, so the generated packets are identical to the corresponding
+ * packets generated without the restriction. Packets may still contain
+ * covered fragments outside rect.
+ *
+ * Must be called after init() and before rasterize().
+ *//*--------------------------------------------------------------------*/
+void TriangleRasterizer::restrictToRect (const tcu::IVec4& rect)
+{
+	// Packets are aligned to bounding box min, find first packet overlapping rect.
+	if (rect.x() > m_bboxMin.x())
+		m_bboxMin.x() += (rect.x() - m_bboxMin.x()) & ~1;
+	if (rect.y() > m_bboxMin.y())
+		m_bboxMin.y() += (rect.y() - m_bboxMin.y()) & ~1;
+
+	m_bboxMax.x() = de::min(m_bboxMax.x(), rect.x() + rect.z() - 1);
+	m_bboxMax.y() = de::min(m_bboxMax.y(), rect.y() + rect.w() - 1);
+
+	// No overlap, terminate rasterization immediately.
+	if (m_bboxMin.x() > m_bboxMax.x() || m_bboxMin.y() > m_bboxMax.y())
+	{
+		m_curPos = m_bboxMin;
+		m_curPos.y() = m_bboxMax.y() + 1;
+		return;
+	}
+
+	m_curBlockMin = m_bboxMin;
+	findNextBlock();
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Test block against edge functions
+ *
+ * Edge functions are linear, so if all corners of the area spanned by
+ * the samples in the block are on the same side of an edge, all samples
+ * are as well. The tested area is conservative for multisampling.
+ *//*--------------------------------------------------------------------*/
+TriangleRasterizer::BlockCoverage TriangleRasterizer::getBlockCoverage (const tcu::IVec2& blockMin, const tcu::IVec2& blockMax) const
+{
+	// Last pixel covered by packets in block. Packets may extend past blockMax by one pixel.
+	const int				x1			= blockMin.x() + ((blockMax.x() - blockMin.x()) & ~1) + 1;
+	const int				y1			= blockMin.y() + ((blockMax.y() - blockMin.y()) & ~1) + 1;
+
+	// Single sample is taken at pixel center, multiple samples are inside pixel area.
+	const deInt64			halfPixel	= 1ll << (RASTERIZER_SUBPIXEL_BITS-1);
+	const bool				isMsaa		= m_numSamples > 1;
+	const deInt64			sx0			= toSubpixelCoord(blockMin.x())				+ (isMsaa ? 0 : halfPixel);
+	const deInt64			sx1			= toSubpixelCoord(x1 + (isMsaa ? 1 : 0))	+ (isMsaa ? 0 : halfPixel);
+	const deInt64			sy0			= toSubpixelCoord(blockMin.y())				+ (isMsaa ? 0 : halfPixel);
+	const deInt64			sy1			= toSubpixelCoord(y1 + (isMsaa ? 1 : 0))	+ (isMsaa ? 0 : halfPixel);
+
+	const EdgeFunction*		edges[]		= { &m_edge01, &m_edge12, &m_edge20 };
+	bool					allInside	= true;
+
+	if (!m_hierarchicalEnabled)
+		return BLOCKCOVERAGE_PARTIAL;
+
+	for (int edgeNdx = 0; edgeNdx < DE_LENGTH_OF_ARRAY(edges); edgeNdx++)
+	{
+		const EdgeFunction&	edge		= *edges[edgeNdx];
+		const int			numInside	= (isInsideCCW(edge, evaluateEdge(edge, sx0, sy0)) ? 1 : 0)
+										+ (isInsideCCW(edge, evaluateEdge(edge, sx1, sy0)) ? 1 : 0)
+										+ (isInsideCCW(edge, evaluateEdge(edge, sx0, sy1)) ? 1 : 0)
+										+ (isInsideCCW(edge, evaluateEdge(edge, sx1, sy1)) ? 1 : 0);
+
+		if (numInside == 0)
+			return BLOCKCOVERAGE_NONE;
+		else if (numInside != 4)
+			allInside = false;
+	}
+
+	return allInside ? BLOCKCOVERAGE_FULL : BLOCKCOVERAGE_PARTIAL;
+}
+
+//! Find first block starting from m_curBlockMin that is not fully outside triangle.
+void TriangleRasterizer::findNextBlock (void)
+{
+	for (; m_curBlockMin.y() <= m_bboxMax.y(); stepBlock())
+	{
+		m_curBlockMax = tcu::min(m_curBlockMin + tcu::IVec2(RASTERIZER_BLOCK_SIZE-1), m_bboxMax);
+
+		const BlockCoverage coverage = getBlockCoverage(m_curBlockMin, m_curBlockMax);
+
+		if (coverage != BLOCKCOVERAGE_NONE)
+		{
+			m_curPos				= m_curBlockMin;
+			m_curBlockFullyCovered	= coverage == BLOCKCOVERAGE_FULL;
+			return;
+		}
+	}
+
+	// No more blocks, terminate rasterization.
+	m_curPos		= m_curBlockMin;
+	m_curPos.y()	= m_bboxMax.y() + 1;
+}
+
+inline void TriangleRasterizer::stepBlock (void)
+{
+	m_curBlockMin.x() += RASTERIZER_BLOCK_SIZE;
+	if (m_curBlockMin.x() > m_bboxMax.x())
+	{
+		m_curBlockMin.y() += RASTERIZER_BLOCK_SIZE;
+		m_curBlockMin.x()  = m_bboxMin.x();
+	}
+}
+
+//! Move to next packet in current block, or to the first packet of next block.
+inline void TriangleRasterizer::advance (void)
+{
+	m_curPos.x() += 2;
+	if (m_curPos.x() > m_curBlockMax.x())
+	{
+		m_curPos.y() += 2;
+		m_curPos.x()  = m_curBlockMin.x();
+
+		if (m_curPos.y() > m_curBlockMax.y())
+		{
+			stepBlock();
+			findNextBlock();
+		}
+	}
 }
 
 void TriangleRasterizer::rasterizeSingleSample (FragmentPacket* const fragmentPackets, float* const depthValues, const int maxFragmentPackets, int& numPacketsRasterized)
@@ -576,27 +731,32 @@ void TriangleRasterizer::rasterizeSingleSample (FragmentPacket* const fragmentPa
 		// Coverage
 		deUint64		coverage	= 0;
 
-		// Evaluate edge values
-		for (int i = 0; i < 4; i++)
+		if (m_curBlockFullyCovered)
 		{
-			e01[i] = evaluateEdge(m_edge01, sx[i], sy[i]);
-			e12[i] = evaluateEdge(m_edge12, sx[i], sy[i]);
-			e20[i] = evaluateEdge(m_edge20, sx[i], sy[i]);
+			// All pixels are inside, edge values are only needed for barycentrics and depth.
+			e01 = evaluatePacketEdge(m_edge01, sx0, sy0);
+			e12 = evaluatePacketEdge(m_edge12, sx0, sy0);
+			e20 = evaluatePacketEdge(m_edge20, sx0, sy0);
+
+			coverage = getFullPacketCoverage(1, outX1, outY1);
 		}
+		else
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				e01[i] = evaluateEdge(m_edge01, sx[i], sy[i]);
+				e12[i] = evaluateEdge(m_edge12, sx[i], sy[i]);
+				e20[i] = evaluateEdge(m_edge20, sx[i], sy[i]);
+			}
 
-		// Compute coverage mask
-		coverage = setCoverageValue(coverage, 1, 0, 0, 0,						isInsideCCW(m_edge01, e01[0]) && isInsideCCW(m_edge12, e12[0]) && isInsideCCW(m_edge20, e20[0]));
-		coverage = setCoverageValue(coverage, 1, 1, 0, 0, !outX1 &&				isInsideCCW(m_edge01, e01[1]) && isInsideCCW(m_edge12, e12[1]) && isInsideCCW(m_edge20, e20[1]));
-		coverage = setCoverageValue(coverage, 1, 0, 1, 0, !outY1 &&				isInsideCCW(m_edge01, e01[2]) && isInsideCCW(m_edge12, e12[2]) && isInsideCCW(m_edge20, e20[2]));
-		coverage = setCoverageValue(coverage, 1, 1, 1, 0, !outX1 && !outY1 &&	isInsideCCW(m_edge01, e01[3]) && isInsideCCW(m_edge12, e12[3]) && isInsideCCW(m_edge20, e20[3]));
+			coverage = setCoverageValue(coverage, 1, 0, 0, 0,						isInsideCCW(m_edge01, e01[0]) && isInsideCCW(m_edge12, e12[0]) && isInsideCCW(m_edge20, e20[0]));
+			coverage = setCoverageValue(coverage, 1, 1, 0, 0, !outX1 &&				isInsideCCW(m_edge01, e01[1]) && isInsideCCW(m_edge12, e12[1]) && isInsideCCW(m_edge20, e20[1]));
+			coverage = setCoverageValue(coverage, 1, 0, 1, 0, !outY1 &&				isInsideCCW(m_edge01, e01[2]) && isInsideCCW(m_edge12, e12[2]) && isInsideCCW(m_edge20, e20[2]));
+			coverage = setCoverageValue(coverage, 1, 1, 1, 0, !outX1 && !outY1 &&	isInsideCCW(m_edge01, e01[3]) && isInsideCCW(m_edge12, e12[3]) && isInsideCCW(m_edge20, e20[3]));
+		}
 
 		// Advance to next location
-		m_curPos.x() += 2;
-		if (m_curPos.x() > m_bboxMax.x())
-		{
-			m_curPos.y() += 2;
-			m_curPos.x()  = m_bboxMin.x();
-		}
+		advance();
 
 		if (coverage == 0)
 			continue; // Discard.
@@ -756,36 +916,39 @@ void TriangleRasterizer::rasterizeMultiSample (FragmentPacket* const fragmentPac
 		// Coverage
 		deUint64		coverage	= 0;
 
-		// Evaluate edge values at sample positions
-		for (int sampleNdx = 0; sampleNdx < NumSamples; sampleNdx++)
+		// Evaluate edge values at sample positions. In fully covered blocks these are only needed for depth.
+		if (!m_curBlockFullyCovered || depthValues)
 		{
-			const deInt64 ox = samplePos[sampleNdx*2 + 0];
-			const deInt64 oy = samplePos[sampleNdx*2 + 1];
-
-			for (int fragNdx = 0; fragNdx < 4; fragNdx++)
+			for (int sampleNdx = 0; sampleNdx < NumSamples; sampleNdx++)
 			{
-				e01[sampleNdx][fragNdx] = evaluateEdge(m_edge01, sx[fragNdx] + ox, sy[fragNdx] + oy);
-				e12[sampleNdx][fragNdx] = evaluateEdge(m_edge12, sx[fragNdx] + ox, sy[fragNdx] + oy);
-				e20[sampleNdx][fragNdx] = evaluateEdge(m_edge20, sx[fragNdx] + ox, sy[fragNdx] + oy);
+				const deInt64 ox = samplePos[sampleNdx*2 + 0];
+				const deInt64 oy = samplePos[sampleNdx*2 + 1];
+
+				for (int fragNdx = 0; fragNdx < 4; fragNdx++)
+				{
+					e01[sampleNdx][fragNdx] = evaluateEdge(m_edge01, sx[fragNdx] + ox, sy[fragNdx] + oy);
+					e12[sampleNdx][fragNdx] = evaluateEdge(m_edge12, sx[fragNdx] + ox, sy[fragNdx] + oy);
+					e20[sampleNdx][fragNdx] = evaluateEdge(m_edge20, sx[fragNdx] + ox, sy[fragNdx] + oy);
+				}
 			}
 		}
 
 		// Compute coverage mask
-		for (int sampleNdx = 0; sampleNdx < NumSamples; sampleNdx++)
+		if (m_curBlockFullyCovered)
+			coverage = getFullPacketCoverage(NumSamples, outX1, outY1);
+		else
 		{
-			coverage = setCoverageValue(coverage, NumSamples, 0, 0, sampleNdx,						isInsideCCW(m_edge01, e01[sampleNdx][0]) && isInsideCCW(m_edge12, e12[sampleNdx][0]) && isInsideCCW(m_edge20, e20[sampleNdx][0]));
-			coverage = setCoverageValue(coverage, NumSamples, 1, 0, sampleNdx, !outX1 &&			isInsideCCW(m_edge01, e01[sampleNdx][1]) && isInsideCCW(m_edge12, e12[sampleNdx][1]) && isInsideCCW(m_edge20, e20[sampleNdx][1]));
-			coverage = setCoverageValue(coverage, NumSamples, 0, 1, sampleNdx, !outY1 &&			isInsideCCW(m_edge01, e01[sampleNdx][2]) && isInsideCCW(m_edge12, e12[sampleNdx][2]) && isInsideCCW(m_edge20, e20[sampleNdx][2]));
-			coverage = setCoverageValue(coverage, NumSamples, 1, 1, sampleNdx, !outX1 && !outY1 &&	isInsideCCW(m_edge01, e01[sampleNdx][3]) && isInsideCCW(m_edge12, e12[sampleNdx][3]) && isInsideCCW(m_edge20, e20[sampleNdx][3]));
+			for (int sampleNdx = 0; sampleNdx < NumSamples; sampleNdx++)
+			{
+				coverage = setCoverageValue(coverage, NumSamples, 0, 0, sampleNdx,						isInsideCCW(m_edge01, e01[sampleNdx][0]) && isInsideCCW(m_edge12, e12[sampleNdx][0]) && isInsideCCW(m_edge20, e20[sampleNdx][0]));
+				coverage = setCoverageValue(coverage, NumSamples, 1, 0, sampleNdx, !outX1 &&			isInsideCCW(m_edge01, e01[sampleNdx][1]) && isInsideCCW(m_edge12, e12[sampleNdx][1]) && isInsideCCW(m_edge20, e20[sampleNdx][1]));
+				coverage = setCoverageValue(coverage, NumSamples, 0, 1, sampleNdx, !outY1 &&			isInsideCCW(m_edge01, e01[sampleNdx][2]) && isInsideCCW(m_edge12, e12[sampleNdx][2]) && isInsideCCW(m_edge20, e20[sampleNdx][2]));
+				coverage = setCoverageValue(coverage, NumSamples, 1, 1, sampleNdx, !outX1 && !outY1 &&	isInsideCCW(m_edge01, e01[sampleNdx][3]) && isInsideCCW(m_edge12, e12[sampleNdx][3]) && isInsideCCW(m_edge20, e20[sampleNdx][3]));
+			}
 		}
 
 		// Advance to next location
-		m_curPos.x() += 2;
-		if (m_curPos.x() > m_bboxMax.x())
-		{
-			m_curPos.y() += 2;
-			m_curPos.x()  = m_bboxMin.x();
-		}
+		advance();
 
 		if (coverage == 0)
 			continue; // Discard.
@@ -36,7 +36,8 @@ namespace rr
 enum
 {
 	RASTERIZER_SUBPIXEL_BITS			= 8,
-	RASTERIZER_MAX_SAMPLES_PER_FRAGMENT	= 16
+	RASTERIZER_MAX_SAMPLES_PER_FRAGMENT	= 16,
+	RASTERIZER_BLOCK_SIZE				= 8		//!< Size of block used in hierarchical triangle rasterization.
 };
 
 //! Get coverage bit value.
@@ -114,6 +115,11 @@ struct EdgeFunction
  *  - Depth interpolation
  *  - Perspective-correct barycentric computation for interpolation
  *  - Visible face determination
+ *  - Hierarchical rasterization: bounding box is traversed in blocks of
+ *    RASTERIZER_BLOCK_SIZE x RASTERIZER_BLOCK_SIZE pixels. Blocks outside
+ *    the triangle are skipped, and per-sample coverage tests are skipped
+ *    for blocks fully inside the triangle. Fragment packets are generated
+ *    block by block.
  *
  * It does not (and will not) implement following:
  *  - Triangle setup
@@ -133,20 +139,39 @@ public:
 
 	// Following functions are only available after init()
 	FaceType				getVisibleFace			(void) const { return m_face; }
+	void					restrictToRect			(const tcu::IVec4& rect);
 	void					rasterize				(FragmentPacket* const fragmentPackets, float* const depthValues, const int maxFragmentPackets, int& numPacketsRasterized);
 
+	//! Disable block classification; every packet in bounding box is tested per sample. For testing.
+	void					setHierarchicalEnabled	(bool enabled) { m_hierarchicalEnabled = enabled; }
+
 private:
+	enum BlockCoverage
+	{
+		BLOCKCOVERAGE_NONE = 0,		//!< No samples in block are covered.
+		BLOCKCOVERAGE_PARTIAL,		//!< Some samples may be covered.
+		BLOCKCOVERAGE_FULL,			//!< All samples in block are covered.
+
+		BLOCKCOVERAGE_LAST
+	};
+
 	void					rasterizeSingleSample	(FragmentPacket* const fragmentPackets, float* const depthValues, const int maxFragmentPackets, int& numPacketsRasterized);
 
 	template<int NumSamples>
 	void					rasterizeMultiSample	(FragmentPacket* const fragmentPackets, float* const depthValues, const int maxFragmentPackets, int& numPacketsRasterized);
 
+	BlockCoverage			getBlockCoverage		(const tcu::IVec2& blockMin, const tcu::IVec2& blockMax) const;
+	void					findNextBlock			(void);
+	void					stepBlock				(void);
+	void					advance					(void);
+
 	// Constant rasterization state.
 	const tcu::IVec4		m_viewport;
 	const int				m_numSamples;
 	const Winding			m_winding;
 	const HorizontalFill	m_horizontalFill;
 	const VerticalFill		m_verticalFill;
+	bool					m_hierarchicalEnabled;
 
 	// Per-triangle rasterization state.
 	tcu::Vec4				m_v0;
@@ -159,6 +184,9 @@ private:
 	tcu::IVec2				m_bboxMin;				//!< Bounding box min (inclusive).
 	tcu::IVec2				m_bboxMax;				//!< Bounding box max (inclusive).
 	tcu::IVec2				m_curPos;				//!< Current rasterization position.
+	tcu::IVec2				m_curBlockMin;			//!< Current block min (inclusive).
+	tcu::IVec2				m_curBlockMax;			//!< Current block max (inclusive), clamped to bounding box.
+	bool					m_curBlockFullyCovered;	//!< All samples in current block are covered.
 	ViewportOrientation		m_viewportOrientation;	//!< Direction of +x+y axis
 } DE_WARN_UNUSED_TYPE;
 
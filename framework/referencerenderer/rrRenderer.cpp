@@ -29,8 +29,15 @@
 #include "rrFragmentOperations.hpp"
 #include "rrRasterizer.hpp"
 #include "deMemory.h"
+#include "deAtomic.h"
+#include "deThread.hpp"
+#include "deSemaphore.hpp"
+#include "deMutex.hpp"
+#include "deSharedPtr.hpp"
 
 #include <set>
+#include <map>
+#include <algorithm>
 
 namespace rr
 {
@@ -41,12 +48,24 @@ typedef double ClipFloat; // floating point type used in clipping
 
 typedef tcu::Vector<ClipFloat, 4> ClipVec4;
 
+enum
+{
+	MAX_FRAGMENT_PACKETS	= 128,	//!< Number of fragment packets rasterized and shaded at once
+	TILE_SIZE				= 64	//!< Width and height of a screen tile in the binned rasterization path
+};
+
 struct RasterizationInternalBuffers
 {
 	std::vector<FragmentPacket>		fragmentPackets;
 	std::vector<GenericVec4>		shaderOutputs;
 	std::vector<Fragment>			shadedFragments;
+	std::vector<float>				depthValues;
 	float*							fragmentDepthBuffer;
+
+	RasterizationInternalBuffers (void)
+		: fragmentDepthBuffer(DE_NULL)
+	{
+	}
 };
 
 deUint32 readIndexArray (const IndexType type, const void* ptr, size_t ndx)
@@ -88,12 +107,178 @@ bool isEmpty (const rr::MultisampleConstPixelBufferAccess& access)
 	return access.raw().getWidth() == 0 || access.raw().getHeight() == 0 || access.raw().getDepth() == 0;
 }
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Thread pool for executing rasterization jobs
+ *
+ * Executes a set of independent jobs (screen tiles) using the calling
+ * thread and numThreads-1 worker threads. Worker threads are started when
+ * the pool is created and live until the pool is destroyed. Calls to run()
+ * from several threads are serialized.
+ *//*--------------------------------------------------------------------*/
+class RasterizationThreadPool
+{
+public:
+	class Job
+	{
+	public:
+		virtual			~Job		(void) {}
+		virtual void	execute		(int jobNdx, int threadNdx) = 0;
+	};
+
+							RasterizationThreadPool		(int numThreads);
+							~RasterizationThreadPool	(void);
+
+	int						getNumThreads				(void) const { return (int)m_threads.size() + 1; }
+
+	//! Execute job for all indices in range [0, numJobs). Returns when all jobs have completed.
+	void					run							(Job& job, int numJobs);
+
+private:
+	class WorkerThread : public de::Thread
+	{
+	public:
+								WorkerThread	(RasterizationThreadPool& pool, int threadNdx);
+
+		void					run				(void);
+		void					wakeUp			(void) { m_wakeUp.increment(); }
+
+	private:
+		RasterizationThreadPool&	m_pool;
+		const int					m_threadNdx;
+		de::Semaphore				m_wakeUp;
+	};
+
+							RasterizationThreadPool		(const RasterizationThreadPool&); // not allowed
+	RasterizationThreadPool&	operator=				(const RasterizationThreadPool&); // not allowed
+
+	void					executeJobs					(int threadNdx);
+
+	typedef de::SharedPtr<WorkerThread> WorkerThreadSp;
+
+	std::vector<WorkerThreadSp>	m_threads;
+	de::Semaphore				m_finished;
+	de::Mutex					m_runLock;
+
+	// Current job set, written only while workers are idle.
+	Job*						m_job;
+	int							m_numJobs;
+	volatile deInt32			m_nextJobNdx;
+	bool						m_exit;
+};
+
+RasterizationThreadPool::WorkerThread::WorkerThread (RasterizationThreadPool& pool, int threadNdx)
+	: m_pool		(pool)
+	, m_threadNdx	(threadNdx)
+	, m_wakeUp		(0)
+{
+}
+
+void RasterizationThreadPool::WorkerThread::run (void)
+{
+	for (;;)
+	{
+		m_wakeUp.decrement();
+
+		if (m_pool.m_exit)
+			break;
+
+		m_pool.executeJobs(m_threadNdx);
+		m_pool.m_finished.increment();
+	}
+}
+
+RasterizationThreadPool::RasterizationThreadPool (int numThreads)
+	: m_finished	(0)
+	, m_job			(DE_NULL)
+	, m_numJobs		(0)
+	, m_nextJobNdx	(0)
+	, m_exit		(false)
+{
+	DE_ASSERT(numThreads >= 1);
+
+	// Calling thread executes jobs as thread 0.
+	for (int threadNdx = 1; threadNdx < numThreads; ++threadNdx)
+	{
+		m_threads.push_back(WorkerThreadSp(new WorkerThread(*this, threadNdx)));
+		m_threads.back()->start();
+	}
+}
+
+RasterizationThreadPool::~RasterizationThreadPool (void)
+{
+	m_exit = true;
+
+	for (size_t threadNdx = 0; threadNdx < m_threads.size(); ++threadNdx)
+		m_threads[threadNdx]->wakeUp();
+
+	for (size_t threadNdx = 0; threadNdx < m_threads.size(); ++threadNdx)
+		m_threads[threadNdx]->join();
+}
+
+void RasterizationThreadPool::executeJobs (int threadNdx)
+{
+	for (;;)
+	{
+		const int jobNdx = (int)deAtomicIncrement32(&m_nextJobNdx) - 1;
+
+		if (jobNdx >= m_numJobs)
+			break;
+
+		m_job->execute(jobNdx, threadNdx);
+	}
+}
+
+void RasterizationThreadPool::run (Job& job, int numJobs)
+{
+	if (numJobs == 0)
+		return;
+
+	const de::ScopedLock lock (m_runLock);
+
+	m_job			= &job;
+	m_numJobs		= numJobs;
+	m_nextJobNdx	= 0;
+
+	// Wake up only as many workers as there are jobs for them
+	const int numWorkers = de::min((int)m_threads.size(), numJobs-1);
+
+	for (int threadNdx = 0; threadNdx < numWorkers; ++threadNdx)
+		m_threads[threadNdx]->wakeUp();
+
+	executeJobs(0);
+
+	for (int threadNdx = 0; threadNdx < numWorkers; ++threadNdx)
+		m_finished.decrement();
+
+	m_job		= DE_NULL;
+	m_numJobs	= 0;
+}
+
+typedef de::SharedPtr<RasterizationThreadPool> RasterizationThreadPoolSp;
+
+de::Mutex									s_threadPoolLock;
+std::map<int, RasterizationThreadPoolSp>	s_threadPools;
+
+//! Get pool shared by all renderers using numThreads threads. Pool is created on first use.
+RasterizationThreadPool& getSharedThreadPool (int numThreads)
+{
+	const de::ScopedLock		lock	(s_threadPoolLock);
+	RasterizationThreadPoolSp&	pool	= s_threadPools[numThreads];
+
+	if (!pool)
+		pool = RasterizationThreadPoolSp(new RasterizationThreadPool(numThreads));
+
+	return *pool;
+}
+
 struct DrawContext
 {
-	int primitiveID;
+	int							primitiveID;
+	RasterizationThreadPool*	threadPool;		//!< Binned multithreaded rasterization is used if not null
 
 	DrawContext (void)
-		: primitiveID(0)
+		: primitiveID	(0)
+		, threadPool	(DE_NULL)
 	{
 	}
 };
@@ -1095,11 +1280,78 @@ void writeFragmentPackets (const RenderState&					state,
 	}
 }
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Remove fragment packets that do not overlap given rect
+ *
+ * Remaining packets and their depth values are compacted to the beginning
+ * of the arrays, preserving order.
+ *//*--------------------------------------------------------------------*/
+int removePacketsOutsideRect (FragmentPacket* packets, float* depthValues, int numPackets, int numSamples, const tcu::IVec4& rect)
+{
+	const int	numDepthValuesPerPacket	= 4*numSamples;
+	int			numRemaining			= 0;
+
+	for (int packetNdx = 0; packetNdx < numPackets; ++packetNdx)
+	{
+		const tcu::IVec2& pos = packets[packetNdx].position;
+
+		if (pos.x() + 1 < rect.x() || pos.x() >= rect.x() + rect.z() ||
+			pos.y() + 1 < rect.y() || pos.y() >= rect.y() + rect.w())
+			continue;
+
+		if (numRemaining != packetNdx)
+		{
+			packets[numRemaining] = packets[packetNdx];
+
+			if (depthValues)
+				deMemcpy(&depthValues[numRemaining*numDepthValuesPerPacket], &depthValues[packetNdx*numDepthValuesPerPacket], sizeof(float)*numDepthValuesPerPacket);
+		}
+
+		++numRemaining;
+	}
+
+	return numRemaining;
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Clear coverage of all fragments outside given rect
+ *
+ * Packets produced for a screen tile may contain fragments that belong to
+ * a neighboring tile. These fragments are shaded, since shading happens
+ * per packet, but must not be written.
+ *//*--------------------------------------------------------------------*/
+void maskCoverageToRect (FragmentPacket* packets, int numPackets, int numSamples, const tcu::IVec4& rect)
+{
+	for (int packetNdx = 0; packetNdx < numPackets; ++packetNdx)
+	{
+		FragmentPacket& packet = packets[packetNdx];
+
+		for (int fragNdx = 0; fragNdx < 4; fragNdx++)
+		{
+			const int xo = fragNdx%2;
+			const int yo = fragNdx/2;
+
+			if (!de::inRange(packet.position.x() + xo, rect.x(), rect.x() + rect.z() - 1) ||
+				!de::inRange(packet.position.y() + yo, rect.y(), rect.y() + rect.w() - 1))
+				packet.coverage &= ~getCoverageFragmentSampleBits(numSamples, xo, yo);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Rasterize, shade and write primitive
+ *
+ * Only fragments inside tileRect are written. Fragment packets are aligned
+ * identically regardless of tileRect, so rendering a primitive in tiles
+ * produces exactly the same result as rendering it with
+ * tileRect == renderTargetRect.
+ *//*--------------------------------------------------------------------*/
 void rasterizePrimitive (const RenderState&					state,
 						 const RenderTarget&				renderTarget,
 						 const Program&						program,
 						 const pa::Triangle&				triangle,
 						 const tcu::IVec4&					renderTargetRect,
+						 const tcu::IVec4&					tileRect,
 						 RasterizationInternalBuffers&		buffers)
 {
 	const int			numSamples		= renderTarget.getNumSamples();
@@ -1108,8 +1360,13 @@ void rasterizePrimitive (const RenderState&					state,
 	TriangleRasterizer	rasterizer		(renderTargetRect, numSamples, state.rasterization);
 	float				depthOffset		= 0.0f;
 
+	const bool			isTile			= tileRect != renderTargetRect;
+
 	rasterizer.init(triangle.v0->position, triangle.v1->position, triangle.v2->position);
 
+	if (isTile)
+		rasterizer.restrictToRect(tileRect);
+
 	// Culling
 	const FaceType visibleFace = rasterizer.getVisibleFace();
 	if ((state.cullMode == CULLMODE_FRONT	&& visibleFace == FACETYPE_FRONT) ||
@@ -1159,6 +1416,9 @@ void rasterizePrimitive (const RenderState&					state,
 
 		// Handle fragment shader outputs
 
+		if (isTile)
+			maskCoverageToRect(&buffers.fragmentPackets[0], numRasterizedPackets, numSamples, tileRect);
+
 		writeFragmentPackets(state, renderTarget, program, &buffers.fragmentPackets[0], numRasterizedPackets, visibleFace, buffers.shaderOutputs, buffers.fragmentDepthBuffer, buffers.shadedFragments);
 	}
 }
@@ -1168,12 +1428,14 @@ void rasterizePrimitive (const RenderState&					state,
 						 const Program&						program,
 						 const pa::Line&					line,
 						 const tcu::IVec4&					renderTargetRect,
+						 const tcu::IVec4&					tileRect,
 						 RasterizationInternalBuffers&		buffers)
 {
 	const int					numSamples			= renderTarget.getNumSamples();
 	const float					depthClampMin		= de::min(state.viewport.zn, state.viewport.zf);
 	const float					depthClampMax		= de::max(state.viewport.zn, state.viewport.zf);
 	const bool					msaa				= numSamples > 1;
+	const bool					isTile				= tileRect != renderTargetRect;
 	FragmentShadingContext		shadingContext		(line.v0->outputs, line.v1->outputs, DE_NULL, &buffers.shaderOutputs[0], buffers.fragmentDepthBuffer, line.v1->primitiveID, (int)program.fragmentShader->getOutputs().size(), numSamples, FACETYPE_FRONT);
 	SingleSampleLineRasterizer	aliasedRasterizer	(renderTargetRect);
 	MultiSampleLineRasterizer	msaaRasterizer		(numSamples, renderTargetRect);
@@ -1201,6 +1463,15 @@ void rasterizePrimitive (const RenderState&					state,
 		if (!numRasterizedPackets)
 			break; // Rasterization finished.
 
+		// Line rasterizers cannot skip packets outside the tile
+		if (isTile)
+		{
+			numRasterizedPackets = removePacketsOutsideRect(&buffers.fragmentPackets[0], buffers.fragmentDepthBuffer, numRasterizedPackets, numSamples, tileRect);
+
+			if (!numRasterizedPackets)
+				continue;
+		}
+
 		// Shade
 
 		program.fragmentShader->shadeFragments(&buffers.fragmentPackets[0], numRasterizedPackets, shadingContext);
@@ -1212,6 +1483,9 @@ void rasterizePrimitive (const RenderState&					state,
 
 		// Handle fragment shader outputs
 
+		if (isTile)
+			maskCoverageToRect(&buffers.fragmentPackets[0], numRasterizedPackets, numSamples, tileRect);
+
 		writeFragmentPackets(state, renderTarget, program, &buffers.fragmentPackets[0], numRasterizedPackets, rr::FACETYPE_FRONT, buffers.shaderOutputs, buffers.fragmentDepthBuffer, buffers.shadedFragments);
 	}
 }
@@ -1221,11 +1495,13 @@ void rasterizePrimitive (const RenderState&					state,
 						 const Program&						program,
 						 const pa::Point&					point,
 						 const tcu::IVec4&					renderTargetRect,
+						 const tcu::IVec4&					tileRect,
 						 RasterizationInternalBuffers&		buffers)
 {
 	const int			numSamples		= renderTarget.getNumSamples();
 	const float			depthClampMin	= de::min(state.viewport.zn, state.viewport.zf);
 	const float			depthClampMax	= de::max(state.viewport.zn, state.viewport.zf);
+	const bool			isTile			= tileRect != renderTargetRect;
 	TriangleRasterizer	rasterizer1		(renderTargetRect, numSamples, state.rasterization);
 	TriangleRasterizer	rasterizer2		(renderTargetRect, numSamples, state.rasterization);
 
@@ -1239,6 +1515,12 @@ void rasterizePrimitive (const RenderState&					state,
 	rasterizer1.init(w0, w1, w2);
 	rasterizer2.init(w0, w2, w3);
 
+	if (isTile)
+	{
+		rasterizer1.restrictToRect(tileRect);
+		rasterizer2.restrictToRect(tileRect);
+	}
+
 	// Shading context
 	FragmentShadingContext shadingContext(point.v0->outputs, DE_NULL, DE_NULL, &buffers.shaderOutputs[0], buffers.fragmentDepthBuffer, point.v0->primitiveID, (int)program.fragmentShader->getOutputs().size(), numSamples, FACETYPE_FRONT);
 
@@ -1277,56 +1559,230 @@ void rasterizePrimitive (const RenderState&					state,
 
 		// Handle fragment shader outputs
 
+		if (isTile)
+			maskCoverageToRect(&buffers.fragmentPackets[0], numRasterizedPackets, numSamples, tileRect);
+
 		writeFragmentPackets(state, renderTarget, program, &buffers.fragmentPackets[0], numRasterizedPackets, rr::FACETYPE_FRONT, buffers.shaderOutputs, buffers.fragmentDepthBuffer, buffers.shadedFragments);
 	}
 }
 
+void initRasterizationBuffers (RasterizationInternalBuffers& buffers, const RenderTarget& renderTarget, const Program& program)
+{
+	const int	numSamples			= renderTarget.getNumSamples();
+	const int	numFragmentOutputs	= (int)program.fragmentShader->getOutputs().size();
+
+	buffers.fragmentPackets.resize(MAX_FRAGMENT_PACKETS);
+	buffers.shaderOutputs.resize(MAX_FRAGMENT_PACKETS*4*numFragmentOutputs);
+	buffers.shadedFragments.resize(MAX_FRAGMENT_PACKETS*4);
+
+	// calculate depth only if we have a depth buffer
+	if (!isEmpty(renderTarget.getDepthBuffer()))
+	{
+		buffers.depthValues.resize(MAX_FRAGMENT_PACKETS*4*numSamples);
+		buffers.fragmentDepthBuffer = &buffers.depthValues[0];
+	}
+	else
+		buffers.fragmentDepthBuffer = DE_NULL;
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Get conservative window-space bounds of a primitive
+ *
+ * Returns (xMin, yMin, xMax, yMax). Bounds include a margin large enough to
+ * cover all fragments the rasterizers may generate for the primitive.
+ *//*--------------------------------------------------------------------*/
+tcu::Vec4 getPrimitiveBounds (const RenderState& state, const pa::Triangle& triangle)
+{
+	DE_UNREF(state);
+
+	const tcu::Vec4&	p0		= triangle.v0->position;
+	const tcu::Vec4&	p1		= triangle.v1->position;
+	const tcu::Vec4&	p2		= triangle.v2->position;
+	const float			margin	= 1.0f;
+
+	return tcu::Vec4(de::min(de::min(p0.x(), p1.x()), p2.x()) - margin,
+					 de::min(de::min(p0.y(), p1.y()), p2.y()) - margin,
+					 de::max(de::max(p0.x(), p1.x()), p2.x()) + margin,
+					 de::max(de::max(p0.y(), p1.y()), p2.y()) + margin);
+}
+
+tcu::Vec4 getPrimitiveBounds (const RenderState& state, const pa::Line& line)
+{
+	const tcu::Vec4&	p0		= line.v0->position;
+	const tcu::Vec4&	p1		= line.v1->position;
+	const float			margin	= deFloatCeil(state.line.lineWidth) + 2.0f;	// wide lines and perturbed endpoints
+
+	return tcu::Vec4(de::min(p0.x(), p1.x()) - margin,
+					 de::min(p0.y(), p1.y()) - margin,
+					 de::max(p0.x(), p1.x()) + margin,
+					 de::max(p0.y(), p1.y()) + margin);
+}
+
+tcu::Vec4 getPrimitiveBounds (const RenderState& state, const pa::Point& point)
+{
+	DE_UNREF(state);
+
+	const tcu::Vec4&	p		= point.v0->position;
+	const float			margin	= point.v0->pointSize / 2.0f + 1.0f;
+
+	return tcu::Vec4(p.x() - margin, p.y() - margin, p.x() + margin, p.y() + margin);
+}
+
+int getTileNdx (float coord, int rectStart, int numTiles)
+{
+	const float tileNdx = deFloatFloor((coord - (float)rectStart) / (float)TILE_SIZE);
+
+	if (tileNdx < 0.0f)
+		return 0;
+	else if (tileNdx >= (float)(numTiles-1))
+		return numTiles-1;
+	else
+		return (int)tileNdx;
+}
+
+template <typename ContainerType>
+class TileRasterizationJob : public RasterizationThreadPool::Job
+{
+public:
+	TileRasterizationJob (const RenderState&							state,
+						  const RenderTarget&							renderTarget,
+						  const Program&								program,
+						  const ContainerType&							list,
+						  const tcu::IVec4&								renderTargetRect,
+						  const std::vector<tcu::IVec4>&				tileRects,
+						  const std::vector<std::vector<size_t> >&		tilePrimitives,
+						  std::vector<RasterizationInternalBuffers>&	threadBuffers)
+		: m_state				(state)
+		, m_renderTarget		(renderTarget)
+		, m_program				(program)
+		, m_list				(list)
+		, m_renderTargetRect	(renderTargetRect)
+		, m_tileRects			(tileRects)
+		, m_tilePrimitives		(tilePrimitives)
+		, m_threadBuffers		(threadBuffers)
+	{
+	}
+
+	void execute (int tileNdx, int threadNdx)
+	{
+		const std::vector<size_t>& primitives = m_tilePrimitives[tileNdx];
+
+		// Primitives are processed in submission order within each tile
+		for (size_t ndx = 0; ndx < primitives.size(); ++ndx)
+			rasterizePrimitive(m_state, m_renderTarget, m_program, m_list[primitives[ndx]], m_renderTargetRect, m_tileRects[tileNdx], m_threadBuffers[threadNdx]);
+	}
+
+private:
+	const RenderState&							m_state;
+	const RenderTarget&							m_renderTarget;
+	const Program&								m_program;
+	const ContainerType&						m_list;
+	const tcu::IVec4							m_renderTargetRect;
+	const std::vector<tcu::IVec4>&				m_tileRects;
+	const std::vector<std::vector<size_t> >&	m_tilePrimitives;
+	std::vector<RasterizationInternalBuffers>&	m_threadBuffers;
+};
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Rasterize primitives in screen tiles using multiple threads
+ *
+ * Primitives are sorted into TILE_SIZE x TILE_SIZE bins. Each tile is
+ * processed by a single thread, which rasterizes, shades and writes all
+ * primitives overlapping the tile in submission order. Since each sample
+ * is written by exactly one thread in the same order as in the single-
+ * threaded path, the result is bit-identical.
+ *//*--------------------------------------------------------------------*/
+template <typename ContainerType>
+void rasterizeBinned (const RenderState&			state,
+					  const RenderTarget&			renderTarget,
+					  const Program&				program,
+					  const ContainerType&			list,
+					  const tcu::IVec4&				renderTargetRect,
+					  RasterizationThreadPool&		threadPool)
+{
+	const int								numTilesX		= deDivRoundUp32(renderTargetRect.z(), TILE_SIZE);
+	const int								numTilesY		= deDivRoundUp32(renderTargetRect.w(), TILE_SIZE);
+	std::vector<std::vector<size_t> >		binnedPrimitives(numTilesX*numTilesY);
+	std::vector<std::vector<size_t> >		tilePrimitives;
+	std::vector<tcu::IVec4>					tileRects;
+	std::vector<RasterizationInternalBuffers>	threadBuffers	(threadPool.getNumThreads());
+
+	// Bin primitives
+	for (size_t primitiveNdx = 0; primitiveNdx < list.size(); ++primitiveNdx)
+	{
+		const tcu::Vec4	bounds		= getPrimitiveBounds(state, list[primitiveNdx]);
+		const bool		validBounds	= bounds.x() <= bounds.z() && bounds.y() <= bounds.w(); // false for NaNs
+		const int		tileX0		= (validBounds) ? (getTileNdx(bounds.x(), renderTargetRect.x(), numTilesX)) : (0);
+		const int		tileY0		= (validBounds) ? (getTileNdx(bounds.y(), renderTargetRect.y(), numTilesY)) : (0);
+		const int		tileX1		= (validBounds) ? (getTileNdx(bounds.z(), renderTargetRect.x(), numTilesX)) : (numTilesX-1);
+		const int		tileY1		= (validBounds) ? (getTileNdx(bounds.w(), renderTargetRect.y(), numTilesY)) : (numTilesY-1);
+
+		for (int tileY = tileY0; tileY <= tileY1; ++tileY)
+		for (int tileX = tileX0; tileX <= tileX1; ++tileX)
+			binnedPrimitives[tileY*numTilesX + tileX].push_back(primitiveNdx);
+	}
+
+	// Collect non-empty tiles
+	for (int tileY = 0; tileY < numTilesY; ++tileY)
+	for (int tileX = 0; tileX < numTilesX; ++tileX)
+	{
+		std::vector<size_t>& primitives = binnedPrimitives[tileY*numTilesX + tileX];
+
+		if (primitives.empty())
+			continue;
+
+		const int	x0	= renderTargetRect.x() + tileX*TILE_SIZE;
+		const int	y0	= renderTargetRect.y() + tileY*TILE_SIZE;
+		const int	x1	= de::min(x0 + (int)TILE_SIZE, renderTargetRect.x() + renderTargetRect.z());
+		const int	y1	= de::min(y0 + (int)TILE_SIZE, renderTargetRect.y() + renderTargetRect.w());
+
+		tileRects.push_back(tcu::IVec4(x0, y0, x1 - x0, y1 - y0));
+		tilePrimitives.push_back(std::vector<size_t>());
+		tilePrimitives.back().swap(primitives);
+	}
+
+	for (size_t threadNdx = 0; threadNdx < threadBuffers.size(); ++threadNdx)
+		initRasterizationBuffers(threadBuffers[threadNdx], renderTarget, program);
+
+	{
+		TileRasterizationJob<ContainerType> job(state, renderTarget, program, list, renderTargetRect, tileRects, tilePrimitives, threadBuffers);
+		threadPool.run(job, (int)tileRects.size());
+	}
+}
+
 template <typename ContainerType>
 void rasterize (const RenderState&					state,
 				const RenderTarget&					renderTarget,
 				const Program&						program,
-				const ContainerType&				list)
+				const ContainerType&				list,
+				DrawContext&						drawContext)
 {
-	const int						numSamples			= renderTarget.getNumSamples();
-	const int						numFragmentOutputs	= (int)program.fragmentShader->getOutputs().size();
-	const size_t					maxFragmentPackets	= 128;
-
 	const tcu::IVec4				viewportRect		= tcu::IVec4(state.viewport.rect.left, state.viewport.rect.bottom, state.viewport.rect.width, state.viewport.rect.height);
 	const tcu::IVec4				bufferRect			= getBufferSize(renderTarget.getColorBuffer(0));
 	const tcu::IVec4				renderTargetRect	= rectIntersection(viewportRect, bufferRect);
 
-	// shared buffers for all primitives
-	std::vector<FragmentPacket>		fragmentPackets		(maxFragmentPackets);
-	std::vector<GenericVec4>		shaderOutputs		(maxFragmentPackets*4*numFragmentOutputs);
-	std::vector<Fragment>			shadedFragments		(maxFragmentPackets*4);
-	std::vector<float>				depthValues			(0);
-	float*							depthBufferPointer	= DE_NULL;
-
-	RasterizationInternalBuffers	buffers;
-
-	// calculate depth only if we have a depth buffer
-	if (!isEmpty(renderTarget.getDepthBuffer()))
+	if (drawContext.threadPool && renderTargetRect.z() > 0 && renderTargetRect.w() > 0)
 	{
-		depthValues.resize(maxFragmentPackets*4*numSamples);
-		depthBufferPointer = &depthValues[0];
+		rasterizeBinned(state, renderTarget, program, list, renderTargetRect, *drawContext.threadPool);
 	}
+	else
+	{
+		// shared buffers for all primitives
+		RasterizationInternalBuffers	buffers;
 
-	// set buffers
-	buffers.fragmentPackets.swap(fragmentPackets);
-	buffers.shaderOutputs.swap(shaderOutputs);
-	buffers.shadedFragments.swap(shadedFragments);
-	buffers.fragmentDepthBuffer = depthBufferPointer;
+		initRasterizationBuffers(buffers, renderTarget, program);
 
-	// rasterize
-	for (typename ContainerType::const_iterator it = list.begin(); it != list.end(); ++it)
-		rasterizePrimitive(state, renderTarget, program, *it, renderTargetRect, buffers);
+		// rasterize
+		for (typename ContainerType::const_iterator it = list.begin(); it != list.end(); ++it)
+			rasterizePrimitive(state, renderTarget, program, *it, renderTargetRect, renderTargetRect, buffers);
+	}
 }
 
 /*--------------------------------------------------------------------*//*!
  * Draws transformed triangles, lines or points to render target
  *//*--------------------------------------------------------------------*/
 template <typename ContainerType>
-void drawBasicPrimitives (const RenderState& state, const RenderTarget& renderTarget, const Program& program, ContainerType& primList, VertexPacketAllocator& vpalloc)
+void drawBasicPrimitives (const RenderState& state, const RenderTarget& renderTarget, const Program& program, ContainerType& primList, DrawContext& drawContext, VertexPacketAllocator& vpalloc)
 {
 	const bool clipZ = !state.fragOps.depthClampEnabled;
 
@@ -1343,7 +1799,7 @@ void drawBasicPrimitives (const RenderState& state, const RenderTarget& renderTa
 	transformClipCoordsToWindowCoords(state, primList);
 
 	// Rasterize and paint
-	rasterize(state, renderTarget, program, primList);
+	rasterize(state, renderTarget, program, primList, drawContext);
 }
 
 void copyVertexPacketPointers(const VertexPacket** dst, const pa::Point& in)
@@ -1383,7 +1839,7 @@ void copyVertexPacketPointers(const VertexPacket** dst, const pa::TriangleAdjace
 }
 
 template <PrimitiveType DrawPrimitiveType> // \note DrawPrimitiveType  can only be Points, line_strip, or triangle_strip
-void drawGeometryShaderOutputAsPrimitives (const RenderState& state, const RenderTarget& renderTarget, const Program& program, VertexPacket* const* vertices, size_t numVertices, VertexPacketAllocator& vpalloc)
+void drawGeometryShaderOutputAsPrimitives (const RenderState& state, const RenderTarget& renderTarget, const Program& program, VertexPacket* const* vertices, size_t numVertices, DrawContext& drawContext, VertexPacketAllocator& vpalloc)
 {
 	// Run primitive assembly for generated stream
 
@@ -1398,7 +1854,7 @@ void drawGeometryShaderOutputAsPrimitives (const RenderState& state, const Rende
 
 	// Draw assembled primitives
 
-	drawBasicPrimitives(state, renderTarget, program, inputPrimitives, vpalloc);
+	drawBasicPrimitives(state, renderTarget, program, inputPrimitives, drawContext, vpalloc);
 }
 
 template <PrimitiveType DrawPrimitiveType>
@@ -1453,9 +1909,9 @@ void drawWithGeometryShader(const RenderState& state, const RenderTarget& render
 
 			switch (program.geometryShader->getOutputType())
 			{
-				case rr::GEOMETRYSHADEROUTPUTTYPE_POINTS:			drawGeometryShaderOutputAsPrimitives<PRIMITIVETYPE_POINTS>			(state, renderTarget, program, &emitted[primitiveBegin], primitiveEnd-primitiveBegin, vpalloc); break;
-				case rr::GEOMETRYSHADEROUTPUTTYPE_LINE_STRIP:		drawGeometryShaderOutputAsPrimitives<PRIMITIVETYPE_LINE_STRIP>		(state, renderTarget, program, &emitted[primitiveBegin], primitiveEnd-primitiveBegin, vpalloc); break;
-				case rr::GEOMETRYSHADEROUTPUTTYPE_TRIANGLE_STRIP:	drawGeometryShaderOutputAsPrimitives<PRIMITIVETYPE_TRIANGLE_STRIP>	(state, renderTarget, program, &emitted[primitiveBegin], primitiveEnd-primitiveBegin, vpalloc); break;
+				case rr::GEOMETRYSHADEROUTPUTTYPE_POINTS:			drawGeometryShaderOutputAsPrimitives<PRIMITIVETYPE_POINTS>			(state, renderTarget, program, &emitted[primitiveBegin], primitiveEnd-primitiveBegin, drawContext, vpalloc); break;
+				case rr::GEOMETRYSHADEROUTPUTTYPE_LINE_STRIP:		drawGeometryShaderOutputAsPrimitives<PRIMITIVETYPE_LINE_STRIP>		(state, renderTarget, program, &emitted[primitiveBegin], primitiveEnd-primitiveBegin, drawContext, vpalloc); break;
+				case rr::GEOMETRYSHADEROUTPUTTYPE_TRIANGLE_STRIP:	drawGeometryShaderOutputAsPrimitives<PRIMITIVETYPE_TRIANGLE_STRIP>	(state, renderTarget, program, &emitted[primitiveBegin], primitiveEnd-primitiveBegin, drawContext, vpalloc); break;
 				default:
 					DE_ASSERT(DE_FALSE);
 			}
@@ -1502,7 +1958,110 @@ void drawAsPrimitives (const RenderState& state, const RenderTarget& renderTarge
 		generatePrimitiveIDs(basePrimitives, drawContext);
 
 		// Draw as a basic type
-		drawBasicPrimitives(state, renderTarget, program, basePrimitives, vpalloc);
+		drawBasicPrimitives(state, renderTarget, program, basePrimitives, drawContext, vpalloc);
+	}
+}
+
+class VertexShadingJob : public RasterizationThreadPool::Job
+{
+public:
+	VertexShadingJob (const VertexShader& shader, const VertexAttrib* inputs, VertexPacket* const* packets, int numPackets, int numPacketsPerJob)
+		: m_shader				(shader)
+		, m_inputs				(inputs)
+		, m_packets				(packets)
+		, m_numPackets			(numPackets)
+		, m_numPacketsPerJob	(numPacketsPerJob)
+	{
+	}
+
+	void execute (int jobNdx, int threadNdx)
+	{
+		const int firstPacketNdx = jobNdx*m_numPacketsPerJob;
+
+		DE_UNREF(threadNdx);
+
+		m_shader.shadeVertices(m_inputs, m_packets + firstPacketNdx, de::min(m_numPacketsPerJob, m_numPackets - firstPacketNdx));
+	}
+
+private:
+	const VertexShader&		m_shader;
+	const VertexAttrib*		m_inputs;
+	VertexPacket* const*	m_packets;
+	const int				m_numPackets;
+	const int				m_numPacketsPerJob;
+};
+
+/*--------------------------------------------------------------------*//*!
+ * Runs vertex shader for packets, distributing large batches between
+ * rasterization threads if available.
+ *//*--------------------------------------------------------------------*/
+void shadeVertices (const VertexShader& shader, const VertexAttrib* inputs, VertexPacket* const* packets, int numPackets, DrawContext& drawContext)
+{
+	enum
+	{
+		MIN_VERTICES_PER_JOB = 256
+	};
+
+	if (drawContext.threadPool && numPackets >= 2*MIN_VERTICES_PER_JOB)
+	{
+		const int			numPacketsPerJob	= de::max((int)MIN_VERTICES_PER_JOB, deDivRoundUp32(numPackets, drawContext.threadPool->getNumThreads()));
+		VertexShadingJob	job					(shader, inputs, packets, numPackets, numPacketsPerJob);
+
+		drawContext.threadPool->run(job, deDivRoundUp32(numPackets, numPacketsPerJob));
+	}
+	else
+		shader.shadeVertices(inputs, packets, numPackets);
+}
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Post-transform vertex cache
+ *
+ * Maps the vertex indices of a primitive sequence to a set of unique
+ * vertices so that each vertex is shaded only once. Primitive assembly
+ * may then share the vertex packets between primitives, just like it
+ * does for strips and fans.
+ *
+ * Cache scope is a single primitive sequence; later stages modify
+ * shared packets in place and only make them distinct within one
+ * sequence.
+ *//*--------------------------------------------------------------------*/
+class VertexCache
+{
+public:
+	//! Find unique vertices for elements [firstElementNdx, firstElementNdx+numElements)
+	void				build				(const PrimitiveList& primitives, size_t firstElementNdx, int numElements);
+
+	int					getNumVertices		(void) const				{ return (int)m_vertexIndices.size();	}
+	int					getVertexIndex		(int vertexNdx) const		{ return m_vertexIndices[vertexNdx];	}
+	int					getElementVertex	(int elementNdx) const		{ return m_elementVertices[elementNdx];	}
+
+private:
+	typedef std::pair<int, int> IndexElementPair;
+
+	std::vector<IndexElementPair>	m_sortedElements;
+	std::vector<int>				m_elementVertices;	//!< Unique vertex for each element
+	std::vector<int>				m_vertexIndices;	//!< Vertex index for each unique vertex
+};
+
+void VertexCache::build (const PrimitiveList& primitives, size_t firstElementNdx, int numElements)
+{
+	m_sortedElements.resize(numElements);
+	m_elementVertices.resize(numElements);
+	m_vertexIndices.clear();
+
+	for (int elementNdx = 0; elementNdx < numElements; ++elementNdx)
+		m_sortedElements[elementNdx] = IndexElementPair((int)primitives.getIndex(firstElementNdx + (size_t)elementNdx), elementNdx);
+
+	std::sort(m_sortedElements.begin(), m_sortedElements.end());
+
+	for (int sortedNdx = 0; sortedNdx < numElements; ++sortedNdx)
+	{
+		const int vertexIndex = m_sortedElements[sortedNdx].first;
+
+		if (m_vertexIndices.empty() || m_vertexIndices.back() != vertexIndex)
+			m_vertexIndices.push_back(vertexIndex);
+
+		m_elementVertices[m_sortedElements[sortedNdx].second] = (int)m_vertexIndices.size() - 1;
 	}
 }
 
@@ -1731,14 +2290,34 @@ bool PrimitiveList::isRestartIndex (size_t elementNdx, deUint32 restartIndex) co
 		return elementNdx == (size_t)restartIndex;
 }
 
+int Renderer::s_defaultNumThreads = 1;
+
 Renderer::Renderer (void)
+	: m_numThreads(s_defaultNumThreads)
+{
+}
+
+Renderer::Renderer (int numThreads)
+	: m_numThreads(numThreads)
 {
+	DE_ASSERT(numThreads >= 1);
 }
 
 Renderer::~Renderer (void)
 {
 }
 
+void Renderer::setDefaultNumThreads (int numThreads)
+{
+	DE_ASSERT(numThreads >= 1);
+	s_defaultNumThreads = numThreads;
+}
+
+int Renderer::getDefaultNumThreads (void)
+{
+	return s_defaultNumThreads;
+}
+
 void Renderer::draw (const DrawCommand& command) const
 {
 	drawInstanced(command, 1);
@@ -1764,11 +2343,18 @@ void Renderer::drawInstanced (const DrawCommand& command, int numInstances) cons
 
 	// Prepare transformation
 
-	const size_t				numVaryings = command.program.vertexShader->getOutputs().size();
-	VertexPacketAllocator		vpalloc(numVaryings);
-	std::vector<VertexPacket*>	vertexPackets = vpalloc.allocArray(command.primitives.getNumElements());
+	const size_t				numVaryings			= command.program.vertexShader->getOutputs().size();
+	const bool					useVertexCache		= command.primitives.isIndexed();
+	VertexPacketAllocator		vpalloc				(numVaryings);
+	std::vector<VertexPacket*>	vertexPackets		= vpalloc.allocArray(command.primitives.getNumElements());
+	std::vector<VertexPacket*>	primitiveVertices	(useVertexCache ? command.primitives.getNumElements() : 0);
+	VertexCache					vertexCache;
 	DrawContext					drawContext;
 
+	// Threads are shared by all draw calls
+	if (m_numThreads > 1)
+		drawContext.threadPool = &getSharedThreadPool(m_numThreads);
+
 	for (int instanceID = 0; instanceID < numInstances; ++instanceID)
 	{
 		// Each instance has its own primitives
@@ -1776,50 +2362,76 @@ void Renderer::drawInstanced (const DrawCommand& command, int numInstances) cons
 
 		for (size_t elementNdx = 0; elementNdx < command.primitives.getNumElements(); ++elementNdx)
 		{
-			int numVertexPackets = 0;
+			const size_t	firstElementNdx		= elementNdx;
+			int				numElements			= 0;
+			int				numVertexPackets	= 0;
 
 			// collect primitive vertices until restart
 
 			while (elementNdx < command.primitives.getNumElements() &&
 					!(command.state.restart.enabled && command.primitives.isRestartIndex(elementNdx, command.state.restart.restartIndex)))
 			{
-				// input
-				vertexPackets[numVertexPackets]->instanceNdx	= instanceID;
-				vertexPackets[numVertexPackets]->vertexNdx		= (int)command.primitives.getIndex(elementNdx);
-
-				// output
-				vertexPackets[numVertexPackets]->pointSize		= command.state.point.pointSize;	// default value from the current state
-				vertexPackets[numVertexPackets]->position		= tcu::Vec4(0, 0, 0, 0);			// no undefined values
-
-				++numVertexPackets;
+				++numElements;
 				++elementNdx;
 			}
 
 			// Duplicated restart shade
-			if (numVertexPackets == 0)
+			if (numElements == 0)
 				continue;
 
-			// \todo Vertex cache?
+			// Find unique vertices of indexed draws
+
+			if (useVertexCache)
+			{
+				vertexCache.build(command.primitives, firstElementNdx, numElements);
+				numVertexPackets = vertexCache.getNumVertices();
+
+				m_vertexCacheStats.numIndices			+= (deUint64)numElements;
+				m_vertexCacheStats.numShadedVertices	+= (deUint64)numVertexPackets;
+			}
+			else
+				numVertexPackets = numElements;
+
+			for (int packetNdx = 0; packetNdx < numVertexPackets; ++packetNdx)
+			{
+				// input
+				vertexPackets[packetNdx]->instanceNdx	= instanceID;
+				vertexPackets[packetNdx]->vertexNdx		= useVertexCache ? vertexCache.getVertexIndex(packetNdx) : (int)command.primitives.getIndex(firstElementNdx + (size_t)packetNdx);
+
+				// output
+				vertexPackets[packetNdx]->pointSize		= command.state.point.pointSize;	// default value from the current state
+				vertexPackets[packetNdx]->position		= tcu::Vec4(0, 0, 0, 0);			// no undefined values
+			}
 
 			// Transform vertices
 
-			command.program.vertexShader->shadeVertices(command.vertexAttribs, &vertexPackets[0], numVertexPackets);
+			shadeVertices(*command.program.vertexShader, command.vertexAttribs, &vertexPackets[0], numVertexPackets, drawContext);
+
+			// Map elements to shared vertices
+
+			if (useVertexCache)
+			{
+				for (int vertexElementNdx = 0; vertexElementNdx < numElements; ++vertexElementNdx)
+					primitiveVertices[vertexElementNdx] = vertexPackets[vertexCache.getElementVertex(vertexElementNdx)];
+			}
+
+			VertexPacket* const* const vertices = useVertexCache ? &primitiveVertices[0] : &vertexPackets[0];
 
 			// Draw primitives
 
 			switch (command.primitives.getPrimitiveType())
 			{
-				case PRIMITIVETYPE_TRIANGLES:				{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLES>					(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_TRIANGLE_STRIP:			{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLE_STRIP>			(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_TRIANGLE_FAN:			{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLE_FAN>				(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_LINES:					{ drawAsPrimitives<PRIMITIVETYPE_LINES>						(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_LINE_STRIP:				{ drawAsPrimitives<PRIMITIVETYPE_LINE_STRIP>				(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_LINE_LOOP:				{ drawAsPrimitives<PRIMITIVETYPE_LINE_LOOP>					(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_POINTS:					{ drawAsPrimitives<PRIMITIVETYPE_POINTS>					(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_LINES_ADJACENCY:			{ drawAsPrimitives<PRIMITIVETYPE_LINES_ADJACENCY>			(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_LINE_STRIP_ADJACENCY:	{ drawAsPrimitives<PRIMITIVETYPE_LINE_STRIP_ADJACENCY>		(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_TRIANGLES_ADJACENCY:		{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLES_ADJACENCY>		(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
-				case PRIMITIVETYPE_TRIANGLE_STRIP_ADJACENCY:{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLE_STRIP_ADJACENCY>	(command.state, command.renderTarget, command.program, &vertexPackets[0], numVertexPackets, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_TRIANGLES:				{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLES>					(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_TRIANGLE_STRIP:			{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLE_STRIP>			(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_TRIANGLE_FAN:			{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLE_FAN>				(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_LINES:					{ drawAsPrimitives<PRIMITIVETYPE_LINES>						(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_LINE_STRIP:				{ drawAsPrimitives<PRIMITIVETYPE_LINE_STRIP>				(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_LINE_LOOP:				{ drawAsPrimitives<PRIMITIVETYPE_LINE_LOOP>					(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_POINTS:					{ drawAsPrimitives<PRIMITIVETYPE_POINTS>					(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_LINES_ADJACENCY:			{ drawAsPrimitives<PRIMITIVETYPE_LINES_ADJACENCY>			(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_LINE_STRIP_ADJACENCY:	{ drawAsPrimitives<PRIMITIVETYPE_LINE_STRIP_ADJACENCY>		(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_TRIANGLES_ADJACENCY:		{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLES_ADJACENCY>		(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
+				case PRIMITIVETYPE_TRIANGLE_STRIP_ADJACENCY:{ drawAsPrimitives<PRIMITIVETYPE_TRIANGLE_STRIP_ADJACENCY>	(command.state, command.renderTarget, command.program, vertices, numElements, drawContext, vpalloc);	break; }
 				default:
 					DE_ASSERT(DE_FALSE);
 			}
@@ -97,6 +97,7 @@ public:
 	inline size_t			getNumElements		(void) const	{ return m_numElements;		}
 	inline PrimitiveType	getPrimitiveType	(void) const	{ return m_primitiveType;	}
 	inline IndexType		getIndexType		(void) const	{ return m_indexType;		}
+	inline bool				isIndexed			(void) const	{ return m_indices != DE_NULL;	}
 
 private:
 	const PrimitiveType		m_primitiveType;
@@ -129,14 +130,68 @@ public:
 	const PrimitiveList&		primitives;
 } DE_WARN_UNUSED_TYPE;
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Post-transform vertex cache statistics
+ *
+ * Indexed draws shade each distinct vertex index of a primitive sequence
+ * (vertices between primitive restarts) only once. Statistics accumulate
+ * over all indexed draws made with a Renderer.
+ *//*--------------------------------------------------------------------*/
+struct VertexCacheStats
+{
+	deUint64	numIndices;			//!< Number of vertices referenced by indexed draws
+	deUint64	numShadedVertices;	//!< Number of vertices actually shaded for indexed draws
+
+	VertexCacheStats (void)
+		: numIndices		(0)
+		, numShadedVertices	(0)
+	{
+	}
+
+	deUint64	getNumHits	(void) const { return numIndices - numShadedVertices;											}
+	float		getHitRate	(void) const { return (numIndices > 0) ? ((float)getNumHits() / (float)numIndices) : (0.0f);	}
+} DE_WARN_UNUSED_TYPE;
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Reference renderer
+ *
+ * If numThreads is larger than 1, primitives are binned into screen tiles
+ * and tiles are rasterized, shaded and written in parallel. Results are
+ * identical to single-threaded rendering, but shaders must then be safe to
+ * execute concurrently from multiple threads. Worker threads are started
+ * on the first such draw and shared by all renderers with the same thread
+ * count, so concurrent draws wait for each other while rasterizing.
+ *
+ * Renderer(void) uses the process-wide default thread count, which is 1
+ * unless changed with setDefaultNumThreads().
+ *
+ * Vertex cache statistics are updated by draw calls and are not
+ * synchronized; a Renderer shouldn't be used for concurrent draws if
+ * the statistics are needed.
+ *//*--------------------------------------------------------------------*/
 class Renderer
 {
 public:
-					Renderer		(void);
-					~Renderer		(void);
+							Renderer				(void);
+	explicit				Renderer				(int numThreads);
+							~Renderer				(void);
+
+	void					draw					(const DrawCommand& command) const;
+	void					drawInstanced			(const DrawCommand& command, int numInstances) const;
+
+	int						getNumThreads			(void) const { return m_numThreads;						}
+
+	const VertexCacheStats&	getVertexCacheStats		(void) const { return m_vertexCacheStats;				}
+	void					resetVertexCacheStats	(void)		 { m_vertexCacheStats = VertexCacheStats();	}
+
+	static void				setDefaultNumThreads	(int numThreads);
+	static int				getDefaultNumThreads	(void);
+
+private:
+	int						m_numThreads;
+	mutable VertexCacheStats	m_vertexCacheStats;
 
-	void			draw			(const DrawCommand& command) const;
-	void			drawInstanced	(const DrawCommand& command, int numInstances) const;
+	static int				s_defaultNumThreads;
 } DE_WARN_UNUSED_TYPE;
 
 } // rr
@@ -22,9 +22,53 @@
  *//*--------------------------------------------------------------------*/
 
 #include "rrShadingContext.hpp"
+#include "rrSimd.hpp"
 
 namespace rr
 {
+namespace
+{
+
+using namespace simd;
+
+// One lane holds a single component of all fragments in a packet.
+
+template <int NumVertices>
+void interpolatePackets (float* dst, int dstStride, int numComponents, const FragmentPacket* packets, int numPackets, const tcu::Vec4* values)
+{
+	DE_STATIC_ASSERT(NUM_FRAGMENTS_PER_PACKET == 4);
+
+	// \note Operation order must match readVarying() to get identical results.
+	for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+	{
+		const FragmentPacket&	packet		= packets[packetNdx];
+		float* const			packetDst	= dst + packetNdx*NUM_FRAGMENTS_PER_PACKET;
+		Lane					barycentric[NumVertices];
+
+		if (NumVertices > 1)
+		{
+			for (int vtxNdx = 0; vtxNdx < NumVertices; vtxNdx++)
+				barycentric[vtxNdx] = loadLane(packet.barycentric[vtxNdx].getPtr());
+		}
+
+		for (int compNdx = 0; compNdx < numComponents; compNdx++)
+		{
+			Lane result = splatLane(values[0][compNdx]);
+
+			if (NumVertices > 1)
+			{
+				result = mulLane(barycentric[0], result);
+
+				for (int vtxNdx = 1; vtxNdx < NumVertices; vtxNdx++)
+					result = addLane(result, mulLane(barycentric[vtxNdx], splatLane(values[vtxNdx][compNdx])));
+			}
+
+			storeLane(packetDst + compNdx*dstStride, result);
+		}
+	}
+}
+
+} // anonymous
 
 FragmentShadingContext::FragmentShadingContext (const GenericVec4* varying0, const GenericVec4* varying1, const GenericVec4* varying2, GenericVec4* outputArray_, float* fragmentDepths_, int primitiveID_, int numFragmentOutputs_, int numSamples_, FaceType visibleFace_)
 	: outputArray			(outputArray_)
@@ -39,4 +83,24 @@ FragmentShadingContext::FragmentShadingContext (const GenericVec4* varying0, con
 	varyings[2] = varying2;
 }
 
+void readVaryingPackets (float* dst, int dstStride, int numComponents, const FragmentPacket* packets, int numPackets, const FragmentShadingContext& context, int varyingLoc)
+{
+	DE_ASSERT(de::inRange(numComponents, 1, 4));
+	DE_ASSERT(dstStride >= numPackets*NUM_FRAGMENTS_PER_PACKET || numComponents == 1);
+
+	const tcu::Vec4 values[3] =
+	{
+		context.varyings[0][varyingLoc].get<float>(),
+		(context.varyings[1]) ? (context.varyings[1][varyingLoc].get<float>()) : (tcu::Vec4()),
+		(context.varyings[2]) ? (context.varyings[2][varyingLoc].get<float>()) : (tcu::Vec4()),
+	};
+
+	if (context.varyings[1] == DE_NULL)
+		interpolatePackets<1>(dst, dstStride, numComponents, packets, numPackets, values);
+	else if (context.varyings[2] == DE_NULL)
+		interpolatePackets<2>(dst, dstStride, numComponents, packets, numPackets, values);
+	else
+		interpolatePackets<3>(dst, dstStride, numComponents, packets, numPackets, values);
+}
+
 } // rr
@@ -94,6 +94,22 @@ tcu::Vector<T, 4> readVarying (const FragmentPacket& packet, const FragmentShadi
 										return readTriangleVarying<T>	(packet, context, varyingLoc, fragNdx);
 }
 
+// Read varyings for a range of packets
+
+/*--------------------------------------------------------------------*//*!
+ * \brief Interpolate a float varying for a range of fragment packets
+ *
+ * Interpolated values are written in structure-of-arrays form so that
+ * each component of a packet occupies one 4-wide SIMD lane:
+ *
+ *  dst[compNdx*dstStride + packetNdx*NUM_FRAGMENTS_PER_PACKET + fragNdx]
+ *
+ * Only the first numComponents components are written. dstStride must be
+ * at least numPackets*NUM_FRAGMENTS_PER_PACKET. The result is equal to
+ * calling readVarying<float>() for each fragment separately.
+ *//*--------------------------------------------------------------------*/
+void readVaryingPackets (float* dst, int dstStride, int numComponents, const FragmentPacket* packets, int numPackets, const FragmentShadingContext& context, int varyingLoc);
+
 // Derivative
 
 template <typename T, int Size>
@@ -0,0 +1,113 @@
+#ifndef _RRSIMD_HPP
+#define _RRSIMD_HPP
+/*-------------------------------------------------------------------------
+ * drawElements Quality Program Reference Renderer
+ * -----------------------------------------------
+ *
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *//*!
+ * \file
+ * \brief 4-wide float SIMD helpers.
+ *
+ * Internal to the reference renderer. Every operation rounds exactly like
+ * the corresponding scalar float operation, and min(), max() and clamp()
+ * select like de::min(), de::max() and de::clamp(), also for NaNs and
+ * signed zeros. Results are bit-exact with scalar code as long as the
+ * compiler doesn't contract the scalar code into fused multiply-adds.
+ *//*--------------------------------------------------------------------*/
+
+#include "rrDefs.hpp"
+#include "tcuVectorUtil.hpp"
+
+#if (DE_CPU == DE_CPU_X86_64)
+#	include <emmintrin.h>
+#	define RR_SIMD_USE_SSE
+#elif (DE_CPU == DE_CPU_ARM_64)
+#	include <arm_neon.h>
+#	define RR_SIMD_USE_NEON
+#endif
+
+namespace rr
+{
+namespace simd
+{
+
+#if defined(RR_SIMD_USE_SSE)
+
+typedef __m128 Lane;
+
+inline Lane		loadLane		(const float* src)								{ return _mm_loadu_ps(src);											}
+inline void		storeLane		(float* dst, const Lane& v)						{ _mm_storeu_ps(dst, v);											}
+inline Lane		splatLane		(float v)										{ return _mm_set1_ps(v);											}
+inline Lane		splatLaneW		(const Lane& v)									{ return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));				}
+inline Lane		addLane			(const Lane& a, const Lane& b)					{ return _mm_add_ps(a, b);											}
+inline Lane		subLane			(const Lane& a, const Lane& b)					{ return _mm_sub_ps(a, b);											}
+inline Lane		mulLane			(const Lane& a, const Lane& b)					{ return _mm_mul_ps(a, b);											}
+
+//! (mask ? a : b) for each component
+inline Lane		selectLane		(const Lane& mask, const Lane& a, const Lane& b)	{ return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));	}
+
+inline Lane		minLane			(const Lane& a, const Lane& b)					{ return selectLane(_mm_cmple_ps(a, b), a, b);						}
+inline Lane		maxLane			(const Lane& a, const Lane& b)					{ return selectLane(_mm_cmpge_ps(a, b), a, b);						}
+inline Lane		clampLane		(const Lane& x, const Lane& lo, const Lane& hi)	{ return selectLane(_mm_cmplt_ps(x, lo), lo, selectLane(_mm_cmpgt_ps(x, hi), hi, x));	}
+
+//! xyz from rgb, w from a
+inline Lane		mergeAlphaLane	(const Lane& rgb, const Lane& a)				{ return selectLane(_mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0)), a, rgb);	}
+
+#elif defined(RR_SIMD_USE_NEON)
+
+typedef float32x4_t Lane;
+
+inline Lane		loadLane		(const float* src)								{ return vld1q_f32(src);											}
+inline void		storeLane		(float* dst, const Lane& v)						{ vst1q_f32(dst, v);												}
+inline Lane		splatLane		(float v)										{ return vdupq_n_f32(v);											}
+inline Lane		splatLaneW		(const Lane& v)									{ return vdupq_laneq_f32(v, 3);										}
+inline Lane		addLane			(const Lane& a, const Lane& b)					{ return vaddq_f32(a, b);											}
+inline Lane		subLane			(const Lane& a, const Lane& b)					{ return vsubq_f32(a, b);											}
+inline Lane		mulLane			(const Lane& a, const Lane& b)					{ return vmulq_f32(a, b);											}
+
+inline Lane		minLane			(const Lane& a, const Lane& b)					{ return vbslq_f32(vcleq_f32(a, b), a, b);							}
+inline Lane		maxLane			(const Lane& a, const Lane& b)					{ return vbslq_f32(vcgeq_f32(a, b), a, b);							}
+inline Lane		clampLane		(const Lane& x, const Lane& lo, const Lane& hi)	{ return vbslq_f32(vcltq_f32(x, lo), lo, vbslq_f32(vcgtq_f32(x, hi), hi, x));	}
+
+//! xyz from rgb, w from a
+inline Lane		mergeAlphaLane	(const Lane& rgb, const Lane& a)				{ return vsetq_lane_f32(vgetq_lane_f32(a, 3), rgb, 3);				}
+
+#else
+
+typedef tcu::Vec4 Lane;
+
+inline Lane		loadLane		(const float* src)								{ return Lane(src[0], src[1], src[2], src[3]);						}
+inline void		storeLane		(float* dst, const Lane& v)						{ for (int i = 0; i < 4; i++) dst[i] = v[i];						}
+inline Lane		splatLane		(float v)										{ return Lane(v);													}
+inline Lane		splatLaneW		(const Lane& v)									{ return Lane(v.w());												}
+inline Lane		addLane			(const Lane& a, const Lane& b)					{ return a + b;														}
+inline Lane		subLane			(const Lane& a, const Lane& b)					{ return a - b;														}
+inline Lane		mulLane			(const Lane& a, const Lane& b)					{ return a * b;														}
+
+inline Lane		minLane			(const Lane& a, const Lane& b)					{ return tcu::min(a, b);											}
+inline Lane		maxLane			(const Lane& a, const Lane& b)					{ return tcu::max(a, b);											}
+inline Lane		clampLane		(const Lane& x, const Lane& lo, const Lane& hi)	{ return tcu::clamp(x, lo, hi);										}
+
+//! xyz from rgb, w from a
+inline Lane		mergeAlphaLane	(const Lane& rgb, const Lane& a)				{ return Lane(rgb.x(), rgb.y(), rgb.z(), a.w());					}
+
+#endif
+
+} // simd
+} // rr
+
+#endif // _RRSIMD_HPP
@@ -28,6 +28,8 @@
 #include "gluStateReset.hpp"
 #include "gluRenderContext.hpp"
 #include "tcuTestLog.hpp"
+#include "tcuCommandLine.hpp"
+#include "rrRenderer.hpp"
 
 namespace deqp
 {
@@ -114,6 +116,9 @@ void TestPackage::init (void)
 {
 	try
 	{
+		// Reference renderer is used through sglr by most rendering cases
+		rr::Renderer::setDefaultNumThreads(de::max(1, m_testCtx.getCommandLine().getRefRendererThreadCount()));
+
 		// Create context
 		m_context = new Context(m_testCtx);
 
@@ -25,6 +25,7 @@
 #include "glsBuiltinPrecisionTests.hpp"
 
 #include "deMath.h"
+#include "deInt32.h"
 #include "deMemory.h"
 #include "deDefs.hpp"
 #include "deRandom.hpp"
@@ -42,6 +43,7 @@
 #include "tcuVector.hpp"
 #include "tcuMatrix.hpp"
 #include "tcuResultCollector.hpp"
+#include "tcuParallelFor.hpp"
 
 #include "gluContextInfo.hpp"
 #include "gluVarType.hpp"
@@ -67,9 +69,9 @@ enum
 {
 	// Computing reference intervals can take a non-trivial amount of time, especially on
 	// platforms where toggling floating-point rounding mode is slow (emulated arm on x86).
-	// As a workaround watchdog is kept happy by touching it periodically during reference
-	// interval computation.
-	TOUCH_WATCHDOG_VALUE_FREQUENCY	= 4096
+	// Values are processed in chunks on all cores and, as a workaround, the watchdog is
+	// kept happy by touching it after each chunk processed on the test thread.
+	REFERENCE_CHECK_CHUNK_SIZE	= 256
 };
 
 namespace deqp
@@ -576,11 +578,43 @@ template <typename T>
 VariableP<T>	variable			(const string& name);
 StatementP		compoundStatement	(const vector<StatementP>& statements);
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Storage layout of the variables of one scope.
+ *
+ * Each declared variable is given a fixed byte offset into the storage of
+ * an Environment. Layouts are built once before evaluation: by the test
+ * case for the top-level variables and by each DerivedFunc for its
+ * parameters and temporaries when its body is first expanded. Evaluation
+ * then only needs an indexed load per variable access.
+ *
+ *//*--------------------------------------------------------------------*/
+class FrameLayout
+{
+public:
+						FrameLayout	(void) : m_size(0) {}
+
+	template<typename T>
+	void				declare		(const Variable<T>& variable)
+	{
+		variable.setOffset(m_size);
+		m_size += deAlignSize(sizeof(typename Traits<T>::IVal), sizeof(deUint64));
+	}
+
+	size_t				getSize		(void) const { return m_size; }
+
+private:
+	size_t				m_size;
+};
+
 /*--------------------------------------------------------------------*//*!
  * \brief A variable environment.
  *
- * An Environment object maintains the mapping between variables of the
- * abstract syntax tree and their values.
+ * An Environment object holds the values of the variables of one scope in a
+ * flat buffer laid out by a FrameLayout. Function calls made while
+ * evaluating in this scope get their frame from getCallee(), which is kept
+ * around and reused so that repeated evaluation does not allocate.
+ *
+ * An Environment must only be used from one thread at a time.
  *
  * \todo [2014-03-28 lauri] At least run-time type safety.
  *
@@ -588,26 +622,50 @@ StatementP		compoundStatement	(const vector<StatementP>& statements);
 class Environment
 {
 public:
+	explicit					Environment	(const FrameLayout& layout = FrameLayout())
+									: m_storage	(layout.getSize() / sizeof(deUint64))
+									, m_callee	(DE_NULL) {}
+								~Environment	(void) { delete m_callee; }
+
 	template<typename T>
-	void						bind	(const Variable<T>&					variable,
-										 const typename Traits<T>::IVal&	value)
+	void						bind		(const Variable<T>&					variable,
+											 const typename Traits<T>::IVal&	value)
 	{
-		deUint8* const data = new deUint8[sizeof(value)];
-
-		deMemcpy(data, &value, sizeof(value));
-		de::insert(m_map, variable.getName(), SharedPtr<deUint8>(data, de::ArrayDeleter<deUint8>()));
+		deMemcpy(getData(variable), &value, sizeof(value));
 	}
 
 	template<typename T>
-	typename Traits<T>::IVal&	lookup	(const Variable<T>& variable) const
+	typename Traits<T>::IVal&	lookup		(const Variable<T>& variable)
+	{
+		return *reinterpret_cast<typename Traits<T>::IVal*>(getData(variable));
+	}
+
+	//! Get the environment for a function body called from this scope
+	Environment&				getCallee	(const FrameLayout& layout)
 	{
-		deUint8* const data = de::lookup(m_map, variable.getName()).get();
+		if (!m_callee)
+			m_callee = new Environment(layout);
+		else if (m_callee->m_storage.size() * sizeof(deUint64) < layout.getSize())
+			m_callee->m_storage.resize(layout.getSize() / sizeof(deUint64));
 
-		return *reinterpret_cast<typename Traits<T>::IVal*>(data);
+		return *m_callee;
 	}
 
 private:
-	map<string, SharedPtr<deUint8> >	m_map;
+								Environment	(const Environment&);	// Not allowed!
+	Environment&				operator=	(const Environment&);	// Not allowed!
+
+	template<typename T>
+	deUint8*					getData		(const Variable<T>& variable)
+	{
+		const size_t offset = variable.getOffset();
+
+		DE_ASSERT(offset + sizeof(typename Traits<T>::IVal) <= m_storage.size() * sizeof(deUint64));
+		return reinterpret_cast<deUint8*>(&m_storage[0]) + offset;
+	}
+
+	vector<deUint64>			m_storage;
+	Environment*				m_callee;
 };
 
 /*--------------------------------------------------------------------*//*!
@@ -700,11 +758,14 @@ public:
 	void	print			(ostream&		os)		const	{ this->doPrint(os);			 }
 	//! Add the functions used in this statement to `dst`.
 	void	getUsedFuncs	(FuncSet& dst)			const	{ this->doGetUsedFuncs(dst);	 }
+	//! Assign storage in `layout` to the variables declared by this statement.
+	void	declareVariables	(FrameLayout& layout)	const	{ this->doDeclareVariables(layout); }
 
 protected:
 	virtual void	doPrint			(ostream& os)			const	= 0;
 	virtual void	doExecute		(EvalContext& ctx)		const	= 0;
 	virtual void	doGetUsedFuncs	(FuncSet& dst)			const	= 0;
+	virtual void	doDeclareVariables	(FrameLayout&)		const	{}
 };
 
 ostream& operator<<(ostream& os, const Statement& stmt)
@@ -767,6 +828,12 @@ protected:
 		m_value->getUsedFuncs(dst);
 	}
 
+	void			doDeclareVariables	(FrameLayout& layout)					const
+	{
+		if (m_isDeclaration)
+			layout.declare(*m_variable);
+	}
+
 	VariableP<T>	m_variable;
 	ExprP<T>		m_value;
 	bool			m_isDeclaration;
@@ -828,6 +895,12 @@ protected:
 			m_statements[ndx]->getUsedFuncs(dst);
 	}
 
+	void				doDeclareVariables	(FrameLayout& layout)					const
+	{
+		for (size_t ndx = 0; ndx < m_statements.size(); ++ndx)
+			m_statements[ndx]->declareVariables(layout);
+	}
+
 	vector<StatementP>	m_statements;
 };
 
@@ -1033,9 +1106,17 @@ class Variable : public Expr<T>
 public:
 	typedef typename Expr<T>::IVal IVal;
 
-					Variable	(const string& name) : m_name (name) {}
+					Variable	(const string& name) : m_name (name), m_offset (~(size_t)0) {}
 	string			getName		(void)							const { return m_name; }
 
+	//! Offset of the value in the Environment, assigned by FrameLayout::declare()
+	size_t			getOffset	(void)							const
+	{
+		DE_ASSERT(m_offset != ~(size_t)0);
+		return m_offset;
+	}
+	void			setOffset	(size_t offset)					const { m_offset = offset; }
+
 protected:
 	void			doPrintExpr	(ostream& os)					const { os << m_name; }
 	IVal			doEvaluate	(const EvalContext& ctx)		const
@@ -1044,7 +1125,8 @@ protected:
 	}
 
 private:
-	string	m_name;
+	string			m_name;
+	mutable size_t	m_offset;
 };
 
 template <typename T>
@@ -1499,12 +1581,13 @@ protected:
 	IRet						doApply			(const EvalContext&	ctx,
 												 const IArgs&		args) const
 	{
-		Environment	funEnv;
 		IArgs&		mutArgs		= const_cast<IArgs&>(args);
 		IRet		ret;
 
 		initialize();
 
+		Environment&	funEnv	= ctx.env.getCallee(m_frame);
+
 		funEnv.bind(*m_var0, args.a);
 		funEnv.bind(*m_var1, args.b);
 		funEnv.bind(*m_var2, args.c);
@@ -1551,6 +1634,7 @@ protected:
 	mutable VariableP<Arg3>		m_var3;
 	mutable vector<StatementP>	m_body;
 	mutable ExprP<Ret>			m_ret;
+	mutable FrameLayout			m_frame;
 
 private:
 
@@ -1562,14 +1646,27 @@ private:
 			Counter				symCounter;
 			ExpandContext		ctx			(symCounter);
 			ArgExprs			args;
+			FrameLayout			frame;
+			ExprP<Ret>			ret;
 
 			args.a	= m_var0 = variable<Arg0>(paramNames.a);
 			args.b	= m_var1 = variable<Arg1>(paramNames.b);
 			args.c	= m_var2 = variable<Arg2>(paramNames.c);
 			args.d	= m_var3 = variable<Arg3>(paramNames.d);
 
-			m_ret	= this->doExpand(ctx, args);
+			ret		= this->doExpand(ctx, args);
 			m_body	= ctx.getStatements();
+
+			frame.declare(*m_var0);
+			frame.declare(*m_var1);
+			frame.declare(*m_var2);
+			frame.declare(*m_var3);
+
+			for (size_t ndx = 0; ndx < m_body.size(); ++ndx)
+				m_body[ndx]->declareVariables(frame);
+
+			m_frame	= frame;
+			m_ret	= ret;
 		}
 	}
 };
@@ -1928,10 +2025,8 @@ public:
 		// Fast-path for common case
 		if (iargs.a.isOrdinary() && iargs.b.isOrdinary())
 		{
-			Interval ret;
-			TCU_SET_INTERVAL_BOUNDS(ret, sum,
-									sum = iargs.a.lo() + iargs.b.lo(),
-									sum = iargs.a.hi() + iargs.b.hi());
+			const Interval	ret	(tcu::addRoundDown(iargs.a.lo(), iargs.b.lo()),
+								 tcu::addRoundUp(iargs.a.hi(), iargs.b.hi()));
 			return ctx.format.convert(ctx.format.roundOut(ret, true));
 		}
 		return this->applyMonotone(ctx, iargs.a, iargs.b);
@@ -1955,7 +2050,6 @@ public:
 		// Fast-path for common case
 		if (a.isOrdinary() && b.isOrdinary())
 		{
-			Interval ret;
 			if (a.hi() < 0)
 			{
 				a = -a;
@@ -1963,16 +2057,14 @@ public:
 			}
 			if (a.lo() >= 0 && b.lo() >= 0)
 			{
-				TCU_SET_INTERVAL_BOUNDS(ret, prod,
-										prod = iargs.a.lo() * iargs.b.lo(),
-										prod = iargs.a.hi() * iargs.b.hi());
+				const Interval	ret	(tcu::mulRoundDown(iargs.a.lo(), iargs.b.lo()),
+									 tcu::mulRoundUp(iargs.a.hi(), iargs.b.hi()));
 				return ctx.format.convert(ctx.format.roundOut(ret, true));
 			}
 			if (a.lo() >= 0 && b.hi() <= 0)
 			{
-				TCU_SET_INTERVAL_BOUNDS(ret, prod,
-										prod = iargs.a.hi() * iargs.b.lo(),
-										prod = iargs.a.lo() * iargs.b.hi());
+				const Interval	ret	(tcu::mulRoundDown(iargs.a.hi(), iargs.b.lo()),
+									 tcu::mulRoundUp(iargs.a.lo(), iargs.b.hi()));
 				return ctx.format.convert(ctx.format.roundOut(ret, true));
 			}
 		}
@@ -2003,11 +2095,8 @@ public:
 		// Fast-path for common case
 		if (iargs.a.isOrdinary() && iargs.b.isOrdinary())
 		{
-			Interval ret;
-
-			TCU_SET_INTERVAL_BOUNDS(ret, diff,
-									diff = iargs.a.lo() - iargs.b.hi(),
-									diff = iargs.a.hi() - iargs.b.lo());
+			const Interval	ret	(tcu::subRoundDown(iargs.a.lo(), iargs.b.hi()),
+								 tcu::subRoundUp(iargs.a.hi(), iargs.b.lo()));
 			return ctx.format.convert(ctx.format.roundOut(ret, true));
 
 		}
@@ -4611,6 +4700,150 @@ IterateResult PrecisionCase::iterate (void)
 	return STOP;
 }
 
+/*--------------------------------------------------------------------*//*!
+ * \brief Reference evaluation and verification of a range of input values
+ *
+ * Evaluates the statement for each input tuple and compares the shader
+ * outputs to the reference intervals. Each value only writes its own result
+ * slots, so values can be processed in any order and from several threads.
+ * Used functions must have been expanded with getUsedFuncs() before the
+ * statement is executed concurrently.
+ *//*--------------------------------------------------------------------*/
+template <typename In, typename Out>
+class ReferenceCheckJob : public tcu::ParallelJob
+{
+public:
+	typedef typename In::In0				In0;
+	typedef typename In::In1				In1;
+	typedef typename In::In2				In2;
+	typedef typename In::In3				In3;
+	typedef typename Out::Out0				Out0;
+	typedef typename Out::Out1				Out1;
+	typedef typename Traits<Out0>::IVal		IVal0;
+	typedef typename Traits<Out1>::IVal		IVal1;
+
+								ReferenceCheckJob	(const FloatFormat&			format,
+													 const FloatFormat&			highpFormat,
+													 Precision					precision,
+													 tcu::TestContext&			testCtx,
+													 const Variables<In, Out>&	variables,
+													 const Statement&			stmt,
+													 const Inputs<In>&			inputs,
+													 const Outputs<Out>&		outputs,
+													 vector<qpTestResult>&		results0,
+													 vector<qpTestResult>&		results1,
+													 vector<IVal0>&				references0,
+													 vector<IVal1>&				references1)
+									: m_format		(format)
+									, m_highpFormat	(highpFormat)
+									, m_precision	(precision)
+									, m_testCtx		(testCtx)
+									, m_variables	(variables)
+									, m_stmt		(stmt)
+									, m_inputs		(inputs)
+									, m_outputs		(outputs)
+									, m_results0	(results0)
+									, m_results1	(results1)
+									, m_references0	(references0)
+									, m_references1	(references1)
+								{
+									// Variable offsets are shared by all threads and must be assigned up front.
+									m_layout.declare(*variables.in0);
+									m_layout.declare(*variables.in1);
+									m_layout.declare(*variables.in2);
+									m_layout.declare(*variables.in3);
+									m_layout.declare(*variables.out0);
+									m_layout.declare(*variables.out1);
+									stmt.declareVariables(m_layout);
+								}
+
+	void						execute				(size_t begin, size_t end, int threadNdx)
+	{
+		const FloatFormat&	fmt			= m_format;
+		const FloatFormat&	highpFmt	= m_highpFormat;
+		const int			outCount	= numOutputs<Out>();
+		Environment			env			(m_layout);		// Hoisted out of the inner loop for optimization.
+
+		if (threadNdx == 0)
+			m_testCtx.touchWatchdog();
+
+		// Initialize environment with dummy values so we don't need to bind in inner loop.
+		{
+			const typename Traits<In0>::IVal		in0;
+			const typename Traits<In1>::IVal		in1;
+			const typename Traits<In2>::IVal		in2;
+			const typename Traits<In3>::IVal		in3;
+			const IVal0								reference0;
+			const IVal1								reference1;
+
+			env.bind(*m_variables.in0, in0);
+			env.bind(*m_variables.in1, in1);
+			env.bind(*m_variables.in2, in2);
+			env.bind(*m_variables.in3, in3);
+			env.bind(*m_variables.out0, reference0);
+			env.bind(*m_variables.out1, reference1);
+		}
+
+		for (size_t valueNdx = begin; valueNdx < end; valueNdx++)
+		{
+			IVal0&	reference0	= m_references0[valueNdx];
+			IVal1&	reference1	= m_references1[valueNdx];
+
+			env.lookup(*m_variables.in0) = convert<In0>(fmt, round(fmt, m_inputs.in0[valueNdx]));
+			env.lookup(*m_variables.in1) = convert<In1>(fmt, round(fmt, m_inputs.in1[valueNdx]));
+			env.lookup(*m_variables.in2) = convert<In2>(fmt, round(fmt, m_inputs.in2[valueNdx]));
+			env.lookup(*m_variables.in3) = convert<In3>(fmt, round(fmt, m_inputs.in3[valueNdx]));
+
+			{
+				EvalContext	ctx (fmt, m_precision, env);
+				m_stmt.execute(ctx);
+			}
+
+			switch (outCount)
+			{
+				case 2:
+					reference1				= convert<Out1>(highpFmt, env.lookup(*m_variables.out1));
+					m_results1[valueNdx]	= getCheckResult(contains(reference1, m_outputs.out1[valueNdx]),
+															 containsWarning(reference1, m_outputs.out1[valueNdx]));
+				// Fallthrough
+
+				case 1:
+					reference0				= convert<Out0>(highpFmt, env.lookup(*m_variables.out0));
+					m_results0[valueNdx]	= getCheckResult(contains(reference0, m_outputs.out0[valueNdx]),
+															 containsWarning(reference0, m_outputs.out0[valueNdx]));
+				// Fallthrough
+
+				default: break;
+			}
+		}
+	}
+
+private:
+	static qpTestResult			getCheckResult		(bool inExpectedRange, bool inWarningRange)
+	{
+		if (inExpectedRange)
+			return QP_TEST_RESULT_PASS;
+		else if (inWarningRange)
+			return QP_TEST_RESULT_QUALITY_WARNING;
+		else
+			return QP_TEST_RESULT_FAIL;
+	}
+
+	const FloatFormat&			m_format;
+	const FloatFormat&			m_highpFormat;
+	const Precision				m_precision;
+	tcu::TestContext&			m_testCtx;
+	const Variables<In, Out>&	m_variables;
+	const Statement&			m_stmt;
+	const Inputs<In>&			m_inputs;
+	const Outputs<Out>&			m_outputs;
+	vector<qpTestResult>&		m_results0;
+	vector<qpTestResult>&		m_results1;
+	vector<IVal0>&				m_references0;
+	vector<IVal1>&				m_references1;
+	FrameLayout					m_layout;
+};
+
 template <typename In, typename Out>
 void PrecisionCase::testStatement (const Variables<In, Out>&	variables,
 								   const Inputs<In>&			inputs,
@@ -4618,10 +4851,6 @@ void PrecisionCase::testStatement (const Variables<In, Out>&	variables,
 {
 	using namespace ShaderExecUtil;
 
-	typedef typename	In::In0		In0;
-	typedef typename	In::In1		In1;
-	typedef typename	In::In2		In2;
-	typedef typename	In::In3		In3;
 	typedef typename	Out::Out0	Out0;
 	typedef typename	Out::Out1	Out1;
 
@@ -4634,7 +4863,6 @@ void PrecisionCase::testStatement (const Variables<In, Out>&	variables,
 	const FloatFormat	highpFmt	= m_ctx.highpFormat;
 	const int			maxMsgs		= 100;
 	int					numErrors	= 0;
-	Environment			env;		// Hoisted out of the inner loop for optimization.
 
 	switch (inCount)
 	{
@@ -4735,60 +4963,39 @@ void PrecisionCase::testStatement (const Variables<In, Out>&	variables,
 		executor->execute(int(numValues), inputArr, outputArr);
 	}
 
-	// Initialize environment with dummy values so we don't need to bind in inner loop.
+	// For each input tuple, compute output reference interval and compare
+	// shader output to the reference. Results are collected and logged
+	// afterwards in input order, so the log does not depend on the number of
+	// threads.
+	vector<qpTestResult>				results0		(numValues, QP_TEST_RESULT_PASS);
+	vector<qpTestResult>				results1		(numValues, QP_TEST_RESULT_PASS);
+	vector<typename Traits<Out0>::IVal>	references0		(numValues);
+	vector<typename Traits<Out1>::IVal>	references1		(numValues);
+
 	{
-		const typename Traits<In0>::IVal		in0;
-		const typename Traits<In1>::IVal		in1;
-		const typename Traits<In2>::IVal		in2;
-		const typename Traits<In3>::IVal		in3;
-		const typename Traits<Out0>::IVal		reference0;
-		const typename Traits<Out1>::IVal		reference1;
+		ReferenceCheckJob<In, Out>	job	(fmt, highpFmt, m_ctx.precision, m_testCtx, variables, stmt, inputs, outputs,
+										 results0, results1, references0, references1);
 
-		env.bind(*variables.in0, in0);
-		env.bind(*variables.in1, in1);
-		env.bind(*variables.in2, in2);
-		env.bind(*variables.in3, in3);
-		env.bind(*variables.out0, reference0);
-		env.bind(*variables.out1, reference1);
+		tcu::parallelFor(job, numValues, REFERENCE_CHECK_CHUNK_SIZE, tcu::getDefaultParallelForThreadCount());
 	}
 
-	// For each input tuple, compute output reference interval and compare
-	// shader output to the reference.
 	for (size_t valueNdx = 0; valueNdx < numValues; valueNdx++)
 	{
-		bool						result = true;
-		bool						inExpectedRange;
-		bool						inWarningRange;
-		const char*					failStr = "Fail";
-		typename Traits<Out0>::IVal	reference0;
-		typename Traits<Out1>::IVal	reference1;
-
-		if (valueNdx % (size_t)TOUCH_WATCHDOG_VALUE_FREQUENCY == 0)
-			m_testCtx.touchWatchdog();
-
-		env.lookup(*variables.in0) = convert<In0>(fmt, round(fmt, inputs.in0[valueNdx]));
-		env.lookup(*variables.in1) = convert<In1>(fmt, round(fmt, inputs.in1[valueNdx]));
-		env.lookup(*variables.in2) = convert<In2>(fmt, round(fmt, inputs.in2[valueNdx]));
-		env.lookup(*variables.in3) = convert<In3>(fmt, round(fmt, inputs.in3[valueNdx]));
-
-		{
-			EvalContext	ctx (fmt, m_ctx.precision, env);
-			stmt.execute(ctx);
-		}
+		bool								result		= true;
+		const char*							failStr		= "Fail";
+		const typename Traits<Out0>::IVal&	reference0	= references0[valueNdx];
+		const typename Traits<Out1>::IVal&	reference1	= references1[valueNdx];
 
 		switch (outCount)
 		{
 			case 2:
-				reference1      = convert<Out1>(highpFmt, env.lookup(*variables.out1));
-				inExpectedRange = contains(reference1, outputs.out1[valueNdx]);
-				inWarningRange  = containsWarning(reference1, outputs.out1[valueNdx]);
-				if (!inExpectedRange && inWarningRange)
+				if (results1[valueNdx] == QP_TEST_RESULT_QUALITY_WARNING)
 				{
 					m_status.addResult(QP_TEST_RESULT_QUALITY_WARNING, "Shader output 1 has low-quality shader precision");
 					failStr = "QualityWarning";
 					result = false;
 				}
-				else if (!inExpectedRange)
+				else if (results1[valueNdx] == QP_TEST_RESULT_FAIL)
 				{
 					m_status.addResult(QP_TEST_RESULT_FAIL, "Shader output 1 is outside acceptable range");
 					failStr = "Fail";
@@ -4797,21 +5004,19 @@ void PrecisionCase::testStatement (const Variables<In, Out>&	variables,
 			// Fallthrough
 
 			case 1:
-				reference0      = convert<Out0>(highpFmt, env.lookup(*variables.out0));
-				inExpectedRange = contains(reference0, outputs.out0[valueNdx]);
-				inWarningRange  = containsWarning(reference0, outputs.out0[valueNdx]);
-				if (!inExpectedRange && inWarningRange)
+				if (results0[valueNdx] == QP_TEST_RESULT_QUALITY_WARNING)
 				{
 					m_status.addResult(QP_TEST_RESULT_QUALITY_WARNING, "Shader output 0 has low-quality shader precision");
 					failStr = "QualityWarning";
 					result = false;
 				}
-				else if (!inExpectedRange)
+				else if (results0[valueNdx] == QP_TEST_RESULT_FAIL)
 				{
 					m_status.addResult(QP_TEST_RESULT_FAIL, "Shader output 0 is outside acceptable range");
 					failStr = "Fail";
 					result = false;
 				}
+			// Fallthrough
 
 			default: break;
 		}
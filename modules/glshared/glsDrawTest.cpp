@@ -1242,14 +1242,26 @@ void DrawTestShaderProgram::shadeVertices (const rr::VertexAttrib* inputs, rr::V
 
 void DrawTestShaderProgram::shadeFragments (rr::FragmentPacket* packets, const int numPackets, const rr::FragmentShadingContext& context) const
 {
-	const size_t varyingLocColor = 0;
+	const int	varyingLocColor		= 0;
+	const int	maxBatchPackets		= 16;
+	const int	batchStride			= maxBatchPackets * rr::NUM_FRAGMENTS_PER_PACKET;
+	float		colors[4 * batchStride];
 
-	for (int packetNdx = 0; packetNdx < numPackets; ++packetNdx)
+	for (int batchOffset = 0; batchOffset < numPackets; batchOffset += maxBatchPackets)
 	{
-		rr::FragmentPacket& packet = packets[packetNdx];
+		const int numBatchPackets = de::min(numPackets - batchOffset, maxBatchPackets);
+
+		rr::readVaryingPackets(colors, batchStride, 4, packets + batchOffset, numBatchPackets, context, varyingLocColor);
 
-		for (int fragNdx = 0; fragNdx < 4; ++fragNdx)
-			rr::writeFragmentOutput(context, packetNdx, fragNdx, 0, rr::readVarying<float>(packet, context, varyingLocColor, fragNdx));
+		for (int packetNdx = 0; packetNdx < numBatchPackets; ++packetNdx)
+		{
+			for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; ++fragNdx)
+			{
+				const int ndx = packetNdx * rr::NUM_FRAGMENTS_PER_PACKET + fragNdx;
+
+				rr::writeFragmentOutput(context, batchOffset + packetNdx, fragNdx, 0, tcu::Vec4(colors[0 * batchStride + ndx], colors[1 * batchStride + ndx], colors[2 * batchStride + ndx], colors[3 * batchStride + ndx]));
+			}
+		}
 	}
 }
 
@@ -266,21 +266,8 @@ void RandomShaderProgram::shadeFragments (rr::FragmentPacket* packets, const int
 
 			DE_ASSERT(varType.isFloatOrVec() && de::inRange(numComponents, 1, 4));
 
-			for (int packetNdx = 0; packetNdx < numPacketsToExecute; packetNdx++)
-			{
-				const rr::FragmentPacket&	packet		= packets[packetOffset+packetNdx];
-
-				for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; fragNdx++)
-				{
-					const tcu::Vec4		varValue	= rr::readVarying<float>(packet, context, varNdx, fragNdx);
-					const int			dstNdx		= packetNdx*rr::NUM_FRAGMENTS_PER_PACKET + fragNdx;
-
-											access.component(0).asFloat(dstNdx) = varValue[0];
-					if (numComponents >= 2)	access.component(1).asFloat(dstNdx) = varValue[1];
-					if (numComponents >= 3)	access.component(2).asFloat(dstNdx) = varValue[2];
-					if (numComponents >= 4)	access.component(3).asFloat(dstNdx) = varValue[3];
-				}
-			}
+			// Execution values are stored component-wise, EXEC_VEC_WIDTH values per component.
+			rr::readVaryingPackets(&access.component(0).asFloat(0), (int)rsg::EXEC_VEC_WIDTH, numComponents, packets + packetOffset, numPacketsToExecute, context, varNdx);
 		}
 
 		m_fragmentShader.execute(m_execCtx);
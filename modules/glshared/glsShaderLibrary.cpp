@@ -24,6 +24,8 @@
 #include "glsShaderLibrary.hpp"
 #include "glsShaderLibraryCase.hpp"
 
+#include "deSharedPtr.hpp"
+
 namespace deqp
 {
 namespace gls
@@ -73,9 +75,9 @@ ShaderLibrary::~ShaderLibrary (void)
 
 std::vector<tcu::TestNode*> ShaderLibrary::loadShaderFile (const char* fileName)
 {
-	CaseFactory	caseFactory	(m_testCtx, m_renderCtx, m_contextInfo);
+	const de::SharedPtr<glu::sl::ShaderCaseFactory>	caseFactory	(new CaseFactory(m_testCtx, m_renderCtx, m_contextInfo));
 
-	return glu::sl::parseFile(m_testCtx.getArchive(), fileName, &caseFactory);
+	return glu::sl::loadFile(m_testCtx, fileName, caseFactory);
 }
 
 } // gls
@@ -208,6 +208,22 @@ private:
 	const tcu::ConstPixelBufferAccess m_texture;
 };
 
+enum
+{
+	COLOR_BATCH_PACKETS	= 16,
+	COLOR_BATCH_STRIDE	= COLOR_BATCH_PACKETS * rr::NUM_FRAGMENTS_PER_PACKET
+};
+
+tcu::Vec4 getBatchColor (const float* colors, int packetNdx, int fragNdx)
+{
+	const int ndx = packetNdx * rr::NUM_FRAGMENTS_PER_PACKET + fragNdx;
+
+	return tcu::Vec4(colors[0 * COLOR_BATCH_STRIDE + ndx],
+					 colors[1 * COLOR_BATCH_STRIDE + ndx],
+					 colors[2 * COLOR_BATCH_STRIDE + ndx],
+					 colors[3 * COLOR_BATCH_STRIDE + ndx]);
+}
+
 class CoordFragmentShader : public rr::FragmentShader
 {
 public:
@@ -221,24 +237,23 @@ public:
 
 	void shadeFragments (rr::FragmentPacket* packets, const int numPackets, const rr::FragmentShadingContext& context) const
 	{
-		for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+		float vtxColors[4 * COLOR_BATCH_STRIDE];
+
+		for (int batchOffset = 0; batchOffset < numPackets; batchOffset += COLOR_BATCH_PACKETS)
 		{
-			rr::FragmentPacket&	packet		= packets[packetNdx];
-
-			const tcu::Vec4		vtxColor0	= rr::readVarying<float>(packet, context, 0, 0);
-			const tcu::Vec4		vtxColor1	= rr::readVarying<float>(packet, context, 0, 1);
-			const tcu::Vec4		vtxColor2	= rr::readVarying<float>(packet, context, 0, 2);
-			const tcu::Vec4		vtxColor3	= rr::readVarying<float>(packet, context, 0, 3);
-
-			const tcu::Vec4		color0		= vtxColor0;
-			const tcu::Vec4		color1		= vtxColor1;
-			const tcu::Vec4		color2		= vtxColor2;
-			const tcu::Vec4		color3		= vtxColor3;
-
-			rr::writeFragmentOutput(context, packetNdx, 0, 0, tcu::Vec4(color0.x() * color0.w(), color0.y() * color0.w(), color0.z() * color0.w(), 1.0f));
-			rr::writeFragmentOutput(context, packetNdx, 1, 0, tcu::Vec4(color1.x() * color1.w(), color1.y() * color1.w(), color1.z() * color1.w(), 1.0f));
-			rr::writeFragmentOutput(context, packetNdx, 2, 0, tcu::Vec4(color2.x() * color2.w(), color2.y() * color2.w(), color2.z() * color2.w(), 1.0f));
-			rr::writeFragmentOutput(context, packetNdx, 3, 0, tcu::Vec4(color3.x() * color3.w(), color3.y() * color3.w(), color3.z() * color3.w(), 1.0f));
+			const int numBatchPackets = de::min(numPackets - batchOffset, (int)COLOR_BATCH_PACKETS);
+
+			rr::readVaryingPackets(vtxColors, COLOR_BATCH_STRIDE, 4, packets + batchOffset, numBatchPackets, context, 0);
+
+			for (int packetNdx = 0; packetNdx < numBatchPackets; packetNdx++)
+			{
+				for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; fragNdx++)
+				{
+					const tcu::Vec4 color = getBatchColor(vtxColors, packetNdx, fragNdx);
+
+					rr::writeFragmentOutput(context, batchOffset + packetNdx, fragNdx, 0, tcu::Vec4(color.x() * color.w(), color.y() * color.w(), color.z() * color.w(), 1.0f));
+				}
+			}
 		}
 	}
 };
@@ -256,34 +271,28 @@ public:
 
 	void shadeFragments (rr::FragmentPacket* packets, const int numPackets, const rr::FragmentShadingContext& context) const
 	{
-		for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+		float vtxColors[4 * COLOR_BATCH_STRIDE];
+
+		for (int batchOffset = 0; batchOffset < numPackets; batchOffset += COLOR_BATCH_PACKETS)
 		{
-			rr::FragmentPacket&	packet		= packets[packetNdx];
-
-			const tcu::IVec2	position0	= packet.position + tcu::IVec2(0, 0);
-			const tcu::IVec2	position1	= packet.position + tcu::IVec2(1, 0);
-			const tcu::IVec2	position2	= packet.position + tcu::IVec2(0, 1);
-			const tcu::IVec2	position3	= packet.position + tcu::IVec2(1, 1);
-
-			const tcu::Vec4		texColor0	= m_texture.getPixel(de::clamp((position0.x() * position0.y()), 0, m_texture.getWidth()-1), 0);
-			const tcu::Vec4		texColor1	= m_texture.getPixel(de::clamp((position1.x() * position1.y()), 0, m_texture.getWidth()-1), 0);
-			const tcu::Vec4		texColor2	= m_texture.getPixel(de::clamp((position2.x() * position2.y()), 0, m_texture.getWidth()-1), 0);
-			const tcu::Vec4		texColor3	= m_texture.getPixel(de::clamp((position3.x() * position3.y()), 0, m_texture.getWidth()-1), 0);
-
-			const tcu::Vec4		vtxColor0	= rr::readVarying<float>(packet, context, 0, 0);
-			const tcu::Vec4		vtxColor1	= rr::readVarying<float>(packet, context, 0, 1);
-			const tcu::Vec4		vtxColor2	= rr::readVarying<float>(packet, context, 0, 2);
-			const tcu::Vec4		vtxColor3	= rr::readVarying<float>(packet, context, 0, 3);
-
-			const tcu::Vec4		color0		= 0.5f * (vtxColor0 + texColor0);
-			const tcu::Vec4		color1		= 0.5f * (vtxColor1 + texColor1);
-			const tcu::Vec4		color2		= 0.5f * (vtxColor2 + texColor2);
-			const tcu::Vec4		color3		= 0.5f * (vtxColor3 + texColor3);
-
-			rr::writeFragmentOutput(context, packetNdx, 0, 0, tcu::Vec4(color0.x() * color0.w(), color0.y() * color0.w(), color0.z() * color0.w(), 1.0f));
-			rr::writeFragmentOutput(context, packetNdx, 1, 0, tcu::Vec4(color1.x() * color1.w(), color1.y() * color1.w(), color1.z() * color1.w(), 1.0f));
-			rr::writeFragmentOutput(context, packetNdx, 2, 0, tcu::Vec4(color2.x() * color2.w(), color2.y() * color2.w(), color2.z() * color2.w(), 1.0f));
-			rr::writeFragmentOutput(context, packetNdx, 3, 0, tcu::Vec4(color3.x() * color3.w(), color3.y() * color3.w(), color3.z() * color3.w(), 1.0f));
+			const int numBatchPackets = de::min(numPackets - batchOffset, (int)COLOR_BATCH_PACKETS);
+
+			rr::readVaryingPackets(vtxColors, COLOR_BATCH_STRIDE, 4, packets + batchOffset, numBatchPackets, context, 0);
+
+			for (int packetNdx = 0; packetNdx < numBatchPackets; packetNdx++)
+			{
+				const rr::FragmentPacket& packet = packets[batchOffset + packetNdx];
+
+				for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; fragNdx++)
+				{
+					const tcu::IVec2	position	= packet.position + tcu::IVec2(fragNdx % 2, fragNdx / 2);
+					const tcu::Vec4		texColor	= m_texture.getPixel(de::clamp((position.x() * position.y()), 0, m_texture.getWidth()-1), 0);
+					const tcu::Vec4		vtxColor	= getBatchColor(vtxColors, packetNdx, fragNdx);
+					const tcu::Vec4		color		= 0.5f * (vtxColor + texColor);
+
+					rr::writeFragmentOutput(context, batchOffset + packetNdx, fragNdx, 0, tcu::Vec4(color.x() * color.w(), color.y() * color.w(), color.z() * color.w(), 1.0f));
+				}
+			}
 		}
 	}
 
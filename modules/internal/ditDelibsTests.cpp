@@ -40,6 +40,8 @@
 // deutil
 #include "deTimerTest.h"
 #include "deCommandLine.h"
+#include "deMappedFile.h"
+#include "deFile.h"
 
 // debase
 #include "deInt32.h"
@@ -147,6 +149,8 @@ public:
 	{
 		addChild(new SelfCheckCase(m_testCtx, "timer",			"deTimer_selfTest()",		deTimer_selfTest));
 		addChild(new SelfCheckCase(m_testCtx, "command_line",	"deCommandLine_selfTest()",	deCommandLine_selfTest));
+		addChild(new SelfCheckCase(m_testCtx, "mapped_file",	"deMappedFile_selfTest()",	deMappedFile_selfTest));
+		addChild(new SelfCheckCase(m_testCtx, "file",			"deFile_selfTest()",		deFile_selfTest));
 	}
 };
 
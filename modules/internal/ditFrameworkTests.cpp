@@ -27,19 +27,38 @@
 #include "ditVulkanTests.hpp"
 
 #include "tcuFloatFormat.hpp"
+#include "tcuInterval.hpp"
+#include "tcuParallelFor.hpp"
 #include "tcuEither.hpp"
 #include "tcuTestLog.hpp"
 #include "tcuCommandLine.hpp"
+#include "tcuFormatUtil.hpp"
 
 #include "rrRenderer.hpp"
+#include "rrFragmentOperations.hpp"
+#include "rrRasterizer.hpp"
+#include "gluShaderLibrary.hpp"
+#include "gluShaderUtil.hpp"
 #include "tcuTextureUtil.hpp"
 #include "tcuVectorUtil.hpp"
 #include "tcuFloat.hpp"
 
 #include "deRandom.hpp"
 #include "deArrayUtil.hpp"
+#include "deStringUtil.hpp"
+#include "deString.h"
+#include "deMemory.h"
+#include "deClock.h"
+#include "deThread.h"
+#include "deFile.h"
+#include "deFilePath.hpp"
+#include "deDirectoryIterator.hpp"
+#include "deSharedPtr.hpp"
 
 #include <stdexcept>
+#include <cmath>
+#include <sstream>
+#include <fstream>
 
 namespace dit
 {
@@ -70,14 +89,42 @@ const char* getMatchCaseExpectedDesc (MatchCase::Expected expected)
 	return de::getSizedArrayElement<MatchCase::EXPECTED_LAST>(descs, expected);
 }
 
+//! Write case list in binary trie format to a temporary file, removed when destroyed.
+class BinaryCaseListFile
+{
+public:
+	BinaryCaseListFile (const std::string& filename, const std::string& caseList)
+		: m_filename(filename)
+	{
+		std::istringstream	src	(caseList);
+		std::ofstream		dst	(m_filename.c_str(), std::ios_base::binary);
+
+		if (!dst.is_open())
+			throw tcu::ResourceError("Failed to create " + m_filename);
+
+		tcu::writeBinaryCaseList(src, dst);
+	}
+
+	~BinaryCaseListFile (void)
+	{
+		deDeleteFile(m_filename.c_str());
+	}
+
+	const std::string&	getFilename	(void) const { return m_filename; }
+
+private:
+	const std::string	m_filename;
+};
+
 class CaseListParserCase : public tcu::TestCase
 {
 public:
-	CaseListParserCase (tcu::TestContext& testCtx, const char* name, const char* caseList, const MatchCase* subCases, int numSubCases)
+	CaseListParserCase (tcu::TestContext& testCtx, const char* name, const char* caseList, const MatchCase* subCases, int numSubCases, bool binary = false)
 		: tcu::TestCase	(testCtx, name, "")
 		, m_caseList	(caseList)
 		, m_subCases	(subCases)
 		, m_numSubCases	(numSubCases)
+		, m_binary		(binary)
 	{
 	}
 
@@ -86,10 +133,26 @@ public:
 		TestLog&							log		= m_testCtx.getLog();
 		tcu::CommandLine					cmdLine;
 		de::MovePtr<tcu::CaseListFilter>	caseListFilter;
+		de::MovePtr<BinaryCaseListFile>		binaryFile;
 		int									numPass	= 0;
 
 		log << TestLog::Message << "Input:\n\"" << m_caseList << "\"" << TestLog::EndMessage;
 
+		if (m_binary)
+		{
+			binaryFile = de::MovePtr<BinaryCaseListFile>(new BinaryCaseListFile(string("case-list-") + getName() + ".bin", m_caseList));
+
+			const string	fileArg	= "--deqp-caselist-file=" + binaryFile->getFilename();
+			const char*		argv[]	=
+			{
+				"deqp",
+				fileArg.c_str()
+			};
+
+			if (!cmdLine.parse(DE_LENGTH_OF_ARRAY(argv), argv))
+				TCU_FAIL("Failed to parse command line");
+		}
+		else
 		{
 			const char* argv[] =
 			{
@@ -137,6 +200,7 @@ private:
 	const char* const			m_caseList;
 	const MatchCase* const		m_subCases;
 	const int					m_numSubCases;
+	const bool					m_binary;
 };
 
 class NegativeCaseListCase : public tcu::TestCase
@@ -556,6 +620,174 @@ public:
 	}
 };
 
+class CaseListStartupBenchmark : public tcu::TestCase
+{
+public:
+	CaseListStartupBenchmark (tcu::TestContext& testCtx)
+		: tcu::TestCase(testCtx, "startup_benchmark", "Measure case list filter setup and lookup time for large case lists")
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		const int			numGroups			= 64;
+		const int			numSubGroups		= 64;
+		const int			numCases			= 64;
+		const string		textFilename		= "case-list-startup-benchmark.txt";
+		vector<string>		casePaths;
+		string				caseList;
+		int					numFailed			= 0;
+
+		for (int groupNdx = 0; groupNdx < numGroups; groupNdx++)
+		for (int subGroupNdx = 0; subGroupNdx < numSubGroups; subGroupNdx++)
+		for (int caseNdx = 0; caseNdx < numCases; caseNdx++)
+			casePaths.push_back("dEQP-VK.group" + de::toString(groupNdx) + ".sub_group" + de::toString(subGroupNdx) + ".case" + de::toString(caseNdx));
+
+		for (size_t caseNdx = 0; caseNdx < casePaths.size(); caseNdx++)
+			caseList += casePaths[caseNdx] + "\n";
+
+		{
+			std::ofstream dst (textFilename.c_str(), std::ios_base::binary);
+
+			if (!dst.is_open())
+				throw tcu::ResourceError("Failed to create " + textFilename);
+
+			dst << caseList;
+		}
+
+		{
+			const BinaryCaseListFile	binaryFile	("case-list-startup-benchmark.bin", caseList);
+			const string				files[]		= { textFilename, binaryFile.getFilename() };
+			const char* const			names[]		= { "Text", "Binary" };
+
+			m_testCtx.getLog() << TestLog::Message << "Case list with " << casePaths.size() << " cases" << TestLog::EndMessage;
+
+			for (int fileNdx = 0; fileNdx < DE_LENGTH_OF_ARRAY(files); fileNdx++)
+			{
+				const string		fileArg		= "--deqp-caselist-file=" + files[fileNdx];
+				const char*			argv[]		= { "deqp", fileArg.c_str() };
+				tcu::CommandLine	cmdLine;
+				deUint64			setupTime;
+				deUint64			lookupTime;
+
+				if (!cmdLine.parse(DE_LENGTH_OF_ARRAY(argv), argv))
+					TCU_FAIL("Failed to parse command line");
+
+				{
+					const deUint64							startTime	= deGetMicroseconds();
+					const de::UniquePtr<tcu::CaseListFilter>	filter		(cmdLine.createCaseListFilter(m_testCtx.getArchive()));
+
+					setupTime = deGetMicroseconds() - startTime;
+
+					{
+						const deUint64 lookupStartTime = deGetMicroseconds();
+
+						for (size_t caseNdx = 0; caseNdx < casePaths.size(); caseNdx++)
+						{
+							if (!filter->checkTestCaseName(casePaths[caseNdx].c_str()) || filter->checkTestGroupName(casePaths[caseNdx].c_str()))
+								numFailed += 1;
+						}
+
+						lookupTime = deGetMicroseconds() - lookupStartTime;
+					}
+
+					if (!filter->checkTestGroupName("dEQP-VK.group1.sub_group2") || filter->checkTestCaseName("dEQP-VK.group1.sub_group2.case64"))
+						numFailed += 1;
+				}
+
+				m_testCtx.getLog() << TestLog::Integer(string(names[fileNdx]) + "SetupTime", string(names[fileNdx]) + " case list filter setup time", "us", QP_KEY_TAG_TIME, (deInt64)setupTime)
+								   << TestLog::Integer(string(names[fileNdx]) + "LookupTime", string(names[fileNdx]) + " case list lookup time for all cases", "us", QP_KEY_TAG_TIME, (deInt64)lookupTime);
+			}
+		}
+
+		deDeleteFile(textFilename.c_str());
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Case list lookups failed");
+
+		return STOP;
+	}
+};
+
+class BinaryCaseListTests : public tcu::TestCaseGroup
+{
+public:
+	BinaryCaseListTests (tcu::TestContext& testCtx)
+		: tcu::TestCaseGroup(testCtx, "binary", "Binary case trie tests")
+	{
+	}
+
+	void init (void)
+	{
+		{
+			static const char* const	caseList	= "{a{b,c},d{e{f}}}";
+			static const MatchCase		subCases[]	=
+			{
+				{ "a",		MatchCase::MATCH_GROUP	},
+				{ "b",		MatchCase::NO_MATCH		},
+				{ "a.b",	MatchCase::MATCH_CASE	},
+				{ "a.c",	MatchCase::MATCH_CASE	},
+				{ "a.d",	MatchCase::NO_MATCH		},
+				{ "d",		MatchCase::MATCH_GROUP	},
+				{ "d.e",	MatchCase::MATCH_GROUP	},
+				{ "d.e.f",	MatchCase::MATCH_CASE	},
+				{ "d.e.f.g",	MatchCase::NO_MATCH		},
+				{ "d.f",	MatchCase::NO_MATCH		},
+			};
+			addChild(new CaseListParserCase(m_testCtx, "from_trie", caseList, subCases, DE_LENGTH_OF_ARRAY(subCases), true));
+		}
+		{
+			static const char* const	caseList	=
+				"a.b.c.d.e\n"
+				"a.b.c.f\n"
+				"x.y.z\n"
+				"a.b.c.d.g\n"
+				"a.b.c.x\n";
+			static const MatchCase		subCases[]	=
+			{
+				{ "a",				MatchCase::MATCH_GROUP	},
+				{ "a.b",			MatchCase::MATCH_GROUP	},
+				{ "a.b.c.d.e",		MatchCase::MATCH_CASE	},
+				{ "a.b.c.d.g",		MatchCase::MATCH_CASE	},
+				{ "a.b.c.d.h",		MatchCase::NO_MATCH		},
+				{ "x.y",			MatchCase::MATCH_GROUP	},
+				{ "x.y.z",			MatchCase::MATCH_CASE	},
+				{ "a.b.c.f",		MatchCase::MATCH_CASE	},
+				{ "a.b.c.x",		MatchCase::MATCH_CASE	},
+				{ "a.b.c.y",		MatchCase::NO_MATCH		},
+			};
+			addChild(new CaseListParserCase(m_testCtx, "from_list", caseList, subCases, DE_LENGTH_OF_ARRAY(subCases), true));
+		}
+		{
+			// Names sharing prefixes and appearing in several groups share pool storage
+			static const char* const	caseList	=
+				"g.ab\n"
+				"g.a\n"
+				"g.abc\n"
+				"g.b\n"
+				"h.a\n"
+				"h.abc\n";
+			static const MatchCase		subCases[]	=
+			{
+				{ "g.a",		MatchCase::MATCH_CASE	},
+				{ "g.ab",		MatchCase::MATCH_CASE	},
+				{ "g.abc",		MatchCase::MATCH_CASE	},
+				{ "g.abcd",		MatchCase::NO_MATCH		},
+				{ "g.b",		MatchCase::MATCH_CASE	},
+				{ "g.c",		MatchCase::NO_MATCH		},
+				{ "h.a",		MatchCase::MATCH_CASE	},
+				{ "h.ab",		MatchCase::NO_MATCH		},
+				{ "h.abc",		MatchCase::MATCH_CASE	},
+			};
+			addChild(new CaseListParserCase(m_testCtx, "shared_prefix", caseList, subCases, DE_LENGTH_OF_ARRAY(subCases), true));
+		}
+
+		addChild(new CaseListStartupBenchmark(m_testCtx));
+	}
+};
+
 class CaseListParserTests : public tcu::TestCaseGroup
 {
 public:
@@ -568,6 +800,7 @@ public:
 	{
 		addChild(new TrieParserTests(m_testCtx));
 		addChild(new ListParserTests(m_testCtx));
+		addChild(new BinaryCaseListTests(m_testCtx));
 	}
 };
 
@@ -880,34 +1113,1632 @@ protected:
 	vector<SubCase>::const_iterator	m_caseIter;
 };
 
-class CommonFrameworkTests : public tcu::TestCaseGroup
+//! Passes position through and color to varying 0
+class PositionColorVertexShader : public rr::VertexShader
 {
 public:
-	CommonFrameworkTests (tcu::TestContext& testCtx)
-		: tcu::TestCaseGroup(testCtx, "common", "Tests for the common utility framework")
+	PositionColorVertexShader (void)
+		: rr::VertexShader(2, 1)
 	{
+		m_inputs[0].type	= rr::GENERICVECTYPE_FLOAT;
+		m_inputs[1].type	= rr::GENERICVECTYPE_FLOAT;
+		m_outputs[0].type	= rr::GENERICVECTYPE_FLOAT;
 	}
 
-	void init (void)
+	void shadeVertices (const rr::VertexAttrib* inputs, rr::VertexPacket* const* packets, const int numPackets) const
 	{
-		addChild(new SelfCheckCase(m_testCtx, "float_format","tcu::FloatFormat_selfTest()",
-								   tcu::FloatFormat_selfTest));
-		addChild(new SelfCheckCase(m_testCtx, "either","tcu::Either_selfTest()",
-								   tcu::Either_selfTest));
+		for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+		{
+			rr::readVertexAttrib(packets[packetNdx]->position, inputs[0], packets[packetNdx]->instanceNdx, packets[packetNdx]->vertexNdx);
+			packets[packetNdx]->outputs[0]	= rr::readVertexAttribFloat(inputs[1], packets[packetNdx]->instanceNdx, packets[packetNdx]->vertexNdx);
+			packets[packetNdx]->pointSize	= 5.0f;
+		}
 	}
 };
 
-class ReferenceRendererTests : public tcu::TestCaseGroup
+//! Outputs varying 0 as color
+class ColorVaryingFragmentShader : public rr::FragmentShader
 {
 public:
-	ReferenceRendererTests (tcu::TestContext& testCtx)
-		: tcu::TestCaseGroup(testCtx, "reference_renderer", "Reference renderer tests")
+	ColorVaryingFragmentShader (void)
+		: rr::FragmentShader(1, 1)
 	{
+		m_inputs[0].type	= rr::GENERICVECTYPE_FLOAT;
+		m_outputs[0].type	= rr::GENERICVECTYPE_FLOAT;
 	}
 
-	void init (void)
+	void shadeFragments (rr::FragmentPacket* packets, const int numPackets, const rr::FragmentShadingContext& context) const
 	{
-		addChild(new ConstantInterpolationTest(m_testCtx));
+		for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+		for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; fragNdx++)
+			rr::writeFragmentOutput(context, packetNdx, fragNdx, 0, rr::readVarying<float>(packets[packetNdx], context, 0, fragNdx));
+	}
+};
+
+class MultithreadedRenderingTest : public tcu::TestCase
+{
+public:
+	MultithreadedRenderingTest (tcu::TestContext& testCtx, const char* name, rr::PrimitiveType primitiveType, int numSamples)
+		: tcu::TestCase		(testCtx, name, "Compare binned multithreaded rendering against single-threaded rendering")
+		, m_primitiveType	(primitiveType)
+		, m_numSamples		(numSamples)
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		using namespace tcu;
+
+		const int				width			= 203;
+		const int				height			= 157;
+		const int				numVertices		= 96;
+		const int				numThreads		= 4;
+		de::Random				rnd				(deStringHash(getName()));
+		vector<Vec4>			positions		(numVertices);
+		vector<Vec4>			colors			(numVertices);
+
+		for (int vtxNdx = 0; vtxNdx < numVertices; vtxNdx++)
+		{
+			// Some vertices outside the viewport to exercise clipping
+			positions[vtxNdx]	= Vec4(rnd.getFloat(-1.2f, 1.2f), rnd.getFloat(-1.2f, 1.2f), rnd.getFloat(-1.0f, 1.0f), 1.0f);
+			colors[vtxNdx]		= Vec4(rnd.getFloat(), rnd.getFloat(), rnd.getFloat(), rnd.getFloat());
+		}
+
+		TextureLevel	refColor		(TextureFormat(TextureFormat::RGBA, TextureFormat::UNORM_INT8), m_numSamples, width, height);
+		TextureLevel	refDepth		(TextureFormat(TextureFormat::D, TextureFormat::FLOAT), m_numSamples, width, height);
+		TextureLevel	resColor		(refColor.getFormat(), m_numSamples, width, height);
+		TextureLevel	resDepth		(refDepth.getFormat(), m_numSamples, width, height);
+
+		render(rr::Renderer(1),				positions, colors, refColor.getAccess(), refDepth.getAccess());
+		render(rr::Renderer(numThreads),	positions, colors, resColor.getAccess(), resDepth.getAccess());
+
+		{
+			const size_t	colorSize	= (size_t)refColor.getAccess().getSlicePitch() * (size_t)refColor.getDepth();
+			const size_t	depthSize	= (size_t)refDepth.getAccess().getSlicePitch() * (size_t)refDepth.getDepth();
+			const bool		colorOk		= deMemCmp(refColor.getAccess().getDataPtr(), resColor.getAccess().getDataPtr(), colorSize) == 0;
+			const bool		depthOk		= deMemCmp(refDepth.getAccess().getDataPtr(), resDepth.getAccess().getDataPtr(), depthSize) == 0;
+
+			m_testCtx.getLog() << TestLog::Message << "Rendered " << numVertices << " vertices to " << width << "x" << height << " target with "
+							   << m_numSamples << " sample(s) using 1 and " << numThreads << " threads" << TestLog::EndMessage;
+
+			if (colorOk && depthOk)
+				m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+			else
+			{
+				TextureLevel	resolvedRef	(refColor.getFormat(), width, height);
+				TextureLevel	resolvedRes	(resColor.getFormat(), width, height);
+
+				rr::resolveMultisampleColorBuffer(resolvedRef.getAccess(), rr::MultisampleConstPixelBufferAccess::fromMultisampleAccess(refColor.getAccess()));
+				rr::resolveMultisampleColorBuffer(resolvedRes.getAccess(), rr::MultisampleConstPixelBufferAccess::fromMultisampleAccess(resColor.getAccess()));
+
+				m_testCtx.getLog() << TestLog::Image("Reference", "Single-threaded result", resolvedRef)
+								   << TestLog::Image("Result", "Multithreaded result", resolvedRes);
+
+				if (!colorOk)
+					m_testCtx.getLog() << TestLog::Message << "FAIL: Color buffers differ" << TestLog::EndMessage;
+
+				if (!depthOk)
+					m_testCtx.getLog() << TestLog::Message << "FAIL: Depth buffers differ" << TestLog::EndMessage;
+
+				m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Multithreaded result differs");
+			}
+		}
+
+		return STOP;
+	}
+
+private:
+	void render (const rr::Renderer& renderer, const vector<tcu::Vec4>& positions, const vector<tcu::Vec4>& colors, const tcu::PixelBufferAccess& color, const tcu::PixelBufferAccess& depth) const
+	{
+		const PositionColorVertexShader			vtxShader;
+		const ColorVaryingFragmentShader		fragShader;
+		const rr::Program						program			(&vtxShader, &fragShader);
+		const rr::MultisamplePixelBufferAccess	colorAccess		= rr::MultisamplePixelBufferAccess::fromMultisampleAccess(color);
+		const rr::MultisamplePixelBufferAccess	depthAccess		= rr::MultisamplePixelBufferAccess::fromMultisampleAccess(depth);
+		const rr::RenderTarget					renderTarget	(colorAccess, depthAccess);
+		const rr::VertexAttrib					vertexAttribs[]	=
+		{
+			rr::VertexAttrib(rr::VERTEXATTRIBTYPE_FLOAT, 4, 0, 0, &positions[0]),
+			rr::VertexAttrib(rr::VERTEXATTRIBTYPE_FLOAT, 4, 0, 0, &colors[0])
+		};
+		rr::RenderState							state			((rr::ViewportState(colorAccess)));
+
+		tcu::clear		(color, tcu::Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		tcu::clearDepth	(depth, 1.0f);
+
+		state.line.lineWidth								= 3.0f;
+		state.fragOps.depthTestEnabled						= true;
+		state.fragOps.depthFunc								= rr::TESTFUNC_LEQUAL;
+		state.fragOps.blendMode								= rr::BLENDMODE_STANDARD;
+		state.fragOps.blendRGBState.srcFunc					= rr::BLENDFUNC_SRC_ALPHA;
+		state.fragOps.blendRGBState.dstFunc					= rr::BLENDFUNC_ONE_MINUS_SRC_ALPHA;
+
+		renderer.draw(rr::DrawCommand(state, renderTarget, program, DE_LENGTH_OF_ARRAY(vertexAttribs), vertexAttribs, rr::PrimitiveList(m_primitiveType, (int)positions.size(), 0)));
+	}
+
+	const rr::PrimitiveType	m_primitiveType;
+	const int				m_numSamples;
+};
+
+class VertexCacheTest : public tcu::TestCase
+{
+public:
+	VertexCacheTest (tcu::TestContext& testCtx, const char* name, rr::PrimitiveType primitiveType)
+		: tcu::TestCase		(testCtx, name, "Compare indexed rendering using vertex cache against non-indexed rendering")
+		, m_primitiveType	(primitiveType)
+	{
+		DE_ASSERT(primitiveType == rr::PRIMITIVETYPE_TRIANGLES || primitiveType == rr::PRIMITIVETYPE_TRIANGLE_STRIP || primitiveType == rr::PRIMITIVETYPE_LINES);
+	}
+
+	IterateResult iterate (void)
+	{
+		using namespace tcu;
+
+		const int				width				= 128;
+		const int				height				= 128;
+		const int				gridSize			= 40;
+		const int				numThreads			= 4;
+		const deUint16			restartIndex		= 0xFFFFu;
+		const bool				useRestart			= m_primitiveType == rr::PRIMITIVETYPE_TRIANGLE_STRIP;
+		de::Random				rnd					(deStringHash(getName()));
+		vector<Vec4>			positions			(gridSize*gridSize);
+		vector<Vec4>			colors				(gridSize*gridSize);
+		vector<deUint16>		indices;
+		vector<int>				segmentLengths;
+		deUint64				numUniqueVertices	= 0;
+
+		for (int y = 0; y < gridSize; y++)
+		for (int x = 0; x < gridSize; x++)
+		{
+			const float fx = 1.9f * ((float)x / (float)(gridSize-1)) - 0.95f;
+			const float fy = 1.9f * ((float)y / (float)(gridSize-1)) - 0.95f;
+
+			positions[y*gridSize + x]	= Vec4(fx + rnd.getFloat(-0.02f, 0.02f), fy + rnd.getFloat(-0.02f, 0.02f), rnd.getFloat(-1.0f, 1.0f), 1.0f);
+			colors[y*gridSize + x]		= Vec4(rnd.getFloat(), rnd.getFloat(), rnd.getFloat(), rnd.getFloat());
+		}
+
+		if (useRestart)
+		{
+			// One strip per row, separated by restart index
+			for (int y = 0; y < gridSize-1; y++)
+			{
+				if (y > 0)
+					indices.push_back(restartIndex);
+
+				for (int x = 0; x < gridSize; x++)
+				{
+					indices.push_back((deUint16)((y+1)*gridSize + x));
+					indices.push_back((deUint16)(y*gridSize + x));
+				}
+
+				segmentLengths.push_back(2*gridSize);
+				numUniqueVertices += 2*gridSize;
+			}
+		}
+		else
+		{
+			for (int y = 0; y < gridSize-1; y++)
+			for (int x = 0; x < gridSize-1; x++)
+			{
+				const deUint16 v00 = (deUint16)(y*gridSize + x);
+				const deUint16 v10 = (deUint16)(y*gridSize + x + 1);
+				const deUint16 v01 = (deUint16)((y+1)*gridSize + x);
+				const deUint16 v11 = (deUint16)((y+1)*gridSize + x + 1);
+
+				if (m_primitiveType == rr::PRIMITIVETYPE_TRIANGLES)
+				{
+					const deUint16 quad[] = { v00, v10, v01, v01, v10, v11 };
+					indices.insert(indices.end(), DE_ARRAY_BEGIN(quad), DE_ARRAY_END(quad));
+				}
+				else
+				{
+					const deUint16 quad[] = { v00, v10, v00, v01 };
+					indices.insert(indices.end(), DE_ARRAY_BEGIN(quad), DE_ARRAY_END(quad));
+				}
+			}
+
+			segmentLengths.push_back((int)indices.size());
+			// Lines never reference the last corner vertex
+			numUniqueVertices = (deUint64)(gridSize*gridSize - (m_primitiveType == rr::PRIMITIVETYPE_LINES ? 1 : 0));
+		}
+
+		TextureLevel	refColor	(TextureFormat(TextureFormat::RGBA, TextureFormat::UNORM_INT8), 1, width, height);
+		TextureLevel	refDepth	(TextureFormat(TextureFormat::D, TextureFormat::FLOAT), 1, width, height);
+		TextureLevel	resColor	(refColor.getFormat(), 1, width, height);
+		TextureLevel	resDepth	(refDepth.getFormat(), 1, width, height);
+		rr::Renderer	renderer	(numThreads);
+
+		// Reference: expand indices to vertex arrays and draw without indices
+		{
+			vector<Vec4>	expandedPositions;
+			vector<Vec4>	expandedColors;
+
+			for (size_t ndx = 0; ndx < indices.size(); ndx++)
+			{
+				if (useRestart && indices[ndx] == restartIndex)
+					continue;
+
+				expandedPositions.push_back(positions[indices[ndx]]);
+				expandedColors.push_back(colors[indices[ndx]]);
+			}
+
+			render(rr::Renderer(1), expandedPositions, expandedColors, DE_NULL, segmentLengths, refColor.getAccess(), refDepth.getAccess());
+		}
+
+		render(renderer, positions, colors, &indices, segmentLengths, resColor.getAccess(), resDepth.getAccess());
+
+		{
+			const rr::VertexCacheStats&	stats		= renderer.getVertexCacheStats();
+			const deUint64				numIndices	= (deUint64)(indices.size() - (useRestart ? segmentLengths.size() - 1 : 0));
+			const size_t				colorSize	= (size_t)refColor.getAccess().getSlicePitch();
+			const size_t				depthSize	= (size_t)refDepth.getAccess().getSlicePitch();
+			const bool					colorOk		= deMemCmp(refColor.getAccess().getDataPtr(), resColor.getAccess().getDataPtr(), colorSize) == 0;
+			const bool					depthOk		= deMemCmp(refDepth.getAccess().getDataPtr(), resDepth.getAccess().getDataPtr(), depthSize) == 0;
+			const bool					statsOk		= stats.numIndices == numIndices && stats.numShadedVertices == numUniqueVertices;
+
+			m_testCtx.getLog() << TestLog::Message << "Indices: " << stats.numIndices << ", shaded vertices: " << stats.numShadedVertices
+							   << ", hit rate: " << stats.getHitRate() * 100.0f << "%" << TestLog::EndMessage;
+
+			if (!statsOk)
+				m_testCtx.getLog() << TestLog::Message << "FAIL: Expected " << numIndices << " indices and " << numUniqueVertices << " shaded vertices" << TestLog::EndMessage;
+
+			if (!colorOk || !depthOk)
+			{
+				m_testCtx.getLog() << TestLog::Image("Reference", "Non-indexed result", refColor)
+								   << TestLog::Image("Result", "Indexed result", resColor);
+
+				if (!colorOk)
+					m_testCtx.getLog() << TestLog::Message << "FAIL: Color buffers differ" << TestLog::EndMessage;
+
+				if (!depthOk)
+					m_testCtx.getLog() << TestLog::Message << "FAIL: Depth buffers differ" << TestLog::EndMessage;
+			}
+
+			if (colorOk && depthOk && statsOk)
+				m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+			else
+				m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, (statsOk) ? ("Indexed result differs") : ("Invalid vertex cache statistics"));
+		}
+
+		return STOP;
+	}
+
+private:
+	//! Draws each segment separately if indices are not given
+	void render (const rr::Renderer& renderer, const vector<tcu::Vec4>& positions, const vector<tcu::Vec4>& colors, const vector<deUint16>* indices, const vector<int>& segmentLengths, const tcu::PixelBufferAccess& color, const tcu::PixelBufferAccess& depth) const
+	{
+		const PositionColorVertexShader			vtxShader;
+		const ColorVaryingFragmentShader		fragShader;
+		const rr::Program						program			(&vtxShader, &fragShader);
+		const rr::MultisamplePixelBufferAccess	colorAccess		= rr::MultisamplePixelBufferAccess::fromMultisampleAccess(color);
+		const rr::MultisamplePixelBufferAccess	depthAccess		= rr::MultisamplePixelBufferAccess::fromMultisampleAccess(depth);
+		const rr::RenderTarget					renderTarget	(colorAccess, depthAccess);
+		const rr::VertexAttrib					vertexAttribs[]	=
+		{
+			rr::VertexAttrib(rr::VERTEXATTRIBTYPE_FLOAT, 4, 0, 0, &positions[0]),
+			rr::VertexAttrib(rr::VERTEXATTRIBTYPE_FLOAT, 4, 0, 0, &colors[0])
+		};
+		rr::RenderState							state			((rr::ViewportState(colorAccess)));
+
+		tcu::clear		(color, tcu::Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		tcu::clearDepth	(depth, 1.0f);
+
+		state.restart.enabled								= true;
+		state.restart.restartIndex							= 0xFFFFu;
+		state.fragOps.depthTestEnabled						= true;
+		state.fragOps.depthFunc								= rr::TESTFUNC_LEQUAL;
+		state.fragOps.blendMode								= rr::BLENDMODE_STANDARD;
+		state.fragOps.blendRGBState.srcFunc					= rr::BLENDFUNC_SRC_ALPHA;
+		state.fragOps.blendRGBState.dstFunc					= rr::BLENDFUNC_ONE_MINUS_SRC_ALPHA;
+
+		if (indices)
+			renderer.draw(rr::DrawCommand(state, renderTarget, program, DE_LENGTH_OF_ARRAY(vertexAttribs), vertexAttribs, rr::PrimitiveList(m_primitiveType, (int)indices->size(), rr::DrawIndices(&(*indices)[0]))));
+		else
+		{
+			int firstElement = 0;
+
+			for (size_t segmentNdx = 0; segmentNdx < segmentLengths.size(); segmentNdx++)
+			{
+				renderer.draw(rr::DrawCommand(state, renderTarget, program, DE_LENGTH_OF_ARRAY(vertexAttribs), vertexAttribs, rr::PrimitiveList(m_primitiveType, segmentLengths[segmentNdx], firstElement)));
+				firstElement += segmentLengths[segmentNdx];
+			}
+		}
+	}
+
+	const rr::PrimitiveType	m_primitiveType;
+};
+
+class VaryingInterpolationBenchmark : public tcu::TestCase
+{
+public:
+	VaryingInterpolationBenchmark (tcu::TestContext& testCtx, const char* name, int numVertices)
+		: tcu::TestCase		(testCtx, name, "Compare batched varying interpolation against per-fragment readVarying()")
+		, m_numVertices		(numVertices)
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		using namespace tcu;
+
+		const int					numPackets		= 128;
+		const int					numVaryings		= 4;
+		const int					numIterations	= 2000;
+		const int					dstStride		= numPackets * rr::NUM_FRAGMENTS_PER_PACKET;
+		de::Random					rnd				(deStringHash(getName()));
+		vector<rr::GenericVec4>		vertexOutputs	(3 * numVaryings);
+		vector<rr::FragmentPacket>	packets			(numPackets);
+		vector<float>				reference		(numVaryings * 4 * dstStride);
+		vector<float>				result			(numVaryings * 4 * dstStride);
+
+		for (int ndx = 0; ndx < (int)vertexOutputs.size(); ndx++)
+			vertexOutputs[ndx] = Vec4(rnd.getFloat(-10.0f, 10.0f), rnd.getFloat(-10.0f, 10.0f), rnd.getFloat(-10.0f, 10.0f), rnd.getFloat(-10.0f, 10.0f));
+
+		for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+		{
+			packets[packetNdx].position	= IVec2(rnd.getInt(0, 255), rnd.getInt(0, 255));
+			packets[packetNdx].coverage	= 0;
+
+			for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; fragNdx++)
+			{
+				const float b0 = rnd.getFloat();
+				const float b1 = rnd.getFloat(0.0f, 1.0f - b0);
+
+				packets[packetNdx].barycentric[0][fragNdx] = b0;
+				packets[packetNdx].barycentric[1][fragNdx] = b1;
+				packets[packetNdx].barycentric[2][fragNdx] = 1.0f - b0 - b1;
+			}
+		}
+
+		{
+			const rr::FragmentShadingContext	context			(&vertexOutputs[0],
+																 (m_numVertices > 1) ? (&vertexOutputs[numVaryings]) : (DE_NULL),
+																 (m_numVertices > 2) ? (&vertexOutputs[2 * numVaryings]) : (DE_NULL),
+																 DE_NULL, DE_NULL, 0, 0, 1, rr::FACETYPE_FRONT);
+			deUint64							scalarTime		= 0;
+			deUint64							batchedTime		= 0;
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+				for (int varyingNdx = 0; varyingNdx < numVaryings; varyingNdx++)
+				for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+				for (int fragNdx = 0; fragNdx < rr::NUM_FRAGMENTS_PER_PACKET; fragNdx++)
+				{
+					const Vec4	value	= rr::readVarying<float>(packets[packetNdx], context, varyingNdx, fragNdx);
+					float*		dst		= &reference[varyingNdx * 4 * dstStride + packetNdx * rr::NUM_FRAGMENTS_PER_PACKET + fragNdx];
+
+					for (int compNdx = 0; compNdx < 4; compNdx++)
+						dst[compNdx * dstStride] = value[compNdx];
+				}
+
+				scalarTime = deGetMicroseconds() - startTime;
+			}
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+				for (int varyingNdx = 0; varyingNdx < numVaryings; varyingNdx++)
+					rr::readVaryingPackets(&result[varyingNdx * 4 * dstStride], dstStride, 4, &packets[0], numPackets, context, varyingNdx);
+
+				batchedTime = deGetMicroseconds() - startTime;
+			}
+
+			m_testCtx.getLog() << TestLog::Message << "Interpolated " << numVaryings << " vec4 varying(s) for " << numPackets << " packet(s) "
+							   << numIterations << " times, " << m_numVertices << " vertex value(s) per primitive" << TestLog::EndMessage
+							   << TestLog::Integer("ScalarTime", "Per-fragment interpolation time", "us", QP_KEY_TAG_TIME, (deInt64)scalarTime)
+							   << TestLog::Integer("BatchedTime", "Batched interpolation time", "us", QP_KEY_TAG_TIME, (deInt64)batchedTime)
+							   << TestLog::Float("Speedup", "Speedup of batched interpolation", "", QP_KEY_TAG_NONE, (float)scalarTime / (float)de::max<deUint64>(batchedTime, 1));
+		}
+
+		{
+			int numFailed = 0;
+
+			for (int ndx = 0; ndx < (int)reference.size(); ndx++)
+			{
+				// \note Allow for compilers contracting the per-fragment path into fused multiply-adds
+				if (de::abs(reference[ndx] - result[ndx]) > 1.0e-5f * (1.0f + de::abs(reference[ndx])))
+				{
+					if (numFailed < 10)
+						m_testCtx.getLog() << TestLog::Message << "ERROR: Value " << ndx << ": expected " << reference[ndx] << ", got " << result[ndx] << TestLog::EndMessage;
+
+					numFailed += 1;
+				}
+			}
+
+			if (numFailed == 0)
+				m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+			else
+				m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Batched interpolation result differs");
+		}
+
+		return STOP;
+	}
+
+private:
+	const int m_numVertices;
+};
+
+class FragmentOperationsFastPathTest : public tcu::TestCase
+{
+public:
+	FragmentOperationsFastPathTest (tcu::TestContext& testCtx, const char* name, const tcu::TextureFormat& colorFormat, const tcu::TextureFormat& depthFormat)
+		: tcu::TestCase		(testCtx, name, "Format-specialized fragment operations produce same buffer contents as generic ones")
+		, m_colorFormat		(colorFormat)
+		, m_depthFormat		(depthFormat)
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		const int				width				= 16;
+		const int				height				= 16;
+		const int				numIterations		= 100;
+		const int				sampleCounts[]		= { 1, 4 };
+		const bool				hasDepth			= m_depthFormat.order == tcu::TextureFormat::D;
+		de::Random				rnd					(deStringHash(getName()));
+		rr::FragmentProcessor	fastProcessor;
+		rr::FragmentProcessor	genericProcessor;
+		int						numFailed			= 0;
+
+		genericProcessor.setFastPathsEnabled(false);
+
+		for (int sampleCountNdx = 0; sampleCountNdx < DE_LENGTH_OF_ARRAY(sampleCounts); sampleCountNdx++)
+		for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+		{
+			const int							numSamples		= sampleCounts[sampleCountNdx];
+			const rr::FragmentOperationState	state			= generateState(rnd, hasDepth);
+			tcu::TextureLevel					fastColor		(m_colorFormat, numSamples, width, height);
+			tcu::TextureLevel					genericColor	(m_colorFormat, numSamples, width, height);
+			tcu::TextureLevel					fastDepth;
+			tcu::TextureLevel					genericDepth;
+			vector<float>						initialDepths	(numSamples * width * height);
+			const bool							premultiplied	= state.blendMode == rr::BLENDMODE_ADVANCED;
+
+			for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+			for (int s = 0; s < numSamples; s++)
+				fastColor.getAccess().setPixel(randomColor(rnd, premultiplied), s, x, y);
+
+			tcu::copy(genericColor.getAccess(), fastColor.getAccess());
+
+			if (hasDepth)
+			{
+				fastDepth.setStorage(m_depthFormat, numSamples, width, height);
+				genericDepth.setStorage(m_depthFormat, numSamples, width, height);
+
+				for (int y = 0; y < height; y++)
+				for (int x = 0; x < width; x++)
+				for (int s = 0; s < numSamples; s++)
+				{
+					const float depth = rnd.getFloat();
+
+					initialDepths[(y*width + x)*numSamples + s] = depth;
+					fastDepth.getAccess().setPixDepth(depth, s, x, y);
+				}
+
+				tcu::copy(genericDepth.getAccess(), fastDepth.getAccess());
+			}
+
+			{
+				const int				numFragments	= rnd.getInt(1, width*height);
+				vector<int>				pixelNdx		(width*height);
+				vector<float>			sampleDepths	(numFragments*numSamples);
+				vector<rr::Fragment>	fragments;
+
+				for (int ndx = 0; ndx < (int)pixelNdx.size(); ndx++)
+					pixelNdx[ndx] = ndx;
+
+				rnd.shuffle(pixelNdx.begin(), pixelNdx.end());
+
+				for (int fragNdx = 0; fragNdx < numFragments; fragNdx++)
+				{
+					const tcu::IVec2	pixelCoord	(pixelNdx[fragNdx] % width, pixelNdx[fragNdx] / width);
+					const deUint32		coverage	= rnd.getUint32() & ((1u << numSamples) - 1u);
+
+					for (int s = 0; s < numSamples; s++)
+					{
+						// Some samples have the depth already in the buffer to exercise equality tests
+						sampleDepths[fragNdx*numSamples + s] = rnd.getBool() ? initialDepths[pixelNdx[fragNdx]*numSamples + s] : rnd.getFloat(-0.1f, 1.1f);
+					}
+
+					fragments.push_back(rr::Fragment(pixelCoord, rr::GenericVec4(randomColor(rnd, premultiplied)), rr::GenericVec4(randomColor(rnd, premultiplied)), coverage, &sampleDepths[fragNdx*numSamples]));
+				}
+
+				fastProcessor.render(rr::MultisamplePixelBufferAccess::fromMultisampleAccess(fastColor.getAccess()),
+									 hasDepth ? rr::MultisamplePixelBufferAccess::fromMultisampleAccess(fastDepth.getAccess()) : rr::MultisamplePixelBufferAccess(),
+									 rr::MultisamplePixelBufferAccess(),
+									 &fragments[0], numFragments, rr::FACETYPE_FRONT, state);
+				genericProcessor.render(rr::MultisamplePixelBufferAccess::fromMultisampleAccess(genericColor.getAccess()),
+										hasDepth ? rr::MultisamplePixelBufferAccess::fromMultisampleAccess(genericDepth.getAccess()) : rr::MultisamplePixelBufferAccess(),
+										rr::MultisamplePixelBufferAccess(),
+										&fragments[0], numFragments, rr::FACETYPE_FRONT, state);
+			}
+
+			{
+				const bool	colorMatch	= isBitExact(fastColor.getAccess(), genericColor.getAccess());
+				const bool	depthMatch	= !hasDepth || isBitExact(fastDepth.getAccess(), genericDepth.getAccess());
+
+				if (!colorMatch || !depthMatch)
+				{
+					m_testCtx.getLog() << TestLog::Message << "ERROR: " << numSamples << " sample(s), iteration " << iterNdx << ": "
+									   << (colorMatch ? "" : "color ") << (depthMatch ? "" : "depth ") << "buffer contents differ" << TestLog::EndMessage;
+					numFailed += 1;
+				}
+			}
+		}
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Buffer contents differ");
+
+		return STOP;
+	}
+
+private:
+	static tcu::Vec4 randomColor (de::Random& rnd, bool premultiplied)
+	{
+		// Advanced blending requires premultiplied colors, otherwise out-of-range values exercise clamping
+		if (premultiplied)
+		{
+			const float alpha = rnd.getFloat();
+
+			return tcu::Vec4(rnd.getFloat() * alpha, rnd.getFloat() * alpha, rnd.getFloat() * alpha, alpha);
+		}
+		else
+			return tcu::Vec4(rnd.getFloat(-0.5f, 1.5f), rnd.getFloat(-0.5f, 1.5f), rnd.getFloat(-0.5f, 1.5f), rnd.getFloat(-0.5f, 1.5f));
+	}
+
+	static rr::FragmentOperationState generateState (de::Random& rnd, bool hasDepth)
+	{
+		rr::FragmentOperationState state;
+
+		state.blendMode = (rr::BlendMode)rnd.getInt(0, rr::BLENDMODE_LAST-1);
+
+		if (state.blendMode == rr::BLENDMODE_STANDARD)
+		{
+			state.blendRGBState.equation	= (rr::BlendEquation)rnd.getInt(0, rr::BLENDEQUATION_LAST-1);
+			state.blendRGBState.srcFunc		= (rr::BlendFunc)rnd.getInt(0, rr::BLENDFUNC_LAST-1);
+			state.blendRGBState.dstFunc		= (rr::BlendFunc)rnd.getInt(0, rr::BLENDFUNC_LAST-1);
+			state.blendAState.equation		= (rr::BlendEquation)rnd.getInt(0, rr::BLENDEQUATION_LAST-1);
+			state.blendAState.srcFunc		= (rr::BlendFunc)rnd.getInt(0, rr::BLENDFUNC_LAST-1);
+			state.blendAState.dstFunc		= (rr::BlendFunc)rnd.getInt(0, rr::BLENDFUNC_LAST-1);
+			state.blendColor				= tcu::Vec4(rnd.getFloat(), rnd.getFloat(), rnd.getFloat(), rnd.getFloat());
+		}
+		else if (state.blendMode == rr::BLENDMODE_ADVANCED)
+			state.blendEquationAdvaced = (rr::BlendEquationAdvanced)rnd.getInt(0, rr::BLENDEQUATION_ADVANCED_LAST-1);
+
+		if (rnd.getBool())
+			state.colorMask = tcu::BVec4(rnd.getBool(), rnd.getBool(), rnd.getBool(), rnd.getBool());
+
+		if (hasDepth)
+		{
+			state.depthTestEnabled	= rnd.getFloat() < 0.8f;
+			state.depthFunc			= (rr::TestFunc)rnd.getInt(0, rr::TESTFUNC_LAST-1);
+			state.depthMask			= rnd.getBool();
+		}
+
+		return state;
+	}
+
+	static bool isBitExact (const tcu::ConstPixelBufferAccess& a, const tcu::ConstPixelBufferAccess& b)
+	{
+		const size_t size = (size_t)(a.getFormat().getPixelSize() * a.getWidth() * a.getHeight() * a.getDepth());
+
+		return deMemCmp(a.getDataPtr(), b.getDataPtr(), size) == 0;
+	}
+
+	const tcu::TextureFormat	m_colorFormat;
+	const tcu::TextureFormat	m_depthFormat;
+};
+
+enum TriangleShape
+{
+	TRIANGLESHAPE_EDGE_ON = 0,	//!< All vertices on one line
+	TRIANGLESHAPE_SLIVER,		//!< Long triangle narrower than a pixel
+	TRIANGLESHAPE_LARGE,		//!< Arbitrary triangle, mostly larger than rasterizer blocks
+
+	TRIANGLESHAPE_LAST
+};
+
+class TriangleCoverageTest : public tcu::TestCase
+{
+public:
+	TriangleCoverageTest (tcu::TestContext& testCtx, const char* name, TriangleShape shape, int numSamples)
+		: tcu::TestCase		(testCtx, name, "Hierarchical triangle rasterization produces same fragment packets as per-sample tests")
+		, m_shape			(shape)
+		, m_numSamples		(numSamples)
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		const int		numIterations	= 200;
+		de::Random		rnd				(deStringHash(getName()));
+		int				numFailed		= 0;
+		int				numCovered		= 0;
+
+		for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+		{
+			// Odd viewport sizes exercise packets extending past viewport edge
+			const tcu::IVec4		viewport	(rnd.getInt(0, 3), rnd.getInt(0, 3), rnd.getInt(40, 67), rnd.getInt(40, 67));
+			rr::RasterizationState	state;
+			tcu::Vec4				vertices[3];
+
+			state.horizontalFill		= rnd.getBool() ? rr::FILL_LEFT : rr::FILL_RIGHT;
+			state.verticalFill			= rnd.getBool() ? rr::FILL_BOTTOM : rr::FILL_TOP;
+			state.viewportOrientation	= rnd.getBool() ? rr::VIEWPORTORIENTATION_LOWER_LEFT : rr::VIEWPORTORIENTATION_UPPER_LEFT;
+
+			generateTriangle(rnd, viewport, vertices);
+
+			{
+				const vector<Packet>	reference	= rasterize(viewport, state, vertices, false);
+				const vector<Packet>	result		= rasterize(viewport, state, vertices, true);
+				const int				mismatchNdx	= findMismatch(reference, result);
+
+				if (mismatchNdx >= 0)
+				{
+					m_testCtx.getLog() << TestLog::Message << "ERROR: Iteration " << iterNdx << ": triangle " << vertices[0] << ", " << vertices[1] << ", " << vertices[2]
+									   << ": got " << result.size() << " packets, expected " << reference.size() << ", first mismatch at packet " << mismatchNdx << TestLog::EndMessage;
+					numFailed += 1;
+				}
+
+				if (!reference.empty())
+					numCovered += 1;
+			}
+		}
+
+		m_testCtx.getLog() << TestLog::Message << numCovered << " of " << numIterations << " triangles covered samples" << TestLog::EndMessage;
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Fragment packets differ");
+
+		return STOP;
+	}
+
+private:
+	struct Packet
+	{
+		rr::FragmentPacket	packet;
+		float				depths[4];
+	};
+
+	void generateTriangle (de::Random& rnd, const tcu::IVec4& viewport, tcu::Vec4* vertices) const
+	{
+		// Vertices may be outside viewport
+		const tcu::Vec2	min	= viewport.swizzle(0, 1).asFloat() - 8.0f;
+		const tcu::Vec2	max	= (viewport.swizzle(0, 1) + viewport.swizzle(2, 3)).asFloat() + 8.0f;
+
+		for (int ndx = 0; ndx < 3; ndx++)
+		{
+			vertices[ndx] = tcu::Vec4(rnd.getFloat(min.x(), max.x()), rnd.getFloat(min.y(), max.y()), rnd.getFloat(), rnd.getFloat(0.5f, 2.0f));
+
+			// Pixel and sample aligned coordinates hit edge function ties
+			if (rnd.getFloat() < 0.3f)
+			{
+				vertices[ndx].x() = deFloatFloor(vertices[ndx].x() * 4.0f) / 4.0f;
+				vertices[ndx].y() = deFloatFloor(vertices[ndx].y() * 4.0f) / 4.0f;
+			}
+		}
+
+		if (m_shape == TRIANGLESHAPE_EDGE_ON)
+		{
+			const float t = rnd.getFloat();
+
+			vertices[2].x() = vertices[0].x() + t * (vertices[1].x() - vertices[0].x());
+			vertices[2].y() = vertices[0].y() + t * (vertices[1].y() - vertices[0].y());
+
+			// Axis-aligned lines lie exactly on sample rows or columns
+			if (rnd.getBool())
+			{
+				const int axis = rnd.getInt(0, 1);
+
+				vertices[1][axis] = vertices[0][axis];
+				vertices[2][axis] = vertices[0][axis];
+			}
+		}
+		else if (m_shape == TRIANGLESHAPE_SLIVER)
+		{
+			const tcu::Vec2	dir			= vertices[1].swizzle(0, 1) - vertices[0].swizzle(0, 1);
+			const tcu::Vec2	normal		= tcu::length(dir) > 0.0f ? tcu::normalize(tcu::Vec2(-dir.y(), dir.x())) : tcu::Vec2(0.0f);
+			const tcu::Vec2	midpoint	= (vertices[0].swizzle(0, 1) + vertices[1].swizzle(0, 1)) * 0.5f + normal * rnd.getFloat(-0.5f, 0.5f);
+
+			vertices[2].x() = midpoint.x();
+			vertices[2].y() = midpoint.y();
+		}
+	}
+
+	vector<Packet> rasterize (const tcu::IVec4& viewport, const rr::RasterizationState& state, const tcu::Vec4* vertices, bool hierarchical) const
+	{
+		// Small batches exercise resuming rasterization mid-block
+		const int					maxPackets	= 7;
+		rr::TriangleRasterizer		rasterizer	(viewport, m_numSamples, state);
+		rr::FragmentPacket			packets		[maxPackets];
+		vector<float>				depths		(maxPackets * 4 * m_numSamples);
+		vector<Packet>				result;
+
+		rasterizer.setHierarchicalEnabled(hierarchical);
+		rasterizer.init(vertices[0], vertices[1], vertices[2]);
+
+		for (;;)
+		{
+			int numPackets = 0;
+
+			rasterizer.rasterize(&packets[0], &depths[0], maxPackets, numPackets);
+
+			if (numPackets == 0)
+				break;
+
+			for (int packetNdx = 0; packetNdx < numPackets; packetNdx++)
+			{
+				Packet packet;
+
+				packet.packet = packets[packetNdx];
+
+				// Compare depth of first sample of each fragment
+				for (int fragNdx = 0; fragNdx < 4; fragNdx++)
+					packet.depths[fragNdx] = depths[(packetNdx*4 + fragNdx) * m_numSamples];
+
+				result.push_back(packet);
+			}
+		}
+
+		return result;
+	}
+
+	static int findMismatch (const vector<Packet>& reference, const vector<Packet>& result)
+	{
+		for (size_t ndx = 0; ndx < de::min(reference.size(), result.size()); ndx++)
+		{
+			const rr::FragmentPacket&	a	= reference[ndx].packet;
+			const rr::FragmentPacket&	b	= result[ndx].packet;
+
+			if (a.position != b.position ||
+				a.coverage != b.coverage ||
+				deMemCmp(&a.barycentric[0], &b.barycentric[0], sizeof(a.barycentric)) != 0 ||
+				deMemCmp(&reference[ndx].depths[0], &result[ndx].depths[0], sizeof(reference[ndx].depths)) != 0)
+				return (int)ndx;
+		}
+
+		return reference.size() == result.size() ? -1 : (int)de::min(reference.size(), result.size());
+	}
+
+	const TriangleShape	m_shape;
+	const int			m_numSamples;
+};
+
+enum IntervalOp
+{
+	INTERVALOP_ADD = 0,
+	INTERVALOP_SUB,
+	INTERVALOP_MUL,
+	INTERVALOP_DIV,
+
+	INTERVALOP_LAST
+};
+
+// Operation evaluated in the current rounding mode. Volatile operands keep the
+// compiler from sharing one result between the two TCU_SET_INTERVAL bodies.
+double legacyPointOp (IntervalOp op, double x, double y)
+{
+	volatile double a = x;
+	volatile double b = y;
+
+	switch (op)
+	{
+		case INTERVALOP_ADD:	return a + b;
+		case INTERVALOP_SUB:	return a - b;
+		case INTERVALOP_MUL:	return a * b;
+		case INTERVALOP_DIV:	return a / b;
+		default:
+			DE_ASSERT(false);
+			return 0.0;
+	}
+}
+
+// Interval operations as implemented with rounding mode switches, for comparison
+tcu::Interval legacyIntervalOp (IntervalOp op, const tcu::Interval& x, const tcu::Interval& y)
+{
+	using tcu::Interval;
+
+	Interval ret;
+
+	if (op == INTERVALOP_ADD)
+	{
+		if (!x.empty() && !y.empty())
+			TCU_SET_INTERVAL_BOUNDS(ret, p,
+									p = legacyPointOp(op, x.lo(), y.lo()),
+									p = legacyPointOp(op, x.hi(), y.hi()));
+		if (x.hasNaN() || y.hasNaN())
+			ret |= TCU_NAN;
+	}
+	else if (op == INTERVALOP_DIV && y.contains(0.0))
+		ret = Interval::unbounded();
+	else
+		TCU_INTERVAL_APPLY_MONOTONE2(ret, xp, x, yp, y, val,
+									 TCU_SET_INTERVAL(val, point, point = legacyPointOp(op, xp, yp)));
+
+	return ret;
+}
+
+double randomIntervalBound (de::Random& rnd)
+{
+	switch (rnd.getInt(0, 9))
+	{
+		case 0:		return rnd.getBool() ? 0.0 : -0.0;
+		case 1:		return rnd.getBool() ? TCU_INFINITY : -TCU_INFINITY;
+		case 2:		return (double)rnd.getInt(-16, 16);
+		case 3:
+		{
+			// Any finite double, including denormals and values that overflow
+			const double mantissa = rnd.getDouble(-1.0, 1.0);
+			return std::ldexp(mantissa, rnd.getInt(-1074, 1024));
+		}
+		case 4:		return (double)rnd.getFloat(-1.0e-30f, 1.0e-30f);
+		default:	return (double)rnd.getFloat(-100.0f, 100.0f);
+	}
+}
+
+bool isBitExact (const tcu::Interval& a, const tcu::Interval& b)
+{
+	const double aBounds[] = { a.lo(), a.hi() };
+	const double bBounds[] = { b.lo(), b.hi() };
+
+	return a.hasNaN() == b.hasNaN() && deMemCmp(aBounds, bBounds, sizeof(aBounds)) == 0;
+}
+
+class IntervalArithmeticBenchmark : public tcu::TestCase
+{
+public:
+	IntervalArithmeticBenchmark (tcu::TestContext& testCtx)
+		: tcu::TestCase(testCtx, "interval_arithmetic_benchmark", "Compare interval arithmetic against rounding mode switching implementation")
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		using tcu::Interval;
+
+		const int				numValues		= 4096;
+		const int				numIterations	= 64;
+		const char* const		opNames[]		= { "Add", "Sub", "Mul", "Div" };
+		de::Random				rnd				(deStringHash(getName()));
+		vector<Interval>		x				(numValues);
+		vector<Interval>		y				(numValues);
+		vector<Interval>		reference		(numValues);
+		vector<Interval>		scalarResult	(numValues);
+		int						numFailed		= 0;
+
+		DE_STATIC_ASSERT(DE_LENGTH_OF_ARRAY(opNames) == INTERVALOP_LAST);
+
+		for (int ndx = 0; ndx < numValues; ndx++)
+		{
+			Interval* const dst[] = { &x[ndx], &y[ndx] };
+
+			for (int argNdx = 0; argNdx < DE_LENGTH_OF_ARRAY(dst); argNdx++)
+			{
+				const double a = randomIntervalBound(rnd);
+				const double b = rnd.getInt(0, 3) == 0 ? a : randomIntervalBound(rnd);
+
+				switch (rnd.getInt(0, 15))
+				{
+					case 0:		*dst[argNdx] = Interval();												break;
+					case 1:		*dst[argNdx] = Interval(TCU_NAN);										break;
+					case 2:		*dst[argNdx] = Interval(true, de::min(a, b), de::max(a, b));			break;
+					default:	*dst[argNdx] = Interval(false, de::min(a, b), de::max(a, b));			break;
+				}
+			}
+		}
+
+		for (int opNdx = 0; opNdx < INTERVALOP_LAST; opNdx++)
+		{
+			const IntervalOp		op				= (IntervalOp)opNdx;
+			deUint64				legacyTime		= 0;
+			deUint64				scalarTime		= 0;
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+				for (int ndx = 0; ndx < numValues; ndx++)
+					reference[ndx] = legacyIntervalOp(op, x[ndx], y[ndx]);
+
+				legacyTime = deGetMicroseconds() - startTime;
+			}
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+				for (int ndx = 0; ndx < numValues; ndx++)
+				{
+					switch (op)
+					{
+						case INTERVALOP_ADD:	scalarResult[ndx] = x[ndx] + y[ndx];	break;
+						case INTERVALOP_SUB:	scalarResult[ndx] = x[ndx] - y[ndx];	break;
+						case INTERVALOP_MUL:	scalarResult[ndx] = x[ndx] * y[ndx];	break;
+						case INTERVALOP_DIV:	scalarResult[ndx] = x[ndx] / y[ndx];	break;
+						default:
+							DE_ASSERT(false);
+					}
+				}
+
+				scalarTime = deGetMicroseconds() - startTime;
+			}
+
+			for (int ndx = 0; ndx < numValues; ndx++)
+			{
+				if (!isBitExact(reference[ndx], scalarResult[ndx]))
+				{
+					if (numFailed < 10)
+						m_testCtx.getLog() << TestLog::Message << "ERROR: " << opNames[opNdx] << " of " << x[ndx] << " and " << y[ndx]
+										   << ": expected " << reference[ndx] << ", got " << scalarResult[ndx] << TestLog::EndMessage;
+					numFailed += 1;
+				}
+			}
+
+			m_testCtx.getLog() << TestLog::Integer(string(opNames[opNdx]) + "LegacyTime", string(opNames[opNdx]) + " time with rounding mode switches", "us", QP_KEY_TAG_TIME, (deInt64)legacyTime)
+							   << TestLog::Integer(string(opNames[opNdx]) + "ScalarTime", string(opNames[opNdx]) + " time with Interval operator", "us", QP_KEY_TAG_TIME, (deInt64)scalarTime);
+		}
+
+		// -((x * y + x) / (y - x)) over the whole input arrays
+		{
+			tcu::IntervalExpr		expr			(2);
+			const int				xNode			= 0;
+			const int				yNode			= 1;
+			const Interval* const	inputs[]		= { &x[0], &y[0] };
+			vector<Interval>		batchResult		(numValues);
+			deUint64				legacyTime		= 0;
+			deUint64				scalarTime		= 0;
+			deUint64				batchTime		= 0;
+
+			expr.neg(expr.div(expr.add(expr.mul(xNode, yNode), xNode), expr.sub(yNode, xNode)));
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+				for (int ndx = 0; ndx < numValues; ndx++)
+				{
+					const Interval	num	= legacyIntervalOp(INTERVALOP_ADD, legacyIntervalOp(INTERVALOP_MUL, x[ndx], y[ndx]), x[ndx]);
+					const Interval	den	= legacyIntervalOp(INTERVALOP_SUB, y[ndx], x[ndx]);
+
+					reference[ndx] = -legacyIntervalOp(INTERVALOP_DIV, num, den);
+				}
+
+				legacyTime = deGetMicroseconds() - startTime;
+			}
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+				for (int ndx = 0; ndx < numValues; ndx++)
+					scalarResult[ndx] = -((x[ndx] * y[ndx] + x[ndx]) / (y[ndx] - x[ndx]));
+
+				scalarTime = deGetMicroseconds() - startTime;
+			}
+
+			{
+				const deUint64 startTime = deGetMicroseconds();
+
+				for (int iterNdx = 0; iterNdx < numIterations; iterNdx++)
+					expr.evaluate(inputs, &batchResult[0], numValues);
+
+				batchTime = deGetMicroseconds() - startTime;
+			}
+
+			for (int ndx = 0; ndx < numValues; ndx++)
+			{
+				if (!isBitExact(reference[ndx], scalarResult[ndx]) || !isBitExact(reference[ndx], batchResult[ndx]))
+				{
+					if (numFailed < 10)
+						m_testCtx.getLog() << TestLog::Message << "ERROR: Expression of " << x[ndx] << " and " << y[ndx] << ": expected " << reference[ndx]
+										   << ", got " << scalarResult[ndx] << " with operators and " << batchResult[ndx] << " with IntervalExpr" << TestLog::EndMessage;
+					numFailed += 1;
+				}
+			}
+
+			m_testCtx.getLog() << TestLog::Integer("ExprLegacyTime", "Expression time with rounding mode switches", "us", QP_KEY_TAG_TIME, (deInt64)legacyTime)
+							   << TestLog::Integer("ExprScalarTime", "Expression time with Interval operators", "us", QP_KEY_TAG_TIME, (deInt64)scalarTime)
+							   << TestLog::Integer("ExprBatchTime", "Expression time with IntervalExpr", "us", QP_KEY_TAG_TIME, (deInt64)batchTime);
+		}
+
+		// Evaluating in place, with an odd count that ends in a partial block
+		{
+			tcu::IntervalExpr		expr			(2);
+			const int				numInPlace		= numValues - 7;
+			vector<Interval>		inPlace			(x.begin(), x.begin() + numInPlace);
+			const Interval* const	inputs[]		= { &inPlace[0], &y[0] };
+
+			expr.sub(expr.mul(0, 1), 1);
+			expr.evaluate(inputs, &inPlace[0], (size_t)numInPlace);
+
+			for (int ndx = 0; ndx < numInPlace; ndx++)
+			{
+				const Interval expected = x[ndx] * y[ndx] - y[ndx];
+
+				if (!isBitExact(expected, inPlace[ndx]))
+				{
+					if (numFailed < 10)
+						m_testCtx.getLog() << TestLog::Message << "ERROR: In-place expression of " << x[ndx] << " and " << y[ndx] << ": expected " << expected
+										   << ", got " << inPlace[ndx] << TestLog::EndMessage;
+					numFailed += 1;
+				}
+			}
+		}
+
+		for (int ndx = 0; ndx < numValues; ndx++)
+		{
+			const double	value		= de::abs(randomIntervalBound(rnd));
+			const double	result[]	= { tcu::sqrtRoundDown(value), tcu::sqrtRoundUp(value) };
+			double			expected[2];
+
+			for (int dirNdx = 0; dirNdx < DE_LENGTH_OF_ARRAY(expected); dirNdx++)
+			{
+				const tcu::ScopedRoundingMode	ctx		(dirNdx == 0 ? DE_ROUNDINGMODE_TO_NEGATIVE_INF : DE_ROUNDINGMODE_TO_POSITIVE_INF);
+				volatile double					arg		= value;
+
+				expected[dirNdx] = std::sqrt(arg);
+			}
+
+			if (deMemCmp(expected, result, sizeof(expected)) != 0)
+			{
+				if (numFailed < 10)
+					m_testCtx.getLog() << TestLog::Message << "ERROR: Sqrt of " << value << ": expected [" << expected[0] << ", " << expected[1]
+									   << "], got [" << result[0] << ", " << result[1] << "]" << TestLog::EndMessage;
+				numFailed += 1;
+			}
+		}
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Results differ from rounding mode implementation");
+
+		return STOP;
+	}
+};
+
+class ParallelForCase : public tcu::TestCase
+{
+public:
+	ParallelForCase (tcu::TestContext& testCtx)
+		: tcu::TestCase(testCtx, "parallel_for", "tcu::parallelFor() executes every item exactly once")
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		const size_t		numItems		= 100000;
+		const int			threadCounts[]	= { 1, 2, 7, 32 };
+		const size_t		chunkSizes[]	= { 1, 100, 256, numItems * 2 };
+		const qpTestResult	errorResults[]	= { QP_TEST_RESULT_FAIL, QP_TEST_RESULT_NOT_SUPPORTED, QP_TEST_RESULT_RESOURCE_ERROR };
+		int					numFailed		= 0;
+
+		for (int threadNdx = 0; threadNdx < DE_LENGTH_OF_ARRAY(threadCounts); threadNdx++)
+		for (int chunkNdx = 0; chunkNdx < DE_LENGTH_OF_ARRAY(chunkSizes); chunkNdx++)
+		{
+			vector<deUint32>	counts	(numItems, 0u);
+			CountJob			job		(counts);
+
+			tcu::parallelFor(job, numItems, chunkSizes[chunkNdx], threadCounts[threadNdx]);
+
+			for (size_t ndx = 0; ndx < numItems; ndx++)
+			{
+				if (counts[ndx] != 1u)
+				{
+					m_testCtx.getLog() << TestLog::Message << "ERROR: " << threadCounts[threadNdx] << " thread(s), chunk size " << chunkSizes[chunkNdx]
+									   << ": item " << ndx << " executed " << counts[ndx] << " times" << TestLog::EndMessage;
+					numFailed += 1;
+					break;
+				}
+			}
+		}
+
+		for (int threadNdx = 0; threadNdx < DE_LENGTH_OF_ARRAY(threadCounts); threadNdx++)
+		for (int resultNdx = 0; resultNdx < DE_LENGTH_OF_ARRAY(errorResults); resultNdx++)
+		{
+			// Error is thrown in a worker thread unless calling thread is the only one
+			ThrowJob		job		(errorResults[resultNdx], threadCounts[threadNdx] == 1);
+			qpTestResult	caught	= QP_TEST_RESULT_LAST;
+
+			try
+			{
+				tcu::parallelFor(job, numItems, 64, threadCounts[threadNdx]);
+			}
+			catch (const tcu::NotSupportedError&)
+			{
+				caught = QP_TEST_RESULT_NOT_SUPPORTED;
+			}
+			catch (const tcu::ResourceError&)
+			{
+				caught = QP_TEST_RESULT_RESOURCE_ERROR;
+			}
+			catch (const tcu::TestError& e)
+			{
+				if (string(e.what()) == "Failure in item")
+					caught = QP_TEST_RESULT_FAIL;
+			}
+			catch (const std::exception&)
+			{
+			}
+
+			if (caught != errorResults[resultNdx])
+			{
+				m_testCtx.getLog() << TestLog::Message << "ERROR: Expected " << qpGetTestResultName(errorResults[resultNdx]) << " error with " << threadCounts[threadNdx] << " thread(s), got "
+								   << (caught != QP_TEST_RESULT_LAST ? qpGetTestResultName(caught) : "other or no error") << TestLog::EndMessage;
+				numFailed += 1;
+			}
+		}
+
+		{
+			vector<deUint32>	counts	(numItems, 0u);
+			NestedJob			job		(counts);
+
+			tcu::parallelFor(job, 16, 1, 4);
+
+			for (size_t ndx = 0; ndx < numItems; ndx++)
+			{
+				if (counts[ndx] != 1u)
+				{
+					m_testCtx.getLog() << TestLog::Message << "ERROR: Nested parallelFor(): item " << ndx << " executed " << counts[ndx] << " times" << TestLog::EndMessage;
+					numFailed += 1;
+					break;
+				}
+			}
+		}
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "parallelFor() failed");
+
+		return STOP;
+	}
+
+private:
+	class CountJob : public tcu::ParallelJob
+	{
+	public:
+						CountJob	(vector<deUint32>& counts) : m_counts(counts) {}
+
+		void			execute		(size_t begin, size_t end, int)
+		{
+			for (size_t ndx = begin; ndx < end; ndx++)
+				m_counts[ndx] += 1;
+		}
+
+	private:
+		vector<deUint32>&	m_counts;
+	};
+
+	class ThrowJob : public tcu::ParallelJob
+	{
+	public:
+						ThrowJob	(qpTestResult result, bool throwInCaller) : m_result(result), m_throwInCaller(throwInCaller), m_thrown(false) {}
+
+		void			execute		(size_t, size_t, int threadNdx)
+		{
+			if (threadNdx != 0 || m_throwInCaller)
+			{
+				m_thrown = true;
+
+				if (m_result == QP_TEST_RESULT_NOT_SUPPORTED)
+					throw tcu::NotSupportedError("Unsupported item");
+				else if (m_result == QP_TEST_RESULT_RESOURCE_ERROR)
+					throw tcu::ResourceError("Out of resources in item");
+				else
+					throw tcu::TestError("Failure in item");
+			}
+
+			// Give workers time to pick up a chunk
+			for (int waitNdx = 0; waitNdx < 1000 && !m_thrown; waitNdx++)
+				deSleep(1);
+		}
+
+	private:
+		const qpTestResult	m_result;
+		const bool			m_throwInCaller;
+		volatile bool		m_thrown;
+	};
+
+	//! Each item runs parallelFor() over its own part of counts
+	class NestedJob : public tcu::ParallelJob
+	{
+	public:
+						NestedJob	(vector<deUint32>& counts) : m_counts(counts) {}
+
+		void			execute		(size_t begin, size_t end, int)
+		{
+			for (size_t ndx = begin; ndx < end; ndx++)
+			{
+				vector<deUint32>	part	(m_counts.size() / 16, 0u);
+				CountJob			job		(part);
+
+				tcu::parallelFor(job, part.size(), 100, 4);
+
+				for (size_t partNdx = 0; partNdx < part.size(); partNdx++)
+					m_counts[ndx * part.size() + partNdx] = part[partNdx];
+			}
+		}
+
+	private:
+		vector<deUint32>&	m_counts;
+	};
+};
+
+class ShaderLibraryTestCase : public tcu::TestCase
+{
+public:
+	ShaderLibraryTestCase (tcu::TestContext& testCtx, const string& name, const string& description, const glu::sl::ShaderCaseSpecification& spec)
+		: tcu::TestCase	(testCtx, name.c_str(), description.c_str())
+		, m_spec		(spec)
+	{
+	}
+
+	const glu::sl::ShaderCaseSpecification&	getSpec		(void) const { return m_spec; }
+
+	IterateResult							iterate		(void) { TCU_THROW(InternalError, "Not executable"); }
+
+private:
+	const glu::sl::ShaderCaseSpecification	m_spec;
+};
+
+class ShaderLibraryTestCaseFactory : public glu::sl::ShaderCaseFactory
+{
+public:
+	ShaderLibraryTestCaseFactory (tcu::TestContext& testCtx)
+		: m_testCtx(testCtx)
+	{
+	}
+
+	tcu::TestCaseGroup* createGroup (const string& name, const string& description, const vector<tcu::TestNode*>& children)
+	{
+		return new tcu::TestCaseGroup(m_testCtx, name.c_str(), description.c_str(), children);
+	}
+
+	tcu::TestCase* createCase (const string& name, const string& description, const glu::sl::ShaderCaseSpecification& spec)
+	{
+		return new ShaderLibraryTestCase(m_testCtx, name, description, spec);
+	}
+
+private:
+	tcu::TestContext&	m_testCtx;
+};
+
+void describeValues (std::ostream& str, const char* storage, const vector<glu::sl::Value>& values)
+{
+	for (size_t valueNdx = 0; valueNdx < values.size(); valueNdx++)
+	{
+		const glu::sl::Value& value = values[valueNdx];
+
+		str << "  " << storage << " " << glu::declare(value.type, value.name) << " =";
+
+		for (size_t elemNdx = 0; elemNdx < value.elements.size(); elemNdx++)
+			str << " " << tcu::toHex(value.elements[elemNdx].int32);
+
+		str << "\n";
+	}
+}
+
+void describeSpec (std::ostream& str, const glu::sl::ShaderCaseSpecification& spec)
+{
+	str << " caseType " << spec.caseType
+		<< " expectResult " << spec.expectResult
+		<< " outputType " << spec.outputType
+		<< " outputFormat " << spec.outputFormat
+		<< " targetVersion " << spec.targetVersion << "\n";
+
+	for (size_t capNdx = 0; capNdx < spec.requiredCaps.size(); capNdx++)
+	{
+		const glu::sl::RequiredCapability& cap = spec.requiredCaps[capNdx];
+
+		if (cap.type == glu::sl::CAPABILITY_FLAG)
+			str << "  require flag " << cap.flagName << "\n";
+		else
+			str << "  require limit " << tcu::toHex(cap.enumName) << " >= " << cap.referenceValue << "\n";
+	}
+
+	describeValues(str, "input", spec.values.inputs);
+	describeValues(str, "output", spec.values.outputs);
+	describeValues(str, "uniform", spec.values.uniforms);
+
+	for (size_t programNdx = 0; programNdx < spec.programs.size(); programNdx++)
+	{
+		const glu::sl::ProgramSpecification& program = spec.programs[programNdx];
+
+		str << "  program " << programNdx << " separable " << program.sources.separable << " activeStages " << tcu::toHex(program.activeStages) << "\n";
+
+		for (size_t extNdx = 0; extNdx < program.requiredExtensions.size(); extNdx++)
+		{
+			str << "   extension " << tcu::toHex(program.requiredExtensions[extNdx].effectiveStages);
+
+			for (size_t altNdx = 0; altNdx < program.requiredExtensions[extNdx].alternatives.size(); altNdx++)
+				str << " " << program.requiredExtensions[extNdx].alternatives[altNdx];
+
+			str << "\n";
+		}
+
+		for (int shaderType = 0; shaderType < glu::SHADERTYPE_LAST; shaderType++)
+		{
+			for (size_t sourceNdx = 0; sourceNdx < program.sources.sources[shaderType].size(); sourceNdx++)
+				str << "   " << glu::getShaderTypeName((glu::ShaderType)shaderType) << "\n" << program.sources.sources[shaderType][sourceNdx] << "\n";
+		}
+	}
+}
+
+//! Describe node tree. Groups are initialized to populate lazily created children.
+void describeNodes (std::ostream& str, const vector<tcu::TestNode*>& nodes, const string& parentPath)
+{
+	for (size_t nodeNdx = 0; nodeNdx < nodes.size(); nodeNdx++)
+	{
+		tcu::TestNode* const	node	= nodes[nodeNdx];
+		const string			path	= parentPath + node->getName();
+
+		str << path << " \"" << node->getDescription() << "\"";
+
+		if (node->getNodeType() == tcu::NODETYPE_GROUP)
+		{
+			vector<tcu::TestNode*> children;
+
+			str << " group\n";
+
+			node->init();
+			node->getChildren(children);
+			describeNodes(str, children, path + ".");
+			node->deinit();
+		}
+		else
+		{
+			const ShaderLibraryTestCase* const testCase = dynamic_cast<const ShaderLibraryTestCase*>(node);
+
+			str << " case\n";
+
+			if (!testCase)
+				TCU_THROW(InternalError, "Case not created by factory");
+
+			describeSpec(str, testCase->getSpec());
+		}
+	}
+}
+
+void deleteNodes (vector<tcu::TestNode*>& nodes)
+{
+	for (size_t ndx = 0; ndx < nodes.size(); ndx++)
+		delete nodes[ndx];
+
+	nodes.clear();
+}
+
+class ShaderLibraryLoadCase : public tcu::TestCase
+{
+public:
+	ShaderLibraryLoadCase (tcu::TestContext& testCtx)
+		: tcu::TestCase(testCtx, "load_file", "glu::sl::loadFile() with and without cache produces same tree as glu::sl::parseFile()")
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		const string									filename	= "internal/data/shaderlibrary/library.test";
+		const string									cacheDir	= "shader-library-cache-test";
+		const de::SharedPtr<glu::sl::ShaderCaseFactory>	factory		(new ShaderLibraryTestCaseFactory(m_testCtx));
+		string											reference;
+		int												numFailed	= 0;
+
+		clearCache(cacheDir);
+
+		{
+			vector<tcu::TestNode*>	nodes	= glu::sl::parseFile(m_testCtx.getArchive(), filename, factory.get());
+			std::ostringstream		str;
+
+			try
+			{
+				describeNodes(str, nodes, "");
+			}
+			catch (...)
+			{
+				deleteNodes(nodes);
+				throw;
+			}
+
+			deleteNodes(nodes);
+			reference = str.str();
+		}
+
+		m_testCtx.getLog() << TestLog::Message << "Tree from parseFile():\n" << reference << TestLog::EndMessage;
+
+		{
+			const char* const	cacheDirs[]	= { DE_NULL, cacheDir.c_str(), cacheDir.c_str() };
+			const char* const	names[]		= { "without cache", "with empty cache", "with populated cache" };
+
+			for (int loadNdx = 0; loadNdx < DE_LENGTH_OF_ARRAY(cacheDirs); loadNdx++)
+			{
+				vector<tcu::TestNode*>	nodes	= glu::sl::loadFile(m_testCtx, filename, factory, cacheDirs[loadNdx]);
+				std::ostringstream		str;
+
+				try
+				{
+					describeNodes(str, nodes, "");
+				}
+				catch (...)
+				{
+					deleteNodes(nodes);
+					throw;
+				}
+
+				deleteNodes(nodes);
+
+				if (str.str() != reference)
+				{
+					m_testCtx.getLog() << TestLog::Message << "ERROR: Tree from loadFile() " << names[loadNdx] << " differs:\n" << str.str() << TestLog::EndMessage;
+					numFailed += 1;
+				}
+			}
+		}
+
+		if (countCacheEntries(cacheDir) != 1)
+		{
+			m_testCtx.getLog() << TestLog::Message << "ERROR: Expected one cache entry in " << cacheDir << TestLog::EndMessage;
+			numFailed += 1;
+		}
+
+		clearCache(cacheDir);
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Trees differ");
+
+		return STOP;
+	}
+
+private:
+	static int countCacheEntries (const string& cacheDir)
+	{
+		int numEntries = 0;
+
+		if (de::FilePath(cacheDir).exists())
+		{
+			for (de::DirectoryIterator iter (cacheDir); iter.hasItem(); iter.next())
+				numEntries += 1;
+		}
+
+		return numEntries;
+	}
+
+	static void clearCache (const string& cacheDir)
+	{
+		if (de::FilePath(cacheDir).exists())
+		{
+			for (de::DirectoryIterator iter (cacheDir); iter.hasItem(); iter.next())
+				deDeleteFile(iter.getItem().getPath());
+		}
+	}
+};
+
+class ShaderLibraryTests : public tcu::TestCaseGroup
+{
+public:
+	ShaderLibraryTests (tcu::TestContext& testCtx)
+		: tcu::TestCaseGroup(testCtx, "shader_library", "Shader library (.test) file tests")
+	{
+	}
+
+	void init (void)
+	{
+		addChild(new ShaderLibraryLoadCase(m_testCtx));
+	}
+};
+
+class CommonFrameworkTests : public tcu::TestCaseGroup
+{
+public:
+	CommonFrameworkTests (tcu::TestContext& testCtx)
+		: tcu::TestCaseGroup(testCtx, "common", "Tests for the common utility framework")
+	{
+	}
+
+	void init (void)
+	{
+		addChild(new SelfCheckCase(m_testCtx, "float_format","tcu::FloatFormat_selfTest()",
+								   tcu::FloatFormat_selfTest));
+		addChild(new SelfCheckCase(m_testCtx, "either","tcu::Either_selfTest()",
+								   tcu::Either_selfTest));
+		addChild(new IntervalArithmeticBenchmark(m_testCtx));
+		addChild(new ParallelForCase(m_testCtx));
+	}
+};
+
+class ReferenceRendererTests : public tcu::TestCaseGroup
+{
+public:
+	ReferenceRendererTests (tcu::TestContext& testCtx)
+		: tcu::TestCaseGroup(testCtx, "reference_renderer", "Reference renderer tests")
+	{
+	}
+
+	void init (void)
+	{
+		addChild(new ConstantInterpolationTest(m_testCtx));
+
+		{
+			static const struct
+			{
+				const char*			name;
+				rr::PrimitiveType	primitiveType;
+			} primitiveTypes[] =
+			{
+				{ "triangles",	rr::PRIMITIVETYPE_TRIANGLES	},
+				{ "lines",		rr::PRIMITIVETYPE_LINES		},
+				{ "points",		rr::PRIMITIVETYPE_POINTS	},
+			};
+			const int supportedMsaaLevels[] = { 1, 4 };
+
+			for (int primitiveNdx = 0; primitiveNdx < DE_LENGTH_OF_ARRAY(primitiveTypes); primitiveNdx++)
+			for (int msaaNdx = 0; msaaNdx < DE_LENGTH_OF_ARRAY(supportedMsaaLevels); msaaNdx++)
+			{
+				const string name = string("multithreaded_") + primitiveTypes[primitiveNdx].name + "_samples_" + de::toString(supportedMsaaLevels[msaaNdx]);
+				addChild(new MultithreadedRenderingTest(m_testCtx, name.c_str(), primitiveTypes[primitiveNdx].primitiveType, supportedMsaaLevels[msaaNdx]));
+			}
+		}
+
+		addChild(new VertexCacheTest(m_testCtx, "vertex_cache_triangles",		rr::PRIMITIVETYPE_TRIANGLES));
+		addChild(new VertexCacheTest(m_testCtx, "vertex_cache_triangle_strip",	rr::PRIMITIVETYPE_TRIANGLE_STRIP));
+		addChild(new VertexCacheTest(m_testCtx, "vertex_cache_lines",			rr::PRIMITIVETYPE_LINES));
+
+		addChild(new VaryingInterpolationBenchmark(m_testCtx, "batched_varying_interpolation_points",		1));
+		addChild(new VaryingInterpolationBenchmark(m_testCtx, "batched_varying_interpolation_lines",		2));
+		addChild(new VaryingInterpolationBenchmark(m_testCtx, "batched_varying_interpolation_triangles",	3));
+
+		{
+			static const struct
+			{
+				const char*				name;
+				tcu::TextureFormat		colorFormat;
+				tcu::TextureFormat		depthFormat;
+			} formats[] =
+			{
+				{ "rgba8",		tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::UNORM_INT8),	tcu::TextureFormat()																},
+				{ "rgba16f",	tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::HALF_FLOAT),	tcu::TextureFormat()																},
+				{ "rgba32f",	tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::FLOAT),		tcu::TextureFormat()																},
+				{ "d32f",		tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::UNORM_INT8),	tcu::TextureFormat(tcu::TextureFormat::D, tcu::TextureFormat::FLOAT)			},
+				{ "d24",		tcu::TextureFormat(tcu::TextureFormat::RGBA, tcu::TextureFormat::UNORM_INT8),	tcu::TextureFormat(tcu::TextureFormat::D, tcu::TextureFormat::UNORM_INT24)	},
+			};
+
+			for (int formatNdx = 0; formatNdx < DE_LENGTH_OF_ARRAY(formats); formatNdx++)
+			{
+				const string name = string("fragment_ops_fast_path_") + formats[formatNdx].name;
+				addChild(new FragmentOperationsFastPathTest(m_testCtx, name.c_str(), formats[formatNdx].colorFormat, formats[formatNdx].depthFormat));
+			}
+		}
+
+		{
+			static const struct
+			{
+				const char*		name;
+				TriangleShape	shape;
+			} shapes[] =
+			{
+				{ "edge_on",	TRIANGLESHAPE_EDGE_ON	},
+				{ "sliver",		TRIANGLESHAPE_SLIVER	},
+				{ "large",		TRIANGLESHAPE_LARGE		},
+			};
+			const int sampleCounts[] = { 1, 4, 16 };
+
+			for (int shapeNdx = 0; shapeNdx < DE_LENGTH_OF_ARRAY(shapes); shapeNdx++)
+			for (int sampleCountNdx = 0; sampleCountNdx < DE_LENGTH_OF_ARRAY(sampleCounts); sampleCountNdx++)
+			{
+				const string name = string("triangle_coverage_") + shapes[shapeNdx].name + "_samples_" + de::toString(sampleCounts[sampleCountNdx]);
+				addChild(new TriangleCoverageTest(m_testCtx, name.c_str(), shapes[shapeNdx].shape, sampleCounts[sampleCountNdx]));
+			}
+		}
 	}
 };
 
@@ -927,6 +2758,7 @@ void FrameworkTests::init (void)
 	addChild(new CommonFrameworkTests	(m_testCtx));
 	addChild(new CaseListParserTests	(m_testCtx));
 	addChild(new ReferenceRendererTests	(m_testCtx));
+	addChild(new ShaderLibraryTests		(m_testCtx));
 	addChild(createTextureFormatTests	(m_testCtx));
 	addChild(createAstcTests			(m_testCtx));
 	addChild(createVulkanTests			(m_testCtx));
@@ -23,8 +23,15 @@
 
 #include "ditTestLogTests.hpp"
 #include "tcuTestLog.hpp"
+#include "tcuSurface.hpp"
+#include "deRandom.hpp"
+#include "deClock.h"
+#include "deStringUtil.hpp"
+#include "deFile.h"
 
 #include <limits>
+#include <fstream>
+#include <iterator>
 
 namespace dit
 {
@@ -69,6 +76,131 @@ public:
 	}
 };
 
+class ImageEncodingBenchmark : public tcu::TestCase
+{
+public:
+	ImageEncodingBenchmark (tcu::TestContext& testCtx)
+		: TestCase(testCtx, "image_encoding_benchmark", "Measure image logging time with different encoder settings")
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		struct Config
+		{
+			const char*		name;
+			deUint32		flags;
+			int				compressionLevel;
+		};
+
+		static const Config s_configs[] =
+		{
+			{ "Default",		0,																	-1	},
+			{ "Threads",		QP_TEST_LOG_IMAGE_THREADS,											-1	},
+			{ "ThreadsAsync",	QP_TEST_LOG_IMAGE_THREADS|QP_TEST_LOG_ASYNC,						-1	},
+			{ "Level3",			0,																	3	},
+			{ "Fast",			QP_TEST_LOG_FAST_IMAGE_COMPRESSION,									-1	},
+			{ "FastThreads",	QP_TEST_LOG_FAST_IMAGE_COMPRESSION|QP_TEST_LOG_IMAGE_THREADS,		-1	},
+			{ "None",			QP_TEST_LOG_NO_IMAGE_COMPRESSION,									-1	},
+		};
+
+		const std::string	filename	= "test-log-image-benchmark.qpa";
+		const tcu::Surface	image		= createImage(256, 256);
+		TestLog&			log			= m_testCtx.getLog();
+		std::string			reference;
+		int					numFailed	= 0;
+
+		for (int configNdx = 0; configNdx < DE_LENGTH_OF_ARRAY(s_configs); configNdx++)
+		{
+			const Config&	config		= s_configs[configNdx];
+			deUint64		writeTime;
+
+			{
+				const deUint64	startTime	= deGetMicroseconds();
+				TestLog			benchLog	(filename.c_str(), config.flags);
+
+				if (config.compressionLevel >= 0)
+					benchLog.setImageCompressionLevel(config.compressionLevel);
+
+				writeCases(benchLog, image, 16, 4);
+
+				writeTime = deGetMicroseconds() - startTime;
+			}
+
+			{
+				const std::string	contents	= readFile(filename);
+				const std::string	name		= config.name;
+
+				// Encoder threads must not change output
+				if (config.flags == 0 && config.compressionLevel < 0)
+					reference = contents;
+				else if ((config.flags & ~(QP_TEST_LOG_IMAGE_THREADS|QP_TEST_LOG_ASYNC)) == 0 && config.compressionLevel < 0 && contents != reference)
+				{
+					log << TestLog::Message << "ERROR: " << name << " log differs from default log" << TestLog::EndMessage;
+					numFailed += 1;
+				}
+
+				log << TestLog::Integer(name + "Time", name + " log write time", "us", QP_KEY_TAG_TIME, (deInt64)writeTime)
+					<< TestLog::Integer(name + "Size", name + " log file size", "bytes", QP_KEY_TAG_NONE, (deInt64)contents.size());
+			}
+		}
+
+		deDeleteFile(filename.c_str());
+
+		if (numFailed == 0)
+			m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+		else
+			m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Log output differs");
+
+		return STOP;
+	}
+
+private:
+	static tcu::Surface createImage (int width, int height)
+	{
+		// Smooth gradients with some noise, roughly like a rendered result
+		tcu::Surface	image	(width, height);
+		de::Random		rnd		(0x5eed);
+
+		for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+		{
+			const int noise = rnd.getInt(0, 3);
+			image.setPixel(x, y, tcu::RGBA((x*255/width + noise) & 0xff, (y*255/height) & 0xff, ((x^y) & 0x20) ? 255 : noise, 255));
+		}
+
+		return image;
+	}
+
+	static void writeCases (TestLog& log, const tcu::Surface& image, int numCases, int numImagesPerCase)
+	{
+		for (int caseNdx = 0; caseNdx < numCases; caseNdx++)
+		{
+			const std::string casePath = "dit.testlog.image_encoding_benchmark.case" + de::toString(caseNdx);
+
+			log.startCase(casePath.c_str(), QP_TEST_CASE_TYPE_SELF_VALIDATE);
+			log << TestLog::ImageSet("Images", "Images");
+
+			for (int imageNdx = 0; imageNdx < numImagesPerCase; imageNdx++)
+				log << TestLog::Image("Image" + de::toString(imageNdx), "Image", image);
+
+			log << TestLog::EndImageSet
+				<< TestLog::Message << "Case " << caseNdx << " done" << TestLog::EndMessage;
+			log.endCase(QP_TEST_RESULT_PASS, "Pass");
+		}
+	}
+
+	static std::string readFile (const std::string& filename)
+	{
+		std::ifstream file (filename.c_str(), std::ios_base::binary);
+
+		if (!file.is_open())
+			throw tcu::ResourceError("Failed to open " + filename);
+
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+};
+
 TestLogTests::TestLogTests (tcu::TestContext& testCtx)
 	: TestCaseGroup(testCtx, "testlog", "Test Log Tests")
 {
@@ -81,6 +213,7 @@ TestLogTests::~TestLogTests (void)
 void TestLogTests::init (void)
 {
 	addChild(new BasicSampleListCase(m_testCtx));
+	addChild(new ImageEncodingBenchmark(m_testCtx));
 }
 
 } // dit
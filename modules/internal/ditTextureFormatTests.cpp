@@ -53,6 +53,8 @@ using tcu::PixelBufferAccess;
 using tcu::ConstPixelBufferAccess;
 using tcu::Vector;
 using tcu::IVec3;
+using tcu::Vec4;
+using tcu::IVec4;
 
 // Test data
 
@@ -1291,6 +1293,36 @@ void copyPixels (const ConstPixelBufferAccess& src, const PixelBufferAccess& dst
 		dst.setPixel(src.getPixelT<T>(ndx, 0, 0), ndx, 0, 0);
 }
 
+void copyPixelRow (const ConstPixelBufferAccess& src, const PixelBufferAccess& dst)
+{
+	const int numPixels = src.getWidth();
+
+	switch (getTextureChannelClass(dst.getFormat().type))
+	{
+		case tcu::TEXTURECHANNELCLASS_FLOATING_POINT:
+		case tcu::TEXTURECHANNELCLASS_SIGNED_FIXED_POINT:
+		case tcu::TEXTURECHANNELCLASS_UNSIGNED_FIXED_POINT:
+		{
+			vector<Vec4> row (numPixels);
+			src.getPixels(&row[0], numPixels, 0, 0);
+			dst.setPixels(&row[0], numPixels, 0, 0);
+			break;
+		}
+
+		case tcu::TEXTURECHANNELCLASS_SIGNED_INTEGER:
+		case tcu::TEXTURECHANNELCLASS_UNSIGNED_INTEGER:
+		{
+			vector<IVec4> row (numPixels);
+			src.getPixelsInt(&row[0], numPixels, 0, 0);
+			dst.setPixels(&row[0], numPixels, 0, 0);
+			break;
+		}
+
+		default:
+			DE_FATAL("Unknown channel class");
+	}
+}
+
 void copyGetSetDepth (const ConstPixelBufferAccess& src, const PixelBufferAccess& dst)
 {
 	for (int ndx = 0; ndx < src.getWidth(); ndx++)
@@ -1424,6 +1456,47 @@ protected:
 			verifyRead<deInt32>(src);
 	}
 
+	template<typename T>
+	void verifyReadRow (const ConstPixelBufferAccess& src, const vector<Vector<T, 4> >& res)
+	{
+		for (int pixelNdx = 0; pixelNdx < src.getWidth(); pixelNdx++)
+		{
+			const Vector<T, 4> ref = src.getPixelT<T>(pixelNdx, 0, 0);
+
+			if (!allComponentsEqual(res[pixelNdx], ref))
+			{
+				m_testCtx.getLog()
+					<< TestLog::Message << "ERROR: at pixel " << pixelNdx << ": expected " << ref << ", got " << res[pixelNdx] << TestLog::EndMessage;
+
+				m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Comparison failed");
+			}
+		}
+	}
+
+	void verifyReadRow (const ConstPixelBufferAccess& src)
+	{
+		const int	numPixels		= src.getWidth();
+		const bool	isFloat32Or64	= src.getFormat().type == tcu::TextureFormat::FLOAT ||
+									  src.getFormat().type == tcu::TextureFormat::FLOAT64;
+
+		m_testCtx.getLog()
+			<< TestLog::Message << "Verifying getPixels() and getPixelsInt() against getPixel() and getPixelInt()" << TestLog::EndMessage;
+
+		if (isAccessValid(src.getFormat(), tcu::TEXTUREACCESSTYPE_FLOAT))
+		{
+			vector<Vec4> res (numPixels);
+			src.getPixels(&res[0], numPixels, 0, 0);
+			verifyReadRow<float>(src, res);
+		}
+
+		if (isAccessValid(src.getFormat(), tcu::TEXTUREACCESSTYPE_SIGNED_INT) && !isFloat32Or64)
+		{
+			vector<IVec4> res (numPixels);
+			src.getPixelsInt(&res[0], numPixels, 0, 0);
+			verifyReadRow<deInt32>(src, res);
+		}
+	}
+
 	void verifyGetPixDepth (const ConstPixelBufferAccess& refAccess, const ConstPixelBufferAccess& combinedAccess)
 	{
 		m_testCtx.getLog()
@@ -1502,6 +1575,7 @@ public:
 		verifyInfoQueries();
 
 		verifyRead(inputAccess);
+		verifyReadRow(inputAccess);
 
 		// \todo [2015-10-12 pyry] Handle lossy conversion with *NORM_INT32
 		if (m_format.type != TextureFormat::UNORM_INT32 && m_format.type != TextureFormat::SNORM_INT32)
@@ -1509,6 +1583,10 @@ public:
 			m_testCtx.getLog() << TestLog::Message << "Copying with getPixel() -> setPixel()" << TestLog::EndMessage;
 			copyPixels(inputAccess, tmpAccess);
 			verifyRead(tmpAccess);
+
+			m_testCtx.getLog() << TestLog::Message << "Copying with getPixels() -> setPixels()" << TestLog::EndMessage;
+			copyPixelRow(inputAccess, tmpAccess);
+			verifyRead(tmpAccess);
 		}
 
 		return STOP;
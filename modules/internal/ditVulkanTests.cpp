@@ -25,17 +25,244 @@
 #include "ditTestCase.hpp"
 
 #include "vkImageUtil.hpp"
+#include "vkShaderCache.hpp"
+
+#include "tcuTestLog.hpp"
 
 #include "deUniquePtr.hpp"
+#include "deRandom.hpp"
+#include "deStringUtil.hpp"
+#include "deFile.h"
+
+#include <fstream>
+#include <vector>
 
 namespace dit
 {
 
+namespace
+{
+
+using tcu::TestLog;
+using std::string;
+using std::vector;
+
+class ShaderCacheCase : public tcu::TestCase
+{
+public:
+	ShaderCacheCase (tcu::TestContext& testCtx)
+		: tcu::TestCase(testCtx, "shader_cache", "Runtime shader cache persistence and recovery")
+	{
+	}
+
+	IterateResult iterate (void)
+	{
+		// More than one automatic index commit happens while storing
+		const int			numCommitted	= 2500;
+		const int			numTail			= 100;
+		const string		filename		= "shader-cache-test.bin";
+		de::Random			rnd				(0x5c0ffee);
+		vector<Record>		records;
+
+		for (int ndx = 0; ndx < numCommitted + numTail; ndx++)
+		{
+			Record record;
+
+			record.key = "shader " + de::toString(ndx) + string((size_t)rnd.getInt(0, 40), 'x');
+			record.binary.resize((size_t)rnd.getInt(1, 300));
+
+			for (size_t byteNdx = 0; byteNdx < record.binary.size(); byteNdx++)
+				record.binary[byteNdx] = rnd.getUint8();
+
+			records.push_back(record);
+		}
+
+		deleteFiles(filename);
+		m_testCtx.setTestResult(QP_TEST_RESULT_PASS, "Pass");
+
+		// Write and commit
+		{
+			vk::ShaderCache cache (filename, false);
+
+			store(cache, records, 0, numCommitted);
+			check(cache, records, numCommitted, "After store");
+			cache.commit();
+		}
+
+		// Reopen from index, append without commit
+		{
+			vk::ShaderCache cache (filename, false);
+
+			check(cache, records, numCommitted, "Reopened");
+			store(cache, records, numCommitted, numTail);
+		}
+
+		// Uncommitted records are recovered from data file tail
+		{
+			vk::ShaderCache cache (filename, false);
+
+			check(cache, records, numCommitted + numTail, "Reopened without commit");
+		}
+
+		// Last record partially written, store it again
+		truncateFile(filename, getFileSize(filename) - 5);
+
+		{
+			vk::ShaderCache cache (filename, false);
+
+			check(cache, records, numCommitted + numTail - 1, "Truncated last record");
+			store(cache, records, numCommitted + numTail - 1, 1);
+			check(cache, records, numCommitted + numTail, "Stored again");
+			cache.commit();
+		}
+
+		// Record stored after the partial one is found through index
+		{
+			vk::ShaderCache cache (filename, false);
+
+			check(cache, records, numCommitted + numTail, "Reopened after partial record");
+		}
+
+		// Data file shorter than index, index is ignored and data file scanned
+		truncateFile(filename, getFileSize(filename) / 2);
+
+		{
+			vk::ShaderCache	cache		(filename, false);
+			int				numFound	= 0;
+
+			while (numFound < (int)records.size() && load(cache, records[numFound]))
+				numFound += 1;
+
+			if (numFound == 0 || numFound == (int)records.size())
+				fail("Truncated data file: expected part of records to be found, found " + de::toString(numFound));
+
+			for (int ndx = numFound; ndx < (int)records.size(); ndx++)
+			{
+				if (load(cache, records[ndx]))
+				{
+					fail("Truncated data file: found record " + de::toString(ndx) + " after missing record " + de::toString(numFound));
+					break;
+				}
+			}
+		}
+
+		// Truncate on open starts over
+		{
+			vk::ShaderCache cache (filename, true);
+
+			check(cache, records, 0, "Truncated on open");
+			store(cache, records, 0, 1);
+		}
+
+		{
+			vk::ShaderCache cache (filename, false);
+
+			check(cache, records, 1, "Rebuilt");
+		}
+
+		// Two writers, second one opened before first one commits
+		{
+			vk::ShaderCache	first	(filename, false);
+			vk::ShaderCache	second	(filename, false);
+
+			for (int ndx = 1; ndx < 1 + numTail; ndx++)
+				store(ndx % 2 ? first : second, records, ndx, 1);
+
+			first.commit();
+			second.commit();
+		}
+
+		{
+			vk::ShaderCache cache (filename, false);
+
+			check(cache, records, 1 + numTail, "Two writers");
+		}
+
+		deleteFiles(filename);
+
+		return STOP;
+	}
+
+private:
+	struct Record
+	{
+		string				key;
+		vector<deUint8>		binary;
+	};
+
+	static void store (vk::ShaderCache& cache, const vector<Record>& records, int first, int count)
+	{
+		for (int ndx = first; ndx < first + count; ndx++)
+			cache.store(vk::ProgramBinary(vk::PROGRAM_FORMAT_SPIRV, records[ndx].binary.size(), &records[ndx].binary[0]), records[ndx].key);
+	}
+
+	static bool load (const vk::ShaderCache& cache, const Record& record)
+	{
+		const de::UniquePtr<vk::ProgramBinary> binary (cache.load(record.key));
+
+		return binary &&
+			   binary->getFormat() == vk::PROGRAM_FORMAT_SPIRV &&
+			   binary->getSize() == record.binary.size() &&
+			   deMemCmp(binary->getBinary(), &record.binary[0], record.binary.size()) == 0;
+	}
+
+	//! Check that exactly the first numStored records are found.
+	void check (const vk::ShaderCache& cache, const vector<Record>& records, int numStored, const string& step)
+	{
+		for (int ndx = 0; ndx < (int)records.size(); ndx++)
+		{
+			if (load(cache, records[ndx]) != (ndx < numStored))
+			{
+				fail(step + ": record " + de::toString(ndx) + (ndx < numStored ? " not found or differs" : " found but not stored"));
+				break;
+			}
+		}
+	}
+
+	void fail (const string& message)
+	{
+		m_testCtx.getLog() << TestLog::Message << "ERROR: " << message << TestLog::EndMessage;
+		m_testCtx.setTestResult(QP_TEST_RESULT_FAIL, "Cache contents differ");
+	}
+
+	static deInt64 getFileSize (const string& filename)
+	{
+		std::ifstream in (filename.c_str(), std::ios::binary | std::ios::ate);
+
+		return in.is_open() ? (deInt64)in.tellg() : 0;
+	}
+
+	static void truncateFile (const string& filename, deInt64 size)
+	{
+		vector<char> data ((size_t)size);
+
+		{
+			std::ifstream in (filename.c_str(), std::ios::binary);
+			in.read(&data[0], (std::streamsize)size);
+		}
+
+		{
+			std::ofstream out (filename.c_str(), std::ios::binary | std::ios::trunc);
+			out.write(&data[0], (std::streamsize)size);
+		}
+	}
+
+	static void deleteFiles (const string& filename)
+	{
+		deDeleteFile(filename.c_str());
+		deDeleteFile((filename + ".idx").c_str());
+		deDeleteFile((filename + ".lock").c_str());
+	}
+};
+
+} // anonymous
+
 tcu::TestCaseGroup* createVulkanTests (tcu::TestContext& testCtx)
 {
 	de::MovePtr<tcu::TestCaseGroup>	group	(new tcu::TestCaseGroup(testCtx, "vulkan", "Vulkan Framework Tests"));
 
 	group->addChild(new SelfCheckCase(testCtx, "image_util", "ImageUtil self-check tests", vk::imageUtilSelfTest));
+	group->addChild(new ShaderCacheCase(testCtx));
 
 	return group.release();
 }